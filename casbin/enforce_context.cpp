@@ -0,0 +1,48 @@
+/*
+ * Copyright 2021 The casbin Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "casbin/pch.h"
+
+#ifndef ENFORCE_CONTEXT_CPP
+#define ENFORCE_CONTEXT_CPP
+
+#include "casbin/enforce_context.h"
+
+namespace casbin {
+
+// NewEnforceContext selects the sections with the suffix, "2" for r2, p2, e2 and m2.
+EnforceContext EnforceContext::NewEnforceContext(const std::string& suffix) {
+    EnforceContext context;
+    context.r_type += suffix;
+    context.p_type += suffix;
+    context.e_type += suffix;
+    context.m_type += suffix;
+    return context;
+}
+
+// IsDefault returns true if the context selects r, p, e and m.
+bool EnforceContext::IsDefault() const {
+    return r_type == "r" && p_type == "p" && e_type == "e" && m_type == "m";
+}
+
+// GetKey returns a key identifying the selected sections.
+std::string EnforceContext::GetKey() const {
+    return r_type + "," + p_type + "," + e_type + "," + m_type;
+}
+
+} // namespace casbin
+
+#endif // ENFORCE_CONTEXT_CPP
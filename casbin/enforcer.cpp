@@ -20,6 +20,7 @@
 #define ENFORCER_CPP
 
 #include <algorithm>
+#include <memory_resource>
 #include <regex>
 
 #include "casbin/effect/default_effector.h"
@@ -32,14 +33,131 @@
 #include "casbin/persist/watcher_ex.h"
 #include "casbin/model/policy_collection.hpp"
 #include "casbin/rbac/default_role_manager.h"
+#include "casbin/util/request_arena.h"
 #include "casbin/util/util.h"
 
 namespace casbin {
 
+namespace {
+
+// PushContextRequest pushes the request values under the request definition of a context.
+template <typename Params>
+bool PushContextRequest(IEvaluator& evaluator, const std::string& r_type, const std::vector<std::string>& field_names, const Params& params) {
+    if (params.size() != field_names.size())
+        return false;
+
+    evaluator.InitialObject(r_type);
+    size_t i = 0;
+    for (const Data& param : params) {
+        const std::string& token_name = field_names[i];
+        if (const auto string_param = std::get_if<std::string>(&param))
+            evaluator.PushObjectString(r_type, token_name, *string_param);
+        else if (const auto json_param = std::get_if<std::shared_ptr<nlohmann::json>>(&param))
+            evaluator.PushObjectJson(r_type, token_name, **json_param);
+        ++i;
+    }
+    return true;
+}
+
+bool PushContextRequest(IEvaluator& evaluator, const std::string& r_type, const std::vector<std::string>&, const DataMap& params) {
+    evaluator.InitialObject(r_type);
+    for (const auto& [param_name, param_data] : params) {
+        if (const auto string_param = std::get_if<std::string>(&param_data))
+            evaluator.PushObjectString(r_type, param_name, *string_param);
+        else if (const auto json_param = std::get_if<std::shared_ptr<nlohmann::json>>(&param_data))
+            evaluator.PushObjectJson(r_type, param_name, **json_param);
+    }
+    return true;
+}
+
+// EffectScratch holds the effects and matcher results handed to the effector.
+struct EffectScratch {
+    std::vector<Effect> effects;
+    std::vector<float> results;
+};
+
+// ThreadEffectScratch returns the scratch of the outermost request of the thread, whose
+// capacity is kept from one request to the next.
+EffectScratch& ThreadEffectScratch() {
+    thread_local EffectScratch scratch;
+    return scratch;
+}
+
+// DiscardedExplain returns the explain of the requests of the thread whose caller does not
+// ask for it, so that its capacity is kept from one request to the next.
+std::vector<std::string>& DiscardedExplain() {
+    thread_local std::vector<std::string> explain;
+    return explain;
+}
+
+// RuleRange is the range of the single rule a hashed policy selects for a request.
+struct RuleRange {
+    const PolicyValues* rule;
+
+    const PolicyValues* begin() const {
+        return rule;
+    }
+
+    const PolicyValues* end() const {
+        return rule + 1;
+    }
+};
+
+// RuleRefRange is the range of the rules a partition of the policy points at.
+struct RuleRefRange {
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using difference_type = std::ptrdiff_t;
+        using value_type = const PolicyValues;
+        using pointer = value_type*;
+        using reference = value_type&;
+
+        explicit const_iterator(std::vector<const PolicyValues*>::const_iterator it) : m_it(it) {}
+
+        const PolicyValues& operator*() const {
+            return **m_it;
+        }
+        const_iterator& operator++() {
+            ++m_it;
+            return *this;
+        }
+        bool operator==(const const_iterator& other) const {
+            return m_it == other.m_it;
+        }
+        bool operator!=(const const_iterator& other) const {
+            return m_it != other.m_it;
+        }
+
+    private:
+        std::vector<const PolicyValues*>::const_iterator m_it;
+    };
+
+    const std::vector<const PolicyValues*>* rules;
+
+    const_iterator begin() const {
+        return const_iterator(rules->begin());
+    }
+
+    const_iterator end() const {
+        return const_iterator(rules->end());
+    }
+};
+
+} // namespace
+
 // enforce use a custom matcher to decides whether a "subject" can access a "object"
 // with the operation "action", input parameters are usually: (matcher, sub, obj, act),
 // use model matcher by default when matcher is "".
 bool Enforcer::m_enforce(const std::string& matcher, std::vector<std::string>& explains, std::shared_ptr<IEvaluator> evalator) {
+    static const EnforceContext default_context;
+    return this->enforceWithContext(default_context, matcher, explains, evalator);
+}
+
+// enforceWithContext decides the request with the definitions selected by the context. The
+// indexes serve the model matcher of each context, each with its own, while the hoisted and
+// planned matchers and the hot rule order only serve the default definitions.
+bool Enforcer::enforceWithContext(const EnforceContext& context, const std::string& matcher, std::vector<std::string>& explains, std::shared_ptr<IEvaluator> evalator) {
     if (!explains.empty()) {
         explains.clear();
     }
@@ -49,59 +167,171 @@ bool Enforcer::m_enforce(const std::string& matcher, std::vector<std::string>& e
         return true;
     }
 
-    evalator->func_list.clear();
-    evalator->LoadFunctions();
-
-    // std::unordered_map<std::string, std::shared_ptr<RoleManager>> rm_map;
-    if (m_model->m.find("g") != m_model->m.end()) {
-        for (auto [assertion_name, assertion] : m_model->m["g"].assertion_map) {
-            std::shared_ptr<RoleManager>& rm = assertion->rm;
-
-            int char_count = static_cast<int>(std::count(assertion->value.begin(), assertion->value.end(), '_'));
-            evalator->LoadGFunction(rm, assertion_name, char_count);
-        }
+    if (m_model->m["r"].assertion_map.count(context.r_type) == 0 || m_model->m["p"].assertion_map.count(context.p_type) == 0 ||
+        m_model->m["e"].assertion_map.count(context.e_type) == 0 || m_model->m["m"].assertion_map.count(context.m_type) == 0)
+        throw CasbinEnforcerException("the model has no definitions for " + context.GetKey());
+    std::shared_ptr<Assertion>& p_assertion = m_model->m["p"].assertion_map[context.p_type];
+    const std::string& effect_expr = m_model->m["e"].assertion_map[context.e_type]->value;
+    bool use_indexes = matcher.empty() && context.IsDefault();
+
+    // the indexes of the context, built for its model matcher
+    FastRejectIndex* fast_reject = nullptr;
+    PermissionBitmapIndex* permission_bitmaps = nullptr;
+    EffectPartitionIndex* effect_partition = nullptr;
+    DomainPartitionIndex* domain_partition = nullptr;
+    std::shared_ptr<ContextIndexes> context_indexes;
+    if (use_indexes) {
+        fast_reject = m_fast_reject.get();
+        permission_bitmaps = m_permission_bitmaps.get();
+        effect_partition = m_effect_partition.get();
+        domain_partition = m_domain_partition.get();
+    } else if (matcher.empty() && (context_indexes = this->contextIndexes(context)) != nullptr) {
+        fast_reject = context_indexes->fast_reject.get();
+        permission_bitmaps = context_indexes->permission_bitmaps.get();
+        effect_partition = context_indexes->effect_partition.get();
+        domain_partition = context_indexes->domain_partition.get();
     }
 
-    std::string exp_string;
-    if (matcher.empty()) {
-        exp_string = m_model->m["m"].assertion_map["m"]->value;
-    } else {
-        exp_string = matcher;
+    // a request value no rule can match takes the decision of an unmatched policy
+    if (fast_reject != nullptr && fast_reject->IsApplicable() && !p_assertion->policy.empty() && fast_reject->Rejects(*evalator)) {
+        return this->unmatchedDecision(context);
     }
 
-    std::unordered_map<std::string, int> r_int_tokens;
-    const std::vector<std::string>& r_tokens = m_model->m["r"].assertion_map["r"]->tokens;
-    r_int_tokens.reserve(r_tokens.size());
+    if (permission_bitmaps != nullptr && permission_bitmaps->IsApplicable() && dynamic_cast<DefaultEffector*>(m_eft.get()) != nullptr) {
+        bool allowed;
+        if (permission_bitmaps->Decide(*evalator, allowed, explains))
+            return allowed;
+    }
 
-    for (int i = 0; i < r_tokens.size(); i++) {
-        r_int_tokens[r_tokens[i]] = i;
+    this->loadFunctions(evalator);
+
+    // the parts of the matcher reading only the request are evaluated once, they may decide
+    // the matcher for all the rules
+    RequestHoist::Decision hoisted = RequestHoist::Decision::Unavailable;
+    if (use_indexes && m_request_hoist != nullptr && m_request_hoist->IsApplicable())
+        hoisted = m_request_hoist->Evaluate(*evalator, [this](const std::shared_ptr<IEvaluator>& term_evaluator) { this->loadFunctions(term_evaluator); });
+    if (hoisted == RequestHoist::Decision::MatchesNone && dynamic_cast<DefaultEffector*>(m_eft.get()) != nullptr) {
+        // the scan would reach every rule, and fail on one of the wrong size
+        if (!p_assertion->policy.is_hash())
+            for (const auto& rule : p_assertion->policy)
+                if (rule.size() != p_assertion->tokens.size())
+                    throw CasbinEnforcerException("invalid policy size");
+        return this->unmatchedDecision(context);
+    }
+    // every rule allows, the scan would report the first one, a hashed policy reports the rule
+    // the request selects
+    if (hoisted == RequestHoist::Decision::MatchesAll && dynamic_cast<DefaultEffector*>(m_eft.get()) != nullptr &&
+        effect_expr == "some(where (p.eft == allow))" && !p_assertion->policy.is_hash() &&
+        std::find(p_assertion->tokens.begin(), p_assertion->tokens.end(), "p_eft") == p_assertion->tokens.end()) {
+        if (p_assertion->policy.empty())
+            return true;
+        // the iterator of a mapped policy holds the rule it reads
+        auto first = p_assertion->policy.begin();
+        const PolicyValues& first_rule = *first;
+        if (first_rule.size() == p_assertion->tokens.size()) {
+            explains = first_rule;
+            return true;
+        }
     }
 
-    std::unordered_map<std::string, int> p_int_tokens;
-    const std::vector<std::string>& p_tokens = m_model->m["p"].assertion_map["p"]->tokens;
+    // the model matcher is evaluated hoisted and in the order of the plan, the plan of a hoisted
+    // matcher only serves the requests its terms were evaluated for
+    std::shared_ptr<const std::string> planned_matcher;
+    if (hoisted != RequestHoist::Decision::Unavailable)
+        planned_matcher = m_request_hoist->GetExpression();
+    bool sampled = use_indexes && m_matcher_plan != nullptr && m_matcher_plan->IsApplicable() &&
+                   (hoisted != RequestHoist::Decision::Unavailable || m_request_hoist == nullptr || !m_request_hoist->IsApplicable());
+    if (sampled)
+        planned_matcher = m_matcher_plan->GetExpression();
+    // only the order of the plan is worth skipping operands for
+    evalator->SetShortCircuit(sampled);
+    const std::string& exp_string = planned_matcher != nullptr ? *planned_matcher : matcher.empty() ? m_model->m["m"].assertion_map[context.m_type]->value : matcher;
+
+    // the temporaries of the request live in the arena of the thread
+    RequestArena::Scope arena_scope;
+    std::pmr::unordered_map<std::string_view, int> p_int_tokens(RequestArena::Resource());
+    const std::vector<std::string>& p_tokens = p_assertion->tokens;
     p_int_tokens.reserve(p_tokens.size());
 
     for (int i = 0; i < p_tokens.size(); i++) {
         p_int_tokens[p_tokens[i]] = i;
     }
 
+    int eft_index = p_assertion->eft_index;
+
     bool hasEval = HasEval(exp_string);
 
-    std::vector<Effect> policy_effects;
-    std::vector<float> matcher_results;
+    // the effector takes its results as vectors, the outermost request of the thread reuses
+    // the ones of the previous request
+    EffectScratch nested_scratch;
+    EffectScratch& scratch = arena_scope.IsOutermost() ? ThreadEffectScratch() : nested_scratch;
+    std::vector<Effect>& policy_effects = scratch.effects;
+    std::vector<float>& matcher_results = scratch.results;
+
+    // match evaluates the matcher against a rule, some evaluations are sampled for the plan
+    auto match = [&](const std::vector<std::string>& p_vals) {
+        bool matched = this->matchPolicy(context.p_type, exp_string, hasEval, p_vals, p_int_tokens, evalator);
+        if (sampled && m_matcher_plan->ShouldSample())
+            m_matcher_plan->Sample(*evalator, [this](const std::shared_ptr<IEvaluator>& operand_evaluator) { this->loadFunctions(operand_evaluator); });
+        return matched;
+    };
 
     Effect effect;
     int explainIndex;
 
-    SelectedPolicies selected_policies(evalator, matcher, m_model);
-    PoliciesValues& p_policy = *selected_policies;
+    // deny rules first, then allow rules until the first match
+    const EffectPartitionIndex::Rules* deny_rules;
+    const EffectPartitionIndex::Rules* allow_rules;
+    if (effect_partition != nullptr && dynamic_cast<DefaultEffector*>(m_eft.get()) != nullptr && !p_assertion->policy.empty() &&
+        effect_partition->Select(*evalator, p_assertion->policy, deny_rules, allow_rules)) {
+        for (const PolicyValues* p_vals : *deny_rules) {
+            if (match(*p_vals)) {
+                explains = *p_vals;
+                return false;
+            }
+        }
+        if (effect_partition->GetMode() == EffectPartitionIndex::Mode::DenyOverride)
+            return true;
+        for (const PolicyValues* p_vals : *allow_rules) {
+            if (match(*p_vals)) {
+                explains = *p_vals;
+                return true;
+            }
+        }
+        return false;
+    }
 
-    if (auto policy_len = p_policy.size(); policy_len != 0) {
-        policy_effects = std::vector<Effect>(policy_len, Effect::Indeterminate);
-        matcher_results = std::vector<float>(policy_len, 0.0f);
+    // only the rules of the requested domain can match
+    const DomainPartitionIndex::Rules* domain_rules = nullptr;
+    if (domain_partition != nullptr && !p_assertion->policy.empty()) {
+        domain_rules = domain_partition->Select(*evalator, p_assertion->policy);
+        if (domain_rules != nullptr && domain_rules->empty())
+            return this->unmatchedDecision(context);
+    }
+    // the hashed selection and the scan order serve the default definitions
+    bool whole_policy = domain_rules == nullptr && context.IsDefault();
+
+    // a hashed policy hands the matcher only the rule equal to the request
+    SelectedPolicies selected_policies(evalator, matcher, m_model);
+    const PolicyValues* selected_rule = nullptr;
+    bool selected = whole_policy && selected_policies.IsHashed();
+    if (selected)
+        selected_rule = selected_policies.Find();
+    PoliciesValues& p_policy = context.IsDefault() ? m_model->m["p"].assertion_map["p"]->policy : p_assertion->policy;
+
+    // the rules deciding most requests are scanned first when the order cannot change the decision
+    std::shared_ptr<const HotRuleOrder::Order> hot_order;
+    if (use_indexes && m_hot_rules != nullptr && whole_policy && !selected && m_hot_rules->IsApplicable() &&
+        dynamic_cast<DefaultEffector*>(m_eft.get()) != nullptr)
+        hot_order = m_hot_rules->GetOrder(p_policy);
+
+    // decide merges the effects of the rules until the effector settles
+    auto decide = [&](const auto& rules, size_t policy_len) {
+        policy_effects.assign(policy_len, Effect::Indeterminate);
+        matcher_results.assign(policy_len, 0.0f);
 
         int policy_index = 0;
-        for (auto& p_vals : p_policy ) {
+        for (const auto& p_vals : rules) {
             casbin::LogUtil::LogPrint("Policy Rule: ", p_vals);
             if (p_tokens.size() != p_vals.size()) {
                 throw CasbinEnforcerException("invalid policy size");
@@ -109,57 +339,10 @@ bool Enforcer::m_enforce(const std::string& matcher, std::vector<std::string>& e
                 //  return false;
             }
 
-            evalator->Clean(m_model->m["p"], false);
-            evalator->InitialObject("p");
-            for (int j = 0; j < p_tokens.size(); j++) {
-                size_t index = p_tokens[j].find('_');
-                std::string token = p_tokens[j].substr(index + 1);
-                evalator->PushObjectString("p", token, p_vals[j]);
-            }
-
-            if (hasEval) {
-                auto ruleNames = GetEvalValue(exp_string);
-                std::unordered_map<std::string, std::string> replacements;
-                for (auto& ruleName : ruleNames) {
-                    auto ruleNameCpy = EscapeAssertion(ruleName);
-
-                    bool ok = p_int_tokens.find(ruleNameCpy) != p_int_tokens.end();
-                    if (ok) {
-                        int idx = p_int_tokens[ruleNameCpy];
-                        replacements[ruleName] = p_vals[idx];
-                    } else {
-                        throw CasbinEnforcerException("please make sure rule exists in policy when using eval() in matcher");
-                        // return false;
-                    }
-                }
-
-                auto expWithRule = ReplaceEvalWithMap(exp_string, replacements);
-                evalator->Eval(expWithRule);
-
-            } else {
-                evalator->Eval(exp_string);
-            }
-
-            // set to no-match at first
-            matcher_results[policy_index] = 0;
-            if (evalator->CheckType() == Type::Bool) {
-                bool result = evalator->GetBoolean();
-                if (result) {
-                    matcher_results[policy_index] = 1;
-                }
-            } else if (evalator->CheckType() == Type::Float) {
-                float result = evalator->GetFloat();
-                if (result != 0.0) {
-                    matcher_results[policy_index] = 1;
-                }
-            } else {
-                throw CasbinEnforcerException("matcher result should be bool, int or float");
-                // return false;
-            }
+            matcher_results[policy_index] = match(p_vals) ? 1 : 0;
 
-            if (int is_p_eft = p_int_tokens.find("p_eft") != p_int_tokens.end(); is_p_eft) {
-                int j = p_int_tokens["p_eft"];
-                const std::string& eft = p_vals[j];
+            if (eft_index != -1) {
+                const std::string& eft = p_vals[eft_index];
                 if (eft == "allow") {
                     policy_effects[policy_index] = Effect::Allow;
                 } else if (eft == "deny") {
@@ -171,7 +354,7 @@ bool Enforcer::m_enforce(const std::string& matcher, std::vector<std::string>& e
                 policy_effects[policy_index] = Effect::Allow;
             }
 
-            effect = m_eft->MergeEffects(m_model->m["e"].assertion_map["e"]->value, policy_effects,
+            effect = m_eft->MergeEffects(effect_expr, policy_effects,
                                          matcher_results, policy_index, policy_len, explainIndex);
 
             if (effect != Effect::Indeterminate) {
@@ -181,24 +364,37 @@ bool Enforcer::m_enforce(const std::string& matcher, std::vector<std::string>& e
         }
 
         casbin::LogUtil::LogPrint("Rule Results: ", policy_effects);
+
+        if (explainIndex != -1 && (policy_len > explainIndex)) {
+            explains = *std::next(rules.begin(), explainIndex);
+        }
+    };
+
+    if (selected && selected_rule != nullptr) {
+        decide(RuleRange{selected_rule}, 1);
+    } else if (domain_rules != nullptr) {
+        decide(RuleRefRange{domain_rules}, domain_rules->size());
+    } else if (hot_order != nullptr) {
+        decide(m_hot_rules->GetRules(*hot_order), hot_order->size());
+        if (explainIndex != -1 && static_cast<size_t>(explainIndex) < hot_order->size())
+            m_hot_rules->Hit(*hot_order, explainIndex);
+    } else if (auto policy_len = selected ? 0 : p_policy.size(); policy_len != 0) {
+        decide(p_policy, policy_len);
     } else {
-        if (hasEval && p_policy.empty()) {
+        if (hasEval) {
             throw CasbinEnforcerException("please make sure rule exists in policy when using eval() in matcher");
             // return false;
         }
 
-        policy_effects = std::vector<Effect>(1, Effect::Indeterminate);
-        matcher_results = std::vector<float>(1, 1);
+        policy_effects.assign(1, Effect::Indeterminate);
+        matcher_results.assign(1, 1);
 
         // Push initial value for p in symbol table
         // If p don't in symbol table, the evaluate result will be invalid.
         evalator->Clean(m_model->m["p"], false);
-        evalator->InitialObject("p");
-        for (const auto& p_token : p_tokens) {
-            size_t index = p_token.find("_");
-            std::string token = p_token.substr(index + 1);
-            evalator->PushObjectString("p", token, "");
-        }
+        evalator->InitialObject(context.p_type);
+        for (const std::string& field_name : p_assertion->field_names)
+            evalator->PushObjectString(context.p_type, field_name, "");
 
         bool isvalid = evalator->Eval(exp_string);
         if (!isvalid) {
@@ -212,20 +408,12 @@ bool Enforcer::m_enforce(const std::string& matcher, std::vector<std::string>& e
             policy_effects[0] = Effect::Indeterminate;
         }
 
-        effect = m_eft->MergeEffects(m_model->m["e"].assertion_map["e"]->value, policy_effects,
+        effect = m_eft->MergeEffects(effect_expr, policy_effects,
                                      matcher_results, 0, 1, explainIndex);
 
         casbin::LogUtil::LogPrint("Rule Results: ", policy_effects);
     }
 
-    PoliciesValues logExplains;
-
-    logExplains.emplace(explains);
-    if (explainIndex != -1 && (p_policy.size() > explainIndex)) {
-        explains = *std::next(p_policy.begin(), explainIndex);
-        logExplains.emplace(explains);
-    }
-
     // effect --> result
     bool result = false;
     if (effect == Effect::Allow) {
@@ -235,6 +423,70 @@ bool Enforcer::m_enforce(const std::string& matcher, std::vector<std::string>& e
     return result;
 }
 
+// loadFunctions registers the built-in functions and the "g" functions of the model.
+void Enforcer::loadFunctions(const std::shared_ptr<IEvaluator>& evalator) {
+    evalator->func_list.clear();
+    evalator->LoadFunctions();
+
+    // std::unordered_map<std::string, std::shared_ptr<RoleManager>> rm_map;
+    if (m_model->m.find("g") != m_model->m.end()) {
+        for (const auto& [assertion_name, assertion] : m_model->m["g"].assertion_map) {
+            std::shared_ptr<RoleManager>& rm = assertion->rm;
+
+            int char_count = static_cast<int>(std::count(assertion->value.begin(), assertion->value.end(), '_'));
+            evalator->LoadGFunction(rm, assertion_name, char_count);
+        }
+    }
+}
+
+// unmatchedDecision returns the decision of the effect of the context when no rule of the
+// policy matches.
+bool Enforcer::unmatchedDecision(const EnforceContext& context) {
+    static const std::vector<Effect> effects = {Effect::Indeterminate};
+    static const std::vector<float> results = {0.0f};
+    int explain_index;
+    Effect effect = m_eft->MergeEffects(m_model->m["e"].assertion_map[context.e_type]->value, effects, results, 0, 1, explain_index);
+    return effect == Effect::Allow;
+}
+
+// matchPolicy evaluates the matcher against one policy rule.
+bool Enforcer::matchPolicy(const std::string& p_type, const std::string& exp_string, bool has_eval, const std::vector<std::string>& p_vals, const std::pmr::unordered_map<std::string_view, int>& p_int_tokens, const std::shared_ptr<IEvaluator>& evalator) {
+    const std::vector<std::string>& field_names = m_model->m["p"].assertion_map[p_type]->field_names;
+
+    evalator->Clean(m_model->m["p"], false);
+    evalator->InitialObject(p_type);
+    for (size_t j = 0; j < field_names.size(); j++)
+        evalator->PushObjectString(p_type, field_names[j], p_vals[j]);
+
+    if (has_eval) {
+        auto ruleNames = GetEvalValue(exp_string);
+        std::unordered_map<std::string, std::string> replacements;
+        for (auto& ruleName : ruleNames) {
+            auto ruleNameCpy = EscapeAssertion(ruleName);
+
+            if (auto it = p_int_tokens.find(ruleNameCpy); it != p_int_tokens.end()) {
+                replacements[ruleName] = p_vals[it->second];
+            } else {
+                throw CasbinEnforcerException("please make sure rule exists in policy when using eval() in matcher");
+                // return false;
+            }
+        }
+
+        auto expWithRule = ReplaceEvalWithMap(exp_string, replacements);
+        evalator->Eval(expWithRule);
+
+    } else {
+        evalator->Eval(exp_string);
+    }
+
+    if (evalator->CheckType() == Type::Bool) {
+        return evalator->GetBoolean();
+    } else if (evalator->CheckType() == Type::Float) {
+        return evalator->GetFloat() != 0.0;
+    }
+    throw CasbinEnforcerException("matcher result should be bool, int or float");
+}
+
 /**
  * Enforcer is the default constructor.
  */
@@ -338,15 +590,170 @@ void Enforcer::InitWithModelAndAdapter(const std::shared_ptr<Model>& m, std::sha
 }
 
 void Enforcer::Initialize() {
-    this->rm = std::make_shared<DefaultRoleManager>(10);
+    // the role graph is allocated with the policy of the model
+    this->rm = std::make_shared<DefaultRoleManager>(10, m_model != nullptr ? m_model->GetMemoryResource() : std::pmr::get_default_resource());
     m_eft = std::make_shared<DefaultEffector>();
     m_watcher = nullptr;
     m_evalator = nullptr;
+    m_context_evaluators.clear();
+    m_request_slots_evaluator = nullptr;
+    m_request_slots.clear();
 
     m_enabled = true;
     m_auto_save = true;
     m_auto_build_role_links = true;
     m_auto_notify_watcher = true;
+    m_rm_shared = false;
+
+    this->buildMatcherPlans();
+    this->rebuildIndexes();
+}
+
+// Fork creates an enforcer sharing the policy and the role graph of this one.
+std::shared_ptr<Enforcer> Enforcer::Fork() {
+    auto fork = std::make_shared<Enforcer>();
+    this->forkInto(*fork);
+    return fork;
+}
+
+void Enforcer::forkInto(Enforcer& fork) {
+    fork.m_model_path = m_model_path;
+    fork.m_model = m_model->Fork();
+    fork.m_eft = m_eft;
+    fork.m_log = m_log;
+    fork.rm = this->rm;
+    fork.m_enabled = m_enabled;
+    fork.m_auto_save = m_auto_save;
+    fork.m_auto_build_role_links = m_auto_build_role_links;
+    fork.m_auto_notify_watcher = m_auto_notify_watcher;
+    fork.m_auto_warmup = m_auto_warmup;
+
+    // both copy the role graph before changing it
+    m_rm_shared = true;
+    fork.m_rm_shared = true;
+}
+
+void Enforcer::unshareRoleManager() {
+    if (!m_rm_shared)
+        return;
+
+    auto default_rm = std::dynamic_pointer_cast<DefaultRoleManager>(this->rm);
+    if (default_rm == nullptr)
+        throw CasbinEnforcerException("the role graph of a fork can only be copied from a DefaultRoleManager");
+    std::shared_ptr<RoleManager> copy = default_rm->Copy();
+
+    if (m_model->HasSection("g")) {
+        for (auto& [key, assertion] : m_model->m["g"].assertion_map) {
+            m_model->Unshare("g", key);
+            if (assertion->rm == this->rm)
+                assertion->rm = copy;
+        }
+    }
+
+    // the copy has the links of the shared graph, what the indexes computed from it holds
+    if (m_permission_bitmaps != nullptr)
+        m_permission_bitmaps->SetRoleManager(this->rm, copy);
+    {
+        std::lock_guard<std::mutex> lock(*m_context_mutex);
+        for (auto& [_, indexes] : m_context_indexes)
+            if (indexes->permission_bitmaps != nullptr)
+                indexes->permission_bitmaps->SetRoleManager(this->rm, copy);
+    }
+    if (m_id_policy != nullptr)
+        m_id_policy->SetRoleManager(this->rm, copy);
+    this->rm = copy;
+    m_rm_shared = false;
+}
+
+// buildMatcherPlans hoists and plans the model matcher, as enabled. The plan orders the
+// hoisted matcher when there is one.
+void Enforcer::buildMatcherPlans() {
+    std::shared_ptr<const std::string> hoisted_matcher;
+    if (m_request_hoist != nullptr) {
+        m_request_hoist->Build(m_model);
+        if (m_request_hoist->IsApplicable())
+            hoisted_matcher = m_request_hoist->GetExpression();
+    }
+    if (m_matcher_plan != nullptr)
+        m_matcher_plan->Build(m_model, hoisted_matcher);
+}
+
+void Enforcer::rebuildIndexes() {
+    if (m_fast_reject != nullptr)
+        m_fast_reject->Build(m_model);
+    if (m_permission_bitmaps != nullptr)
+        m_permission_bitmaps->Build(m_model);
+    if (m_effect_partition != nullptr)
+        m_effect_partition->Build(m_model);
+    if (m_domain_partition != nullptr)
+        m_domain_partition->Build(m_model);
+    if (m_id_policy != nullptr)
+        m_id_policy->Build(m_model);
+    if (m_hot_rules != nullptr)
+        m_hot_rules->Build(m_model);
+    this->clearContextIndexes();
+}
+
+void Enforcer::updateIndexes(policy_op op, const std::string& sec, const std::string& p_type, const PoliciesValues& rules) {
+    if (m_fast_reject != nullptr)
+        m_fast_reject->Update(op, sec, p_type, rules);
+    if (m_permission_bitmaps != nullptr)
+        m_permission_bitmaps->Update(op, sec, p_type, rules);
+    if (m_effect_partition != nullptr)
+        m_effect_partition->Update(m_model, op, sec, p_type, rules);
+    if (m_domain_partition != nullptr)
+        m_domain_partition->Update(m_model, op, sec, p_type, rules);
+    if (m_id_policy != nullptr)
+        m_id_policy->Update(op, sec, p_type, rules);
+    if (m_hot_rules != nullptr)
+        m_hot_rules->Update(sec, p_type);
+
+    std::lock_guard<std::mutex> lock(*m_context_mutex);
+    for (auto& [_, indexes] : m_context_indexes) {
+        if (indexes->fast_reject != nullptr)
+            indexes->fast_reject->Update(op, sec, p_type, rules);
+        if (indexes->permission_bitmaps != nullptr)
+            indexes->permission_bitmaps->Update(op, sec, p_type, rules);
+        if (indexes->effect_partition != nullptr)
+            indexes->effect_partition->Update(m_model, op, sec, p_type, rules);
+        if (indexes->domain_partition != nullptr)
+            indexes->domain_partition->Update(m_model, op, sec, p_type, rules);
+    }
+}
+
+void Enforcer::clearContextIndexes() {
+    std::lock_guard<std::mutex> lock(*m_context_mutex);
+    m_context_indexes.clear();
+}
+
+// contextIndexes returns the enabled indexes of a non-default context, built for its
+// definitions on its first request.
+std::shared_ptr<Enforcer::ContextIndexes> Enforcer::contextIndexes(const EnforceContext& context) {
+    if (m_fast_reject == nullptr && m_permission_bitmaps == nullptr && m_effect_partition == nullptr && m_domain_partition == nullptr)
+        return nullptr;
+
+    std::lock_guard<std::mutex> lock(*m_context_mutex);
+    std::shared_ptr<ContextIndexes>& indexes = m_context_indexes[context.GetKey()];
+    if (indexes != nullptr)
+        return indexes;
+    indexes = std::make_shared<ContextIndexes>();
+    if (m_fast_reject != nullptr) {
+        indexes->fast_reject = std::make_shared<FastRejectIndex>();
+        indexes->fast_reject->Build(m_model, context);
+    }
+    if (m_permission_bitmaps != nullptr) {
+        indexes->permission_bitmaps = std::make_shared<PermissionBitmapIndex>();
+        indexes->permission_bitmaps->Build(m_model, context);
+    }
+    if (m_effect_partition != nullptr) {
+        indexes->effect_partition = std::make_shared<EffectPartitionIndex>();
+        indexes->effect_partition->Build(m_model, context);
+    }
+    if (m_domain_partition != nullptr) {
+        indexes->domain_partition = std::make_shared<DomainPartitionIndex>();
+        indexes->domain_partition->Build(m_model, context);
+    }
+    return indexes;
 }
 
 /**
@@ -410,17 +817,34 @@ std::shared_ptr<RoleManager> Enforcer ::GetRoleManager() {
 
 // SetRoleManager sets the current role manager.
 void Enforcer::SetRoleManager(std::shared_ptr<RoleManager>& rm) {
+    std::shared_ptr<RoleManager> previous = this->rm;
     this->rm = rm;
+    m_rm_shared = false;
+
+    // the role definitions linked in the previous role manager, and the indexes reading them,
+    // read the new one
+    if (m_model->HasSection("g")) {
+        for (auto& [key, assertion] : m_model->m["g"].assertion_map) {
+            if (assertion->rm != previous)
+                continue;
+            m_model->Unshare("g", key);
+            assertion->rm = rm;
+        }
+    }
+    this->rebuildIndexes();
 }
 
 // SetEffector sets the current effector.
 void Enforcer::SetEffector(std::shared_ptr<Effector> eft) {
     m_eft = eft;
+    if (m_id_policy != nullptr)
+        m_id_policy->SetEffector(eft);
 }
 
 // ClearPolicy clears all policy.
 void Enforcer::ClearPolicy() {
     m_model->ClearPolicy();
+    this->rebuildIndexes();
 }
 
 // LoadPolicy reloads the policy from file/database.
@@ -432,7 +856,12 @@ void Enforcer::LoadPolicy() {
 
     if (m_auto_build_role_links) {
         Enforcer::BuildRoleLinks();
+    } else {
+        this->rebuildIndexes();
     }
+
+    if (m_auto_warmup)
+        Enforcer::Warmup();
 }
 
 // LoadFilteredPolicy reloads a filtered policy from file/database.
@@ -452,6 +881,11 @@ void Enforcer::LoadFilteredPolicy(Filter filter) {
     m_model->PrintPolicy();
     if (m_auto_build_role_links)
         this->BuildRoleLinks();
+    else
+        this->rebuildIndexes();
+
+    if (m_auto_warmup)
+        Enforcer::Warmup();
 }
 
 // IsFiltered returns true if the loaded policy has been filtered.
@@ -503,13 +937,194 @@ void Enforcer::EnableAutoBuildRoleLinks(bool auto_build_role_links) {
 
 // BuildRoleLinks manually rebuild the role inheritance relations.
 void Enforcer::BuildRoleLinks() {
+    this->unshareRoleManager();
     this->rm->Clear();
 
     m_model->BuildRoleLinks(this->rm);
+    this->rebuildIndexes();
+}
+
+// EnableFastReject controls whether requests with a value that appears in no rule the matcher
+// requires it to equal are decided without scanning the policy.
+void Enforcer::EnableFastReject(bool enable) {
+    this->clearContextIndexes();
+    if (!enable) {
+        m_fast_reject = nullptr;
+        return;
+    }
+    if (m_fast_reject == nullptr)
+        m_fast_reject = std::make_shared<FastRejectIndex>();
+    m_fast_reject->Build(m_model);
+}
+
+// EnablePermissionBitmaps controls whether closed-world RBAC requests are decided with
+// precomputed permission bitmaps instead of evaluating the matcher.
+void Enforcer::EnablePermissionBitmaps(bool enable) {
+    this->clearContextIndexes();
+    if (!enable) {
+        m_permission_bitmaps = nullptr;
+        return;
+    }
+    if (m_permission_bitmaps == nullptr)
+        m_permission_bitmaps = std::make_shared<PermissionBitmapIndex>();
+    m_permission_bitmaps->Build(m_model);
+}
+
+// EnableEffectPartition controls whether deny and allow rules are kept apart so that
+// deny-override effects stop at the first deciding rule.
+void Enforcer::EnableEffectPartition(bool enable) {
+    this->clearContextIndexes();
+    if (!enable) {
+        m_effect_partition = nullptr;
+        return;
+    }
+    if (m_effect_partition == nullptr)
+        m_effect_partition = std::make_shared<EffectPartitionIndex>();
+    m_effect_partition->Build(m_model);
+}
+
+// EnableDomainPartition controls whether the rules of a domain model are partitioned by
+// domain, so that requests and filtered operations naming a domain only touch its rules.
+void Enforcer::EnableDomainPartition(bool enable) {
+    this->clearContextIndexes();
+    if (!enable) {
+        m_domain_partition = nullptr;
+        return;
+    }
+    if (m_domain_partition == nullptr)
+        m_domain_partition = std::make_shared<DomainPartitionIndex>();
+    m_domain_partition->Build(m_model);
+}
+
+// EnableValueIds controls whether the policy values are interned in a dictionary, so that
+// requests given as value ids are decided on integers.
+void Enforcer::EnableValueIds(bool enable) {
+    if (!enable) {
+        m_id_policy = nullptr;
+        return;
+    }
+    if (m_id_policy == nullptr)
+        m_id_policy = std::make_shared<IdPolicyIndex>();
+    m_id_policy->SetEffector(m_eft);
+    m_id_policy->Build(m_model);
+}
+
+// EnableHotRuleOrder controls whether the rules of first-match effects are scanned in the order
+// of the requests they decided, so that the scan length follows the traffic.
+void Enforcer::EnableHotRuleOrder(bool enable) {
+    if (!enable) {
+        m_hot_rules = nullptr;
+        return;
+    }
+    if (m_hot_rules == nullptr)
+        m_hot_rules = std::make_shared<HotRuleOrder>();
+    m_hot_rules->Build(m_model);
+}
+
+// EnableMatcherReordering controls whether the operands of the "&&" and "||" of the matcher
+// are evaluated cheapest and most deciding first, as estimated and then measured.
+void Enforcer::EnableMatcherReordering(bool enable) {
+    if (!enable) {
+        m_matcher_plan = nullptr;
+        return;
+    }
+    if (m_matcher_plan == nullptr)
+        m_matcher_plan = std::make_shared<MatcherPlan>();
+    this->buildMatcherPlans();
+}
+
+// EnableRequestHoisting controls whether the parts of the matcher reading only the request
+// are evaluated once per request instead of once per rule.
+void Enforcer::EnableRequestHoisting(bool enable) {
+    if (!enable)
+        m_request_hoist = nullptr;
+    else if (m_request_hoist == nullptr)
+        m_request_hoist = std::make_shared<RequestHoist>();
+    this->buildMatcherPlans();
+}
+
+// GetValueDictionary returns a copy of the value dictionary to resolve request values with.
+// The ids it resolves stay valid while its epoch is the epoch of the enforcer,
+// ResolveValueIds resolves a request without copying it.
+ValueDictionary Enforcer::GetValueDictionary() {
+    if (m_id_policy == nullptr || !m_id_policy->IsApplicable())
+        throw CasbinEnforcerException("value ids are not enabled for this model and effector");
+    return m_id_policy->GetDictionary();
+}
+
+// ResolveValueIds returns the ids of the values of a request.
+ValueIds Enforcer::ResolveValueIds(const std::vector<std::string>& values) {
+    if (m_id_policy == nullptr || !m_id_policy->IsApplicable())
+        throw CasbinEnforcerException("value ids are not enabled for this model and effector");
+    return m_id_policy->GetDictionary().Resolve(values);
+}
+
+// GetValueDictionaryEpoch returns the epoch of the value dictionary, ids resolved in an
+// earlier epoch must be resolved again.
+uint64_t Enforcer::GetValueDictionaryEpoch() {
+    if (m_id_policy == nullptr || !m_id_policy->IsApplicable())
+        throw CasbinEnforcerException("value ids are not enabled for this model and effector");
+    return m_id_policy->GetDictionary().GetEpoch();
+}
+
+// EnableAutoWarmup controls whether the enforcer is warmed up after every policy load.
+void Enforcer::EnableAutoWarmup(bool enable) {
+    m_auto_warmup = enable;
+}
+
+// Warmup prepares the enforcer for its first request: it creates the evaluator, compiles
+// the matcher on it and computes the role closures of the permission bitmaps.
+void Enforcer::Warmup() {
+    if (m_evalator == nullptr)
+        m_evalator = IEvaluator::NewEvaluator();
+    this->PrepareEvaluator(m_evalator);
+
+    if (m_permission_bitmaps != nullptr)
+        m_permission_bitmaps->Prepare(m_model);
+}
+
+// PrepareEvaluator registers the functions of the model on the evaluator and compiles the
+// model matcher, so that the first request evaluated with it does not pay for either.
+// Matchers using eval() depend on the rules and are still compiled on demand.
+void Enforcer::PrepareEvaluator(const std::shared_ptr<IEvaluator>& evaluator) {
+    if (!m_model->HasSection("m") || !m_model->HasSection("r") || !m_model->HasSection("p"))
+        return;
+    const std::string& matcher = m_model->m["m"].assertion_map["m"]->value;
+    if (HasEval(matcher))
+        return;
+    bool hoisting = m_request_hoist != nullptr && m_request_hoist->IsApplicable();
+    std::shared_ptr<const std::string> planned_matcher;
+    if (hoisting)
+        planned_matcher = m_request_hoist->GetExpression();
+    bool planned = m_matcher_plan != nullptr && m_matcher_plan->IsApplicable();
+    if (planned)
+        planned_matcher = m_matcher_plan->GetExpression();
+    const std::string& exp_string = planned_matcher != nullptr ? *planned_matcher : matcher;
+    evaluator->SetShortCircuit(planned);
+
+    this->loadFunctions(evaluator);
+    if (hoisting)
+        m_request_hoist->InitialObject(*evaluator);
+
+    evaluator->InitialObject("r");
+    for (const std::string& r_token : m_model->m["r"].assertion_map["r"]->tokens)
+        evaluator->PushObjectString("r", r_token.substr(2), "");
+    evaluator->InitialObject("p");
+    for (const std::string& p_token : m_model->m["p"].assertion_map["p"]->tokens)
+        evaluator->PushObjectString("p", p_token.substr(2), "");
+
+    // a matcher that does not compile yet, e.g. for a missing function, is left to the
+    // first request
+    if (!evaluator->Eval(exp_string)) {
+        evaluator->Clean(m_model->m["p"]);
+        if (evaluator == m_request_slots_evaluator)
+            m_request_slots_evaluator = nullptr;
+    }
 }
 
 // BuildIncrementalRoleLinks provides incremental build the role inheritance relations.
 void Enforcer::BuildIncrementalRoleLinks(policy_op op, const std::string& p_type, const PoliciesValues& rules) {
+    this->unshareRoleManager();
     return m_model->BuildIncrementalRoleLinks(this->rm, op, "g", p_type, rules);
 }
 
@@ -533,23 +1148,32 @@ bool Enforcer::Enforce(const DataMap& params) {
     return this->EnforceWithMatcher("", params);
 }
 
+// Enforce with value ids decides a request resolved by the value dictionary.
+bool Enforcer::Enforce(const ValueIds& request) {
+    if (!m_enabled)
+        return true;
+    if (m_id_policy == nullptr || !m_id_policy->IsApplicable())
+        throw CasbinEnforcerException("value ids are not enabled for this model and effector");
+    return m_id_policy->Decide(request);
+}
+
 // EnforceWithMatcher use a custom matcher to decides whether a "subject" can access a "object" with the operation "action", input parameters are usually: (matcher, sub, obj, act), use model matcher by default when matcher is "".
 bool Enforcer::EnforceWithMatcher(const std::string& matcher, std::shared_ptr<IEvaluator> evalator) {
-    std::vector<std::string> explain;
+    std::vector<std::string>& explain = DiscardedExplain();
     bool result = EnforceExWithMatcher(matcher, evalator, explain);
     return result;
 }
 
 // EnforceWithMatcher use a custom matcher to decides whether a "subject" can access a "object" with the operation "action", input parameters are usually: (matcher, sub, obj, act), use model matcher by default when matcher is "".
 bool Enforcer::EnforceWithMatcher(const std::string& matcher, const DataList& params) {
-    std::vector<std::string> explain;
+    std::vector<std::string>& explain = DiscardedExplain();
     bool result = EnforceExWithMatcher(matcher, params, explain);
     return result;
 }
 
 // EnforceWithMatcher use a custom matcher to decides whether a "subject" can access a "object" with the operation "action", input parameters are usually: (matcher, sub, obj, act), use model matcher by default when matcher is "".
 bool Enforcer::EnforceWithMatcher(const std::string& matcher, const DataVector& params) {
-    std::vector<std::string> explain;
+    std::vector<std::string>& explain = DiscardedExplain();
     bool result = EnforceExWithMatcher(matcher, params, explain);
     return result;
 }
@@ -558,7 +1182,7 @@ bool Enforcer::EnforceWithMatcher(const std::string& matcher, const DataVector&
 // with the operation "action", input parameters are usually: (matcher, sub, obj, act),
 // use model matcher by default when matcher is "".
 bool Enforcer::EnforceWithMatcher(const std::string& matcher, const DataMap& params) {
-    std::vector<std::string> explain;
+    std::vector<std::string>& explain = DiscardedExplain();
     bool result = EnforceExWithMatcher(matcher, params, explain);
     return result;
 }
@@ -593,7 +1217,7 @@ bool Enforcer::EnforceExWithMatcher(const std::string& matcher, const DataList&
         return false;
 
     if (this->m_evalator == nullptr) {
-        this->m_evalator = std::make_shared<ExprtkEvaluator>();
+        this->m_evalator = IEvaluator::NewEvaluator();
     }
 
     this->m_evalator->InitialObject("r");
@@ -626,7 +1250,7 @@ bool Enforcer::EnforceExWithMatcher(const std::string& matcher, const DataVector
         return false;
 
     if (this->m_evalator == nullptr) {
-        this->m_evalator = std::make_shared<ExprtkEvaluator>();
+        this->m_evalator = IEvaluator::NewEvaluator();
     }
 
     this->m_evalator->InitialObject("r");
@@ -652,7 +1276,7 @@ bool Enforcer::EnforceExWithMatcher(const std::string& matcher, const DataVector
 }
 bool Enforcer::EnforceExWithMatcher(const std::string& matcher, const DataMap& params, std::vector<std::string>& explain) {
     if (this->m_evalator == nullptr) {
-        this->m_evalator = std::make_shared<ExprtkEvaluator>();
+        this->m_evalator = IEvaluator::NewEvaluator();
     }
 
     this->m_evalator->InitialObject("r");
@@ -671,6 +1295,119 @@ bool Enforcer::EnforceExWithMatcher(const std::string& matcher, const DataMap& p
     return result;
 }
 
+// enforceValues decides a request given as the values of the request tokens in order. The
+// storage of the request values in the evaluator is resolved once, then every request only
+// assigns to it.
+bool Enforcer::enforceValues(const std::string_view* values, size_t count, std::vector<std::string>& explain) {
+    const std::vector<std::string>& r_tokens = m_model->m["r"].assertion_map["r"]->tokens;
+    if (count != r_tokens.size())
+        return false;
+
+    if (m_evalator == nullptr)
+        m_evalator = IEvaluator::NewEvaluator();
+    if (m_request_slots_evaluator != m_evalator) {
+        m_request_slots.clear();
+        for (const std::string& r_token : r_tokens)
+            m_request_slots.push_back(m_evalator->GetObjectSlot("r", r_token.substr(2)));
+        m_request_slots_evaluator = m_evalator;
+    }
+
+    m_evalator->InitialObject("r");
+    for (size_t i = 0; i < count; ++i) {
+        if (m_request_slots[i] != nullptr)
+            m_request_slots[i]->assign(values[i].data(), values[i].size());
+        else
+            m_evalator->PushObjectString("r", r_tokens[i].substr(2), std::string(values[i]));
+    }
+
+    return m_enforce("", explain, m_evalator);
+}
+
+// withContextEvaluator decides a request of the context with an evaluator of the context.
+// Each context keeps its own, so that alternating contexts do not recompile their matchers,
+// and a request of a non-default context takes an idle one, so that concurrent requests of
+// the context do not share it.
+bool Enforcer::withContextEvaluator(const EnforceContext& context, const std::function<bool(const std::shared_ptr<IEvaluator>&)>& decide) {
+    if (context.IsDefault()) {
+        if (m_evalator == nullptr)
+            m_evalator = IEvaluator::NewEvaluator();
+        return decide(m_evalator);
+    }
+
+    std::shared_ptr<IEvaluator> evaluator;
+    {
+        std::lock_guard<std::mutex> lock(*m_context_mutex);
+        std::vector<std::shared_ptr<IEvaluator>>& idle = m_context_evaluators[context.GetKey()];
+        if (!idle.empty()) {
+            evaluator = std::move(idle.back());
+            idle.pop_back();
+        }
+    }
+    if (evaluator == nullptr)
+        evaluator = IEvaluator::NewEvaluator();
+
+    auto release = [&]() {
+        std::lock_guard<std::mutex> lock(*m_context_mutex);
+        m_context_evaluators[context.GetKey()].push_back(std::move(evaluator));
+    };
+    bool result;
+    try {
+        result = decide(evaluator);
+    } catch (...) {
+        release();
+        throw;
+    }
+    release();
+    return result;
+}
+
+// EnforceWithContext decides the request with the request, policy, effect and matcher
+// definitions selected by the context.
+bool Enforcer::EnforceWithContext(const EnforceContext& context, const DataList& params) {
+    std::vector<std::string>& explain = DiscardedExplain();
+    return this->EnforceExWithContext(context, params, explain);
+}
+
+bool Enforcer::EnforceWithContext(const EnforceContext& context, const DataVector& params) {
+    std::vector<std::string>& explain = DiscardedExplain();
+    return this->EnforceExWithContext(context, params, explain);
+}
+
+bool Enforcer::EnforceWithContext(const EnforceContext& context, const DataMap& params) {
+    std::vector<std::string>& explain = DiscardedExplain();
+    return this->EnforceExWithContext(context, params, explain);
+}
+
+// EnforceExWithContext explains the decision of EnforceWithContext.
+bool Enforcer::EnforceExWithContext(const EnforceContext& context, const DataList& params, std::vector<std::string>& explain) {
+    if (m_model->m["r"].assertion_map.count(context.r_type) == 0)
+        throw CasbinEnforcerException("the model has no definitions for " + context.GetKey());
+    return this->withContextEvaluator(context, [&](const std::shared_ptr<IEvaluator>& evaluator) {
+        if (!PushContextRequest(*evaluator, context.r_type, m_model->m["r"].assertion_map[context.r_type]->field_names, params))
+            return false;
+        return this->enforceWithContext(context, "", explain, evaluator);
+    });
+}
+
+bool Enforcer::EnforceExWithContext(const EnforceContext& context, const DataVector& params, std::vector<std::string>& explain) {
+    if (m_model->m["r"].assertion_map.count(context.r_type) == 0)
+        throw CasbinEnforcerException("the model has no definitions for " + context.GetKey());
+    return this->withContextEvaluator(context, [&](const std::shared_ptr<IEvaluator>& evaluator) {
+        if (!PushContextRequest(*evaluator, context.r_type, m_model->m["r"].assertion_map[context.r_type]->field_names, params))
+            return false;
+        return this->enforceWithContext(context, "", explain, evaluator);
+    });
+}
+
+bool Enforcer::EnforceExWithContext(const EnforceContext& context, const DataMap& params, std::vector<std::string>& explain) {
+    if (m_model->m["r"].assertion_map.count(context.r_type) == 0)
+        throw CasbinEnforcerException("the model has no definitions for " + context.GetKey());
+    return this->withContextEvaluator(context, [&](const std::shared_ptr<IEvaluator>& evaluator) {
+        PushContextRequest(*evaluator, context.r_type, m_model->m["r"].assertion_map[context.r_type]->field_names, params);
+        return this->enforceWithContext(context, "", explain, evaluator);
+    });
+}
+
 // BatchEnforce enforce in batches
 std::vector<bool> Enforcer::BatchEnforce(const std::initializer_list<DataList>& requests) {
     // Initializing an array for storing results with false
@@ -105,12 +105,18 @@ CachedEnforcer ::CachedEnforcer(const std::string& model_path, const std::string
 CachedEnforcer::CachedEnforcer(const CachedEnforcer& ce)
     : Enforcer(ce) {
     this->m = ce.m;
+    this->context_cache = ce.context_cache;
+    this->id_cache = ce.id_cache;
+    this->id_cache_epoch = ce.id_cache_epoch;
     this->enableCache = ce.enableCache;
 }
 
 CachedEnforcer::CachedEnforcer(CachedEnforcer&& ce) noexcept
     : Enforcer(ce) {
     this->m = std::move(ce.m);
+    this->context_cache = std::move(ce.context_cache);
+    this->id_cache = std::move(ce.id_cache);
+    this->id_cache_epoch = ce.id_cache_epoch;
     this->enableCache = ce.enableCache;
 }
 
@@ -137,8 +143,67 @@ void CachedEnforcer::setCachedResult(const std::string& key, const bool& res) {
     locker.unlock();
 }
 
+// getCachedResult reads the decision cached in the namespace of the context, the default
+// definitions share the one of Enforce.
+std::pair<bool, bool> CachedEnforcer::getCachedResult(const EnforceContext& context, const std::string& key) {
+    if (context.IsDefault())
+        return getCachedResult(key);
+
+    std::lock_guard<std::mutex> lock(locker);
+    auto context_it = context_cache.find(context.GetKey());
+    if (context_it == context_cache.end())
+        return std::pair<bool, bool>(false, false);
+    auto it = context_it->second.find(key);
+    if (it == context_it->second.end())
+        return std::pair<bool, bool>(false, false);
+    return std::pair<bool, bool>(it->second, true);
+}
+
+void CachedEnforcer::setCachedResult(const EnforceContext& context, const std::string& key, const bool& res) {
+    if (context.IsDefault()) {
+        setCachedResult(key, res);
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(locker);
+    context_cache[context.GetKey()][key] = res;
+}
+
 void CachedEnforcer::InvalidateCache() {
     m.clear();
+    context_cache.clear();
+    id_cache.clear();
+}
+
+// CommitTransaction applies the operations staged in the transaction and invalidates
+// the cache once.
+bool CachedEnforcer::CommitTransaction(Transaction& transaction) {
+    bool committed = Enforcer::CommitTransaction(transaction);
+    if (committed) {
+        locker.lock();
+        this->InvalidateCache();
+        locker.unlock();
+    }
+    return committed;
+}
+
+// Fork creates a cached enforcer sharing the policy and the role graph of this one.
+std::shared_ptr<Enforcer> CachedEnforcer::Fork() {
+    auto fork = std::make_shared<CachedEnforcer>();
+    this->forkInto(*fork);
+    fork->enableCache = this->enableCache;
+    return fork;
+}
+
+// importPolicies moves rules into the current policy and invalidates the cache once.
+size_t CachedEnforcer::importPolicies(const std::string& sec, const std::string& p_type, std::vector<std::vector<std::string>>&& rules) {
+    size_t rules_imported = Enforcer::importPolicies(sec, p_type, std::move(rules));
+    if (rules_imported > 0) {
+        locker.lock();
+        this->InvalidateCache();
+        locker.unlock();
+    }
+    return rules_imported;
 }
 
 // Enforce decides whether a "subject" can access a "object" with the operation
@@ -163,6 +228,35 @@ bool CachedEnforcer::Enforce(const DataMap& params) {
     return EnforceWithMatcher("", params);
 }
 
+// Enforce with value ids decides a request resolved by the value dictionary, its
+// decision is cached by the ids.
+bool CachedEnforcer::Enforce(const ValueIds& request) {
+    if (!enableCache || request.epoch != this->GetValueDictionaryEpoch()) {
+        return Enforcer::Enforce(request);
+    }
+
+    locker.lock();
+    if (id_cache_epoch == request.epoch) {
+        auto it = id_cache.find(request.ids);
+        if (it != id_cache.end()) {
+            bool res = it->second;
+            locker.unlock();
+            return res;
+        }
+    }
+    locker.unlock();
+
+    bool res = Enforcer::Enforce(request);
+    locker.lock();
+    if (id_cache_epoch != request.epoch) {
+        id_cache.clear();
+        id_cache_epoch = request.epoch;
+    }
+    id_cache[request.ids] = res;
+    locker.unlock();
+    return res;
+}
+
 // EnforceWithMatcher use a custom matcher to decides whether a "subject" can
 // access a "object" with the operation "action", input parameters are usually:
 // (matcher, sub, obj, act), use model matcher by default when matcher is "".
@@ -254,6 +348,80 @@ bool CachedEnforcer::EnforceWithMatcher(const std::string& matcher, const DataMa
     return res;
 }
 
+// EnforceWithContext decides the request with the definitions selected by the context, its
+// decision is cached in the namespace of the context.
+bool CachedEnforcer::EnforceWithContext(const EnforceContext& context, const DataList& params) {
+    if (!enableCache) {
+        return Enforcer::EnforceWithContext(context, params);
+    }
+
+    std::string key;
+    for (const auto& r : params) {
+        if (const auto string_param = std::get_if<std::string>(&r))
+            key += *string_param;
+        key += "$$";
+    }
+    key += "$";
+
+    std::pair<bool, bool> res_ok = getCachedResult(context, key);
+
+    if (res_ok.second) {
+        return res_ok.first;
+    }
+
+    bool res = Enforcer::EnforceWithContext(context, params);
+    setCachedResult(context, key, res);
+    return res;
+}
+
+bool CachedEnforcer::EnforceWithContext(const EnforceContext& context, const DataVector& params) {
+    if (!enableCache) {
+        return Enforcer::EnforceWithContext(context, params);
+    }
+
+    std::string key;
+    for (const auto& r : params) {
+        if (const auto string_param = std::get_if<std::string>(&r))
+            key += *string_param;
+        key += "$$";
+    }
+    key += "$";
+
+    std::pair<bool, bool> res_ok = getCachedResult(context, key);
+
+    if (res_ok.second) {
+        return res_ok.first;
+    }
+
+    bool res = Enforcer::EnforceWithContext(context, params);
+    setCachedResult(context, key, res);
+    return res;
+}
+
+bool CachedEnforcer::EnforceWithContext(const EnforceContext& context, const DataMap& params) {
+    if (!enableCache) {
+        return Enforcer::EnforceWithContext(context, params);
+    }
+
+    std::string key;
+    for (auto [param_name, param_value] : params) {
+        if (const auto string_value = std::get_if<std::string>(&param_value))
+            key += *string_value;
+        key += "$$";
+    }
+    key += "$";
+
+    std::pair<bool, bool> res_ok = getCachedResult(context, key);
+
+    if (res_ok.second) {
+        return res_ok.first;
+    }
+
+    bool res = Enforcer::EnforceWithContext(context, params);
+    setCachedResult(context, key, res);
+    return res;
+}
+
 } // namespace casbin
 
 #endif // ENFORCER_CACHED_CPP
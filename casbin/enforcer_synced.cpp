@@ -133,6 +133,8 @@ std::string SyncedEnforcer ::UpdateWrapper() {
 
 // SetWatcher sets the current watcher.
 void SyncedEnforcer ::SetWatcher(std::shared_ptr<Watcher> w) {
+    // the policy writes notify through the enforcer's watcher
+    Enforcer::SetWatcher(w);
     watcher = w;
     return watcher->SetUpdateCallback(&SyncedEnforcer::UpdateWrapper);
 }
@@ -180,6 +182,154 @@ void SyncedEnforcer ::BuildRoleLinks() {
     Enforcer::BuildRoleLinks();
 }
 
+// combineWrite queues a single rule mutation. The first writer to find no combiner running
+// becomes it and applies the queued mutations, its own included, under one exclusive lock,
+// the others wait for it to publish their results.
+bool SyncedEnforcer::combineWrite(Transaction::OperationType type, const std::string& sec, const std::string& p_type, const std::vector<std::string>& rule) {
+    PendingWrite write{type, sec, p_type, rule, false, false, nullptr};
+    std::unique_lock<std::mutex> lock(writesMutex);
+    pendingWrites.push_back(&write);
+    while (!write.done) {
+        if (combining) {
+            writesDone.wait(lock);
+            continue;
+        }
+
+        combining = true;
+        std::vector<PendingWrite*> writes;
+        writes.swap(pendingWrites);
+        lock.unlock();
+        try {
+            this->applyWrites(writes);
+        } catch (...) {
+            for (PendingWrite* pending : writes)
+                if (!pending->error)
+                    pending->error = std::current_exception();
+        }
+        lock.lock();
+        for (PendingWrite* pending : writes)
+            pending->done = true;
+        combining = false;
+        writesDone.notify_all();
+    }
+
+    if (write.error)
+        std::rethrow_exception(write.error);
+    return write.result;
+}
+
+// applyWrites applies a batch of queued mutations under one exclusive lock, as one
+// transaction with one role link pass and one index update.
+void SyncedEnforcer::applyWrites(const std::vector<PendingWrite*>& writes) {
+    std::unique_lock<std::shared_mutex> lock(policyMutex);
+    if (writes.size() == 1) {
+        PendingWrite& write = *writes.front();
+        try {
+            if (write.type == Transaction::OperationType::Add)
+                write.result = Enforcer::addPolicy(write.sec, write.p_type, write.rule);
+            else
+                write.result = Enforcer::removePolicy(write.sec, write.p_type, write.rule);
+        } catch (...) {
+            write.error = std::current_exception();
+        }
+        return;
+    }
+
+    // staged under the lock, the batch holds only the net changes and cannot go stale
+    Transaction transaction(*this);
+    transaction.m_locked = true;
+    std::vector<PendingWrite*> staged;
+    for (PendingWrite* write : writes) {
+        bool add = write->type == Transaction::OperationType::Add;
+        if (write->sec == "p")
+            write->result = add ? transaction.AddNamedPolicy(write->p_type, write->rule) : transaction.RemoveNamedPolicy(write->p_type, write->rule);
+        else
+            write->result = add ? transaction.AddNamedGroupingPolicy(write->p_type, write->rule) : transaction.RemoveNamedGroupingPolicy(write->p_type, write->rule);
+        if (write->result)
+            staged.push_back(write);
+    }
+    if (staged.empty())
+        return;
+
+    bool committed = false;
+    try {
+        committed = Enforcer::CommitTransaction(transaction);
+    } catch (...) {
+        // the transaction undid its changes, none of the staged writes applied
+        for (PendingWrite* write : staged)
+            write->error = std::current_exception();
+    }
+    if (!committed)
+        for (PendingWrite* write : staged)
+            write->result = false;
+}
+
+// stageTransaction calls stage with the model under the shared lock.
+bool SyncedEnforcer::stageTransaction(const std::function<bool(Model&)>& stage) {
+    std::shared_lock<std::shared_mutex> lock(policyMutex);
+    return Enforcer::stageTransaction(stage);
+}
+
+// CommitTransaction applies the operations staged in the transaction under one lock.
+bool SyncedEnforcer::CommitTransaction(Transaction& transaction) {
+    std::unique_lock<std::shared_mutex> lock(policyMutex);
+    return Enforcer::CommitTransaction(transaction);
+}
+
+// Fork creates an enforcer sharing the policy of this one under the lock.
+std::shared_ptr<Enforcer> SyncedEnforcer::Fork() {
+    std::unique_lock<std::shared_mutex> lock(policyMutex);
+    return Enforcer::Fork();
+}
+
+// enforceValues decides a request given as the values of the request tokens under the lock.
+bool SyncedEnforcer::enforceValues(const std::string_view* values, size_t count, std::vector<std::string>& explain) {
+    std::unique_lock<std::shared_mutex> lock(policyMutex);
+    return Enforcer::enforceValues(values, count, explain);
+}
+
+// Warmup prepares the enforcer for its first request under the lock.
+void SyncedEnforcer::Warmup() {
+    std::unique_lock<std::shared_mutex> lock(policyMutex);
+    Enforcer::Warmup();
+}
+
+// EnforceExWithContext explains the decision for the definitions selected by the context.
+// Requests of a non-default context only read the policy and run under the shared lock,
+// the default definitions update their matcher plans and take the lock alone.
+bool SyncedEnforcer::EnforceExWithContext(const EnforceContext& context, const DataList& params, std::vector<std::string>& explain) {
+    if (context.IsDefault()) {
+        std::unique_lock<std::shared_mutex> lock(policyMutex);
+        return Enforcer::EnforceExWithContext(context, params, explain);
+    }
+    std::shared_lock<std::shared_mutex> lock(policyMutex);
+    return Enforcer::EnforceExWithContext(context, params, explain);
+}
+
+bool SyncedEnforcer::EnforceExWithContext(const EnforceContext& context, const DataVector& params, std::vector<std::string>& explain) {
+    if (context.IsDefault()) {
+        std::unique_lock<std::shared_mutex> lock(policyMutex);
+        return Enforcer::EnforceExWithContext(context, params, explain);
+    }
+    std::shared_lock<std::shared_mutex> lock(policyMutex);
+    return Enforcer::EnforceExWithContext(context, params, explain);
+}
+
+bool SyncedEnforcer::EnforceExWithContext(const EnforceContext& context, const DataMap& params, std::vector<std::string>& explain) {
+    if (context.IsDefault()) {
+        std::unique_lock<std::shared_mutex> lock(policyMutex);
+        return Enforcer::EnforceExWithContext(context, params, explain);
+    }
+    std::shared_lock<std::shared_mutex> lock(policyMutex);
+    return Enforcer::EnforceExWithContext(context, params, explain);
+}
+
+// importPolicies moves rules into the current policy under one lock.
+size_t SyncedEnforcer::importPolicies(const std::string& sec, const std::string& p_type, std::vector<std::vector<std::string>>&& rules) {
+    std::unique_lock<std::shared_mutex> lock(policyMutex);
+    return Enforcer::importPolicies(sec, p_type, std::move(rules));
+}
+
 // Enforce decides whether a "subject" can access a "object" with the operation "action", input parameters are usually: (sub, obj, act).
 bool SyncedEnforcer ::Enforce(std::shared_ptr<IEvaluator> evalator) {
     std::unique_lock<std::shared_mutex> lock(policyMutex);
@@ -209,6 +359,31 @@ bool SyncedEnforcer ::Enforce(const DataMap& params) {
     return Enforcer::Enforce(params);
 }
 
+// Enforce with value ids decides a request resolved by the value dictionary, requests
+// given as ids share the lock as they do not use the evaluator.
+bool SyncedEnforcer::Enforce(const ValueIds& request) {
+    std::shared_lock<std::shared_mutex> lock(policyMutex);
+    return Enforcer::Enforce(request);
+}
+
+// GetValueDictionary returns a copy of the value dictionary taken under the lock.
+ValueDictionary SyncedEnforcer::GetValueDictionary() {
+    std::shared_lock<std::shared_mutex> lock(policyMutex);
+    return Enforcer::GetValueDictionary();
+}
+
+// ResolveValueIds returns the ids of the values of a request under the lock.
+ValueIds SyncedEnforcer::ResolveValueIds(const std::vector<std::string>& values) {
+    std::shared_lock<std::shared_mutex> lock(policyMutex);
+    return Enforcer::ResolveValueIds(values);
+}
+
+// GetValueDictionaryEpoch returns the epoch of the value dictionary under the lock.
+uint64_t SyncedEnforcer::GetValueDictionaryEpoch() {
+    std::shared_lock<std::shared_mutex> lock(policyMutex);
+    return Enforcer::GetValueDictionaryEpoch();
+}
+
 // BatchEnforce enforce in batches
 std::vector<bool> SyncedEnforcer ::BatchEnforce(const std::initializer_list<DataList>& requests) {
     std::unique_lock<std::shared_mutex> lock(policyMutex);
@@ -337,8 +512,7 @@ bool SyncedEnforcer ::HasNamedPolicy(const std::string& ptype, const std::vector
 // If the rule already exists, the function returns false and the rule will not be added.
 // Otherwise the function returns true by adding the new rule.
 bool SyncedEnforcer ::AddPolicy(const std::vector<std::string>& params) {
-    std::unique_lock<std::shared_mutex> lock(policyMutex);
-    return Enforcer::AddPolicy(params);
+    return this->combineWrite(Transaction::OperationType::Add, "p", "p", params);
 }
 
 // AddPolicies adds authorization rules to the current policy.
@@ -353,8 +527,7 @@ bool SyncedEnforcer ::AddPolicies(const PoliciesValues& rules) {
 // If the rule already exists, the function returns false and the rule will not be added.
 // Otherwise the function returns true by adding the new rule.
 bool SyncedEnforcer ::AddNamedPolicy(const std::string& ptype, const std::vector<std::string>& params) {
-    std::unique_lock<std::shared_mutex> lock(policyMutex);
-    return Enforcer::AddNamedPolicy(ptype, params);
+    return this->combineWrite(Transaction::OperationType::Add, "p", ptype, params);
 }
 
 // AddNamedPolicies adds authorization rules to the current named policy.
@@ -367,8 +540,7 @@ bool SyncedEnforcer ::AddNamedPolicies(const std::string& ptype, const PoliciesV
 
 // RemovePolicy removes an authorization rule from the current policy.
 bool SyncedEnforcer ::RemovePolicy(const std::vector<std::string>& params) {
-    std::unique_lock<std::shared_mutex> lock(policyMutex);
-    return Enforcer::RemovePolicy(params);
+    return this->combineWrite(Transaction::OperationType::Remove, "p", "p", params);
 }
 
 // UpdatePolicy updates an authorization rule from the current policy.
@@ -407,8 +579,7 @@ bool SyncedEnforcer ::RemoveFilteredPolicy(int fieldIndex, const std::vector<std
 
 // RemoveNamedPolicy removes an authorization rule from the current named policy.
 bool SyncedEnforcer ::RemoveNamedPolicy(const std::string& ptype, const std::vector<std::string>& params) {
-    std::unique_lock<std::shared_mutex> lock(policyMutex);
-    return Enforcer::RemoveNamedPolicy(ptype, params);
+    return this->combineWrite(Transaction::OperationType::Remove, "p", ptype, params);
 }
 
 // RemoveNamedPolicies removes authorization rules from the current named policy.
@@ -439,8 +610,7 @@ bool SyncedEnforcer ::HasNamedGroupingPolicy(const std::string& ptype, const std
 // If the rule already exists, the function returns false and the rule will not be added.
 // Otherwise the function returns true by adding the new rule.
 bool SyncedEnforcer ::AddGroupingPolicy(const std::vector<std::string>& params) {
-    std::unique_lock<std::shared_mutex> lock(policyMutex);
-    return Enforcer::AddGroupingPolicy(params);
+    return this->combineWrite(Transaction::OperationType::Add, "g", "g", params);
 }
 
 // AddGroupingPolicies adds role inheritance rulea to the current policy.
@@ -455,8 +625,7 @@ bool SyncedEnforcer ::AddGroupingPolicies(const PoliciesValues& rules) {
 // If the rule already exists, the function returns false and the rule will not be added.
 // Otherwise the function returns true by adding the new rule.
 bool SyncedEnforcer ::AddNamedGroupingPolicy(const std::string& ptype, const std::vector<std::string>& params) {
-    std::unique_lock<std::shared_mutex> lock(policyMutex);
-    return Enforcer::AddNamedGroupingPolicy(ptype, params);
+    return this->combineWrite(Transaction::OperationType::Add, "g", ptype, params);
 }
 
 // AddNamedGroupingPolicies adds named role inheritance rules to the current policy.
@@ -469,8 +638,7 @@ bool SyncedEnforcer ::AddNamedGroupingPolicies(const std::string& ptype, const P
 
 // RemoveGroupingPolicy removes a role inheritance rule from the current policy.
 bool SyncedEnforcer ::RemoveGroupingPolicy(const std::vector<std::string>& params) {
-    std::unique_lock<std::shared_mutex> lock(policyMutex);
-    return Enforcer::RemoveGroupingPolicy(params);
+    return this->combineWrite(Transaction::OperationType::Remove, "g", "g", params);
 }
 
 // RemoveGroupingPolicies removes role inheritance rules from the current policy.
@@ -487,8 +655,7 @@ bool SyncedEnforcer ::RemoveFilteredGroupingPolicy(int fieldIndex, const std::ve
 
 // RemoveNamedGroupingPolicy removes a role inheritance rule from the current named policy.
 bool SyncedEnforcer ::RemoveNamedGroupingPolicy(const std::string& ptype, const std::vector<std::string>& params) {
-    std::unique_lock<std::shared_mutex> lock(policyMutex);
-    return Enforcer::RemoveNamedGroupingPolicy(ptype, params);
+    return this->combineWrite(Transaction::OperationType::Remove, "g", ptype, params);
 }
 
 // RemoveNamedGroupingPolicies removes role inheritance rules from the current named policy.
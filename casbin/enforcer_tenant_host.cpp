@@ -0,0 +1,554 @@
+/*
+ * Copyright 2020 The casbin Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "casbin/pch.h"
+
+#ifndef ENFORCER_TENANT_HOST_CPP
+#define ENFORCER_TENANT_HOST_CPP
+
+#include "casbin/effect/default_effector.h"
+#include "casbin/enforcer_tenant_host.h"
+
+namespace casbin {
+
+namespace {
+
+void PushRequest(IEvaluator& evaluator, const std::vector<std::string>&, const DataMap& params) {
+    for (const auto& [param_name, param_data] : params) {
+        if (const auto string_param = std::get_if<std::string>(&param_data))
+            evaluator.PushObjectString("r", param_name, *string_param);
+        else if (const auto json_param = std::get_if<std::shared_ptr<nlohmann::json>>(&param_data))
+            evaluator.PushObjectJson("r", param_name, **json_param);
+    }
+}
+
+template <typename Params>
+void PushRequest(IEvaluator& evaluator, const std::vector<std::string>& r_tokens, const Params& params) {
+    size_t i = 0;
+    for (const Data& param : params) {
+        std::string token_name = r_tokens[i].substr(2, r_tokens[i].size() - 2);
+        if (const auto string_param = std::get_if<std::string>(&param))
+            evaluator.PushObjectString("r", token_name, *string_param);
+        else if (const auto json_param = std::get_if<std::shared_ptr<nlohmann::json>>(&param))
+            evaluator.PushObjectJson("r", token_name, **json_param);
+        ++i;
+    }
+}
+
+bool IsRequestSizeValid(const std::vector<std::string>&, const DataMap&) {
+    return true;
+}
+
+template <typename Params>
+bool IsRequestSizeValid(const std::vector<std::string>& r_tokens, const Params& params) {
+    return params.size() == r_tokens.size();
+}
+
+const std::string* GetDomain(const std::vector<std::string>& r_tokens, const DataMap& params, int index) {
+    if (index < 0 || static_cast<size_t>(index) >= r_tokens.size())
+        return nullptr;
+    auto it = params.find(r_tokens[index].substr(2, r_tokens[index].size() - 2));
+    return it == params.end() ? nullptr : std::get_if<std::string>(&it->second);
+}
+
+template <typename Params>
+const std::string* GetDomain(const std::vector<std::string>&, const Params& params, int index) {
+    if (index < 0 || static_cast<size_t>(index) >= params.size())
+        return nullptr;
+    return std::get_if<std::string>(&*std::next(params.begin(), index));
+}
+
+// EstimateRuleBytes estimates the heap used by a policy row.
+size_t EstimateRuleBytes(const std::vector<std::string>& rule) {
+    static const size_t sso_capacity = std::string().capacity();
+    size_t bytes = sizeof(rule) + rule.capacity() * sizeof(std::string);
+    for (const std::string& field : rule)
+        if (field.capacity() > sso_capacity)
+            bytes += field.capacity() + 1;
+    return bytes;
+}
+
+size_t EstimateRulesBytes(const PoliciesValues& rules) {
+    size_t bytes = 0;
+    for (const auto& rule : rules)
+        bytes += EstimateRuleBytes(rule);
+    return bytes;
+}
+
+// EstimatePolicyBytes estimates the heap used by the "p" and "g" rows of the model.
+size_t EstimatePolicyBytes(const std::shared_ptr<Model>& m) {
+    size_t bytes = 0;
+    for (const char* sec : {"p", "g"}) {
+        auto it = m->m.find(sec);
+        if (it == m->m.end())
+            continue;
+        for (const auto& [_, assertion] : it->second.assertion_map)
+            bytes += EstimateRulesBytes(assertion->policy);
+    }
+    return bytes;
+}
+
+bool IsAccounted(const std::string& sec) {
+    return sec == "p" || sec == "g";
+}
+
+} // namespace
+
+// LazyTenant is a lazily loaded tenant, it reports the size changes of its policy to the host.
+class TenantHost::LazyTenant : public Enforcer {
+public:
+    LazyTenant(const std::shared_ptr<Model>& m, const std::shared_ptr<Self>& host, const std::string& tenant)
+        : Enforcer(m), m_host(host), m_tenant(tenant) {}
+
+    bool addPolicy(const std::string& sec, const std::string& p_type, const std::vector<std::string>& rule) override {
+        bool added = Enforcer::addPolicy(sec, p_type, rule);
+        if (added && IsAccounted(sec))
+            this->Resize(static_cast<int64_t>(EstimateRuleBytes(rule)));
+        return added;
+    }
+
+    bool addPolicies(const std::string& sec, const std::string& p_type, const PoliciesValues& rules) override {
+        return this->Measure(sec, [&] { return Enforcer::addPolicies(sec, p_type, rules); });
+    }
+
+    bool removePolicy(const std::string& sec, const std::string& p_type, const std::vector<std::string>& rule) override {
+        bool removed = Enforcer::removePolicy(sec, p_type, rule);
+        if (removed && IsAccounted(sec))
+            this->Resize(-static_cast<int64_t>(EstimateRuleBytes(rule)));
+        return removed;
+    }
+
+    bool removePolicies(const std::string& sec, const std::string& p_type, const PoliciesValues& rules) override {
+        return this->Measure(sec, [&] { return Enforcer::removePolicies(sec, p_type, rules); });
+    }
+
+    bool removeFilteredPolicy(const std::string& sec, const std::string& p_type, int field_index, const std::vector<std::string>& field_values) override {
+        return this->Measure(sec, [&] { return Enforcer::removeFilteredPolicy(sec, p_type, field_index, field_values); });
+    }
+
+    bool updatePolicy(const std::string& sec, const std::string& p_type, const std::vector<std::string>& old_rule, const std::vector<std::string>& new_rule) override {
+        bool updated = Enforcer::updatePolicy(sec, p_type, old_rule, new_rule);
+        if (updated && IsAccounted(sec))
+            this->Resize(static_cast<int64_t>(EstimateRuleBytes(new_rule)) - static_cast<int64_t>(EstimateRuleBytes(old_rule)));
+        return updated;
+    }
+
+    bool updatePolicies(const std::string& sec, const std::string& p_type, const PoliciesValues& old_rules, const PoliciesValues& new_rules) override {
+        return this->Measure(sec, [&] { return Enforcer::updatePolicies(sec, p_type, old_rules, new_rules); });
+    }
+
+private:
+    std::weak_ptr<Self> m_host;
+    std::string m_tenant;
+
+    void Resize(int64_t bytes) {
+        std::shared_ptr<Self> host = m_host.lock();
+        if (host == nullptr)
+            return;
+        std::shared_lock<std::shared_mutex> lock(host->mutex);
+        if (host->host != nullptr)
+            host->host->Resize(m_tenant, bytes);
+    }
+
+    // Measure applies a change of several rules and resizes the tenant by the size of the
+    // assertions of the section before and after it.
+    template <typename Change>
+    bool Measure(const std::string& sec, Change change) {
+        if (!IsAccounted(sec))
+            return change();
+        auto section_bytes = [&] {
+            size_t bytes = 0;
+            for (const auto& [_, assertion] : this->GetModel()->m[sec].assertion_map)
+                bytes += EstimateRulesBytes(assertion->policy);
+            return bytes;
+        };
+        size_t before = section_bytes();
+        bool changed = change();
+        if (changed)
+            this->Resize(static_cast<int64_t>(section_bytes()) - static_cast<int64_t>(before));
+        return changed;
+    }
+};
+
+/**
+ * TenantHost initializes a host with a model file shared by all tenants.
+ *
+ * @param model_path the path of the model file.
+ */
+TenantHost::TenantHost(const std::string& model_path)
+    : TenantHost(Model::NewModelFromFile(model_path)) {
+}
+
+/**
+ * TenantHost initializes a host with a model shared by all tenants.
+ * Any policy already loaded into the model is ignored.
+ *
+ * @param m the model.
+ */
+TenantHost::TenantHost(const std::shared_ptr<Model>& m)
+    : m_template(Model::NewModelSharingDefinition(m)), m_eft(std::make_shared<DefaultEffector>()), m_max_pooled_evaluators(std::thread::hardware_concurrency() + 1), m_p_domain_index(1), m_g_domain_index(2), m_memory_budget(0), m_self(std::make_shared<Self>()), m_resident_bytes(0) {
+    m_self->host = this;
+}
+
+// ~TenantHost waits for the tenants reporting to the host, those outliving it stop accounting.
+TenantHost::~TenantHost() {
+    std::unique_lock<std::shared_mutex> lock(m_self->mutex);
+    m_self->host = nullptr;
+}
+
+// GetModel gets the template model shared by all tenants.
+std::shared_ptr<Model> TenantHost::GetModel() {
+    return m_template;
+}
+
+// AddTenant creates the tenant and loads its policy from the adapter (if any).
+std::shared_ptr<Enforcer> TenantHost::AddTenant(const std::string& tenant, std::shared_ptr<Adapter> adapter) {
+    if (auto existing = this->FindTenant(tenant))
+        return existing;
+
+    // Load outside of the registry lock, adapters may be slow
+    auto e = std::make_shared<Enforcer>(Model::NewModelSharingDefinition(m_template), adapter);
+    e->SetEffector(m_eft);
+
+    std::unique_lock<std::shared_mutex> lock(m_tenants_mutex);
+    auto [it, _] = m_tenants.emplace(tenant, e);
+    return it->second;
+}
+
+std::shared_ptr<Enforcer> TenantHost::FindTenant(const std::string& tenant) {
+    std::shared_lock<std::shared_mutex> lock(m_tenants_mutex);
+    auto it = m_tenants.find(tenant);
+    return it == m_tenants.end() ? nullptr : it->second;
+}
+
+// GetTenant gets the tenant's enforcer for policy management, nullptr if the tenant does not exist.
+// Lazily loaded tenants are loaded if needed.
+std::shared_ptr<Enforcer> TenantHost::GetTenant(const std::string& tenant) {
+    if (auto e = this->FindTenant(tenant)) {
+        if (m_loader != nullptr)
+            this->Touch(tenant);
+        return e;
+    }
+    if (m_loader == nullptr || tenant.empty())
+        return nullptr;
+
+    std::promise<std::shared_ptr<Enforcer>> promise;
+    std::shared_future<std::shared_ptr<Enforcer>> pending;
+    {
+        std::unique_lock<std::shared_mutex> lock(m_tenants_mutex);
+        auto it = m_tenants.find(tenant);
+        if (it != m_tenants.end())
+            return it->second;
+        auto loading = m_loading.find(tenant);
+        if (loading != m_loading.end())
+            pending = loading->second;
+        else
+            m_loading.emplace(tenant, promise.get_future().share());
+    }
+
+    // Another request is loading this tenant, wait for it (a failed load rethrows here)
+    if (pending.valid())
+        return pending.get();
+
+    std::shared_ptr<Enforcer> e;
+    try {
+        e = this->LoadTenant(tenant);
+    } catch (...) {
+        {
+            std::unique_lock<std::shared_mutex> lock(m_tenants_mutex);
+            m_loading.erase(tenant);
+        }
+        promise.set_exception(std::current_exception());
+        throw;
+    }
+
+    {
+        std::unique_lock<std::shared_mutex> lock(m_tenants_mutex);
+        m_tenants.emplace(tenant, e);
+        m_loading.erase(tenant);
+    }
+    promise.set_value(e);
+
+    this->Account(tenant, EstimatePolicyBytes(e->GetModel()));
+    return e;
+}
+
+// HasTenant determines whether the tenant exists.
+bool TenantHost::HasTenant(const std::string& tenant) {
+    std::shared_lock<std::shared_mutex> lock(m_tenants_mutex);
+    return m_tenants.find(tenant) != m_tenants.end();
+}
+
+// RemoveTenant removes the tenant together with its policy and role data.
+bool TenantHost::RemoveTenant(const std::string& tenant) {
+    this->Forget(tenant);
+    std::unique_lock<std::shared_mutex> lock(m_tenants_mutex);
+    return m_tenants.erase(tenant) > 0;
+}
+
+// GetAllTenants gets the names of all tenants.
+std::vector<std::string> TenantHost::GetAllTenants() {
+    std::shared_lock<std::shared_mutex> lock(m_tenants_mutex);
+    std::vector<std::string> tenants;
+    tenants.reserve(m_tenants.size());
+    for (const auto& [name, _] : m_tenants)
+        tenants.push_back(name);
+    return tenants;
+}
+
+// TenantCount returns the number of tenants.
+size_t TenantHost::TenantCount() {
+    std::shared_lock<std::shared_mutex> lock(m_tenants_mutex);
+    return m_tenants.size();
+}
+
+// SetMaxPooledEvaluators bounds the number of idle evaluators kept for reuse.
+void TenantHost::SetMaxPooledEvaluators(size_t max_pooled_evaluators) {
+    std::lock_guard<std::mutex> lock(m_evaluators_mutex);
+    m_max_pooled_evaluators = max_pooled_evaluators;
+    if (m_evaluators.size() > m_max_pooled_evaluators)
+        m_evaluators.resize(m_max_pooled_evaluators);
+}
+
+// Warmup fills the evaluator pool with evaluators that have the matcher compiled, one for
+// each of the given number of concurrent requests, as far as the pool bound allows.
+void TenantHost::Warmup(size_t evaluators) {
+    // the "g" functions are bound to the role manager of each tenant when enforcing
+    Enforcer e(Model::NewModelSharingDefinition(m_template));
+
+    std::lock_guard<std::mutex> lock(m_evaluators_mutex);
+    while (m_evaluators.size() < std::min(evaluators, m_max_pooled_evaluators)) {
+        std::shared_ptr<IEvaluator> evaluator = IEvaluator::NewEvaluator();
+        e.PrepareEvaluator(evaluator);
+        m_evaluators.push_back(std::move(evaluator));
+    }
+}
+
+// EnableLazyLoading makes unknown tenants load on demand from the filtered adapter.
+void TenantHost::EnableLazyLoading(std::shared_ptr<FilteredAdapter> adapter, size_t memory_budget, int p_domain_index, int g_domain_index) {
+    m_loader = adapter;
+    m_p_domain_index = p_domain_index;
+    m_g_domain_index = g_domain_index;
+    this->SetMemoryBudget(memory_budget);
+}
+
+// SetMemoryBudget changes the memory budget of lazily loaded tenants, 0 for no limit.
+void TenantHost::SetMemoryBudget(size_t memory_budget) {
+    {
+        std::lock_guard<std::mutex> lock(m_lru_mutex);
+        m_memory_budget = memory_budget;
+    }
+    this->EvictOverBudget();
+}
+
+// GetResidentBytes returns the estimated policy size of the lazily loaded tenants in memory.
+size_t TenantHost::GetResidentBytes() {
+    std::lock_guard<std::mutex> lock(m_lru_mutex);
+    return m_resident_bytes;
+}
+
+std::shared_ptr<Enforcer> TenantHost::LoadTenant(const std::string& tenant) {
+    auto m = Model::NewModelSharingDefinition(m_template);
+
+    Filter filter;
+    filter.P.resize(m_p_domain_index + 1);
+    filter.P[m_p_domain_index] = tenant;
+    filter.G.resize(m_g_domain_index + 1);
+    filter.G[m_g_domain_index] = tenant;
+    m_loader->LoadFilteredPolicy(m, &filter);
+
+    auto e = std::make_shared<LazyTenant>(m, m_self, tenant);
+    e->SetEffector(m_eft);
+    e->SetAdapter(m_loader);
+    e->BuildRoleLinks();
+    return e;
+}
+
+void TenantHost::Touch(const std::string& tenant) {
+    std::lock_guard<std::mutex> lock(m_lru_mutex);
+    auto it = m_resident.find(tenant);
+    if (it != m_resident.end())
+        m_lru.splice(m_lru.begin(), m_lru, it->second.first);
+}
+
+void TenantHost::Account(const std::string& tenant, size_t bytes) {
+    {
+        std::lock_guard<std::mutex> lock(m_lru_mutex);
+        if (m_resident.find(tenant) != m_resident.end())
+            return;
+        m_lru.push_front(tenant);
+        m_resident.emplace(tenant, std::make_pair(m_lru.begin(), bytes + kTenantBytes));
+        m_resident_bytes += bytes + kTenantBytes;
+    }
+    this->EvictOverBudget();
+}
+
+void TenantHost::Forget(const std::string& tenant) {
+    std::lock_guard<std::mutex> lock(m_lru_mutex);
+    auto it = m_resident.find(tenant);
+    if (it == m_resident.end())
+        return;
+    m_resident_bytes -= it->second.second;
+    m_lru.erase(it->second.first);
+    m_resident.erase(it);
+}
+
+void TenantHost::Resize(const std::string& tenant, int64_t bytes) {
+    {
+        std::lock_guard<std::mutex> lock(m_lru_mutex);
+        auto it = m_resident.find(tenant);
+        // e.g. a tenant evicted while the caller still held it
+        if (it == m_resident.end())
+            return;
+        size_t size = static_cast<size_t>(std::max<int64_t>(static_cast<int64_t>(it->second.second) + bytes, kTenantBytes));
+        m_resident_bytes = m_resident_bytes - it->second.second + size;
+        it->second.second = size;
+    }
+    this->EvictOverBudget();
+}
+
+// EvictOverBudget unloads the least recently used tenants until the resident policy fits
+// the budget. The most recently used tenant is always kept, even if it alone exceeds it.
+void TenantHost::EvictOverBudget() {
+    std::vector<std::string> victims;
+    {
+        std::lock_guard<std::mutex> lock(m_lru_mutex);
+        while (m_memory_budget > 0 && m_resident_bytes > m_memory_budget && m_lru.size() > 1) {
+            auto it = m_resident.find(m_lru.back());
+            m_resident_bytes -= it->second.second;
+            m_resident.erase(it);
+            victims.push_back(std::move(m_lru.back()));
+            m_lru.pop_back();
+        }
+    }
+    if (victims.empty())
+        return;
+
+    // Requests already holding an evicted tenant finish on it, later ones reload it
+    std::unique_lock<std::shared_mutex> lock(m_tenants_mutex);
+    for (const std::string& victim : victims)
+        m_tenants.erase(victim);
+}
+
+TenantHost::EvaluatorLease::EvaluatorLease(TenantHost& host)
+    : m_host(host), m_evaluator(host.AcquireEvaluator()) {
+}
+
+TenantHost::EvaluatorLease::~EvaluatorLease() {
+    m_host.ReleaseEvaluator(std::move(m_evaluator));
+}
+
+std::shared_ptr<IEvaluator> TenantHost::AcquireEvaluator() {
+    {
+        std::lock_guard<std::mutex> lock(m_evaluators_mutex);
+        if (!m_evaluators.empty()) {
+            auto evaluator = std::move(m_evaluators.back());
+            m_evaluators.pop_back();
+            return evaluator;
+        }
+    }
+    return IEvaluator::NewEvaluator();
+}
+
+void TenantHost::ReleaseEvaluator(std::shared_ptr<IEvaluator> evaluator) {
+    std::lock_guard<std::mutex> lock(m_evaluators_mutex);
+    if (m_evaluators.size() < m_max_pooled_evaluators)
+        m_evaluators.push_back(std::move(evaluator));
+}
+
+template <typename Params>
+bool TenantHost::EnforceTenant(const std::string& tenant, const Params& params, std::vector<std::string>& explain) {
+    auto e = this->GetTenant(tenant);
+    if (e == nullptr)
+        return false;
+
+    const std::vector<std::string>& r_tokens = m_template->m.at("r").assertion_map.at("r")->tokens;
+    if (!IsRequestSizeValid(r_tokens, params))
+        return false;
+
+    // the values left by a request that threw are replaced by those of the next one
+    EvaluatorLease evaluator(*this);
+    evaluator.Get()->InitialObject("r");
+    PushRequest(*evaluator.Get(), r_tokens, params);
+    return e->EnforceEx(evaluator.Get(), explain);
+}
+
+template <typename Params>
+bool TenantHost::EnforceDomain(const Params& params, std::vector<std::string>& explain) {
+    const std::vector<std::string>& r_tokens = m_template->m.at("r").assertion_map.at("r")->tokens;
+    const std::string* domain = GetDomain(r_tokens, params, m_p_domain_index);
+    if (domain == nullptr)
+        return false;
+    return this->EnforceTenant(*domain, params, explain);
+}
+
+bool TenantHost::Enforce(const std::string& tenant, const DataList& params) {
+    std::vector<std::string> explain;
+    return this->EnforceTenant(tenant, params, explain);
+}
+
+bool TenantHost::Enforce(const std::string& tenant, const DataVector& params) {
+    std::vector<std::string> explain;
+    return this->EnforceTenant(tenant, params, explain);
+}
+
+bool TenantHost::Enforce(const std::string& tenant, const DataMap& params) {
+    std::vector<std::string> explain;
+    return this->EnforceTenant(tenant, params, explain);
+}
+
+bool TenantHost::EnforceEx(const std::string& tenant, const DataList& params, std::vector<std::string>& explain) {
+    return this->EnforceTenant(tenant, params, explain);
+}
+
+bool TenantHost::EnforceEx(const std::string& tenant, const DataVector& params, std::vector<std::string>& explain) {
+    return this->EnforceTenant(tenant, params, explain);
+}
+
+bool TenantHost::EnforceEx(const std::string& tenant, const DataMap& params, std::vector<std::string>& explain) {
+    return this->EnforceTenant(tenant, params, explain);
+}
+
+bool TenantHost::Enforce(const DataList& params) {
+    std::vector<std::string> explain;
+    return this->EnforceDomain(params, explain);
+}
+
+bool TenantHost::Enforce(const DataVector& params) {
+    std::vector<std::string> explain;
+    return this->EnforceDomain(params, explain);
+}
+
+bool TenantHost::Enforce(const DataMap& params) {
+    std::vector<std::string> explain;
+    return this->EnforceDomain(params, explain);
+}
+
+bool TenantHost::EnforceEx(const DataList& params, std::vector<std::string>& explain) {
+    return this->EnforceDomain(params, explain);
+}
+
+bool TenantHost::EnforceEx(const DataVector& params, std::vector<std::string>& explain) {
+    return this->EnforceDomain(params, explain);
+}
+
+bool TenantHost::EnforceEx(const DataMap& params, std::vector<std::string>& explain) {
+    return this->EnforceDomain(params, explain);
+}
+
+} // namespace casbin
+
+#endif // ENFORCER_TENANT_HOST_CPP
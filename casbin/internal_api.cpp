@@ -28,16 +28,29 @@
 
 namespace casbin {
 
+namespace {
+
+// PolicySize returns the number of rules of the policy type, 0 if the model has none.
+size_t PolicySize(Model& m, const std::string& sec, const std::string& p_type) {
+    if (!m.HasSection(sec) || m.m[sec].assertion_map.count(p_type) == 0)
+        return 0;
+    return m.m[sec].assertion_map[p_type]->policy.size();
+}
+
+} // namespace
+
 // addPolicy adds a rule to the current policy.
 bool Enforcer::addPolicy(const std::string& sec, const std::string& p_type, const std::vector<std::string>& rule) {
+    if (sec == "g")
+        this->unshareRoleManager();
     bool rule_added = m_model->AddPolicy(sec, p_type, rule);
     if (!rule_added)
         return rule_added;
 
-    if (sec == "g") {
-        PoliciesValues rules({rule});
+    PoliciesValues rules({rule});
+    if (sec == "g")
         this->BuildIncrementalRoleLinks(policy_add, p_type, rules);
-    }
+    this->updateIndexes(policy_add, sec, p_type, rules);
 
     if (m_adapter && m_auto_save) {
         try {
@@ -47,8 +60,9 @@ bool Enforcer::addPolicy(const std::string& sec, const std::string& p_type, cons
     }
 
     if (m_watcher && m_auto_notify_watcher) {
-        if (IsInstanceOf<WatcherEx>(m_watcher.get())) {
-            std::dynamic_pointer_cast<WatcherEx>(m_watcher)->UpdateForAddPolicy(rule);
+        // IsInstanceOf compares the static types, the watcher is told apart at run time
+        if (auto watcher_ex = std::dynamic_pointer_cast<WatcherEx>(m_watcher); watcher_ex != nullptr) {
+            watcher_ex->UpdateForAddPolicy(rule);
         } else
             m_watcher->Update();
     }
@@ -58,16 +72,25 @@ bool Enforcer::addPolicy(const std::string& sec, const std::string& p_type, cons
 
 // addPolicies adds rules to the current policy.
 bool Enforcer::addPolicies(const std::string& sec, const std::string& p_type, const PoliciesValues& rules) {
+    if (sec == "g")
+        this->unshareRoleManager();
     bool rules_added = m_model->AddPolicies(sec, p_type, rules);
     if (!rules_added)
         return rules_added;
 
     if (sec == "g")
         this->BuildIncrementalRoleLinks(policy_add, p_type, rules);
+    this->updateIndexes(policy_add, sec, p_type, rules);
 
     if (m_adapter && m_auto_save) {
         try {
-            std::dynamic_pointer_cast<BatchAdapter>(m_adapter)->AddPolicies(sec, p_type, rules);
+            auto batch_adapter = std::dynamic_pointer_cast<BatchAdapter>(m_adapter);
+            if (batch_adapter != nullptr) {
+                batch_adapter->AddPolicies(sec, p_type, rules);
+            } else {
+                for (const auto& rule : rules)
+                    m_adapter->AddPolicy(sec, p_type, rule);
+            }
         } catch (UnsupportedOperationException e) {
         }
     }
@@ -78,16 +101,41 @@ bool Enforcer::addPolicies(const std::string& sec, const std::string& p_type, co
     return rules_added;
 }
 
+// importPolicies moves rules into the current policy, then builds their role links and the
+// enabled indexes once.
+size_t Enforcer::importPolicies(const std::string& sec, const std::string& p_type, std::vector<std::vector<std::string>>&& rules) {
+    if (!m_model->HasSection(sec) || m_model->m[sec].assertion_map.count(p_type) == 0)
+        return 0;
+
+    if (sec == "g")
+        this->unshareRoleManager();
+    auto& assertion = m_model->m[sec].assertion_map[p_type];
+    size_t first = assertion->policy.size();
+    size_t rules_imported = m_model->ImportPolicies(sec, p_type, std::move(rules));
+    if (rules_imported == 0)
+        return rules_imported;
+
+    // models with role definitions keep their policy in order, the imported rules follow the
+    // existing ones
+    if (sec == "g")
+        assertion->BuildIncrementalRoleLinks(this->rm, policy_add, assertion->policy, first);
+    this->rebuildIndexes();
+
+    return rules_imported;
+}
+
 // removePolicy removes a rule from the current policy.
 bool Enforcer::removePolicy(const std::string& sec, const std::string& p_type, const std::vector<std::string>& rule) {
+    if (sec == "g")
+        this->unshareRoleManager();
     bool rule_removed = m_model->RemovePolicy(sec, p_type, rule);
     if (!rule_removed)
         return rule_removed;
 
-    if (sec == "g") {
-        PoliciesValues rules({rule});
-        this->BuildIncrementalRoleLinks(policy_add, p_type, rules);
-    }
+    PoliciesValues rules({rule});
+    if (sec == "g")
+        this->BuildIncrementalRoleLinks(policy_remove, p_type, rules);
+    this->updateIndexes(policy_remove, sec, p_type, rules);
 
     if (m_adapter && m_auto_save) {
         try {
@@ -97,8 +145,9 @@ bool Enforcer::removePolicy(const std::string& sec, const std::string& p_type, c
     }
 
     if (m_watcher && m_auto_notify_watcher) {
-        if (IsInstanceOf<WatcherEx>(m_watcher.get())) {
-            std::dynamic_pointer_cast<WatcherEx>(m_watcher)->UpdateForRemovePolicy(rule);
+        // IsInstanceOf compares the static types, the watcher is told apart at run time
+        if (auto watcher_ex = std::dynamic_pointer_cast<WatcherEx>(m_watcher); watcher_ex != nullptr) {
+            watcher_ex->UpdateForRemovePolicy(rule);
         } else
             m_watcher->Update();
     }
@@ -108,16 +157,27 @@ bool Enforcer::removePolicy(const std::string& sec, const std::string& p_type, c
 
 // removePolicies removes rules from the current policy.
 bool Enforcer::removePolicies(const std::string& sec, const std::string& p_type, const PoliciesValues& rules) {
-    bool rules_removed = m_model->AddPolicies(sec, p_type, rules);
+    if (sec == "g")
+        this->unshareRoleManager();
+    // a rule listed twice is only erased as many times as the policy holds it
+    PoliciesValues removed_rules;
+    bool rules_removed = m_model->RemovePolicies(sec, p_type, rules, &removed_rules);
     if (!rules_removed)
         return rules_removed;
 
     if (sec == "g")
-        this->BuildIncrementalRoleLinks(policy_add, p_type, rules);
+        this->BuildIncrementalRoleLinks(policy_remove, p_type, removed_rules);
+    this->updateIndexes(policy_remove, sec, p_type, removed_rules);
 
     if (m_adapter && m_auto_save) {
         try {
-            std::dynamic_pointer_cast<BatchAdapter>(m_adapter)->RemovePolicies(sec, p_type, rules);
+            auto batch_adapter = std::dynamic_pointer_cast<BatchAdapter>(m_adapter);
+            if (batch_adapter != nullptr) {
+                batch_adapter->RemovePolicies(sec, p_type, rules);
+            } else {
+                for (const auto& rule : rules)
+                    m_adapter->RemovePolicy(sec, p_type, rule);
+            }
         } catch (UnsupportedOperationException e) {
         }
     }
@@ -130,6 +190,14 @@ bool Enforcer::removePolicies(const std::string& sec, const std::string& p_type,
 
 // removeFilteredPolicy removes rules based on field filters from the current policy.
 bool Enforcer::removeFilteredPolicy(const std::string& sec, const std::string& p_type, int field_index, const std::vector<std::string>& field_values) {
+    // a domain without matching rules leaves the policy untouched
+    PoliciesValues domain_rules;
+    if (sec == "p" && p_type == "p" && m_domain_partition != nullptr && m_domain_partition->IsApplicable() &&
+        m_domain_partition->GetFilteredPolicy(m_model->m["p"].assertion_map["p"]->policy, field_index, field_values, domain_rules) && domain_rules.empty())
+        return false;
+
+    if (sec == "g")
+        this->unshareRoleManager();
     std::pair<int, PoliciesValues> p = m_model->RemoveFilteredPolicy(sec, p_type, field_index, field_values);
     bool rule_removed = p.first;
     PoliciesValues effects = p.second;
@@ -139,6 +207,7 @@ bool Enforcer::removeFilteredPolicy(const std::string& sec, const std::string& p
 
     if (sec == "g")
         this->BuildIncrementalRoleLinks(policy_remove, p_type, effects);
+    this->updateIndexes(policy_remove, sec, p_type, effects);
 
     if (m_adapter && m_auto_save) {
         try {
@@ -158,14 +227,26 @@ bool Enforcer::removeFilteredPolicy(const std::string& sec, const std::string& p
 }
 
 bool Enforcer::updatePolicy(const std::string& sec, const std::string& p_type, const std::vector<std::string>& oldRule, const std::vector<std::string>& newRule) {
+    if (sec == "g")
+        this->unshareRoleManager();
+    size_t policy_size = PolicySize(*m_model, sec, p_type);
     bool is_rule_updated = m_model->UpdatePolicy(sec, p_type, oldRule, newRule);
-    if (!is_rule_updated)
+    if (!is_rule_updated) {
+        // the old rule is removed even when the new one already is in the policy
+        if (PolicySize(*m_model, sec, p_type) != policy_size) {
+            if (sec == "g")
+                this->BuildIncrementalRoleLinks(policy_remove, p_type, PoliciesValues({oldRule}));
+            this->updateIndexes(policy_remove, sec, p_type, PoliciesValues({oldRule}));
+        }
         return false;
+    }
 
     if (sec == "g") {
         this->BuildIncrementalRoleLinks(policy_remove, p_type, PoliciesValues({oldRule}));
         this->BuildIncrementalRoleLinks(policy_add, p_type, PoliciesValues({newRule}));
     }
+    this->updateIndexes(policy_remove, sec, p_type, PoliciesValues({oldRule}));
+    this->updateIndexes(policy_add, sec, p_type, PoliciesValues({newRule}));
     if (m_watcher && m_auto_notify_watcher) {
         if (IsInstanceOf<WatcherUpdatable>(m_watcher.get())) {
             std::dynamic_pointer_cast<WatcherUpdatable>(m_watcher)->UpdateForUpdatePolicy(oldRule, newRule);
@@ -177,14 +258,23 @@ bool Enforcer::updatePolicy(const std::string& sec, const std::string& p_type, c
 }
 
 bool Enforcer::updatePolicies(const std::string& sec, const std::string& p_type, const PoliciesValues& oldRules, const PoliciesValues& newRules) {
+    if (sec == "g")
+        this->unshareRoleManager();
+    size_t policy_size = PolicySize(*m_model, sec, p_type);
     bool is_rules_updated = m_model->UpdatePolicies(sec, p_type, oldRules, newRules);
-    if (!is_rules_updated)
+    if (!is_rules_updated) {
+        // some of the old rules may be removed before an update is refused
+        if (PolicySize(*m_model, sec, p_type) != policy_size)
+            Enforcer::BuildRoleLinks();
         return false;
+    }
 
     if (sec == "g") {
         this->BuildIncrementalRoleLinks(policy_remove, p_type, oldRules);
         this->BuildIncrementalRoleLinks(policy_add, p_type, newRules);
     }
+    this->updateIndexes(policy_remove, sec, p_type, oldRules);
+    this->updateIndexes(policy_add, sec, p_type, newRules);
 
     if (m_watcher && m_auto_notify_watcher) {
         if (IsInstanceOf<WatcherUpdatable>(m_watcher.get())) {
@@ -80,6 +80,10 @@ PoliciesValues Enforcer ::GetNamedPolicy(const std::string& p_type) {
 
 // GetFilteredNamedPolicy gets all the authorization rules in the named policy, field filters can be specified.
 PoliciesValues Enforcer ::GetFilteredNamedPolicy(const std::string& p_type, int field_index, const std::vector<std::string>& field_values) {
+    PoliciesValues rules;
+    if (p_type == "p" && m_domain_partition != nullptr && m_domain_partition->IsApplicable() &&
+        m_domain_partition->GetFilteredPolicy(m_model->m["p"].assertion_map["p"]->policy, field_index, field_values, rules))
+        return rules;
     return m_model->GetFilteredPolicy("p", p_type, field_index, field_values);
 }
 
@@ -154,6 +158,17 @@ bool Enforcer ::AddNamedPolicies(const std::string& p_type, const PoliciesValues
     return this->addPolicies("p", p_type, rules);
 }
 
+// ImportPolicies adds authorization rules in bulk, moving them into the current policy.
+// Rules the policy already has and repeated ones are skipped, and it returns the number
+// of rules imported.
+size_t Enforcer::ImportPolicies(std::vector<std::vector<std::string>> rules) {
+    return this->ImportNamedPolicies("p", std::move(rules));
+}
+
+size_t Enforcer::ImportNamedPolicies(const std::string& p_type, std::vector<std::vector<std::string>> rules) {
+    return this->importPolicies("p", p_type, std::move(rules));
+}
+
 // RemovePolicy removes an authorization rule from the current policy.
 bool Enforcer ::RemovePolicy(const std::vector<std::string>& params) {
     return this->RemoveNamedPolicy("p", params);
@@ -254,6 +269,15 @@ bool Enforcer ::AddNamedGroupingPolicies(const std::string& p_type, const Polici
     return this->addPolicies("g", p_type, rules);
 }
 
+// ImportGroupingPolicies adds role inheritance rules in bulk, like ImportPolicies.
+size_t Enforcer::ImportGroupingPolicies(std::vector<std::vector<std::string>> rules) {
+    return this->ImportNamedGroupingPolicies("g", std::move(rules));
+}
+
+size_t Enforcer::ImportNamedGroupingPolicies(const std::string& p_type, std::vector<std::vector<std::string>> rules) {
+    return this->importPolicies("g", p_type, std::move(rules));
+}
+
 // RemoveGroupingPolicy removes a role inheritance rule from the current policy.
 bool Enforcer ::RemoveGroupingPolicy(const std::vector<std::string>& params) {
     return this->RemoveNamedGroupingPolicy("g", params);
@@ -332,8 +356,10 @@ bool Enforcer ::UpdateNamedPolicies(const std::string& ptype, const PoliciesValu
 
 // AddNamedMatchingFunc add MatchingFunc by ptype RoleManager
 bool Enforcer ::AddNamedMatchingFunc(const std::string& ptype, const std::string& name, casbin::MatchingFunc func) {
+    this->unshareRoleManager();
     auto default_rm = dynamic_cast<casbin::DefaultRoleManager*>(this->rm.get());
     default_rm->AddMatchingFunc(func);
+    this->rebuildIndexes();
 
     return true;
 }
@@ -26,14 +26,38 @@
 
 namespace casbin {
 
-void Assertion::BuildIncrementalRoleLinks(std::shared_ptr<RoleManager>& rm, policy_op op, const PoliciesValues& rules) {
+Assertion::Assertion(std::pmr::memory_resource* resource)
+    : policy(PoliciesValues::createWithVector({}, resource)) {
+}
+
+// SetTokens sets the tokens of a request or policy definition and their field names.
+void Assertion::SetTokens(std::vector<std::string> tokens) {
+    this->tokens = std::move(tokens);
+    field_names.clear();
+    eft_index = -1;
+    for (const std::string& token : this->tokens) {
+        field_names.push_back(token.substr(token.find('_') + 1));
+        if (field_names.back() == "eft")
+            eft_index = static_cast<int>(field_names.size() - 1);
+    }
+}
+
+size_t Assertion::GetMemoryUsage() const {
+    return policy.memory_usage();
+}
+
+void Assertion::BuildIncrementalRoleLinks(std::shared_ptr<RoleManager>& rm, policy_op op, const PoliciesValues& rules, size_t first) {
     this->rm = rm;
     size_t char_count = count(this->value.begin(), this->value.end(), '_');
 
     if (char_count < 2)
         throw IllegalArgumentException("the number of \"_\" in role definition should be at least 2");
 
-    for (std::vector<std::string> rule : rules) {
+    size_t position = 0;
+    for (const std::vector<std::string>& policy_rule : rules) {
+        if (position++ < first)
+            continue;
+        std::vector<std::string> rule = policy_rule;
         if (rule.size() < char_count)
             throw IllegalArgumentException("grouping policy elements do not meet role definition");
 
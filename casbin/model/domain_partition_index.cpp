@@ -0,0 +1,183 @@
+/*
+ * Copyright 2021 The casbin Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "casbin/pch.h"
+
+#ifndef DOMAIN_PARTITION_INDEX_CPP
+#define DOMAIN_PARTITION_INDEX_CPP
+
+#include "casbin/model/domain_partition_index.h"
+#include "casbin/model/matcher.h"
+
+namespace casbin {
+
+// Build detects the domain column of the context and partitions its current policy.
+void DomainPartitionIndex::Build(const std::shared_ptr<Model>& m, const EnforceContext& context) {
+    m_context = context;
+    m_applicable = false;
+    m_invalid_rules = 0;
+    m_policy = nullptr;
+    m_partitions.clear();
+
+    if (!m->HasSection("m") || !m->HasSection("p") || !m->HasSection("g") || m->m["m"].assertion_map.count(context.m_type) == 0 ||
+        m->m["p"].assertion_map.count(context.p_type) == 0)
+        return;
+    // the rules of a mapped policy have no address to point at
+    auto& assertion = m->m["p"].assertion_map[context.p_type];
+    if (assertion->policy.is_hash() || assertion->policy.is_mapped())
+        return;
+
+    auto conjuncts = GetConjuncts(ParseMatcher(m->m["m"].assertion_map[context.m_type]->value, context.r_type, context.p_type));
+    std::vector<std::string> domain_arguments;
+    for (const auto& conjunct : conjuncts)
+        if (conjunct->kind == MatcherNode::Kind::Call && conjunct->children.size() == 3 && m->m["g"].assertion_map.count(conjunct->value) != 0)
+            domain_arguments.push_back(conjunct->children[2]->value);
+
+    for (const auto& conjunct : conjuncts) {
+        if (conjunct->kind != MatcherNode::Kind::Compare || conjunct->value != "==")
+            continue;
+        const MatcherNode* r_field = conjunct->children[0].get();
+        const MatcherNode* p_field = conjunct->children[1].get();
+        if (!r_field->IsRequestField())
+            std::swap(r_field, p_field);
+        if (!r_field->IsRequestField() || !p_field->IsPolicyField())
+            continue;
+        if (std::find(domain_arguments.begin(), domain_arguments.end(), r_field->value) == domain_arguments.end() &&
+            std::find(domain_arguments.begin(), domain_arguments.end(), p_field->value) == domain_arguments.end())
+            continue;
+        auto column = std::find(assertion->tokens.begin(), assertion->tokens.end(), context.p_type + "_" + p_field->value.substr(2));
+        if (column == assertion->tokens.end())
+            continue;
+
+        m_applicable = true;
+        m_column_count = assertion->tokens.size();
+        m_domain_column = column - assertion->tokens.begin();
+        m_domain_token = r_field->value.substr(2);
+        break;
+    }
+
+    if (!m_applicable)
+        return;
+    this->PartitionPolicy(assertion->policy);
+}
+
+void DomainPartitionIndex::PartitionPolicy(const PoliciesValues& policy) {
+    m_invalid_rules = 0;
+    m_partitions.clear();
+    for (const auto& rule : policy)
+        this->AddRule(rule);
+    m_policy = &policy;
+    m_policy_size = policy.size();
+    m_first_rule = policy.empty() ? nullptr : &*policy.begin();
+    m_generation = policy.generation();
+}
+
+void DomainPartitionIndex::AddRule(const PolicyValues& rule) {
+    if (rule.size() != m_column_count) {
+        ++m_invalid_rules;
+        return;
+    }
+    m_partitions[rule[m_domain_column]].push_back(&rule);
+}
+
+bool DomainPartitionIndex::IsCurrent(const PoliciesValues& policy) const {
+    return &policy == m_policy && !policy.is_mapped() && policy.generation() == m_generation && policy.size() == m_policy_size &&
+           (policy.empty() || &*policy.begin() == m_first_rule);
+}
+
+// Update applies a policy change of the model made after Build. Like the model, added rules
+// are appended, while the policy keeps its storage they are appended to their partitions too,
+// any other change partitions the policy again.
+void DomainPartitionIndex::Update(const std::shared_ptr<Model>& m, policy_op op, const std::string& sec, const std::string& p_type, const PoliciesValues& rules) {
+    if (!m_applicable || sec != "p" || p_type != m_context.p_type)
+        return;
+    const PoliciesValues& policy = m->m["p"].assertion_map[p_type]->policy;
+    if (policy.is_mapped()) {
+        m_applicable = false;
+        return;
+    }
+    if (op == policy_add && &policy == m_policy && policy.generation() == m_generation && !policy.is_chunked() && m_first_rule != nullptr &&
+        &*policy.begin() == m_first_rule && policy.size() == m_policy_size + rules.size()) {
+        // the vector policy is contiguous, the added rules follow the partitioned ones
+        for (const PolicyValues* rule = m_first_rule + m_policy_size; rule != m_first_rule + policy.size(); ++rule)
+            this->AddRule(*rule);
+        m_policy_size = policy.size();
+        return;
+    }
+    this->PartitionPolicy(policy);
+}
+
+// IsApplicable returns true if the model has a domain column.
+bool DomainPartitionIndex::IsApplicable() const {
+    return m_applicable;
+}
+
+// GetDomainColumn returns the index of the domain column in the "p" rules.
+size_t DomainPartitionIndex::GetDomainColumn() const {
+    return m_domain_column;
+}
+
+// GetPartition returns the rules of the domain, nullptr when it has none.
+const DomainPartitionIndex::Rules* DomainPartitionIndex::GetPartition(const std::string& domain) const {
+    auto it = m_partitions.find(domain);
+    return it == m_partitions.end() ? nullptr : &it->second;
+}
+
+// Select returns the rules of the policy the request pushed into the evaluator can match, or
+// nullptr when the request has no string domain and every rule must be scanned.
+const DomainPartitionIndex::Rules* DomainPartitionIndex::Select(IEvaluator& evaluator, const PoliciesValues& policy) const {
+    static const Rules empty;
+
+    if (!m_applicable || m_invalid_rules > 0 || !this->IsCurrent(policy))
+        return nullptr;
+    const std::string* domain = evaluator.GetObjectString(m_context.r_type, m_domain_token);
+    if (domain == nullptr)
+        return nullptr;
+    const Rules* partition = this->GetPartition(*domain);
+    return partition == nullptr ? &empty : partition;
+}
+
+// GetFilteredPolicy reads the rules of the policy matching the field filters from the
+// partition of the domain they name. It returns false when the filters leave the domain open.
+bool DomainPartitionIndex::GetFilteredPolicy(const PoliciesValues& policy, int field_index, const std::vector<std::string>& field_values, PoliciesValues& rules) const {
+    if (!m_applicable || m_invalid_rules > 0 || !this->IsCurrent(policy) || field_index < 0 || m_domain_column < size_t(field_index) ||
+        m_domain_column >= field_index + field_values.size())
+        return false;
+    const std::string& domain = field_values[m_domain_column - field_index];
+    if (domain.empty())
+        return false;
+
+    rules = PoliciesValues();
+    const Rules* partition = this->GetPartition(domain);
+    if (partition == nullptr)
+        return true;
+    for (const PolicyValues* rule : *partition) {
+        bool matched = true;
+        for (size_t j = 0; j < field_values.size(); j++) {
+            if (field_values[j] != "" && (*rule)[field_index + j] != field_values[j]) {
+                matched = false;
+                break;
+            }
+        }
+        if (matched)
+            rules.emplace(*rule);
+    }
+    return true;
+}
+
+} // namespace casbin
+
+#endif // DOMAIN_PARTITION_INDEX_CPP
@@ -0,0 +1,163 @@
+/*
+ * Copyright 2021 The casbin Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "casbin/pch.h"
+
+#ifndef EFFECT_PARTITION_INDEX_CPP
+#define EFFECT_PARTITION_INDEX_CPP
+
+#include "casbin/model/effect_partition_index.h"
+#include "casbin/model/matcher.h"
+
+namespace casbin {
+
+// Build analyses the definitions of the context and partitions its current policy.
+void EffectPartitionIndex::Build(const std::shared_ptr<Model>& m, const EnforceContext& context) {
+    m_context = context;
+    m_mode = Mode::None;
+    m_has_key = false;
+    m_invalid_rules = 0;
+    m_policy = nullptr;
+    m_deny.clear();
+    m_allow.clear();
+
+    if (!m->HasSection("m") || !m->HasSection("p") || !m->HasSection("e") || m->m["m"].assertion_map.count(context.m_type) == 0 ||
+        m->m["p"].assertion_map.count(context.p_type) == 0 || m->m["e"].assertion_map.count(context.e_type) == 0)
+        return;
+    const std::string& effect = m->m["e"].assertion_map[context.e_type]->value;
+    Mode mode;
+    if (effect == "some(where (p.eft == allow)) && !some(where (p.eft == deny))")
+        mode = Mode::AllowAndDeny;
+    else if (effect == "!some(where (p.eft == deny))")
+        mode = Mode::DenyOverride;
+    else
+        return;
+
+    // the hash set policy is already narrowed down to one rule per request, the rules of a
+    // mapped policy have no address to point at
+    auto& assertion = m->m["p"].assertion_map[context.p_type];
+    auto eft = std::find(assertion->tokens.begin(), assertion->tokens.end(), context.p_type + "_eft");
+    if (assertion->policy.is_hash() || assertion->policy.is_mapped() || eft == assertion->tokens.end())
+        return;
+    m_eft_column = eft - assertion->tokens.begin();
+    m_column_count = assertion->tokens.size();
+
+    for (const auto& conjunct : GetConjuncts(ParseMatcher(m->m["m"].assertion_map[context.m_type]->value, context.r_type, context.p_type))) {
+        if (conjunct->kind != MatcherNode::Kind::Compare || conjunct->value != "==")
+            continue;
+        const MatcherNode* r_field = conjunct->children[0].get();
+        const MatcherNode* p_field = conjunct->children[1].get();
+        if (!r_field->IsRequestField())
+            std::swap(r_field, p_field);
+        if (!r_field->IsRequestField() || !p_field->IsPolicyField())
+            continue;
+        auto column = std::find(assertion->tokens.begin(), assertion->tokens.end(), context.p_type + "_" + p_field->value.substr(2));
+        if (column == assertion->tokens.end() || column == eft)
+            continue;
+        m_has_key = true;
+        m_key_column = column - assertion->tokens.begin();
+        m_key_token = r_field->value.substr(2);
+        break;
+    }
+
+    m_mode = mode;
+    this->PartitionPolicy(assertion->policy);
+}
+
+void EffectPartitionIndex::PartitionPolicy(const PoliciesValues& policy) {
+    m_invalid_rules = 0;
+    m_deny.clear();
+    m_allow.clear();
+    for (const auto& rule : policy)
+        this->AddRule(rule);
+    m_policy = &policy;
+    m_policy_size = policy.size();
+    m_first_rule = policy.empty() ? nullptr : &*policy.begin();
+    m_generation = policy.generation();
+}
+
+std::unordered_map<std::string_view, EffectPartitionIndex::Rules>* EffectPartitionIndex::Partition(const PolicyValues& rule) {
+    if (rule[m_eft_column] == "deny")
+        return &m_deny;
+    if (rule[m_eft_column] == "allow")
+        return &m_allow;
+    // any other effect never decides
+    return nullptr;
+}
+
+void EffectPartitionIndex::AddRule(const PolicyValues& rule) {
+    if (rule.size() != m_column_count) {
+        ++m_invalid_rules;
+        return;
+    }
+    auto partition = this->Partition(rule);
+    if (partition != nullptr)
+        (*partition)[m_has_key ? std::string_view(rule[m_key_column]) : std::string_view()].push_back(&rule);
+}
+
+// Update applies a policy change of the model made after Build. Like the model, added rules
+// are appended, while the policy keeps its storage they are appended to their buckets too,
+// any other change partitions the policy again.
+void EffectPartitionIndex::Update(const std::shared_ptr<Model>& m, policy_op op, const std::string& sec, const std::string& p_type, const PoliciesValues& rules) {
+    if (m_mode == Mode::None || sec != "p" || p_type != m_context.p_type)
+        return;
+    const PoliciesValues& policy = m->m["p"].assertion_map[p_type]->policy;
+    if (policy.is_mapped()) {
+        m_mode = Mode::None;
+        return;
+    }
+    if (op == policy_add && &policy == m_policy && policy.generation() == m_generation && !policy.is_chunked() && m_first_rule != nullptr &&
+        &*policy.begin() == m_first_rule && policy.size() == m_policy_size + rules.size()) {
+        // the vector policy is contiguous, the added rules follow the partitioned ones
+        for (const PolicyValues* rule = m_first_rule + m_policy_size; rule != m_first_rule + policy.size(); ++rule)
+            this->AddRule(*rule);
+        m_policy_size = policy.size();
+        return;
+    }
+    this->PartitionPolicy(policy);
+}
+
+// GetMode returns the effect the partitions are used for, None when they do not apply.
+EffectPartitionIndex::Mode EffectPartitionIndex::GetMode() const {
+    return m_mode;
+}
+
+// Select points deny_rules and allow_rules at the candidates of the policy for the request
+// pushed into the evaluator. It returns false when every rule must be scanned.
+bool EffectPartitionIndex::Select(IEvaluator& evaluator, const PoliciesValues& policy, const Rules*& deny_rules, const Rules*& allow_rules) const {
+    static const Rules empty;
+
+    if (m_mode == Mode::None || m_invalid_rules > 0 || &policy != m_policy || policy.is_mapped() || policy.generation() != m_generation ||
+        policy.size() != m_policy_size || (!policy.empty() && &*policy.begin() != m_first_rule))
+        return false;
+    std::string_view key;
+    if (m_has_key) {
+        const std::string* value = evaluator.GetObjectString(m_context.r_type, m_key_token);
+        if (value == nullptr)
+            return false;
+        key = *value;
+    }
+
+    auto deny = m_deny.find(key);
+    deny_rules = deny == m_deny.end() ? &empty : &deny->second;
+    auto allow = m_allow.find(key);
+    allow_rules = allow == m_allow.end() ? &empty : &allow->second;
+    return true;
+}
+
+} // namespace casbin
+
+#endif // EFFECT_PARTITION_INDEX_CPP
@@ -20,6 +20,13 @@
 #include "casbin/util/util.h"
 
 namespace casbin {
+
+// NewEvaluator returns an exprtk evaluator, the casbin_lite library defines it in
+// native_evaluator.cpp instead.
+std::shared_ptr<IEvaluator> IEvaluator::NewEvaluator() {
+    return std::make_shared<ExprtkEvaluator>();
+}
+
 bool ExprtkEvaluator::Eval(const std::string& expression_string) {
     expression.register_symbol_table(symbol_table);
     if (enable_get) {
@@ -28,9 +35,11 @@ bool ExprtkEvaluator::Eval(const std::string& expression_string) {
 
     if (this->expression_string_ != expression_string) {
         this->expression_string_ = expression_string;
-        // replace (&& -> and), (|| -> or)
-        auto replaced_string = std::regex_replace(expression_string, std::regex("&&"), "and");
-        replaced_string = std::regex_replace(replaced_string, std::regex("\\|{2}"), "or");
+        // replace (&& -> and), (|| -> or), or with the short-circuit forms (&& -> &), (|| -> |)
+        // when the operands are ordered by a plan, so that an operand deciding the result skips
+        // the ones after it
+        auto replaced_string = std::regex_replace(this->RewriteIn(expression_string), std::regex("&&"), short_circuit_ ? "&" : "and");
+        replaced_string = std::regex_replace(replaced_string, std::regex("\\|{2}"), short_circuit_ ? "|" : "or");
         // replace string "" -> ''
         replaced_string = std::regex_replace(replaced_string, std::regex("\""), "\'");
 
@@ -40,6 +49,70 @@ bool ExprtkEvaluator::Eval(const std::string& expression_string) {
     return this->parser.error_count() == 0;
 }
 
+void ExprtkEvaluator::SetShortCircuit(bool enable) {
+    if (short_circuit_ == enable)
+        return;
+    short_circuit_ = enable;
+    // the expression is compiled again with the other operators
+    this->expression_string_.clear();
+}
+
+std::string ExprtkEvaluator::RewriteIn(const std::string& expression) {
+    static const std::regex in_operator("\\bin\\s*\\(");
+    if (!std::regex_search(expression, in_operator))
+        return expression;
+    auto root = ParseMatcher(expression);
+    if (root == nullptr)
+        return expression;
+    this->RewriteIn(*root);
+    return PrintMatcher(*root);
+}
+
+// RewriteIn replaces "x in ('a', 'b')" by a call to a function testing x against the set of
+// the literals, built once for the evaluator, and an "in" with other candidates by the
+// comparisons "x == a || x == b".
+void ExprtkEvaluator::RewriteIn(MatcherNode& node) {
+    for (const auto& child : node.children)
+        this->RewriteIn(*child);
+    if (node.kind != MatcherNode::Kind::In)
+        return;
+
+    std::shared_ptr<MatcherNode> operand = node.children[0];
+    std::vector<std::shared_ptr<MatcherNode>> candidates = node.children[1]->children;
+    bool literals = std::all_of(candidates.begin(), candidates.end(), [](const std::shared_ptr<MatcherNode>& candidate) {
+        return candidate->kind == MatcherNode::Kind::String;
+    });
+    node.children.clear();
+
+    if (!literals || candidates.empty()) {
+        node.kind = MatcherNode::Kind::Or;
+        for (const auto& candidate : candidates) {
+            auto compare = std::make_shared<MatcherNode>(MatcherNode::Kind::Compare, "==");
+            compare->children = {operand, candidate};
+            node.children.push_back(compare);
+        }
+        if (node.children.empty())
+            node = MatcherNode(MatcherNode::Kind::Number, "0");
+        return;
+    }
+
+    std::vector<std::string> values;
+    std::string key;
+    for (const auto& candidate : candidates) {
+        values.push_back(candidate->value);
+        key += candidate->value;
+        key += '\0';
+    }
+    std::string& name = in_functions_[key];
+    if (name.empty()) {
+        name = "inSet" + std::to_string(in_functions_.size());
+        this->AddFunction(name, std::make_shared<ExprtkInFunction>(std::make_shared<const LiteralSet>(values)));
+    }
+    node.kind = MatcherNode::Kind::Call;
+    node.value = name;
+    node.children = {operand};
+}
+
 void ExprtkEvaluator::InitialObject(const std::string& identifier) {
     // symbol_table.add_stringvar("");
 }
@@ -64,7 +137,26 @@ void ExprtkEvaluator::PushObjectJson(const std::string& target, const std::strin
     // this->symbol_table.add_stringvar(identifier, const_cast<std::string&>(var));
 }
 
+const std::string* ExprtkEvaluator::GetObjectString(const std::string& target, const std::string& proprity) {
+    auto it = identifiers_.find(target + "." + proprity);
+    return it == identifiers_.end() ? nullptr : it->second.get();
+}
+
+std::string* ExprtkEvaluator::GetObjectSlot(const std::string& target, const std::string& proprity) {
+    auto identifier = target + "." + proprity;
+    if (!symbol_table.symbol_exists(identifier))
+        this->AddIdentifier(identifier, "");
+    auto it = identifiers_.find(identifier);
+    return it == identifiers_.end() ? nullptr : it->second.get();
+}
+
 void ExprtkEvaluator::LoadFunctions() {
+    // the symbol table keeps the first registration of a name, loading again would only
+    // create functions to throw away
+    if (functions_loaded_)
+        return;
+    functions_loaded_ = true;
+
     AddFunction("keyMatch", ExprtkFunctionFactory::GetExprtkFunction(ExprtkFunctionType::KeyMatch, 2));
     AddFunction("keyMatch2", ExprtkFunctionFactory::GetExprtkFunction(ExprtkFunctionType::KeyMatch2, 2));
     AddFunction("keyMatch3", ExprtkFunctionFactory::GetExprtkFunction(ExprtkFunctionType::KeyMatch3, 2));
@@ -77,7 +169,15 @@ void ExprtkEvaluator::LoadFunctions() {
 }
 
 void ExprtkEvaluator::LoadGFunction(std::shared_ptr<RoleManager> rm, const std::string& name, int narg) {
-    auto func = ExprtkFunctionFactory::GetExprtkFunction(ExprtkFunctionType::Gfunction, narg, rm);
+    // A compiled expression keeps referring to the function object it was compiled with,
+    // so an evaluator shared between enforcers rebinds the role manager in place.
+    if (auto it = g_functions_.find(name); it != g_functions_.end()) {
+        it->second->UpdateRoleManager(rm);
+        return;
+    }
+
+    auto func = std::make_shared<ExprtkGFunction>(std::string(narg, 'S'), rm);
+    g_functions_[name] = func;
     this->AddFunction(name, func);
 }
 
@@ -117,13 +217,16 @@ void ExprtkEvaluator::Clean(AssertionMap& section, bool after_enforce) {
     this->glbl_variable_symbol_table.clear();
     this->expression_string_ = "";
     this->Functions.clear();
+    this->g_functions_.clear();
     this->identifiers_.clear();
+    this->in_functions_.clear();
+    this->functions_loaded_ = false;
 }
 
 void ExprtkEvaluator::AddFunction(const std::string& func_name, std::shared_ptr<exprtk_func_t> func) {
-    if (func != nullptr) {
+    // The first registration of a name wins, keep only the functions the symbol table refers to
+    if (func != nullptr && symbol_table.add_function(func_name, *func)) {
         this->Functions.push_back(func);
-        symbol_table.add_function(func_name, *func);
     }
 }
 
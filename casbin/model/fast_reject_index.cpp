@@ -0,0 +1,163 @@
+/*
+ * Copyright 2021 The casbin Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "casbin/pch.h"
+
+#ifndef FAST_REJECT_INDEX_CPP
+#define FAST_REJECT_INDEX_CPP
+
+#include "casbin/model/fast_reject_index.h"
+#include "casbin/model/matcher.h"
+#include "casbin/rbac/default_role_manager.h"
+
+namespace casbin {
+
+namespace {
+
+// FindColumn returns the index of the policy field named by the node ("p.sub" -> "p_sub").
+bool FindColumn(const std::vector<std::string>& p_tokens, const std::string& p_type, const MatcherNode& node, size_t& column) {
+    std::string token = p_type + "_" + node.value.substr(2);
+    auto it = std::find(p_tokens.begin(), p_tokens.end(), token);
+    if (it == p_tokens.end())
+        return false;
+    column = it - p_tokens.begin();
+    return true;
+}
+
+// HasExactRoleNames returns true if g() can only link names that appear in its rules.
+bool HasExactRoleNames(const std::shared_ptr<RoleManager>& rm) {
+    auto default_rm = std::dynamic_pointer_cast<DefaultRoleManager>(rm);
+    return default_rm != nullptr && !default_rm->HasPattern();
+}
+
+} // namespace
+
+void FastRejectIndex::Count(std::unordered_map<std::string, size_t>& values, const std::string& value, policy_op op) {
+    if (op == policy_add) {
+        ++values[value];
+        return;
+    }
+    auto it = values.find(value);
+    if (it != values.end() && --it->second == 0)
+        values.erase(it);
+}
+
+// Build analyses the matcher of the context and indexes its current policy.
+void FastRejectIndex::Build(const std::shared_ptr<Model>& m, const EnforceContext& context) {
+    m_context = context;
+    m_requirements.clear();
+    m_p_values.clear();
+    m_g_names.clear();
+    m_g_sources.clear();
+
+    if (!m->HasSection("m") || m->m["m"].assertion_map.count(context.m_type) == 0 || !m->HasSection("p") || m->m["p"].assertion_map.count(context.p_type) == 0)
+        return;
+    auto root = ParseMatcher(m->m["m"].assertion_map[context.m_type]->value, context.r_type, context.p_type);
+    const std::vector<std::string>& p_tokens = m->m["p"].assertion_map[context.p_type]->tokens;
+
+    for (const auto& conjunct : GetConjuncts(root)) {
+        Requirement requirement;
+        if (conjunct->kind == MatcherNode::Kind::Compare && conjunct->value == "==") {
+            const MatcherNode* r_field = conjunct->children[0].get();
+            const MatcherNode* p_field = conjunct->children[1].get();
+            if (!r_field->IsRequestField())
+                std::swap(r_field, p_field);
+            if (!r_field->IsRequestField() || !p_field->IsPolicyField() || !FindColumn(p_tokens, context.p_type, *p_field, requirement.p_column))
+                continue;
+            requirement.r_token = r_field->value.substr(2);
+        } else if (conjunct->kind == MatcherNode::Kind::Call && conjunct->children.size() >= 2 && m->HasSection("g")) {
+            auto g_it = m->m["g"].assertion_map.find(conjunct->value);
+            if (g_it == m->m["g"].assertion_map.end() || !HasExactRoleNames(g_it->second->rm))
+                continue;
+            const MatcherNode& r_field = *conjunct->children[0];
+            const MatcherNode& p_field = *conjunct->children[1];
+            if (!r_field.IsRequestField() || !p_field.IsPolicyField() || !FindColumn(p_tokens, context.p_type, p_field, requirement.p_column))
+                continue;
+            requirement.r_token = r_field.value.substr(2);
+            requirement.g_names = this->AddRoleManager(m, g_it->second->rm);
+        } else {
+            continue;
+        }
+        m_requirements.push_back(requirement);
+    }
+
+    for (const Requirement& requirement : m_requirements)
+        m_p_values[requirement.p_column];
+    this->Update(policy_add, "p", context.p_type, m->m["p"].assertion_map[context.p_type]->policy);
+    for (auto& [g_key, _] : m_g_sources)
+        this->Update(policy_add, "g", g_key, m->m["g"].assertion_map[g_key]->policy);
+}
+
+// AddRoleManager returns the member names counted for the role manager, taking the rules of
+// every role definition that links through it.
+size_t FastRejectIndex::AddRoleManager(const std::shared_ptr<Model>& m, const std::shared_ptr<RoleManager>& rm) {
+    for (auto& [g_key, assertion] : m->m["g"].assertion_map)
+        if (assertion->rm == rm && m_g_sources.count(g_key) != 0)
+            return m_g_sources[g_key];
+
+    size_t g_names = m_g_names.size();
+    m_g_names.emplace_back();
+    for (auto& [g_key, assertion] : m->m["g"].assertion_map)
+        if (assertion->rm == rm)
+            m_g_sources[g_key] = g_names;
+    return g_names;
+}
+
+// Update applies a policy change made after Build.
+void FastRejectIndex::Update(policy_op op, const std::string& sec, const std::string& p_type, const PoliciesValues& rules) {
+    if (sec == "p" && p_type == m_context.p_type) {
+        for (auto& [column, values] : m_p_values)
+            for (const auto& rule : rules)
+                if (column < rule.size())
+                    this->Count(values, rule[column], op);
+    } else if (sec == "g") {
+        auto it = m_g_sources.find(p_type);
+        if (it == m_g_sources.end())
+            return;
+        for (const auto& rule : rules)
+            if (!rule.empty())
+                this->Count(m_g_names[it->second], rule[0], op);
+    }
+}
+
+// IsApplicable returns true if the matcher has conjuncts the index can check.
+bool FastRejectIndex::IsApplicable() const {
+    return !m_requirements.empty();
+}
+
+// Rejects returns true if the request pushed into the evaluator cannot match any rule.
+bool FastRejectIndex::Rejects(IEvaluator& evaluator) const {
+    for (const Requirement& requirement : m_requirements) {
+        const std::string* value = evaluator.GetObjectString(m_context.r_type, requirement.r_token);
+        if (value == nullptr)
+            continue;
+
+        const auto& p_values = m_p_values.at(requirement.p_column);
+        if (p_values.find(*value) != p_values.end())
+            continue;
+        if (requirement.g_names.has_value()) {
+            const auto& g_names = m_g_names[*requirement.g_names];
+            if (g_names.find(*value) != g_names.end())
+                continue;
+        }
+        return true;
+    }
+    return false;
+}
+
+} // namespace casbin
+
+#endif // FAST_REJECT_INDEX_CPP
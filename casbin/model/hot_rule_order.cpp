@@ -0,0 +1,166 @@
+/*
+ * Copyright 2021 The casbin Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "casbin/pch.h"
+
+#ifndef HOT_RULE_ORDER_CPP
+#define HOT_RULE_ORDER_CPP
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
+#include "casbin/model/hot_rule_order.h"
+
+namespace casbin {
+
+// Build analyses the model and orders its current policy by the remembered hits.
+void HotRuleOrder::Build(const std::shared_ptr<Model>& m) {
+    std::lock_guard<std::mutex> lock(m_reorder_mutex);
+    m_applicable = false;
+    std::atomic_store(&m_order, std::shared_ptr<const Order>());
+
+    if (!m->HasSection("p") || !m->HasSection("e") || m->m["p"].assertion_map.count("p") == 0)
+        return;
+    const std::string& effect = m->m["e"].assertion_map["e"]->value;
+    if (effect != "some(where (p.eft == allow))" && effect != "!some(where (p.eft == deny))" &&
+        effect != "some(where (p.eft == allow)) && !some(where (p.eft == deny))")
+        return;
+
+    m_column_count = m->m["p"].assertion_map["p"]->tokens.size();
+    m_applicable = true;
+    this->Index(m->m["p"].assertion_map["p"]->policy);
+}
+
+// Index reads the rules of the policy and orders them by the remembered hits. The caller must
+// hold m_reorder_mutex. Readers still scanning the previous order keep its rules and hits.
+void HotRuleOrder::Index(const PoliciesValues& policy) {
+    m_stale.store(false, std::memory_order_relaxed);
+    auto rules = std::make_shared<Rules>();
+    rules->policy = &policy;
+    rules->policy_size = policy.size();
+    rules->first_rule = policy.empty() ? nullptr : &*policy.begin();
+
+    // the hash set policy is already narrowed down to one rule per request, the rules of a
+    // mapped policy have no address to order, a rule without the expected number of columns
+    // fails the scan where the policy puts it
+    bool orderable = !policy.is_hash() && !policy.is_mapped() && policy.size() <= std::numeric_limits<uint32_t>::max();
+    if (orderable) {
+        for (const auto& rule : policy) {
+            if (rule.size() != m_column_count) {
+                rules->rules.clear();
+                break;
+            }
+            rules->rules.push_back(&rule);
+        }
+    }
+
+    rules->hits = std::make_unique<std::atomic<uint32_t>[]>(rules->rules.size());
+    for (size_t id = 0; id < rules->rules.size(); id++) {
+        auto remembered = m_remembered.find(*rules->rules[id]);
+        rules->hits[id].store(remembered != m_remembered.end() ? remembered->second : 0, std::memory_order_relaxed);
+    }
+    auto order = std::make_shared<Order>();
+    order->rules = std::move(rules);
+    std::atomic_store(&m_order, std::shared_ptr<const Order>(std::move(order)));
+    this->Reorder(false);
+}
+
+// Reorder sorts the scan order by the hits, halving them with decay. The caller must hold
+// m_reorder_mutex.
+void HotRuleOrder::Reorder(bool decay) {
+    std::shared_ptr<const Order> current = std::atomic_load(&m_order);
+    if (current == nullptr || current->rules->rules.empty())
+        return;
+    const std::shared_ptr<Rules>& rules = current->rules;
+    size_t count = rules->rules.size();
+
+    std::vector<uint32_t> hits(count);
+    for (size_t id = 0; id < count; id++)
+        hits[id] = rules->hits[id].load(std::memory_order_relaxed);
+
+    auto order = std::make_shared<Order>();
+    order->rules = rules;
+    order->ids.resize(count);
+    std::iota(order->ids.begin(), order->ids.end(), 0);
+    std::stable_sort(order->ids.begin(), order->ids.end(), [&](uint32_t a, uint32_t b) {
+        return hits[a] > hits[b];
+    });
+
+    m_remembered.clear();
+    for (size_t i = 0; i < count && i < kRememberedRules && hits[order->ids[i]] > 0; i++)
+        m_remembered[*rules->rules[order->ids[i]]] = hits[order->ids[i]];
+    // hits counted meanwhile may be lost, the order only needs their proportions
+    if (decay) {
+        for (size_t id = 0; id < count; id++)
+            rules->hits[id].store(hits[id] / 2, std::memory_order_relaxed);
+    }
+
+    std::atomic_store(&m_order, std::shared_ptr<const Order>(std::move(order)));
+}
+
+// IsApplicable returns true if the model has an effect the scan order does not change.
+bool HotRuleOrder::IsApplicable() const {
+    return m_applicable;
+}
+
+// Update marks the rules of the policy stale after it changed. A changed policy may keep its
+// size and its first rule, while the rules the order points at moved.
+void HotRuleOrder::Update(const std::string& sec, const std::string& p_type) {
+    if (sec == "p" && p_type == "p")
+        m_stale.store(true, std::memory_order_relaxed);
+}
+
+// GetOrder returns the scan order of the policy. A policy changed since it was indexed is
+// indexed again, its remembered rules keep their place.
+std::shared_ptr<const HotRuleOrder::Order> HotRuleOrder::GetOrder(const PoliciesValues& policy) {
+    if (!m_applicable)
+        return nullptr;
+    auto changed = [&](const std::shared_ptr<const Order>& order) {
+        return order == nullptr || m_stale.load(std::memory_order_relaxed) || &policy != order->rules->policy ||
+               policy.size() != order->rules->policy_size || (policy.empty() ? nullptr : &*policy.begin()) != order->rules->first_rule;
+    };
+    std::shared_ptr<const Order> order = std::atomic_load(&m_order);
+    if (changed(order)) {
+        std::lock_guard<std::mutex> lock(m_reorder_mutex);
+        order = std::atomic_load(&m_order);
+        if (changed(order)) {
+            this->Index(policy);
+            order = std::atomic_load(&m_order);
+        }
+    }
+    return order->ids.empty() ? nullptr : order;
+}
+
+// GetRules returns the rules of the policy in the order.
+HotRuleOrder::Range HotRuleOrder::GetRules(const Order& order) {
+    return Range(&order);
+}
+
+// Hit counts a decision by the rule at the position of the scan order.
+void HotRuleOrder::Hit(const Order& order, size_t position) {
+    order.rules->hits[order.ids[position]].fetch_add(1, std::memory_order_relaxed);
+    if ((m_decisions.fetch_add(1, std::memory_order_relaxed) + 1) % kReorderInterval != 0)
+        return;
+    // another thread reordering is as good
+    std::unique_lock<std::mutex> lock(m_reorder_mutex, std::try_to_lock);
+    if (lock.owns_lock())
+        this->Reorder(true);
+}
+
+} // namespace casbin
+
+#endif // HOT_RULE_ORDER_CPP
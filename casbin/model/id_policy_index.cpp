@@ -0,0 +1,436 @@
+/*
+ * Copyright 2021 The casbin Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "casbin/pch.h"
+
+#ifndef ID_POLICY_INDEX_CPP
+#define ID_POLICY_INDEX_CPP
+
+#include <atomic>
+#include <unordered_set>
+
+#include "casbin/model/id_policy_index.h"
+#include "casbin/effect/default_effector.h"
+#include "casbin/exception/casbin_enforcer_exception.h"
+#include "casbin/exception/illegal_argument_exception.h"
+#include "casbin/model/matcher.h"
+
+namespace casbin {
+
+namespace {
+
+// A rebuild starts a new epoch once the dictionary holds this many more values than twice
+// those of the policy.
+const size_t kDictionarySlack = 1024;
+
+// Epochs are unique across enforcers, so ids resolved by another enforcer are refused.
+std::atomic<uint64_t> s_epochs{0};
+
+bool FindToken(const std::vector<std::string>& tokens, const std::string& prefix, const MatcherNode& node, size_t& index) {
+    auto it = std::find(tokens.begin(), tokens.end(), prefix + node.value.substr(2));
+    if (it == tokens.end())
+        return false;
+    index = it - tokens.begin();
+    return true;
+}
+
+} // namespace
+
+ValueDictionary::ValueDictionary(uint64_t epoch)
+    : m_epoch(epoch) {
+    this->Intern("");
+}
+
+// Intern returns the id of the value, adding it when it is new.
+ValueId ValueDictionary::Intern(const std::string& value) {
+    auto [it, inserted] = m_ids.emplace(value, static_cast<ValueId>(m_values.size()));
+    if (inserted)
+        m_values.push_back(value);
+    return it->second;
+}
+
+// GetId returns the id of the value, kUnknownValueId when no rule holds it.
+ValueId ValueDictionary::GetId(const std::string& value) const {
+    auto it = m_ids.find(value);
+    return it != m_ids.end() ? it->second : kUnknownValueId;
+}
+
+// GetValue returns the value of an id of the dictionary.
+const std::string& ValueDictionary::GetValue(ValueId id) const {
+    if (id >= m_values.size())
+        throw IllegalArgumentException("the value id is not in the dictionary");
+    return m_values[id];
+}
+
+// Resolve returns the ids of the values of a request.
+ValueIds ValueDictionary::Resolve(const std::vector<std::string>& values) const {
+    ValueIds request;
+    request.epoch = m_epoch;
+    request.ids.reserve(values.size());
+    for (const std::string& value : values)
+        request.ids.push_back(this->GetId(value));
+    return request;
+}
+
+uint64_t ValueDictionary::GetEpoch() const {
+    return m_epoch;
+}
+
+size_t ValueDictionary::Size() const {
+    return m_values.size();
+}
+
+// Build analyses the model and interns its current policy. The dictionary and its epoch
+// are kept, unless it grew much larger than the policy it interns.
+void IdPolicyIndex::Build(const std::shared_ptr<Model>& m) {
+    if (m_dictionary.GetEpoch() == 0)
+        m_dictionary = ValueDictionary(++s_epochs);
+    this->BuildRules(m);
+    if (!m_applicable)
+        return;
+
+    std::unordered_set<ValueId> values;
+    for (const auto& [subject, rules] : m_rules) {
+        values.insert(subject);
+        for (const Rule& rule : rules) {
+            values.insert(rule.values.begin(), rule.values.end());
+            values.insert(rule.eft);
+        }
+    }
+    if (!m_g_key.empty()) {
+        for (const auto& rule : m->m["g"].assertion_map[m_g_key]->policy)
+            for (const std::string& value : rule)
+                values.insert(m_dictionary.GetId(value));
+    }
+    if (m_dictionary.Size() > 2 * values.size() + kDictionarySlack) {
+        m_dictionary = ValueDictionary(++s_epochs);
+        this->BuildRules(m);
+    }
+}
+
+void IdPolicyIndex::BuildRules(const std::shared_ptr<Model>& m) {
+    m_applicable = false;
+    m_g_key.clear();
+    m_rm = nullptr;
+    m_eft_column = -1;
+    m_domain_request = -1;
+    m_requests.clear();
+    m_columns.clear();
+    m_rule_count = 0;
+    m_invalid_rules = 0;
+    m_rules.clear();
+    {
+        std::lock_guard<std::mutex> lock(m_closures_mutex);
+        m_closures.clear();
+    }
+
+    if (!m->HasSection("m") || !m->HasSection("r") || !m->HasSection("p") || !m->HasSection("e") || m->m["p"].assertion_map.count("p") == 0)
+        return;
+    const std::string& effect = m->m["e"].assertion_map["e"]->value;
+    if (effect == "some(where (p.eft == allow))")
+        m_mode = Mode::AllowOverride;
+    else if (effect == "!some(where (p.eft == deny))")
+        m_mode = Mode::DenyOverride;
+    else if (effect == "some(where (p.eft == allow)) && !some(where (p.eft == deny))")
+        m_mode = Mode::AllowAndDeny;
+    else
+        return;
+    auto root = ParseMatcher(m->m["m"].assertion_map["m"]->value);
+    if (root == nullptr)
+        return;
+
+    const std::vector<std::string>& r_tokens = m->m["r"].assertion_map["r"]->tokens;
+    const std::vector<std::string>& p_tokens = m->m["p"].assertion_map["p"]->tokens;
+    bool has_subject = false;
+    for (const auto& conjunct : GetConjuncts(root)) {
+        size_t request;
+        size_t column;
+        if (conjunct->kind == MatcherNode::Kind::Call && m->HasSection("g") && m->m["g"].assertion_map.count(conjunct->value) != 0) {
+            auto default_rm = std::dynamic_pointer_cast<DefaultRoleManager>(m->m["g"].assertion_map[conjunct->value]->rm);
+            if (has_subject || default_rm == nullptr || default_rm->HasPattern())
+                return;
+            if (conjunct->children.size() != 2 && conjunct->children.size() != 3)
+                return;
+            const MatcherNode& r_field = *conjunct->children[0];
+            const MatcherNode& p_field = *conjunct->children[1];
+            if (!r_field.IsRequestField() || !p_field.IsPolicyField() || !FindToken(r_tokens, "r_", r_field, request) || !FindToken(p_tokens, "p_", p_field, column))
+                return;
+            if (conjunct->children.size() == 3) {
+                size_t domain;
+                if (!conjunct->children[2]->IsRequestField() || !FindToken(r_tokens, "r_", *conjunct->children[2], domain))
+                    return;
+                m_domain_request = static_cast<int>(domain);
+            }
+            has_subject = true;
+            m_g_key = conjunct->value;
+            m_rm = default_rm;
+            m_subject_request = request;
+            m_subject_column = column;
+        } else if (conjunct->kind == MatcherNode::Kind::Compare && conjunct->value == "==" && conjunct->children.size() == 2) {
+            const MatcherNode* r_field = conjunct->children[0].get();
+            const MatcherNode* p_field = conjunct->children[1].get();
+            if (!r_field->IsRequestField())
+                std::swap(r_field, p_field);
+            if (!r_field->IsRequestField() || !p_field->IsPolicyField() || !FindToken(r_tokens, "r_", *r_field, request) || !FindToken(p_tokens, "p_", *p_field, column))
+                return;
+            m_requests.push_back(request);
+            m_columns.push_back(column);
+        } else {
+            return;
+        }
+    }
+
+    // without role definition the first equality selects the subject
+    if (!has_subject) {
+        if (m_columns.empty())
+            return;
+        m_subject_request = m_requests.front();
+        m_subject_column = m_columns.front();
+        m_requests.erase(m_requests.begin());
+        m_columns.erase(m_columns.begin());
+    }
+
+    auto eft = std::find(p_tokens.begin(), p_tokens.end(), "p_eft");
+    if (eft != p_tokens.end())
+        m_eft_column = static_cast<int>(eft - p_tokens.begin());
+    m_request_size = r_tokens.size();
+    m_column_count = p_tokens.size();
+    m_applicable = true;
+
+    const PoliciesValues& policy = m->m["p"].assertion_map["p"]->policy;
+    m_hashed = policy.is_hash();
+    for (const auto& rule : policy)
+        this->AddRule(rule);
+    if (!m_g_key.empty()) {
+        for (const auto& rule : m->m["g"].assertion_map[m_g_key]->policy)
+            for (const std::string& value : rule)
+                m_dictionary.Intern(value);
+    }
+}
+
+void IdPolicyIndex::AddRule(const std::vector<std::string>& rule) {
+    ++m_rule_count;
+    if (rule.size() != m_column_count) {
+        ++m_invalid_rules;
+        return;
+    }
+
+    Rule id_rule;
+    for (size_t column : m_columns)
+        id_rule.values.push_back(m_dictionary.Intern(rule[column]));
+    id_rule.eft = m_eft_column >= 0 ? m_dictionary.Intern(rule[m_eft_column]) : 0;
+    id_rule.effect = Effect::Allow;
+    if (m_eft_column >= 0) {
+        const std::string& eft = rule[m_eft_column];
+        id_rule.effect = eft == "allow" ? Effect::Allow : eft == "deny" ? Effect::Deny : Effect::Indeterminate;
+    }
+    id_rule.count = 1;
+
+    std::vector<Rule>& rules = m_rules[m_dictionary.Intern(rule[m_subject_column])];
+    for (Rule& existing : rules) {
+        if (existing.values == id_rule.values && existing.eft == id_rule.eft) {
+            ++existing.count;
+            return;
+        }
+    }
+    rules.push_back(std::move(id_rule));
+}
+
+void IdPolicyIndex::RemoveRule(const std::vector<std::string>& rule) {
+    if (m_rule_count > 0)
+        --m_rule_count;
+    if (rule.size() != m_column_count) {
+        if (m_invalid_rules > 0)
+            --m_invalid_rules;
+        return;
+    }
+
+    auto rules_it = m_rules.find(m_dictionary.GetId(rule[m_subject_column]));
+    if (rules_it == m_rules.end())
+        return;
+    std::vector<ValueId> values;
+    for (size_t column : m_columns)
+        values.push_back(m_dictionary.GetId(rule[column]));
+    ValueId eft = m_eft_column >= 0 ? m_dictionary.GetId(rule[m_eft_column]) : 0;
+
+    std::vector<Rule>& rules = rules_it->second;
+    for (auto it = rules.begin(); it != rules.end(); ++it) {
+        if (it->values == values && it->eft == eft) {
+            if (--it->count == 0)
+                rules.erase(it);
+            break;
+        }
+    }
+    if (rules.empty())
+        m_rules.erase(rules_it);
+}
+
+// SetRoleManager moves the index onto a copy of the role graph with the same links.
+void IdPolicyIndex::SetRoleManager(const std::shared_ptr<RoleManager>& from, const std::shared_ptr<RoleManager>& to) {
+    if (m_rm != nullptr && m_rm == from)
+        m_rm = std::dynamic_pointer_cast<DefaultRoleManager>(to);
+}
+
+// Update applies a policy change made after Build.
+void IdPolicyIndex::Update(policy_op op, const std::string& sec, const std::string& p_type, const PoliciesValues& rules) {
+    if (!m_applicable)
+        return;
+    size_t dictionary_size = m_dictionary.Size();
+    if (sec == "p" && p_type == "p") {
+        for (const auto& rule : rules) {
+            if (op == policy_add)
+                this->AddRule(rule);
+            else
+                this->RemoveRule(rule);
+        }
+    } else if (sec == "g" && p_type == m_g_key) {
+        if (op == policy_add) {
+            for (const auto& rule : rules)
+                for (const std::string& value : rule)
+                    m_dictionary.Intern(value);
+        }
+        std::lock_guard<std::mutex> lock(m_closures_mutex);
+        m_closures.clear();
+    }
+
+    // closures leave out the roles the dictionary did not know yet
+    if (m_dictionary.Size() != dictionary_size) {
+        std::lock_guard<std::mutex> lock(m_closures_mutex);
+        m_closures.clear();
+    }
+}
+
+// SetEffector sets the effector of the enforcer, the index decides for a DefaultEffector.
+void IdPolicyIndex::SetEffector(const std::shared_ptr<Effector>& eft) {
+    m_default_effector = dynamic_cast<DefaultEffector*>(eft.get()) != nullptr;
+}
+
+// IsApplicable returns true if the model has the shape the index can decide, with the
+// effect of a DefaultEffector.
+bool IdPolicyIndex::IsApplicable() const {
+    return m_applicable && m_default_effector;
+}
+
+const ValueDictionary& IdPolicyIndex::GetDictionary() const {
+    return m_dictionary;
+}
+
+// GetClosure returns the subject and the roles it inherits. m_closures_mutex is held only
+// to look the closure up and to cache it.
+std::shared_ptr<const IdPolicyIndex::Closure> IdPolicyIndex::GetClosure(ValueId subject, ValueId domain) const {
+    uint64_t key = (uint64_t(subject) << 32) | domain;
+    {
+        std::lock_guard<std::mutex> lock(m_closures_mutex);
+        auto it = m_closures.find(key);
+        if (it != m_closures.end())
+            return it->second;
+    }
+
+    auto closure_ptr = std::make_shared<Closure>(Closure{subject});
+    Closure& closure = *closure_ptr;
+    if (subject < m_dictionary.Size() && (m_domain_request < 0 || domain < m_dictionary.Size())) {
+        std::vector<std::string> domains;
+        if (m_domain_request >= 0)
+            domains.push_back(m_dictionary.GetValue(domain));
+
+        std::vector<std::string> roles;
+        m_rm->GetInheritedRoles(m_dictionary.GetValue(subject), domains, roles);
+        for (const std::string& role : roles) {
+            ValueId id = m_dictionary.GetId(role);
+            if (id != kUnknownValueId && id != subject)
+                closure.push_back(id);
+        }
+    }
+
+    // a closure computed by another request in the meantime is as good
+    std::lock_guard<std::mutex> lock(m_closures_mutex);
+    if (m_closures.size() >= DefaultRoleManager::kMaxCachedClosures)
+        m_closures.clear();
+    return m_closures.emplace(key, std::move(closure_ptr)).first->second;
+}
+
+// Decide returns the decision for the request. It throws a CasbinEnforcerException when
+// the ids are from another epoch or do not fit the request definition.
+bool IdPolicyIndex::Decide(const ValueIds& request) const {
+    if (request.epoch != m_dictionary.GetEpoch())
+        throw CasbinEnforcerException("the value ids are from another dictionary epoch");
+    if (request.ids.size() != m_request_size)
+        throw CasbinEnforcerException("invalid request size");
+    if (m_invalid_rules > 0)
+        throw CasbinEnforcerException("invalid policy size");
+
+    const ValueId* r = request.ids.data();
+    ValueId subject = r[m_subject_request];
+    bool matched = false;
+    bool allowed = false;
+    auto match_rules = [&](ValueId name) {
+        auto rules_it = m_rules.find(name);
+        if (rules_it == m_rules.end())
+            return false;
+        for (const Rule& rule : rules_it->second) {
+            size_t i = 0;
+            while (i < m_requests.size() && rule.values[i] == r[m_requests[i]])
+                ++i;
+            if (i < m_requests.size())
+                continue;
+            matched = true;
+            if (m_mode != Mode::AllowOverride && rule.effect == Effect::Deny) {
+                allowed = false;
+                return true;
+            }
+            if (rule.effect == Effect::Allow) {
+                allowed = true;
+                if (m_mode == Mode::AllowOverride)
+                    return true;
+            }
+        }
+        return false;
+    };
+
+    // an empty policy, and a hashed one without the requested rule, are decided by matching
+    // a rule of empty values like the generic enforcer does
+    auto empty_rule_matches = [&](bool subject_has_empty_role) {
+        for (size_t request_index : m_requests)
+            if (r[request_index] != 0)
+                return false;
+        return subject == 0 || subject_has_empty_role;
+    };
+
+    // deny-override allows every request no matching rule denies, the empty rule included
+    if (m_rm == nullptr) {
+        if (match_rules(subject))
+            return allowed;
+        if (m_mode == Mode::DenyOverride)
+            return true;
+        if (!matched && (m_rule_count == 0 || m_hashed))
+            return empty_rule_matches(false);
+        return allowed;
+    }
+
+    std::shared_ptr<const Closure> closure = this->GetClosure(subject, m_domain_request >= 0 ? r[m_domain_request] : 0);
+    for (ValueId name : *closure)
+        if (match_rules(name))
+            return allowed;
+    if (m_mode == Mode::DenyOverride)
+        return true;
+    if (!matched && m_rule_count == 0)
+        return empty_rule_matches(std::find(closure->begin(), closure->end(), 0) != closure->end());
+    return allowed;
+}
+
+} // namespace casbin
+
+#endif // ID_POLICY_INDEX_CPP
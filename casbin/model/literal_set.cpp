@@ -0,0 +1,50 @@
+
+/*
+ * Copyright 2020 The casbin Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "casbin/pch.h"
+
+#ifndef LITERAL_SET_CPP
+#define LITERAL_SET_CPP
+
+#include "casbin/model/literal_set.h"
+
+namespace casbin {
+
+LiteralSet::LiteralSet(const std::vector<std::string>& literals) {
+    std::unordered_set<std::string> unique(literals.begin(), literals.end());
+    if (unique.size() > kMaxSortedSize) {
+        m_hashed = std::move(unique);
+        return;
+    }
+    m_sorted.assign(unique.begin(), unique.end());
+    std::sort(m_sorted.begin(), m_sorted.end());
+}
+
+// Contains returns true if the value is one of the literals.
+bool LiteralSet::Contains(const std::string& value) const {
+    if (m_sorted.empty())
+        return m_hashed.count(value) != 0;
+    return std::binary_search(m_sorted.begin(), m_sorted.end(), value);
+}
+
+size_t LiteralSet::Size() const {
+    return m_sorted.empty() ? m_hashed.size() : m_sorted.size();
+}
+
+} // namespace casbin
+
+#endif // LITERAL_SET_CPP
@@ -0,0 +1,381 @@
+/*
+ * Copyright 2021 The casbin Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "casbin/pch.h"
+
+#ifndef MATCHER_CPP
+#define MATCHER_CPP
+
+#include <cctype>
+
+#include "casbin/model/matcher.h"
+
+namespace casbin {
+
+namespace {
+
+struct Token {
+    enum class Kind { Identifier, String, Number, Operator, End };
+
+    Kind kind;
+    std::string text;
+};
+
+// Tokenize splits a matcher into tokens, returns false on characters it does not know.
+bool Tokenize(const std::string& expression, std::vector<Token>& tokens) {
+    static const std::vector<std::string> operators = {"&&", "||", "==", "!=", "<=", ">=", "!", "<", ">", "+", "-", "*", "/", "%", "(", ")", ","};
+
+    size_t i = 0;
+    while (i < expression.size()) {
+        char c = expression[i];
+        if (std::isspace(static_cast<unsigned char>(c))) {
+            ++i;
+        } else if (std::isalpha(static_cast<unsigned char>(c)) || c == '_') {
+            size_t start = i;
+            while (i < expression.size() && (std::isalnum(static_cast<unsigned char>(expression[i])) || expression[i] == '_' || expression[i] == '.'))
+                ++i;
+            tokens.push_back({Token::Kind::Identifier, expression.substr(start, i - start)});
+        } else if (std::isdigit(static_cast<unsigned char>(c))) {
+            size_t start = i;
+            while (i < expression.size() && (std::isdigit(static_cast<unsigned char>(expression[i])) || expression[i] == '.'))
+                ++i;
+            tokens.push_back({Token::Kind::Number, expression.substr(start, i - start)});
+        } else if (c == '\'' || c == '"') {
+            size_t end = expression.find(c, i + 1);
+            if (end == std::string::npos)
+                return false;
+            tokens.push_back({Token::Kind::String, expression.substr(i + 1, end - i - 1)});
+            i = end + 1;
+        } else {
+            auto op = std::find_if(operators.begin(), operators.end(), [&](const std::string& op) {
+                return expression.compare(i, op.size(), op) == 0;
+            });
+            if (op == operators.end())
+                return false;
+            tokens.push_back({Token::Kind::Operator, *op});
+            i += op->size();
+        }
+    }
+    tokens.push_back({Token::Kind::End, ""});
+    return true;
+}
+
+// Parser is a recursive descent parser following the operator precedence of exprtk:
+// "||" < "&&" < "in" < comparisons < "+ -" < "* / %" < "!".
+class Parser {
+private:
+    std::vector<Token> m_tokens;
+    size_t m_pos = 0;
+    bool m_failed = false;
+
+    const Token& Peek() const {
+        return m_tokens[m_pos];
+    }
+
+    bool IsOperator(const std::string& op) const {
+        return Peek().kind == Token::Kind::Operator && Peek().text == op;
+    }
+
+    bool IsKeyword(const std::string& keyword) const {
+        return Peek().kind == Token::Kind::Identifier && Peek().text == keyword;
+    }
+
+    bool Expect(const std::string& op) {
+        if (!IsOperator(op)) {
+            m_failed = true;
+            return false;
+        }
+        ++m_pos;
+        return true;
+    }
+
+    std::shared_ptr<MatcherNode> ParseOr() {
+        auto node = ParseAnd();
+        if (!IsOperator("||") && !IsKeyword("or"))
+            return node;
+
+        auto or_node = std::make_shared<MatcherNode>(MatcherNode::Kind::Or);
+        or_node->children.push_back(node);
+        while (!m_failed && (IsOperator("||") || IsKeyword("or"))) {
+            ++m_pos;
+            or_node->children.push_back(ParseAnd());
+        }
+        return or_node;
+    }
+
+    std::shared_ptr<MatcherNode> ParseAnd() {
+        auto node = ParseIn();
+        if (!IsOperator("&&") && !IsKeyword("and"))
+            return node;
+
+        auto and_node = std::make_shared<MatcherNode>(MatcherNode::Kind::And);
+        and_node->children.push_back(node);
+        while (!m_failed && (IsOperator("&&") || IsKeyword("and"))) {
+            ++m_pos;
+            and_node->children.push_back(ParseIn());
+        }
+        return and_node;
+    }
+
+    std::shared_ptr<MatcherNode> ParseIn() {
+        auto node = ParseCompare();
+        if (!IsKeyword("in"))
+            return node;
+
+        ++m_pos;
+        auto in_node = std::make_shared<MatcherNode>(MatcherNode::Kind::In);
+        in_node->children.push_back(node);
+        if (!Expect("("))
+            return in_node;
+        auto list = std::make_shared<MatcherNode>(MatcherNode::Kind::List);
+        if (!IsOperator(")")) {
+            list->children.push_back(ParseCompare());
+            while (!m_failed && IsOperator(",")) {
+                ++m_pos;
+                list->children.push_back(ParseCompare());
+            }
+        }
+        Expect(")");
+        in_node->children.push_back(list);
+        return in_node;
+    }
+
+    std::shared_ptr<MatcherNode> ParseCompare() {
+        auto node = ParseAdditive();
+        for (const char* op : {"==", "!=", "<=", ">=", "<", ">"}) {
+            if (IsOperator(op)) {
+                ++m_pos;
+                auto compare = std::make_shared<MatcherNode>(MatcherNode::Kind::Compare, op);
+                compare->children = {node, ParseAdditive()};
+                return compare;
+            }
+        }
+        return node;
+    }
+
+    std::shared_ptr<MatcherNode> ParseAdditive() {
+        auto node = ParseMultiplicative();
+        while (!m_failed && (IsOperator("+") || IsOperator("-"))) {
+            auto arithmetic = std::make_shared<MatcherNode>(MatcherNode::Kind::Arithmetic, Peek().text);
+            ++m_pos;
+            arithmetic->children = {node, ParseMultiplicative()};
+            node = arithmetic;
+        }
+        return node;
+    }
+
+    std::shared_ptr<MatcherNode> ParseMultiplicative() {
+        auto node = ParseUnary();
+        while (!m_failed && (IsOperator("*") || IsOperator("/") || IsOperator("%"))) {
+            auto arithmetic = std::make_shared<MatcherNode>(MatcherNode::Kind::Arithmetic, Peek().text);
+            ++m_pos;
+            arithmetic->children = {node, ParseUnary()};
+            node = arithmetic;
+        }
+        return node;
+    }
+
+    std::shared_ptr<MatcherNode> ParseUnary() {
+        if (IsOperator("!") || IsKeyword("not")) {
+            ++m_pos;
+            auto not_node = std::make_shared<MatcherNode>(MatcherNode::Kind::Not);
+            not_node->children.push_back(ParseUnary());
+            return not_node;
+        }
+        return ParsePrimary();
+    }
+
+    std::shared_ptr<MatcherNode> ParsePrimary() {
+        const Token token = Peek();
+        switch (token.kind) {
+            case Token::Kind::String:
+                ++m_pos;
+                return std::make_shared<MatcherNode>(MatcherNode::Kind::String, token.text);
+            case Token::Kind::Number:
+                ++m_pos;
+                return std::make_shared<MatcherNode>(MatcherNode::Kind::Number, token.text);
+            case Token::Kind::Identifier: {
+                ++m_pos;
+                if (token.text == "in" || token.text == "and" || token.text == "or" || token.text == "not")
+                    break;
+                if (!IsOperator("("))
+                    return std::make_shared<MatcherNode>(MatcherNode::Kind::Identifier, token.text);
+
+                ++m_pos;
+                auto call = std::make_shared<MatcherNode>(MatcherNode::Kind::Call, token.text);
+                if (!IsOperator(")")) {
+                    call->children.push_back(ParseOr());
+                    while (!m_failed && IsOperator(",")) {
+                        ++m_pos;
+                        call->children.push_back(ParseOr());
+                    }
+                }
+                Expect(")");
+                return call;
+            }
+            case Token::Kind::Operator:
+                if (token.text == "(") {
+                    ++m_pos;
+                    auto node = ParseOr();
+                    Expect(")");
+                    return node;
+                }
+                break;
+            default:
+                break;
+        }
+        m_failed = true;
+        return std::make_shared<MatcherNode>(MatcherNode::Kind::Number, "0");
+    }
+
+public:
+    explicit Parser(std::vector<Token> tokens)
+        : m_tokens(std::move(tokens)) {
+    }
+
+    std::shared_ptr<MatcherNode> Parse() {
+        auto node = ParseOr();
+        if (m_failed || Peek().kind != Token::Kind::End)
+            return nullptr;
+        return node;
+    }
+};
+
+// Precedence returns the binding strength of the node, primaries bind the strongest.
+int Precedence(const MatcherNode& node) {
+    switch (node.kind) {
+        case MatcherNode::Kind::Or:
+            return 1;
+        case MatcherNode::Kind::And:
+            return 2;
+        case MatcherNode::Kind::In:
+            return 3;
+        case MatcherNode::Kind::Compare:
+            return 4;
+        case MatcherNode::Kind::Arithmetic:
+            return node.value == "+" || node.value == "-" ? 5 : 6;
+        case MatcherNode::Kind::Not:
+            return 7;
+        default:
+            return 8;
+    }
+}
+
+// PrintOperand prints a child, in parentheses when it binds weaker than min_precedence.
+std::string PrintOperand(const MatcherNode& node, int min_precedence) {
+    std::string out = PrintMatcher(node);
+    return Precedence(node) < min_precedence ? "(" + out + ")" : out;
+}
+
+std::string PrintJoined(const MatcherNode& node, const std::string& separator, int min_precedence) {
+    std::string out;
+    for (size_t i = 0; i < node.children.size(); ++i) {
+        if (i > 0)
+            out += separator;
+        out += PrintOperand(*node.children[i], min_precedence);
+    }
+    return out;
+}
+
+} // namespace
+
+MatcherNode::MatcherNode(Kind kind, const std::string& value)
+    : kind(kind), value(value) {
+}
+
+// IsRequestField returns true if the node is a request field like "r.sub".
+bool MatcherNode::IsRequestField() const {
+    return kind == Kind::Identifier && value.size() > 2 && value[0] == 'r' && value[1] == '.' && value.find('.', 2) == std::string::npos;
+}
+
+// IsPolicyField returns true if the node is a policy field like "p.sub".
+bool MatcherNode::IsPolicyField() const {
+    return kind == Kind::Identifier && value.size() > 2 && value[0] == 'p' && value[1] == '.' && value.find('.', 2) == std::string::npos;
+}
+
+// ParseMatcher parses a matcher expression, nullptr when the syntax is not understood.
+std::shared_ptr<MatcherNode> ParseMatcher(const std::string& expression) {
+    std::vector<Token> tokens;
+    if (!Tokenize(expression, tokens))
+        return nullptr;
+    return Parser(std::move(tokens)).Parse();
+}
+
+namespace {
+
+// RenameFields renames the fields of the sections r_type and p_type to those of "r" and "p".
+void RenameFields(MatcherNode& node, const std::string& r_type, const std::string& p_type) {
+    if (node.kind == MatcherNode::Kind::Identifier) {
+        if (r_type != "r" && node.value.compare(0, r_type.size() + 1, r_type + ".") == 0)
+            node.value = "r" + node.value.substr(r_type.size());
+        else if (p_type != "p" && node.value.compare(0, p_type.size() + 1, p_type + ".") == 0)
+            node.value = "p" + node.value.substr(p_type.size());
+    }
+    for (const auto& child : node.children)
+        RenameFields(*child, r_type, p_type);
+}
+
+} // namespace
+
+// ParseMatcher parses a matcher reading the sections r_type and p_type, with their fields
+// named as those of "r" and "p".
+std::shared_ptr<MatcherNode> ParseMatcher(const std::string& expression, const std::string& r_type, const std::string& p_type) {
+    std::shared_ptr<MatcherNode> root = ParseMatcher(expression);
+    if (root != nullptr)
+        RenameFields(*root, r_type, p_type);
+    return root;
+}
+
+// PrintMatcher formats a syntax tree back into an expression the evaluator accepts.
+std::string PrintMatcher(const MatcherNode& node) {
+    int precedence = Precedence(node);
+    switch (node.kind) {
+        case MatcherNode::Kind::Or:
+            // "&&" inside "||" is parenthesized for readability only
+            return PrintJoined(node, " || ", precedence + 2);
+        case MatcherNode::Kind::And:
+            return PrintJoined(node, " && ", precedence + 1);
+        case MatcherNode::Kind::Not:
+            return "!" + PrintOperand(*node.children[0], precedence + 1);
+        case MatcherNode::Kind::Compare:
+        case MatcherNode::Kind::In:
+            return PrintOperand(*node.children[0], precedence + 1) + " " + (node.kind == MatcherNode::Kind::In ? "in" : node.value) + " " +
+                   PrintOperand(*node.children[1], precedence + 1);
+        case MatcherNode::Kind::Arithmetic:
+            return PrintOperand(*node.children[0], precedence) + " " + node.value + " " + PrintOperand(*node.children[1], precedence + 1);
+        case MatcherNode::Kind::List:
+            return "(" + PrintJoined(node, ", ", 0) + ")";
+        case MatcherNode::Kind::Call:
+            return node.value + "(" + PrintJoined(node, ", ", 0) + ")";
+        case MatcherNode::Kind::String:
+            return "'" + node.value + "'";
+        default:
+            return node.value;
+    }
+}
+
+// GetConjuncts returns the operands of the top-level "&&" of the expression.
+std::vector<std::shared_ptr<MatcherNode>> GetConjuncts(const std::shared_ptr<MatcherNode>& node) {
+    if (node == nullptr)
+        return {};
+    if (node->kind == MatcherNode::Kind::And)
+        return node->children;
+    return {node};
+}
+
+} // namespace casbin
+
+#endif // MATCHER_CPP
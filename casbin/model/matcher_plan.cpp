@@ -0,0 +1,297 @@
+/*
+ * Copyright 2021 The casbin Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "casbin/pch.h"
+
+#ifndef MATCHER_PLAN_CPP
+#define MATCHER_PLAN_CPP
+
+#include <algorithm>
+#include <chrono>
+#include <numeric>
+
+#include "casbin/model/matcher_plan.h"
+#include "casbin/util/util.h"
+
+namespace casbin {
+
+namespace {
+
+// The estimated costs of the operations, relative to comparing two strings
+constexpr double kCompareCost = 1;
+constexpr double kRoleCheckCost = 4;
+constexpr double kKeyMatchCost = 16;
+constexpr double kRegexMatchCost = 64;
+
+// FunctionCost returns the estimated cost of a built-in function, false for functions
+// which may have side effects, like keyGet, or that the plan does not know.
+bool FunctionCost(const std::string& name, double& cost) {
+    static const std::unordered_set<std::string> key_matches = {"keyMatch", "keyMatch2", "keyMatch3", "keyMatch4", "ipMatch"};
+    if (key_matches.count(name) != 0) {
+        cost = kKeyMatchCost;
+        return true;
+    }
+    if (name == "regexMatch") {
+        cost = kRegexMatchCost;
+        return true;
+    }
+    return false;
+}
+
+// SortRuns stably sorts the runs of consecutive pure operands by the key, the other
+// operands keep their place.
+template <typename Key>
+void SortRuns(std::vector<size_t>& order, const std::vector<bool>& pure, Key key) {
+    size_t begin = 0;
+    while (begin < order.size()) {
+        if (!pure[order[begin]]) {
+            ++begin;
+            continue;
+        }
+        size_t end = begin;
+        while (end < order.size() && pure[order[end]])
+            ++end;
+        std::stable_sort(order.begin() + begin, order.begin() + end, [&](size_t a, size_t b) {
+            return key(a) < key(b);
+        });
+        begin = end;
+    }
+}
+
+// CollectFields adds the request and policy fields read by the node, as "r.sub" -> ("r", "sub").
+void CollectFields(const MatcherNode& node, std::vector<std::pair<std::string, std::string>>& fields) {
+    if (node.kind == MatcherNode::Kind::Identifier) {
+        size_t dot = node.value.find('.');
+        if (dot == std::string::npos)
+            return;
+        std::pair<std::string, std::string> field(node.value.substr(0, dot), node.value.substr(dot + 1));
+        if (std::find(fields.begin(), fields.end(), field) == fields.end())
+            fields.push_back(std::move(field));
+        return;
+    }
+    for (const auto& child : node.children)
+        CollectFields(*child, fields);
+}
+
+} // namespace
+
+double MatcherPlan::Order(MatcherNode& node, bool& pure) const {
+    switch (node.kind) {
+        case MatcherNode::Kind::Identifier:
+        case MatcherNode::Kind::String:
+        case MatcherNode::Kind::Number:
+            return 0;
+        case MatcherNode::Kind::And:
+        case MatcherNode::Kind::Or: {
+            std::vector<double> costs;
+            std::vector<bool> pure_children;
+            for (const auto& child : node.children) {
+                bool child_pure = true;
+                costs.push_back(this->Order(*child, child_pure));
+                pure_children.push_back(child_pure);
+                pure = pure && child_pure;
+            }
+
+            std::vector<size_t> order(node.children.size());
+            std::iota(order.begin(), order.end(), 0);
+            SortRuns(order, pure_children, [&](size_t i) { return costs[i]; });
+            std::vector<std::shared_ptr<MatcherNode>> children;
+            for (size_t i : order)
+                children.push_back(node.children[i]);
+            node.children = std::move(children);
+            return std::accumulate(costs.begin(), costs.end(), 0.0);
+        }
+        case MatcherNode::Kind::Call: {
+            double cost;
+            if (m_g_keys.count(node.value) != 0)
+                cost = kRoleCheckCost;
+            else if (!FunctionCost(node.value, cost)) {
+                cost = kRegexMatchCost;
+                pure = false;
+            }
+            for (const auto& child : node.children)
+                cost += this->Order(*child, pure);
+            return cost;
+        }
+        default: {
+            double cost = kCompareCost;
+            for (const auto& child : node.children)
+                cost += this->Order(*child, pure);
+            return cost;
+        }
+    }
+}
+
+void MatcherPlan::Build(const std::shared_ptr<Model>& m, std::shared_ptr<const std::string> matcher) {
+    std::lock_guard<std::mutex> lock(m_sample_mutex);
+    m_applicable = false;
+    m_sampling = false;
+    m_root = nullptr;
+    m_operands.clear();
+    m_g_keys.clear();
+    m_window = 0;
+
+    if (matcher == nullptr) {
+        if (!m->HasSection("m") || m->m["m"].assertion_map.count("m") == 0)
+            return;
+        matcher = std::make_shared<const std::string>(m->m["m"].assertion_map["m"]->value);
+    }
+    if (HasEval(*matcher))
+        return;
+    m_root = ParseMatcher(*matcher);
+    if (m_root == nullptr)
+        return;
+
+    if (m->HasSection("g"))
+        for (const auto& [key, _] : m->m["g"].assertion_map)
+            m_g_keys.insert(key);
+
+    bool pure = true;
+    this->Order(*m_root, pure);
+    std::atomic_store(&m_expression, std::make_shared<const std::string>(PrintMatcher(*m_root)));
+    m_applicable = true;
+
+    if (m_root->kind != MatcherNode::Kind::And && m_root->kind != MatcherNode::Kind::Or)
+        return;
+    m_conjunction = m_root->kind == MatcherNode::Kind::And;
+    size_t pure_operands = 0;
+    for (const auto& child : m_root->children) {
+        Operand operand;
+        operand.node = child;
+        operand.expression = PrintMatcher(*child);
+        CollectFields(*child, operand.fields);
+        this->Order(*child, operand.pure);
+        operand.evaluator = IEvaluator::NewEvaluator();
+        operand.evaluator->SetShortCircuit(true);
+        pure_operands += operand.pure ? 1 : 0;
+        m_operands.push_back(std::move(operand));
+    }
+    m_sampling = pure_operands > 1;
+}
+
+bool MatcherPlan::IsApplicable() const {
+    return m_applicable;
+}
+
+std::shared_ptr<const std::string> MatcherPlan::GetExpression() const {
+    return std::atomic_load(&m_expression);
+}
+
+bool MatcherPlan::ShouldSample() {
+    return m_sampling.load(std::memory_order_relaxed) && m_evaluations.fetch_add(1, std::memory_order_relaxed) % kSampleInterval == 0;
+}
+
+void MatcherPlan::Sample(IEvaluator& evaluator, const std::function<void(const std::shared_ptr<IEvaluator>&)>& load_functions) {
+    // a sample taken by another thread is as good as this one
+    std::unique_lock<std::mutex> lock(m_sample_mutex, std::try_to_lock);
+    if (!lock.owns_lock() || !m_sampling)
+        return;
+
+    try {
+        for (const Operand& operand : m_operands) {
+            for (const auto& [target, property] : operand.fields) {
+                // e.g. a field of a JSON request value
+                const std::string* value = evaluator.GetObjectString(target, property);
+                if (value == nullptr)
+                    return;
+            }
+        }
+
+        for (Operand& operand : m_operands) {
+            // the time of an operand includes binding the rule, which the scan pays for too, and
+            // not compiling it, which happens once
+            auto start = std::chrono::steady_clock::now();
+            for (const auto& [target, property] : operand.fields)
+                operand.evaluator->PushObjectString(target, property, *evaluator.GetObjectString(target, property));
+            auto bound = std::chrono::steady_clock::now();
+            load_functions(operand.evaluator);
+            if (!operand.evaluator->Eval(operand.expression)) {
+                m_sampling = false;
+                return;
+            }
+            auto compiled = std::chrono::steady_clock::now();
+            bool held = operand.evaluator->GetBoolean();
+            auto end = std::chrono::steady_clock::now();
+            operand.nanos += double(std::chrono::duration_cast<std::chrono::nanoseconds>((bound - start) + (end - compiled)).count());
+            operand.held += held ? 1 : 0;
+            operand.samples += 1;
+        }
+    } catch (...) {
+        // an operand failing alone, e.g. on an invalid pattern, is not sampled any more
+        m_sampling = false;
+        return;
+    }
+
+    if (++m_window >= kSampleWindow) {
+        m_window = 0;
+        this->Replan();
+    }
+}
+
+// Replan orders the operands by their mean time over their chance to decide the "&&" or
+// "||", which minimizes the expected time of independent operands.
+void MatcherPlan::Replan() {
+    std::vector<double> costs;
+    std::vector<double> passes;
+    std::vector<bool> pure;
+    for (const Operand& operand : m_operands) {
+        costs.push_back(operand.nanos / operand.samples);
+        passes.push_back(operand.held / operand.samples);
+        pure.push_back(operand.pure);
+    }
+
+    auto expected_cost = [&](const std::vector<size_t>& order) {
+        double cost = 0;
+        double reached = 1;
+        for (size_t i : order) {
+            cost += reached * costs[i];
+            reached *= m_conjunction ? passes[i] : 1 - passes[i];
+        }
+        return cost;
+    };
+
+    std::vector<size_t> current(m_operands.size());
+    std::iota(current.begin(), current.end(), 0);
+    std::vector<size_t> order = current;
+    SortRuns(order, pure, [&](size_t i) {
+        double decides = m_conjunction ? 1 - passes[i] : passes[i];
+        return costs[i] / std::max(decides, 1e-3);
+    });
+
+    // the statistics decay, so that the order follows a change of the traffic
+    for (Operand& operand : m_operands) {
+        operand.samples /= 2;
+        operand.held /= 2;
+        operand.nanos /= 2;
+    }
+
+    // a small gain is not worth compiling the matcher again
+    if (order == current || expected_cost(order) > 0.9 * expected_cost(current))
+        return;
+
+    std::vector<Operand> operands;
+    for (size_t i : order)
+        operands.push_back(std::move(m_operands[i]));
+    m_operands = std::move(operands);
+    m_root->children.clear();
+    for (const Operand& operand : m_operands)
+        m_root->children.push_back(operand.node);
+    std::atomic_store(&m_expression, std::make_shared<const std::string>(PrintMatcher(*m_root)));
+}
+
+} // namespace casbin
+
+#endif // MATCHER_PLAN_CPP
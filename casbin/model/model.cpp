@@ -19,18 +19,73 @@
 #ifndef MODEL_CPP
 #define MODEL_CPP
 
+#include <algorithm>
 #include <sstream>
 #include <regex>
 
 #include "casbin/config/config.h"
 #include "casbin/exception/missing_required_sections.h"
 #include "casbin/model/model.h"
+#include "casbin/rbac/default_role_manager.h"
 #include "casbin/util/util.h"
 
 namespace {
 
 std::vector<std::string> sections_names_reading_order = { "m", "r", "p", "g", "e" };
 
+// Rules are equal when they hold the same values in any order, like ArrayEquals, but
+// compared without copying them.
+bool IsSameRule(const std::vector<std::string>& a, const std::vector<std::string>& b) {
+    return a.size() == b.size() && std::is_permutation(a.begin(), a.end(), b.begin());
+}
+
+// RuleRefHash hashes a rule independently of the order of its values, consistently with
+// IsSameRule. Mixed values are summed so that repeated values do not cancel out.
+struct RuleRefHash {
+    size_t operator()(const std::vector<std::string>* rule) const {
+        uint64_t hash = rule->size();
+        for (const std::string& value : *rule) {
+            uint64_t x = std::hash<std::string>{}(value) + 0x9e3779b97f4a7c15ULL;
+            x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+            hash += x ^ (x >> 31);
+        }
+        return size_t(hash);
+    }
+};
+
+struct RuleRefEqual {
+    bool operator()(const std::vector<std::string>* a, const std::vector<std::string>* b) const {
+        return IsSameRule(*a, *b);
+    }
+};
+
+// RuleRefSet looks rules up by reference, so a policy is indexed without copying it.
+typedef std::unordered_set<const std::vector<std::string>*, RuleRefHash, RuleRefEqual> RuleRefSet;
+
+RuleRefSet IndexRules(const PoliciesValues& policy, size_t capacity) {
+    RuleRefSet rules;
+    rules.reserve(capacity);
+    for (const std::vector<std::string>& rule : policy)
+        rules.insert(&rule);
+    return rules;
+}
+
+// CopyAssertion copies a "p" or "g" assertion into the resource, with or without its policy.
+std::shared_ptr<casbin::Assertion> CopyAssertion(const casbin::Assertion& assertion, std::pmr::memory_resource* resource, bool with_policy) {
+    auto copy = std::make_shared<casbin::Assertion>(resource);
+    copy->key = assertion.key;
+    copy->value = assertion.value;
+    copy->SetTokens(assertion.tokens);
+    copy->rm = assertion.rm;
+    if (assertion.policy.is_hash())
+        copy->policy = PoliciesValues::createWithHashset({}, resource);
+    // a copy assignment keeps the resource of the collection assigned to
+    if (with_policy)
+        copy->policy = assertion.policy;
+    return copy;
+}
+
 };
 
 namespace casbin {
@@ -111,25 +166,26 @@ bool Model::AddDef(const std::string& sec, const std::string& key, const std::st
     if (value == "")
         return false;
 
-    std::shared_ptr<Assertion> ast = std::make_shared<Assertion>();
+    std::shared_ptr<Assertion> ast = std::make_shared<Assertion>(m_resource);
     ast->key = key;
     ast->value = value;
     if (sec == "r" || sec == "p") {
-        ast->tokens = Split(ast->value, ",");
-        for (std::string& token : ast->tokens)
+        std::vector<std::string> tokens = Split(ast->value, ",");
+        for (std::string& token : tokens)
             token = key + "_" + Trim(token);
+        ast->SetTokens(std::move(tokens));
     } else
         ast->value = RemoveComments(ast->value);
     if (m.find(sec) == m.end())
         m[sec] = AssertionMap();
     if (sec != "p") {
-        ast->policy = IsHashsetUsagePossible(*this) ? PoliciesValues::createWithHashset() : PoliciesValues::createWithVector();
+        ast->policy = IsHashsetUsagePossible(*this) ? PoliciesValues::createWithHashset({}, m_resource) : PoliciesValues::createWithVector({}, m_resource);
     } else {
         // base model detection expects "m" and "r" to be set
         if ( sec != "m" && sec != "r" && (m.find("m") == m.end() || m.find("r") == m.end())) {
             return false;
         }
-        ast->policy = IsHashsetUsagePossible(*this) ? PoliciesValues::createWithHashset() : PoliciesValues::createWithVector();
+        ast->policy = IsHashsetUsagePossible(*this) ? PoliciesValues::createWithHashset({}, m_resource) : PoliciesValues::createWithVector({}, m_resource);
     }
 
     m[sec].assertion_map[key] = ast;
@@ -173,6 +229,55 @@ Model::Model(const std::string& path) {
     LoadModel(path);
 }
 
+Model::Model(std::pmr::memory_resource* resource)
+    : m_resource(resource) {
+}
+
+std::pmr::memory_resource* Model::GetMemoryResource() const {
+    return m_resource;
+}
+
+size_t MemoryUsage::Total() const {
+    size_t total = role_graph;
+    for (const auto& [_, bytes] : assertions)
+        total += bytes;
+    return total;
+}
+
+// GetMemoryUsage returns the bytes held by the policy of each assertion and by the role
+// graphs, a role manager shared by several assertions is counted once.
+MemoryUsage Model::GetMemoryUsage() {
+    MemoryUsage usage;
+    std::vector<DefaultRoleManager*> role_managers;
+    for (const std::string sec : {"p", "g"}) {
+        if (m.find(sec) == m.end())
+            continue;
+        for (const auto& [key, assertion] : m[sec].assertion_map) {
+            usage.assertions[key] = assertion->GetMemoryUsage();
+            auto rm = dynamic_cast<DefaultRoleManager*>(assertion->rm.get());
+            if (rm != nullptr && std::find(role_managers.begin(), role_managers.end(), rm) == role_managers.end())
+                role_managers.push_back(rm);
+        }
+    }
+    for (DefaultRoleManager* rm : role_managers)
+        usage.role_graph += rm->GetMemoryUsage();
+    return usage;
+}
+
+void Model::InternPolicy() {
+    if (m_resource == std::pmr::get_default_resource())
+        return;
+    for (const std::string sec : {"p", "g"}) {
+        if (m.find(sec) == m.end())
+            continue;
+        for (auto& [_, assertion] : m[sec].assertion_map) {
+            PoliciesValues& policy = assertion->policy;
+            if (m_shared.count(assertion.get()) == 0 && !policy.empty() && !policy.is_hash() && !policy.is_mapped())
+                policy = PoliciesValues::createInterned(policy, m_resource);
+        }
+    }
+}
+
 // NewModel creates an empty model.
 std::shared_ptr<Model> Model::NewModel() {
     return std::make_shared<Model>();
@@ -192,6 +297,75 @@ std::shared_ptr<Model> Model::NewModelFromString(const std::string& text) {
     return m;
 }
 
+// NewModelSharingDefinition creates a model without policy that shares the request,
+// effect and matcher assertions of an existing model instead of parsing them again.
+std::shared_ptr<Model> Model::NewModelSharingDefinition(const std::shared_ptr<Model>& model) {
+    std::shared_ptr<Model> m = std::make_shared<Model>(model->m_resource);
+    for (const auto& [sec, assertion_map] : model->m) {
+        // Only "p" and "g" hold per-model state (policy and role manager)
+        if (sec != "p" && sec != "g") {
+            m->m[sec] = assertion_map;
+            continue;
+        }
+
+        AssertionMap& own_map = m->m[sec];
+        for (const auto& [key, assertion] : assertion_map.assertion_map) {
+            std::shared_ptr<Assertion> ast = std::make_shared<Assertion>(m->m_resource);
+            ast->key = assertion->key;
+            ast->value = assertion->value;
+            ast->SetTokens(assertion->tokens);
+            ast->policy = assertion->policy.is_hash() ? PoliciesValues::createWithHashset({}, m->m_resource) : PoliciesValues::createWithVector({}, m->m_resource);
+            own_map.assertion_map[key] = ast;
+        }
+    }
+    return m;
+}
+
+// Fork shares every assertion: the request, effect and matcher ones are never changed, the
+// "p" and "g" ones are marked as shared in both models.
+std::shared_ptr<Model> Model::Fork() {
+    std::shared_ptr<Model> fork = std::make_shared<Model>(m_resource);
+    fork->m = m;
+    for (const std::string sec : {"p", "g"}) {
+        auto it = m.find(sec);
+        if (it == m.end())
+            continue;
+        for (const auto& [_, assertion] : it->second.assertion_map) {
+            m_shared.insert(assertion.get());
+            fork->m_shared.insert(assertion.get());
+        }
+    }
+    return fork;
+}
+
+bool Model::IsShared(const std::string& sec, const std::string& p_type) const {
+    auto sec_it = m.find(sec);
+    if (sec_it == m.end())
+        return false;
+    auto it = sec_it->second.assertion_map.find(p_type);
+    return it != sec_it->second.assertion_map.end() && m_shared.count(it->second.get()) != 0;
+}
+
+void Model::Unshare(const std::string& sec, const std::string& p_type) {
+    if (this->IsShared(sec, p_type))
+        this->ownAssertion(sec, p_type);
+}
+
+// ownAssertion copies a shared assertion into the memory resource of the model. Whichever
+// model changes a shared assertion copies it, the other one may still be reading it, and a
+// shared assertion is never changed again. The copy shares the rules of the shared one in
+// chunks, it copies the chunks it changes. The rules of a mapped policy are copied.
+const std::shared_ptr<Assertion>& Model::ownAssertion(const std::string& sec, const std::string& p_type) {
+    std::shared_ptr<Assertion>& assertion = m[sec].assertion_map[p_type];
+    if (m_shared.erase(assertion.get()) != 0) {
+        std::shared_ptr<Assertion> shared = assertion;
+        assertion = CopyAssertion(*shared, m_resource, false);
+        assertion->policy = PoliciesValues::createShared(shared->policy, shared, m_resource);
+    }
+    assertion->policy.detach(m_resource);
+    return assertion;
+}
+
 void Model::BuildIncrementalRoleLinks(std::shared_ptr<RoleManager>& rm, policy_op op, const std::string& sec, const std::string& p_type, const PoliciesValues& rules) {
     if (sec == "g")
         this->m[sec].assertion_map[p_type]->BuildIncrementalRoleLinks(rm, op, rules);
@@ -225,16 +399,14 @@ void Model::PrintPolicy() {
 
 // ClearPolicy clears all current policy.
 void Model::ClearPolicy() {
-    // Caching "p" assertion map by reference for the scope of this function
-    for (auto [_, assertion_ptr] : this->m["p"].assertion_map) {
-        if (assertion_ptr->policy.size() > 0)
-            assertion_ptr->policy.clear();
-    }
-
-    // Caching "g" assertion map by reference for the scope of this function
-    for (auto [_, assertion_ptr] : this->m["g"].assertion_map) {
-        if (assertion_ptr->policy.size() > 0)
-            assertion_ptr->policy.clear();
+    for (const std::string sec : {"p", "g"}) {
+        for (auto& [_, assertion_ptr] : this->m[sec].assertion_map) {
+            // a shared assertion is left to the fork, the model takes an empty one
+            if (m_shared.erase(assertion_ptr.get()) != 0)
+                assertion_ptr = CopyAssertion(*assertion_ptr, m_resource, false);
+            else if (assertion_ptr->policy.size() > 0)
+                assertion_ptr->policy.clear();
+        }
     }
 }
 
@@ -267,7 +439,7 @@ PoliciesValues Model::GetFilteredPolicy(const std::string& sec, const std::strin
 bool Model::HasPolicy(const std::string& sec, const std::string& p_type, const std::vector<std::string>& rule) {
     auto& policy = this->m[sec].assertion_map[p_type]->policy;
     for (const std::vector<std::string>& policy_it : policy)
-        if (ArrayEquals(rule, policy_it))
+        if (IsSameRule(rule, policy_it))
             return true;
 
     return false;
@@ -276,7 +448,7 @@ bool Model::HasPolicy(const std::string& sec, const std::string& p_type, const s
 // AddPolicy adds a policy rule to the model.
 bool Model::AddPolicy(const std::string& sec, const std::string& p_type, const std::vector<std::string>& rule) {
     if (!this->HasPolicy(sec, p_type, rule)) {
-        m[sec].assertion_map[p_type]->policy.emplace(rule);
+        this->ownAssertion(sec, p_type)->policy.emplace(rule);
         return true;
     }
 
@@ -285,19 +457,60 @@ bool Model::AddPolicy(const std::string& sec, const std::string& p_type, const s
 
 // AddPolicies adds policy rules to the model.
 bool Model::AddPolicies(const std::string& sec, const std::string& p_type, const PoliciesValues& rules) {
-    for (const std::vector<std::string>& rule : rules)
-        if (this->HasPolicy(sec, p_type, rule))
-            return false;
+    // a rejected add leaves a forked policy shared
+    const PoliciesValues& shared_policy = this->m[sec].assertion_map[p_type]->policy;
+
+    // one hashed pass over the policy instead of a scan per rule
+    if (rules.size() > 1) {
+        RuleRefSet existing = IndexRules(shared_policy, shared_policy.size());
+        for (const std::vector<std::string>& rule : rules)
+            if (existing.count(&rule) != 0)
+                return false;
+    } else {
+        for (const std::vector<std::string>& rule : rules)
+            if (this->HasPolicy(sec, p_type, rule))
+                return false;
+    }
 
+    auto& policy = this->ownAssertion(sec, p_type)->policy;
+    policy.reserve(policy.size() + rules.size());
     for (const std::vector<std::string>& rule : rules)
-        this->m[sec].assertion_map[p_type]->policy.emplace(rule);
+        policy.emplace(rule);
 
     return true;
 }
 
+// ImportPolicies moves the rules into the model, skipping those it already has and repeated
+// ones. The duplicates are found with one hashed pass over the policy and the rules, storage
+// is reserved once and the rules are appended in their order. It returns the number of rules
+// imported.
+size_t Model::ImportPolicies(const std::string& sec, const std::string& p_type, std::vector<std::vector<std::string>>&& rules) {
+    auto& policy = this->ownAssertion(sec, p_type)->policy;
+
+    std::vector<bool> imported(rules.size());
+    size_t count = 0;
+    {
+        RuleRefSet known = IndexRules(policy, policy.size() + rules.size());
+        for (size_t i = 0; i < rules.size(); i++) {
+            if (known.insert(&rules[i]).second) {
+                imported[i] = true;
+                ++count;
+            }
+        }
+    }
+
+    policy.reserve(policy.size() + count);
+    for (size_t i = 0; i < rules.size(); i++)
+        if (imported[i])
+            policy.emplace(std::move(rules[i]));
+    rules.clear();
+
+    return count;
+}
+
 bool Model::UpdatePolicy(const std::string& sec, const std::string& p_type, const std::vector<std::string>& oldRule, const std::vector<std::string>& newRule) {
     // Caching policy by reference for the scope of this function
-    auto& policy = m[sec].assertion_map[p_type]->policy;
+    auto& policy = this->ownAssertion(sec, p_type)->policy;
 
     // Status flags
     bool is_oldRule_deleted = false, is_newRule_added = false;
@@ -327,7 +540,7 @@ bool Model::UpdatePolicy(const std::string& sec, const std::string& p_type, cons
 
 bool Model::UpdatePolicies(const std::string& sec, const std::string& p_type, const PoliciesValues& oldRules, const PoliciesValues& newRules) {
     // Caching policy by reference for the scope of this function
-    auto& policy = this->m[sec].assertion_map[p_type]->policy;
+    auto& policy = this->ownAssertion(sec, p_type)->policy;
 
     // Deleting old rules
     bool is_oldRule_deleted;
@@ -362,7 +575,7 @@ bool Model::UpdatePolicies(const std::string& sec, const std::string& p_type, co
 // RemovePolicy removes a policy rule from the model.
 bool Model::RemovePolicy(const std::string& sec, const std::string& p_type, const std::vector<std::string>& rule) {
     // Caching policy by reference for the scope of this function
-    auto& policy = m[sec].assertion_map[p_type]->policy;
+    auto& policy = this->ownAssertion(sec, p_type)->policy;
     for (auto it = policy.begin(); it != policy.end(); ++it) {
         if (ArrayEquals(rule, *it)) {
             policy.erase(it);
@@ -373,9 +586,9 @@ bool Model::RemovePolicy(const std::string& sec, const std::string& p_type, cons
 }
 
 // RemovePolicies removes policy rules from the model.
-bool Model::RemovePolicies(const std::string& sec, const std::string& p_type, const PoliciesValues& rules) {
+bool Model::RemovePolicies(const std::string& sec, const std::string& p_type, const PoliciesValues& rules, PoliciesValues* removed_rules) {
     // Caching policy by reference for the scope of this function
-    auto& policy = this->m[sec].assertion_map[p_type]->policy;
+    auto& policy = this->ownAssertion(sec, p_type)->policy;
 
     bool is_equal;
     for (const std::vector<std::string>& rule : rules) {
@@ -390,8 +603,12 @@ bool Model::RemovePolicies(const std::string& sec, const std::string& p_type, co
 
     for (const std::vector<std::string>& rule : rules) {
         for (auto policy_it = policy.begin(); policy_it != policy.end(); ++policy_it) {
-            if (ArrayEquals(rule, *policy_it))
+            if (ArrayEquals(rule, *policy_it)) {
+                if (removed_rules != nullptr)
+                    removed_rules->emplace(rule);
                 policy.erase(policy_it);
+                break;
+            }
         }
     }
 
@@ -400,7 +617,7 @@ bool Model::RemovePolicies(const std::string& sec, const std::string& p_type, co
 
 // RemoveFilteredPolicy removes policy rules based on field filters from the model.
 std::pair<bool, PoliciesValues> Model::RemoveFilteredPolicy(const std::string& sec, const std::string& p_type, int field_index, const std::vector<std::string>& field_values) {
-    PoliciesValues& policy = m[sec].assertion_map[p_type]->policy;
+    PoliciesValues& policy = this->ownAssertion(sec, p_type)->policy;
     PoliciesValues tmp(policy.size());
     PoliciesValues effects(policy.size());
     bool res = false;
@@ -0,0 +1,461 @@
+
+/*
+ * Copyright 2020 The casbin Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "casbin/pch.h"
+
+#ifndef NATIVE_EVALUATOR_CPP
+#define NATIVE_EVALUATOR_CPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+#include "casbin/exception/casbin_enforcer_exception.h"
+#include "casbin/model/literal_set.h"
+#include "casbin/model/native_evaluator.h"
+#include "casbin/util/built_in_functions.h"
+
+namespace casbin {
+
+// Node is a compiled node of an expression. String nodes evaluate to a string, the others
+// to a number, booleans being 0 and 1.
+struct NativeEvaluator::Node {
+    enum class Op { Number, String, Identifier, Not, And, Or, Equal, NotEqual, Less, LessEqual, Greater, GreaterEqual, Add, Subtract, Multiply, Divide, Modulo, Concat, In, InSet, Call };
+
+    Op op;
+    bool is_string = false;
+    float number = 0;
+    std::string text;
+    // the value of an identifier, owned by the evaluator
+    const std::string* value = nullptr;
+    const Function* function = nullptr;
+    // the candidates of an "in" that are all string literals
+    std::shared_ptr<const LiteralSet> set;
+    std::vector<Node> children;
+};
+
+namespace {
+
+using Node = NativeEvaluator::Node;
+using Function = NativeEvaluator::Function;
+
+float EvaluateNumber(const Node& node);
+
+// EvaluateString returns the value of a string node, buffer holds it when it is computed.
+const std::string& EvaluateString(const Node& node, std::string& buffer) {
+    switch (node.op) {
+        case Node::Op::String:
+            return node.text;
+        case Node::Op::Identifier:
+            return *node.value;
+        case Node::Op::Concat: {
+            std::string left_buffer, right_buffer;
+            const std::string& left = EvaluateString(node.children[0], left_buffer);
+            const std::string& right = EvaluateString(node.children[1], right_buffer);
+            buffer = left + right;
+            return buffer;
+        }
+        default: {
+            std::string buffers[3];
+            const std::string& key1 = EvaluateString(node.children[0], buffers[0]);
+            const std::string& key2 = EvaluateString(node.children[1], buffers[1]);
+            if (node.function->kind == Function::Kind::Get)
+                buffer = node.function->get(key1, key2);
+            else
+                buffer = node.function->get_with_path(key1, key2, EvaluateString(node.children[2], buffers[2]));
+            return buffer;
+        }
+    }
+}
+
+// Equals compares the values of two nodes of the same type.
+bool Equals(const Node& left, const Node& right) {
+    if (!left.is_string)
+        return EvaluateNumber(left) == EvaluateNumber(right);
+    std::string left_buffer, right_buffer;
+    return EvaluateString(left, left_buffer) == EvaluateString(right, right_buffer);
+}
+
+// Compare returns the order of the values of two nodes of the same type.
+int Compare(const Node& left, const Node& right) {
+    if (!left.is_string) {
+        float l = EvaluateNumber(left), r = EvaluateNumber(right);
+        return l < r ? -1 : l > r ? 1 : 0;
+    }
+    std::string left_buffer, right_buffer;
+    return EvaluateString(left, left_buffer).compare(EvaluateString(right, right_buffer));
+}
+
+float CallNumber(const Node& node) {
+    std::string buffers[3];
+    const std::string& name1 = EvaluateString(node.children[0], buffers[0]);
+    const std::string& name2 = EvaluateString(node.children[1], buffers[1]);
+    const Function& function = *node.function;
+    if (function.kind == Function::Kind::Match)
+        return function.match(name1, name2);
+
+    if (function.rm == nullptr)
+        return name1 == name2;
+    std::vector<std::string> domains;
+    if (node.children.size() == 3)
+        domains.push_back(EvaluateString(node.children[2], buffers[2]));
+    return function.rm->HasLink(name1, name2, domains);
+}
+
+float EvaluateNumber(const Node& node) {
+    switch (node.op) {
+        case Node::Op::Number:
+            return node.number;
+        case Node::Op::Not:
+            return EvaluateNumber(node.children[0]) == 0;
+        case Node::Op::And:
+            for (const Node& child : node.children)
+                if (EvaluateNumber(child) == 0)
+                    return 0;
+            return 1;
+        case Node::Op::Or:
+            for (const Node& child : node.children)
+                if (EvaluateNumber(child) != 0)
+                    return 1;
+            return 0;
+        case Node::Op::Equal:
+            return Equals(node.children[0], node.children[1]);
+        case Node::Op::NotEqual:
+            return !Equals(node.children[0], node.children[1]);
+        case Node::Op::Less:
+            return Compare(node.children[0], node.children[1]) < 0;
+        case Node::Op::LessEqual:
+            return Compare(node.children[0], node.children[1]) <= 0;
+        case Node::Op::Greater:
+            return Compare(node.children[0], node.children[1]) > 0;
+        case Node::Op::GreaterEqual:
+            return Compare(node.children[0], node.children[1]) >= 0;
+        case Node::Op::Add:
+            return EvaluateNumber(node.children[0]) + EvaluateNumber(node.children[1]);
+        case Node::Op::Subtract:
+            return EvaluateNumber(node.children[0]) - EvaluateNumber(node.children[1]);
+        case Node::Op::Multiply:
+            return EvaluateNumber(node.children[0]) * EvaluateNumber(node.children[1]);
+        case Node::Op::Divide:
+            return EvaluateNumber(node.children[0]) / EvaluateNumber(node.children[1]);
+        case Node::Op::Modulo:
+            return std::fmod(EvaluateNumber(node.children[0]), EvaluateNumber(node.children[1]));
+        case Node::Op::InSet: {
+            std::string buffer;
+            return node.set->Contains(EvaluateString(node.children[0], buffer));
+        }
+        case Node::Op::In:
+            for (size_t i = 1; i < node.children.size(); i++)
+                if (Equals(node.children[0], node.children[i]))
+                    return 1;
+            return 0;
+        case Node::Op::Call:
+            return CallNumber(node);
+        default:
+            return 0;
+    }
+}
+
+Function MatchFunction(bool (*match)(const std::string&, const std::string&)) {
+    Function function{Function::Kind::Match, 2};
+    function.match = match;
+    return function;
+}
+
+} // namespace
+
+#ifdef CASBIN_LITE
+// NewEvaluator returns a native evaluator, the casbin_lite library is built without exprtk.
+std::shared_ptr<IEvaluator> IEvaluator::NewEvaluator() {
+    return std::make_shared<NativeEvaluator>();
+}
+#endif
+
+NativeEvaluator::NativeEvaluator() = default;
+
+NativeEvaluator::~NativeEvaluator() = default;
+
+// Compile compiles a node of the syntax tree, nullptr with m_error set when it does not.
+std::shared_ptr<NativeEvaluator::Node> NativeEvaluator::Compile(const MatcherNode& node) {
+    auto compiled = std::make_shared<Node>();
+    auto fail = [this](const std::string& error) {
+        if (m_error.empty())
+            m_error = error;
+        return nullptr;
+    };
+
+    for (const auto& child : node.children) {
+        auto compiled_child = this->Compile(*child);
+        if (compiled_child == nullptr)
+            return nullptr;
+        compiled->children.push_back(std::move(*compiled_child));
+    }
+    std::vector<Node>& children = compiled->children;
+    auto numeric_children = [&children] {
+        return std::none_of(children.begin(), children.end(), [](const Node& child) { return child.is_string; });
+    };
+
+    switch (node.kind) {
+        case MatcherNode::Kind::Number:
+            compiled->op = Node::Op::Number;
+            compiled->number = std::strtof(node.value.c_str(), nullptr);
+            break;
+        case MatcherNode::Kind::String:
+            compiled->op = Node::Op::String;
+            compiled->is_string = true;
+            compiled->text = node.value;
+            break;
+        case MatcherNode::Kind::Identifier: {
+            if (node.value == "true" || node.value == "false") {
+                compiled->op = Node::Op::Number;
+                compiled->number = node.value == "true" ? 1 : 0;
+                break;
+            }
+            auto it = m_identifiers.find(node.value);
+            if (it == m_identifiers.end())
+                return fail("undefined symbol: " + node.value);
+            compiled->op = Node::Op::Identifier;
+            compiled->is_string = true;
+            compiled->value = it->second.get();
+            break;
+        }
+        case MatcherNode::Kind::Not:
+        case MatcherNode::Kind::And:
+        case MatcherNode::Kind::Or:
+            if (!numeric_children())
+                return fail("a string operand of a logical operator");
+            compiled->op = node.kind == MatcherNode::Kind::Not ? Node::Op::Not : node.kind == MatcherNode::Kind::And ? Node::Op::And : Node::Op::Or;
+            break;
+        case MatcherNode::Kind::Compare: {
+            if (children[0].is_string != children[1].is_string)
+                return fail("a string compared to a number: " + PrintMatcher(node));
+            static const std::unordered_map<std::string, Node::Op> compare_ops = {
+                {"==", Node::Op::Equal}, {"!=", Node::Op::NotEqual}, {"<", Node::Op::Less},
+                {"<=", Node::Op::LessEqual}, {">", Node::Op::Greater}, {">=", Node::Op::GreaterEqual}};
+            compiled->op = compare_ops.at(node.value);
+            break;
+        }
+        case MatcherNode::Kind::Arithmetic: {
+            if (children[0].is_string || children[1].is_string) {
+                if (node.value != "+" || !children[0].is_string || !children[1].is_string)
+                    return fail("an invalid string operation: " + PrintMatcher(node));
+                compiled->op = Node::Op::Concat;
+                compiled->is_string = true;
+                break;
+            }
+            static const std::unordered_map<std::string, Node::Op> arithmetic_ops = {
+                {"+", Node::Op::Add}, {"-", Node::Op::Subtract}, {"*", Node::Op::Multiply}, {"/", Node::Op::Divide}, {"%", Node::Op::Modulo}};
+            compiled->op = arithmetic_ops.at(node.value);
+            break;
+        }
+        case MatcherNode::Kind::In: {
+            std::vector<Node> list = std::move(children[1].children);
+            children.pop_back();
+            bool literals = children[0].is_string && std::all_of(list.begin(), list.end(), [](const Node& candidate) {
+                return candidate.op == Node::Op::String;
+            });
+            if (literals) {
+                std::vector<std::string> values;
+                for (const Node& candidate : list)
+                    values.push_back(candidate.text);
+                compiled->op = Node::Op::InSet;
+                compiled->set = std::make_shared<const LiteralSet>(values);
+                break;
+            }
+
+            // the candidates follow the tested operand
+            for (Node& candidate : list) {
+                if (candidate.is_string != children[0].is_string)
+                    return fail("a string compared to a number: " + PrintMatcher(node));
+                children.push_back(std::move(candidate));
+            }
+            compiled->op = Node::Op::In;
+            break;
+        }
+        case MatcherNode::Kind::List:
+            // only "in" takes a list, it is compiled with it
+            compiled->op = Node::Op::Number;
+            return compiled;
+        case MatcherNode::Kind::Call: {
+            auto it = m_functions.find(node.value);
+            if (it == m_functions.end())
+                return fail("undefined function: " + node.value);
+            const Function& function = *it->second;
+            if (children.size() != function.arg_count || std::any_of(children.begin(), children.end(), [](const Node& child) { return !child.is_string; }))
+                return fail("invalid arguments of " + node.value);
+            compiled->op = Node::Op::Call;
+            compiled->is_string = function.kind == Function::Kind::Get || function.kind == Function::Kind::GetWithPath;
+            compiled->function = &function;
+            break;
+        }
+    }
+    return compiled;
+}
+
+bool NativeEvaluator::Eval(const std::string& expression) {
+    m_checked = false;
+    if (m_root != nullptr && expression == m_expression_string)
+        return true;
+
+    m_expression_string = expression;
+    m_error.clear();
+    auto parsed = ParseMatcher(expression);
+    if (parsed == nullptr) {
+        m_root = nullptr;
+        m_error = "cannot parse the expression: " + expression;
+        return false;
+    }
+    m_root = this->Compile(*parsed);
+    return m_root != nullptr;
+}
+
+void NativeEvaluator::InitialObject(const std::string& /*target*/) {
+}
+
+void NativeEvaluator::PushObjectString(const std::string& target, const std::string& proprity, const std::string& var) {
+    this->AddIdentifier(target + "." + proprity, var);
+}
+
+void NativeEvaluator::PushObjectJson(const std::string& /*target*/, const std::string& /*proprity*/, const nlohmann::json& /*var*/) {
+    // JSON values are not evaluated, as with exprtk
+}
+
+const std::string* NativeEvaluator::GetObjectString(const std::string& target, const std::string& proprity) {
+    auto it = m_identifiers.find(target + "." + proprity);
+    return it == m_identifiers.end() ? nullptr : it->second.get();
+}
+
+std::string* NativeEvaluator::GetObjectSlot(const std::string& target, const std::string& proprity) {
+    m_checked = false;
+    std::unique_ptr<std::string>& slot = m_identifiers[target + "." + proprity];
+    if (slot == nullptr)
+        slot = std::make_unique<std::string>();
+    return slot.get();
+}
+
+void NativeEvaluator::LoadFunctions() {
+    if (m_functions_loaded)
+        return;
+    m_functions_loaded = true;
+
+    AddFunction("keyMatch", MatchFunction(KeyMatch));
+    AddFunction("keyMatch2", MatchFunction(KeyMatch2));
+    AddFunction("keyMatch3", MatchFunction(KeyMatch3));
+    AddFunction("keyMatch4", MatchFunction(KeyMatch4));
+    AddFunction("regexMatch", MatchFunction(RegexMatch));
+    AddFunction("ipMatch", MatchFunction(IPMatch));
+
+    Function key_get{Function::Kind::Get, 2};
+    key_get.get = KeyGet;
+    AddFunction("keyGet", key_get);
+    Function key_get2{Function::Kind::GetWithPath, 3};
+    key_get2.get_with_path = KeyGet2;
+    AddFunction("keyGet2", key_get2);
+    Function key_get3{Function::Kind::GetWithPath, 3};
+    key_get3.get_with_path = KeyGet3;
+    AddFunction("keyGet3", key_get3);
+}
+
+void NativeEvaluator::LoadGFunction(std::shared_ptr<RoleManager> rm, const std::string& name, int narg) {
+    // a compiled expression calls the function it was compiled with, an evaluator shared
+    // between enforcers rebinds the role manager in place
+    if (auto it = m_functions.find(name); it != m_functions.end()) {
+        if (it->second->kind == Function::Kind::Role)
+            it->second->rm = rm;
+        return;
+    }
+
+    Function function{Function::Kind::Role, static_cast<size_t>(narg)};
+    function.rm = rm;
+    this->AddFunction(name, function);
+}
+
+void NativeEvaluator::ProcessFunctions(const std::string& /*expression*/) {
+}
+
+float NativeEvaluator::Evaluate() {
+    if (m_root == nullptr || m_root->is_string)
+        return 0;
+    return EvaluateNumber(*m_root);
+}
+
+Type NativeEvaluator::CheckType() {
+    if (m_root == nullptr)
+        throw CasbinEnforcerException(m_error);
+    if (m_root->is_string)
+        throw CasbinEnforcerException("the expression evaluates to a string: " + m_expression_string);
+    m_result = this->Evaluate();
+    m_checked = true;
+    return m_result == 0 || m_result == 1 ? Type::Bool : Type::Float;
+}
+
+bool NativeEvaluator::GetBoolean() {
+    return this->GetFloat() != 0;
+}
+
+float NativeEvaluator::GetFloat() {
+    if (m_checked) {
+        m_checked = false;
+        return m_result;
+    }
+    return this->Evaluate();
+}
+
+std::string NativeEvaluator::GetString() {
+    if (m_root == nullptr || !m_root->is_string)
+        return "";
+    std::string buffer;
+    return EvaluateString(*m_root, buffer);
+}
+
+void NativeEvaluator::Clean(AssertionMap& /*section*/, bool after_enforce) {
+    if (!after_enforce)
+        return;
+
+    m_root = nullptr;
+    m_expression_string.clear();
+    m_identifiers.clear();
+    m_functions.clear();
+    m_functions_loaded = false;
+    m_checked = false;
+}
+
+void NativeEvaluator::AddFunction(const std::string& name, const Function& function) {
+    if (m_functions.count(name) == 0)
+        m_functions[name] = std::make_unique<Function>(function);
+}
+
+void NativeEvaluator::AddIdentifier(const std::string& identifier, const std::string& var) {
+    m_checked = false;
+    std::unique_ptr<std::string>& slot = m_identifiers[identifier];
+    if (slot == nullptr)
+        slot = std::make_unique<std::string>(var);
+    else
+        *slot = var;
+}
+
+std::unordered_map<std::string, std::string> NativeEvaluator::requestValues() const {
+    std::unordered_map<std::string, std::string> result;
+    for (const auto& [identifier, value] : m_identifiers)
+        if (identifier.compare(0, 2, "r.") == 0)
+            result.emplace(identifier.substr(2), *value);
+    return result;
+}
+
+} // namespace casbin
+
+#endif // NATIVE_EVALUATOR_CPP
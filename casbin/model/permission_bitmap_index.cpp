@@ -0,0 +1,405 @@
+/*
+ * Copyright 2021 The casbin Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "casbin/pch.h"
+
+#ifndef PERMISSION_BITMAP_INDEX_CPP
+#define PERMISSION_BITMAP_INDEX_CPP
+
+#include "casbin/model/permission_bitmap_index.h"
+#include "casbin/model/matcher.h"
+#include "casbin/rbac/default_role_manager.h"
+
+namespace casbin {
+
+namespace {
+
+bool FindColumn(const std::vector<std::string>& p_tokens, const std::string& p_type, const MatcherNode& node, size_t& column) {
+    auto it = std::find(p_tokens.begin(), p_tokens.end(), p_type + "_" + node.value.substr(2));
+    if (it == p_tokens.end())
+        return false;
+    column = it - p_tokens.begin();
+    return true;
+}
+
+} // namespace
+
+std::vector<PermissionBitmap::Block>::iterator PermissionBitmap::Find(uint32_t key) {
+    return std::lower_bound(m_blocks.begin(), m_blocks.end(), key, [](const Block& block, uint32_t key) {
+        return block.key < key;
+    });
+}
+
+void PermissionBitmap::Set(uint32_t id) {
+    auto it = this->Find(id / 64);
+    if (it == m_blocks.end() || it->key != id / 64)
+        it = m_blocks.insert(it, {id / 64, 0});
+    it->bits |= uint64_t(1) << (id % 64);
+}
+
+void PermissionBitmap::Reset(uint32_t id) {
+    auto it = this->Find(id / 64);
+    if (it == m_blocks.end() || it->key != id / 64)
+        return;
+    it->bits &= ~(uint64_t(1) << (id % 64));
+    if (it->bits == 0)
+        m_blocks.erase(it);
+}
+
+bool PermissionBitmap::Test(uint32_t id) const {
+    auto it = std::lower_bound(m_blocks.begin(), m_blocks.end(), id / 64, [](const Block& block, uint32_t key) {
+        return block.key < key;
+    });
+    return it != m_blocks.end() && it->key == id / 64 && (it->bits >> (id % 64) & 1) != 0;
+}
+
+// Union adds every id of other to the bitmap.
+void PermissionBitmap::Union(const PermissionBitmap& other) {
+    std::vector<Block> blocks;
+    blocks.reserve(m_blocks.size() + other.m_blocks.size());
+    auto a = m_blocks.begin();
+    auto b = other.m_blocks.begin();
+    while (a != m_blocks.end() || b != other.m_blocks.end()) {
+        if (b == other.m_blocks.end() || (a != m_blocks.end() && a->key < b->key)) {
+            blocks.push_back(*a++);
+        } else if (a == m_blocks.end() || b->key < a->key) {
+            blocks.push_back(*b++);
+        } else {
+            blocks.push_back({a->key, a->bits | b->bits});
+            ++a;
+            ++b;
+        }
+    }
+    m_blocks = std::move(blocks);
+}
+
+bool PermissionBitmap::Empty() const {
+    return m_blocks.empty();
+}
+
+// Build analyses the definitions of the context and materializes the bitmaps of its current
+// policy.
+void PermissionBitmapIndex::Build(const std::shared_ptr<Model>& m, const EnforceContext& context) {
+    m_context = context;
+    m_applicable = false;
+    m_g_key.clear();
+    m_rm = nullptr;
+    m_eft_column = -1;
+    m_subject_token.clear();
+    m_permission_columns.clear();
+    m_permission_tokens.clear();
+    m_pattern_columns.clear();
+    m_permission_ids.clear();
+    m_grants.clear();
+    m_direct.clear();
+    m_pattern_rules = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_closures_mutex);
+        this->ClearClosures();
+    }
+
+    if (!m->HasSection("m") || !m->HasSection("p") || !m->HasSection("e") || m->m["m"].assertion_map.count(context.m_type) == 0 ||
+        m->m["p"].assertion_map.count(context.p_type) == 0 || m->m["e"].assertion_map.count(context.e_type) == 0)
+        return;
+    if (m->m["e"].assertion_map[context.e_type]->value != "some(where (p.eft == allow))")
+        return;
+    auto root = ParseMatcher(m->m["m"].assertion_map[context.m_type]->value, context.r_type, context.p_type);
+    if (root == nullptr)
+        return;
+
+    const std::vector<std::string>& p_tokens = m->m["p"].assertion_map[context.p_type]->tokens;
+    bool has_subject = false;
+    for (const auto& conjunct : GetConjuncts(root)) {
+        if (conjunct->children.size() != 2)
+            return;
+        const MatcherNode* r_field = conjunct->children[0].get();
+        const MatcherNode* p_field = conjunct->children[1].get();
+        size_t column;
+
+        if (conjunct->kind == MatcherNode::Kind::Call && m->HasSection("g") && m->m["g"].assertion_map.count(conjunct->value) != 0) {
+            auto default_rm = std::dynamic_pointer_cast<DefaultRoleManager>(m->m["g"].assertion_map[conjunct->value]->rm);
+            if (has_subject || default_rm == nullptr || default_rm->HasPattern())
+                return;
+            if (!r_field->IsRequestField() || !p_field->IsPolicyField() || !FindColumn(p_tokens, context.p_type, *p_field, column))
+                return;
+            has_subject = true;
+            m_g_key = conjunct->value;
+            m_rm = default_rm;
+            m_subject_column = column;
+            m_subject_token = r_field->value.substr(2);
+        } else if ((conjunct->kind == MatcherNode::Kind::Compare && conjunct->value == "==") ||
+                   (conjunct->kind == MatcherNode::Kind::Call && conjunct->value == "keyMatch")) {
+            bool is_pattern = conjunct->kind == MatcherNode::Kind::Call;
+            if (!is_pattern && !r_field->IsRequestField())
+                std::swap(r_field, p_field);
+            if (!r_field->IsRequestField() || !p_field->IsPolicyField() || !FindColumn(p_tokens, context.p_type, *p_field, column))
+                return;
+            m_permission_columns.push_back(column);
+            m_permission_tokens.push_back(r_field->value.substr(2));
+            m_pattern_columns.push_back(is_pattern);
+        } else {
+            return;
+        }
+    }
+
+    // without role definition the first plain equality selects the subject
+    if (!has_subject) {
+        auto it = std::find(m_pattern_columns.begin(), m_pattern_columns.end(), false);
+        if (it == m_pattern_columns.end())
+            return;
+        size_t i = it - m_pattern_columns.begin();
+        m_subject_column = m_permission_columns[i];
+        m_subject_token = m_permission_tokens[i];
+        m_permission_columns.erase(m_permission_columns.begin() + i);
+        m_permission_tokens.erase(m_permission_tokens.begin() + i);
+        m_pattern_columns.erase(m_pattern_columns.begin() + i);
+    }
+
+    auto eft = std::find(p_tokens.begin(), p_tokens.end(), context.p_type + "_eft");
+    if (eft != p_tokens.end())
+        m_eft_column = static_cast<int>(eft - p_tokens.begin());
+    m_column_count = p_tokens.size();
+    m_applicable = true;
+
+    for (const auto& rule : m->m["p"].assertion_map[context.p_type]->policy)
+        this->AddRule(rule);
+}
+
+bool PermissionBitmapIndex::IsPatternRule(const std::vector<std::string>& rule) const {
+    for (size_t i = 0; i < m_permission_columns.size(); ++i)
+        if (m_pattern_columns[i] && rule[m_permission_columns[i]].find('*') != std::string::npos)
+            return true;
+    return false;
+}
+
+std::string PermissionBitmapIndex::PermissionKey(const std::vector<const std::string*>& values) const {
+    std::string key;
+    for (const std::string* value : values) {
+        key += *value;
+        key += '\0';
+    }
+    return key;
+}
+
+void PermissionBitmapIndex::AddRule(const std::vector<std::string>& rule) {
+    // rules of the wrong size make the normal evaluation throw, deny rules never grant
+    if (rule.size() != m_column_count || (m_eft_column >= 0 && rule[m_eft_column] != "allow"))
+        return;
+    if (this->IsPatternRule(rule)) {
+        ++m_pattern_rules;
+        return;
+    }
+
+    std::vector<const std::string*> values;
+    for (size_t column : m_permission_columns)
+        values.push_back(&rule[column]);
+    auto [id_it, _] = m_permission_ids.emplace(this->PermissionKey(values), static_cast<uint32_t>(m_permission_ids.size()));
+    uint32_t id = id_it->second;
+
+    const std::string& subject = rule[m_subject_column];
+    Grant& grant = m_grants[subject][id];
+    if (grant.count++ > 0)
+        return;
+    grant.rule = rule;
+    m_direct[subject].Set(id);
+
+    std::lock_guard<std::mutex> lock(m_closures_mutex);
+    auto dependents_it = m_dependents.find(subject);
+    if (dependents_it == m_dependents.end())
+        return;
+    for (const std::string& dependent : dependents_it->second)
+        m_closures.at(dependent).permissions.Set(id);
+}
+
+void PermissionBitmapIndex::RemoveRule(const std::vector<std::string>& rule) {
+    if (rule.size() != m_column_count || (m_eft_column >= 0 && rule[m_eft_column] != "allow"))
+        return;
+    if (this->IsPatternRule(rule)) {
+        if (m_pattern_rules > 0)
+            --m_pattern_rules;
+        return;
+    }
+
+    std::vector<const std::string*> values;
+    for (size_t column : m_permission_columns)
+        values.push_back(&rule[column]);
+    auto id_it = m_permission_ids.find(this->PermissionKey(values));
+    const std::string& subject = rule[m_subject_column];
+    auto grants_it = m_grants.find(subject);
+    if (id_it == m_permission_ids.end() || grants_it == m_grants.end())
+        return;
+    auto grant_it = grants_it->second.find(id_it->second);
+    if (grant_it == grants_it->second.end() || --grant_it->second.count > 0)
+        return;
+    grants_it->second.erase(grant_it);
+    m_direct[subject].Reset(id_it->second);
+
+    // another subject of a closure may still grant the permission, so recompute those
+    std::lock_guard<std::mutex> lock(m_closures_mutex);
+    this->EraseClosures(subject);
+}
+
+void PermissionBitmapIndex::EraseClosures(const std::string& subject) {
+    auto dependents_it = m_dependents.find(subject);
+    if (dependents_it == m_dependents.end())
+        return;
+    std::unordered_set<std::string> dependents = std::move(dependents_it->second);
+    m_dependents.erase(dependents_it);
+    for (const std::string& dependent : dependents) {
+        auto closure_it = m_closures.find(dependent);
+        for (const std::string& name : closure_it->second.subjects) {
+            auto it = m_dependents.find(name);
+            if (it == m_dependents.end())
+                continue;
+            it->second.erase(dependent);
+            if (it->second.empty())
+                m_dependents.erase(it);
+        }
+        m_closures.erase(closure_it);
+    }
+}
+
+void PermissionBitmapIndex::ClearClosures() const {
+    m_closures.clear();
+    m_dependents.clear();
+}
+
+// SetRoleManager moves the index onto a copy of the role graph with the same links.
+void PermissionBitmapIndex::SetRoleManager(const std::shared_ptr<RoleManager>& from, const std::shared_ptr<RoleManager>& to) {
+    if (m_rm != nullptr && m_rm == from)
+        m_rm = std::dynamic_pointer_cast<DefaultRoleManager>(to);
+}
+
+// Update applies a policy change made after Build.
+void PermissionBitmapIndex::Update(policy_op op, const std::string& sec, const std::string& p_type, const PoliciesValues& rules) {
+    if (!m_applicable)
+        return;
+    if (sec == "p" && p_type == m_context.p_type) {
+        for (const auto& rule : rules) {
+            if (op == policy_add)
+                this->AddRule(rule);
+            else
+                this->RemoveRule(rule);
+        }
+    } else if (sec == "g" && p_type == m_g_key) {
+        // a link changes the closures including its member
+        std::lock_guard<std::mutex> lock(m_closures_mutex);
+        for (const auto& rule : rules) {
+            if (rule.empty())
+                this->ClearClosures();
+            else
+                this->EraseClosures(rule[0]);
+        }
+    }
+}
+
+// IsApplicable returns true if the model has the shape the index can decide.
+bool PermissionBitmapIndex::IsApplicable() const {
+    return m_applicable;
+}
+
+// GetClosure returns the subjects the subject inherits from, itself included, and the
+// union of their permissions. The caller must hold m_closures_mutex.
+const PermissionBitmapIndex::Closure& PermissionBitmapIndex::GetClosure(const std::string& subject) const {
+    auto it = m_closures.find(subject);
+    if (it != m_closures.end())
+        return it->second;
+    if (m_closures.size() >= DefaultRoleManager::kMaxCachedClosures)
+        this->ClearClosures();
+
+    Closure closure;
+    closure.subjects.push_back(subject);
+    std::vector<std::string> roles;
+    if (m_rm != nullptr && m_rm->GetInheritedRoles(subject, {}, roles)) {
+        for (std::string& role : roles)
+            if (role != subject)
+                closure.subjects.push_back(std::move(role));
+    }
+    for (const std::string& name : closure.subjects) {
+        auto direct_it = m_direct.find(name);
+        if (direct_it != m_direct.end())
+            closure.permissions.Union(direct_it->second);
+    }
+    for (const std::string& name : closure.subjects)
+        m_dependents[name].insert(subject);
+    return m_closures.emplace(subject, std::move(closure)).first->second;
+}
+
+// Prepare computes the role closures of the subjects of the policy ahead of requests: the
+// members of the role definition and the subjects granted permissions directly, as far as
+// the closure cache holds them.
+void PermissionBitmapIndex::Prepare(const std::shared_ptr<Model>& m) const {
+    if (!m_applicable)
+        return;
+
+    std::lock_guard<std::mutex> lock(m_closures_mutex);
+    if (!m_g_key.empty() && m->HasSection("g") && m->m["g"].assertion_map.count(m_g_key) != 0) {
+        for (const auto& rule : m->m["g"].assertion_map[m_g_key]->policy) {
+            if (m_closures.size() >= DefaultRoleManager::kMaxCachedClosures)
+                return;
+            if (!rule.empty())
+                this->GetClosure(rule[0]);
+        }
+    }
+    for (const auto& [subject, _] : m_direct) {
+        if (m_closures.size() >= DefaultRoleManager::kMaxCachedClosures)
+            return;
+        this->GetClosure(subject);
+    }
+}
+
+// Decide sets allowed to the decision for the request pushed into the evaluator, and
+// explains to the granting rule. It returns false when the normal evaluation must decide.
+bool PermissionBitmapIndex::Decide(IEvaluator& evaluator, bool& allowed, std::vector<std::string>& explains) const {
+    const std::string* subject = evaluator.GetObjectString(m_context.r_type, m_subject_token);
+    if (subject == nullptr)
+        return false;
+    std::vector<const std::string*> values;
+    for (const std::string& token : m_permission_tokens) {
+        values.push_back(evaluator.GetObjectString(m_context.r_type, token));
+        if (values.back() == nullptr)
+            return false;
+    }
+
+    auto id_it = m_permission_ids.find(this->PermissionKey(values));
+    if (id_it != m_permission_ids.end()) {
+        std::lock_guard<std::mutex> lock(m_closures_mutex);
+        const Closure& closure = this->GetClosure(*subject);
+        if (closure.permissions.Test(id_it->second)) {
+            for (const std::string& name : closure.subjects) {
+                auto grants_it = m_grants.find(name);
+                if (grants_it == m_grants.end())
+                    continue;
+                auto grant_it = grants_it->second.find(id_it->second);
+                if (grant_it != grants_it->second.end()) {
+                    explains = grant_it->second.rule;
+                    break;
+                }
+            }
+            allowed = true;
+            return true;
+        }
+    }
+
+    if (m_pattern_rules > 0)
+        return false;
+    allowed = false;
+    return true;
+}
+
+} // namespace casbin
+
+#endif // PERMISSION_BITMAP_INDEX_CPP
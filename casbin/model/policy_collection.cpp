@@ -14,14 +14,24 @@
  * limitations under the License.
  */
 
+#include <atomic>
+#include <limits>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_map>
+
 #include "casbin/model/policy_collection.hpp"
 
+uint64_t PoliciesValues::Generation::Next() noexcept {
+    static std::atomic<uint64_t> next{1};
+    return next.fetch_add(1, std::memory_order_relaxed);
+}
 
 PoliciesValues::PoliciesValues(PoliciesVector&& base_collection)
-    : opt_base_vector(base_collection), opt_base_hashset({}) {}
+    : opt_base_vector(std::move(base_collection)), opt_base_hashset({}) {}
 
 PoliciesValues::PoliciesValues(PoliciesHashset&& base_collection)
-    : opt_base_vector({}), opt_base_hashset(base_collection) {}
+    : opt_base_vector({}), opt_base_hashset(std::move(base_collection)) {}
 
 PoliciesValues::PoliciesValues(const std::initializer_list<PolicyValues>& list) 
 	: opt_base_vector(list), opt_base_hashset({}) {}
@@ -31,23 +41,128 @@ PoliciesValues::PoliciesValues(size_t capacity)
     opt_base_vector->reserve(capacity);
 }
 
-PoliciesValues PoliciesValues::createWithVector(const std::initializer_list<PolicyValues>& list) {
-    PoliciesVector vec(list);
+// operator= moves the rules of other along with its memory resource.
+PoliciesValues& PoliciesValues::operator=(PoliciesValues&& other) noexcept {
+    if (this == &other)
+        return *this;
+    opt_base_vector.reset();
+    opt_base_hashset.reset();
+    opt_base_chunks.reset();
+    mapped_rules = std::move(other.mapped_rules);
+    if (other.opt_base_vector.has_value())
+        opt_base_vector.emplace(std::move(*other.opt_base_vector));
+    else if (other.opt_base_hashset.has_value())
+        opt_base_hashset.emplace(std::move(*other.opt_base_hashset));
+    else if (other.opt_base_chunks.has_value())
+        opt_base_chunks.emplace(std::move(*other.opt_base_chunks));
+    chunked_size = other.chunked_size;
+    chunk_resource = other.chunk_resource;
+    changes.Bump();
+    return *this;
+}
+
+PoliciesValues PoliciesValues::createWithVector(const std::initializer_list<PolicyValues>& list, std::pmr::memory_resource* resource) {
+    PoliciesVector vec(list, resource);
     return PoliciesValues(std::move(vec));
 }
 
-PoliciesValues PoliciesValues::createWithHashset(const std::initializer_list<PolicyValues>& list) {
-    PoliciesHashset hashset(list);
+PoliciesValues PoliciesValues::createWithHashset(const std::initializer_list<PolicyValues>& list, std::pmr::memory_resource* resource) {
+    PoliciesHashset hashset(list, 0, std::hash<PolicyValues>(), std::equal_to<PolicyValues>(), resource);
     return PoliciesValues(std::move(hashset));
 }
 
+PoliciesValues PoliciesValues::createMapped(std::shared_ptr<const MappedPolicies> rules) {
+    PoliciesValues values;
+    values.opt_base_vector.reset();
+    values.mapped_rules = std::move(rules);
+    return values;
+}
+
+PoliciesValues PoliciesValues::createInterned(const PoliciesValues& rules, std::pmr::memory_resource* resource) {
+    return createMapped(std::allocate_shared<InternedPolicies>(std::pmr::polymorphic_allocator<InternedPolicies>(resource), rules, resource));
+}
+
+// createShared keeps the rules of a vector in chunks reading them, and the chunks of a chunked
+// collection, which are copied once changed.
+PoliciesValues PoliciesValues::createShared(const PoliciesValues& rules, std::shared_ptr<const void> owner, std::pmr::memory_resource* resource) {
+    if (rules.is_hash()) {
+        // a copy assignment keeps the resource of the collection assigned to
+        PoliciesValues copy = createWithHashset({}, resource);
+        copy = rules;
+        return copy;
+    }
+    if (rules.is_mapped())
+        return rules;
+
+    PoliciesValues values;
+    values.opt_base_vector.reset();
+    values.opt_base_chunks.emplace();
+    values.chunked_size = rules.size();
+    values.chunk_resource = resource;
+    if (rules.opt_base_chunks.has_value()) {
+        *values.opt_base_chunks = *rules.opt_base_chunks;
+        return values;
+    }
+    const PoliciesVector& vector = *rules.opt_base_vector;
+    for (size_t begin = 0; begin < vector.size(); begin += kChunkRules) {
+        Chunk chunk;
+        chunk.owner = owner;
+        chunk.first = vector.data() + begin;
+        chunk.count = std::min(kChunkRules, vector.size() - begin);
+        values.opt_base_chunks->push_back(std::move(chunk));
+    }
+    return values;
+}
+
+size_t PoliciesValues::Chunk::size() const {
+    return rules != nullptr ? rules->size() : count;
+}
+
+const PolicyValues& PoliciesValues::Chunk::at(size_t index) const {
+    return rules != nullptr ? (*rules)[index] : first[index];
+}
+
+PoliciesValues::PoliciesVector& PoliciesValues::ownChunk(size_t index) {
+    Chunk& chunk = (*opt_base_chunks)[index];
+    if (chunk.rules == nullptr || chunk.rules.use_count() != 1) {
+        auto rules = std::make_shared<PoliciesVector>(chunk_resource);
+        rules->reserve(chunk.size());
+        for (size_t i = 0; i < chunk.size(); i++)
+            rules->push_back(chunk.at(i));
+        chunk.rules = std::move(rules);
+        chunk.owner = nullptr;
+        chunk.first = nullptr;
+        chunk.count = 0;
+    }
+    return *chunk.rules;
+}
+
+PoliciesValues::PoliciesVector& PoliciesValues::appendChunk() {
+    PoliciesChunks& chunks = *opt_base_chunks;
+    // a shared last chunk is left as it is instead of being copied
+    if (chunks.empty() || chunks.back().rules == nullptr || chunks.back().rules.use_count() != 1 || chunks.back().rules->size() >= kChunkRules) {
+        Chunk chunk;
+        chunk.rules = std::make_shared<PoliciesVector>(chunk_resource);
+        chunks.push_back(std::move(chunk));
+    }
+    return *chunks.back().rules;
+}
+
 size_t PoliciesValues::size() const {
+    if (mapped_rules != nullptr)
+        return mapped_rules->size();
+    if (opt_base_chunks.has_value())
+        return chunked_size;
     if (opt_base_vector.has_value())
     	return opt_base_vector->size();
     return opt_base_hashset->size();
 }
 
 bool PoliciesValues::empty() const {
+    if (mapped_rules != nullptr)
+        return mapped_rules->size() == 0;
+    if (opt_base_chunks.has_value())
+        return chunked_size == 0;
     if(opt_base_vector.has_value())
         return opt_base_vector->empty();
     return opt_base_hashset->empty();
@@ -57,11 +172,130 @@ bool PoliciesValues::is_hash() const {
     return opt_base_hashset.has_value();
 }
 
+bool PoliciesValues::is_mapped() const {
+    return mapped_rules != nullptr;
+}
+
+uint64_t PoliciesValues::generation() const {
+    return changes.value;
+}
+
+bool PoliciesValues::is_chunked() const {
+    return opt_base_chunks.has_value();
+}
+
+void PoliciesValues::detach(std::pmr::memory_resource* resource) {
+    if (mapped_rules == nullptr)
+        return;
+    PoliciesVector rules(resource);
+    rules.reserve(mapped_rules->size());
+    for (size_t position = mapped_rules->Begin(); position != mapped_rules->End(); position = mapped_rules->Next(position)) {
+        rules.emplace_back();
+        mapped_rules->Read(position, rules.back());
+    }
+    mapped_rules = nullptr;
+    opt_base_vector.emplace(std::move(rules));
+    changes.Bump();
+}
+
+std::pmr::memory_resource* PoliciesValues::get_memory_resource() const {
+    if (mapped_rules != nullptr)
+        return mapped_rules->GetMemoryResource();
+    if (opt_base_chunks.has_value())
+        return chunk_resource;
+    if (opt_base_vector.has_value())
+        return opt_base_vector->get_allocator().resource();
+    return opt_base_hashset->get_allocator().resource();
+}
+
+// memory_usage estimates the bytes of the collection from its capacity: the vector buffer or
+// the buckets and nodes of the hash set, and the rules with their strings.
+size_t PoliciesValues::memory_usage() const {
+    size_t bytes = 0;
+    // the rules of a mapped collection are shared, only interned ones are held in the process
+    if (mapped_rules != nullptr)
+        return mapped_rules->GetMemoryUsage();
+    // the rules a chunk reads from another collection are held by it
+    if (opt_base_chunks.has_value()) {
+        bytes += opt_base_chunks->capacity() * sizeof(Chunk);
+        for (const Chunk& chunk : *opt_base_chunks) {
+            if (chunk.rules == nullptr)
+                continue;
+            bytes += chunk.rules->capacity() * sizeof(PolicyValues);
+            for (const PolicyValues& rule : *chunk.rules)
+                bytes += casbin::HeapBytes(rule);
+        }
+        return bytes;
+    }
+    if (opt_base_vector.has_value()) {
+        bytes += opt_base_vector->capacity() * sizeof(PolicyValues);
+    } else {
+        bytes += opt_base_hashset->bucket_count() * sizeof(void*);
+        // a node holds the rule, its hash and the link to the next node
+        bytes += opt_base_hashset->size() * (sizeof(PolicyValues) + 2 * sizeof(void*));
+    }
+    for (const PolicyValues& rule : *this)
+        bytes += casbin::HeapBytes(rule);
+    return bytes;
+}
+
+void PoliciesValues::reserve(size_t capacity) {
+    this->detach(this->get_memory_resource());
+    if (opt_base_vector.has_value())
+        opt_base_vector->reserve(capacity);
+    else if (opt_base_hashset.has_value())
+        opt_base_hashset->reserve(capacity);
+}
+
+void PoliciesValues::emplace(PolicyValues&& element) {
+    this->detach(this->get_memory_resource());
+    if (opt_base_chunks.has_value()) {
+        this->appendChunk().push_back(std::move(element));
+        ++chunked_size;
+    } else if (opt_base_vector.has_value())
+        opt_base_vector->push_back(std::move(element));
+    else {
+        opt_base_hashset->emplace(std::move(element));
+        changes.Bump();
+    }
+}
+
 void PoliciesValues::emplace(const PolicyValues& element) {
-    if (opt_base_vector.has_value()) 
+    this->detach(this->get_memory_resource());
+    if (opt_base_chunks.has_value()) {
+        this->appendChunk().push_back(element);
+        ++chunked_size;
+    } else if (opt_base_vector.has_value())
         opt_base_vector->push_back(element);
-    else
+    else {
         opt_base_hashset->emplace(element);
+        changes.Bump();
+    }
+}
+
+PolicyValues& PoliciesValues::MappedCursor::Get() const {
+    if (!is_read) {
+        rules->Read(position, rule);
+        is_read = true;
+    }
+    return rule;
+}
+
+void PoliciesValues::MappedCursor::Advance() {
+    position = rules->Next(position);
+    is_read = false;
+}
+
+const PolicyValues& PoliciesValues::ChunkCursor::Get() const {
+    return (*chunks)[chunk].at(rule);
+}
+
+// Advance moves to the next rule, the chunks are never empty.
+void PoliciesValues::ChunkCursor::Advance() {
+    if (++rule == (*chunks)[chunk].size()) {
+        ++chunk;
+        rule = 0;
+    }
 }
 
 PoliciesValues::iterator::iterator(const PoliciesVector::iterator& base_iterator_)
@@ -70,14 +304,36 @@ PoliciesValues::iterator::iterator(const PoliciesVector::iterator& base_iterator
 PoliciesValues::iterator::iterator(const PoliciesHashset::iterator& base_iterator_)
     : opt_hashset_iterator(base_iterator_), is_vector_iterator(false) {}
 
+PoliciesValues::iterator::iterator(const MappedPolicies* rules, size_t position)
+    : is_vector_iterator(false) {
+    mapped_cursor.rules = rules;
+    mapped_cursor.position = position;
+}
+
+PoliciesValues::iterator::iterator(const PoliciesChunks* chunks, size_t chunk)
+    : is_vector_iterator(false) {
+    chunk_cursor.chunks = chunks;
+    chunk_cursor.chunk = chunk;
+}
+
+// operator* returns the rule read by the iterator for a mapped collection, changing it does
+// not change the collection. The rule of a shared chunk must not be changed.
 PolicyValues& PoliciesValues::iterator::operator*() const {
+     if ( mapped_cursor.rules != nullptr )
+         return mapped_cursor.Get();
+     if ( chunk_cursor.chunks != nullptr )
+         return const_cast<PolicyValues&>(chunk_cursor.Get());
      if ( is_vector_iterator )
          return *opt_vector_iterator;
      return const_cast<PolicyValues&>(*opt_hashset_iterator);
 }
 
-PoliciesValues::iterator  PoliciesValues::iterator::operator++() { 
-     if ( is_vector_iterator )
+PoliciesValues::iterator& PoliciesValues::iterator::operator++() {
+     if ( mapped_cursor.rules != nullptr )
+         mapped_cursor.Advance();
+     else if ( chunk_cursor.chunks != nullptr )
+         chunk_cursor.Advance();
+     else if ( is_vector_iterator )
          opt_vector_iterator++;
      else
          opt_hashset_iterator++;
@@ -85,36 +341,74 @@ PoliciesValues::iterator  PoliciesValues::iterator::operator++() {
 }
 
 bool PoliciesValues::iterator::operator!=(const PoliciesValues::iterator& other) const {
-     return opt_vector_iterator != other.opt_vector_iterator || opt_hashset_iterator != other.opt_hashset_iterator;
+     return opt_vector_iterator != other.opt_vector_iterator || opt_hashset_iterator != other.opt_hashset_iterator ||
+            mapped_cursor.position != other.mapped_cursor.position || chunk_cursor.chunk != other.chunk_cursor.chunk ||
+            chunk_cursor.rule != other.chunk_cursor.rule;
 }
 
 PoliciesValues::iterator PoliciesValues::begin() { 
+    if (mapped_rules != nullptr)
+        return iterator(mapped_rules.get(), mapped_rules->Begin());
+    if (opt_base_chunks.has_value())
+        return iterator(&*opt_base_chunks, 0);
     if (opt_base_vector.has_value())
         return iterator(opt_base_vector->begin());
     return iterator(opt_base_hashset->begin());
 }
 
 PoliciesValues::iterator PoliciesValues::end() { 
+    if (mapped_rules != nullptr)
+        return iterator(mapped_rules.get(), mapped_rules->End());
+    if (opt_base_chunks.has_value())
+        return iterator(&*opt_base_chunks, opt_base_chunks->size());
     if (opt_base_vector.has_value())
         return iterator(opt_base_vector->end());
     return iterator(opt_base_hashset->end());
 }
 
 PoliciesValues::iterator PoliciesValues::find(const PolicyValues& values) {
+    // the rule found is usually erased next
+    this->detach(this->get_memory_resource());
+    if (opt_base_chunks.has_value()) {
+        iterator it = this->begin();
+        while (it != this->end() && *it != values)
+            ++it;
+        return it;
+    }
     if (opt_base_vector.has_value()) 
         return iterator(std::find(opt_base_vector->begin(), opt_base_vector->end(), values));
     return iterator(opt_base_hashset->find(values));
 }
 
 void PoliciesValues::clear() {
-    if (opt_base_vector.has_value())
+    changes.Bump();
+    if (mapped_rules != nullptr) {
+        opt_base_vector.emplace(mapped_rules->GetMemoryResource());
+        mapped_rules = nullptr;
+    } else if (opt_base_chunks.has_value()) {
+        opt_base_chunks->clear();
+        chunked_size = 0;
+    } else if (opt_base_vector.has_value())
         opt_base_vector->clear();
     else
         opt_base_hashset->clear();
 }
 
 void PoliciesValues::erase(const iterator& it) {
-    if (opt_base_vector.has_value())
+    changes.Bump();
+    if (mapped_rules != nullptr) {
+        size_t index = 0;
+        for (size_t position = mapped_rules->Begin(); position != it.mapped_cursor.position; position = mapped_rules->Next(position))
+            ++index;
+        this->detach(this->get_memory_resource());
+        opt_base_vector->erase(opt_base_vector->begin() + index);
+    } else if (opt_base_chunks.has_value()) {
+        PoliciesVector& rules = this->ownChunk(it.chunk_cursor.chunk);
+        rules.erase(rules.begin() + it.chunk_cursor.rule);
+        if (rules.empty())
+            opt_base_chunks->erase(opt_base_chunks->begin() + it.chunk_cursor.chunk);
+        --chunked_size;
+    } else if (opt_base_vector.has_value())
         opt_base_vector->erase(it.opt_vector_iterator);
     else
         opt_base_hashset->erase(it.opt_hashset_iterator);
@@ -129,14 +423,34 @@ PoliciesValues::const_iterator::const_iterator(const PoliciesHashset::const_iter
     : opt_hashset_iterator(base_iterator_), is_vector_iterator(false) {
 }
 
+PoliciesValues::const_iterator::const_iterator(const MappedPolicies* rules, size_t position)
+    : is_vector_iterator(false) {
+    mapped_cursor.rules = rules;
+    mapped_cursor.position = position;
+}
+
+PoliciesValues::const_iterator::const_iterator(const PoliciesChunks* chunks, size_t chunk)
+    : is_vector_iterator(false) {
+    chunk_cursor.chunks = chunks;
+    chunk_cursor.chunk = chunk;
+}
+
 const PolicyValues& PoliciesValues::const_iterator::operator*() const {
+     if ( mapped_cursor.rules != nullptr )
+         return mapped_cursor.Get();
+     if ( chunk_cursor.chunks != nullptr )
+         return chunk_cursor.Get();
      if ( is_vector_iterator )
          return *opt_vector_iterator;
      return *opt_hashset_iterator;
 }
 
-PoliciesValues::const_iterator PoliciesValues::const_iterator::operator++() {
-     if ( is_vector_iterator )
+PoliciesValues::const_iterator& PoliciesValues::const_iterator::operator++() {
+     if ( mapped_cursor.rules != nullptr )
+         mapped_cursor.Advance();
+     else if ( chunk_cursor.chunks != nullptr )
+         chunk_cursor.Advance();
+     else if ( is_vector_iterator )
          opt_vector_iterator++;
      else
          opt_hashset_iterator++;
@@ -144,18 +458,84 @@ PoliciesValues::const_iterator PoliciesValues::const_iterator::operator++() {
 }
 
 bool PoliciesValues::const_iterator::operator!=(const const_iterator& other) const {
-     return opt_vector_iterator != other.opt_vector_iterator || opt_hashset_iterator != other.opt_hashset_iterator;
+     return opt_vector_iterator != other.opt_vector_iterator || opt_hashset_iterator != other.opt_hashset_iterator ||
+            mapped_cursor.position != other.mapped_cursor.position || chunk_cursor.chunk != other.chunk_cursor.chunk ||
+            chunk_cursor.rule != other.chunk_cursor.rule;
 }
 
 
 PoliciesValues::const_iterator PoliciesValues::begin() const {
+    if (mapped_rules != nullptr)
+        return const_iterator(mapped_rules.get(), mapped_rules->Begin());
+    if (opt_base_chunks.has_value())
+        return const_iterator(&*opt_base_chunks, 0);
     if (opt_base_vector.has_value())
         return const_iterator(opt_base_vector->cbegin());
     return const_iterator(opt_base_hashset->cbegin());
 }
 
 PoliciesValues::const_iterator PoliciesValues::end() const {
+    if (mapped_rules != nullptr)
+        return const_iterator(mapped_rules.get(), mapped_rules->End());
+    if (opt_base_chunks.has_value())
+        return const_iterator(&*opt_base_chunks, opt_base_chunks->size());
     if (opt_base_vector.has_value())
         return const_iterator(opt_base_vector->cend());
     return const_iterator(opt_base_hashset->cend());
 }
+
+InternedPolicies::InternedPolicies(const PoliciesValues& rules, std::pmr::memory_resource* resource)
+    : m_resource(resource), m_bytes(resource), m_values(resource), m_fields(resource), m_rules(resource) {
+    std::unordered_map<std::string_view, uint32_t> ids;
+    m_values.push_back(0);
+    m_rules.reserve(rules.size() + 1);
+    m_rules.push_back(0);
+    for (const PolicyValues& rule : rules) {
+        for (const std::string& value : rule) {
+            auto [it, inserted] = ids.try_emplace(value, static_cast<uint32_t>(ids.size()));
+            if (inserted) {
+                if (ids.size() > std::numeric_limits<uint32_t>::max())
+                    throw std::length_error("too many distinct values to intern");
+                m_bytes.insert(m_bytes.end(), value.begin(), value.end());
+                m_values.push_back(m_bytes.size());
+            }
+            m_fields.push_back(it->second);
+        }
+        m_rules.push_back(m_fields.size());
+    }
+    m_bytes.shrink_to_fit();
+    m_values.shrink_to_fit();
+    m_fields.shrink_to_fit();
+}
+
+size_t InternedPolicies::size() const {
+    return m_rules.size() - 1;
+}
+
+size_t InternedPolicies::Begin() const {
+    return 0;
+}
+
+size_t InternedPolicies::End() const {
+    return this->size();
+}
+
+size_t InternedPolicies::Next(size_t position) const {
+    return position + 1;
+}
+
+void InternedPolicies::Read(size_t position, PolicyValues& rule) const {
+    rule.resize(m_rules[position + 1] - m_rules[position]);
+    for (size_t i = 0; i < rule.size(); i++) {
+        uint32_t id = m_fields[m_rules[position] + i];
+        rule[i].assign(m_bytes.data() + m_values[id], m_values[id + 1] - m_values[id]);
+    }
+}
+
+std::pmr::memory_resource* InternedPolicies::GetMemoryResource() const {
+    return m_resource;
+}
+
+size_t InternedPolicies::GetMemoryUsage() const {
+    return sizeof(*this) + m_bytes.capacity() + m_values.capacity() * sizeof(size_t) + m_fields.capacity() * sizeof(uint32_t) + m_rules.capacity() * sizeof(size_t);
+}
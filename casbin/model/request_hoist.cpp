@@ -0,0 +1,214 @@
+/*
+ * Copyright 2021 The casbin Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "casbin/pch.h"
+
+#ifndef REQUEST_HOIST_CPP
+#define REQUEST_HOIST_CPP
+
+#include <algorithm>
+
+#include "casbin/model/request_hoist.h"
+#include "casbin/util/util.h"
+
+namespace casbin {
+
+namespace {
+
+// The sources a subexpression depends on
+constexpr int kRequest = 1;
+// Policy fields, and identifiers of unknown origin
+constexpr int kOther = 2;
+// A call to a function not known to be pure, like keyGet or a custom function
+constexpr int kImpure = 4;
+
+// Sources returns the sources the node depends on.
+int Sources(const MatcherNode& node, const std::unordered_set<std::string>& g_keys) {
+    static const std::unordered_set<std::string> pure_functions = {"keyMatch", "keyMatch2", "keyMatch3", "keyMatch4", "regexMatch", "ipMatch"};
+    int sources = 0;
+    if (node.kind == MatcherNode::Kind::Identifier)
+        sources = node.IsRequestField() ? kRequest : kOther;
+    else if (node.kind == MatcherNode::Kind::Call && g_keys.count(node.value) == 0 && pure_functions.count(node.value) == 0)
+        sources = kImpure;
+    for (const auto& child : node.children)
+        sources |= Sources(*child, g_keys);
+    return sources;
+}
+
+// IsCostly returns true if the node calls a function or tests an "in" list.
+bool IsCostly(const MatcherNode& node) {
+    if (node.kind == MatcherNode::Kind::Call || node.kind == MatcherNode::Kind::In)
+        return true;
+    return std::any_of(node.children.begin(), node.children.end(), [](const std::shared_ptr<MatcherNode>& child) { return IsCostly(*child); });
+}
+
+// CollectRequestFields adds the request fields read by the node, as "r.sub" -> "sub".
+void CollectRequestFields(const MatcherNode& node, std::vector<std::string>& fields) {
+    if (node.IsRequestField()) {
+        std::string field = node.value.substr(2);
+        if (std::find(fields.begin(), fields.end(), field) == fields.end())
+            fields.push_back(std::move(field));
+        return;
+    }
+    for (const auto& child : node.children)
+        CollectRequestFields(*child, fields);
+}
+
+} // namespace
+
+void RequestHoist::Hoist(std::shared_ptr<MatcherNode>& node, bool top_level) {
+    // only subexpressions with a truth value are hoisted, e.g. not the "+" of strings
+    bool boolean = node->kind == MatcherNode::Kind::Or || node->kind == MatcherNode::Kind::And || node->kind == MatcherNode::Kind::Not ||
+                   node->kind == MatcherNode::Kind::Compare || node->kind == MatcherNode::Kind::In || node->kind == MatcherNode::Kind::Call;
+    if (!boolean || Sources(*node, m_g_keys) != kRequest || (!top_level && !IsCostly(*node))) {
+        for (auto& child : node->children)
+            this->Hoist(child, false);
+        return;
+    }
+
+    std::string expression = PrintMatcher(*node);
+    auto term = std::find_if(m_terms.begin(), m_terms.end(), [&](const Term& t) { return t.expression == expression; });
+    if (term == m_terms.end()) {
+        Term hoisted;
+        hoisted.expression = expression;
+        hoisted.property = "t" + std::to_string(m_terms.size());
+        CollectRequestFields(*node, hoisted.fields);
+        term = m_terms.insert(m_terms.end(), std::move(hoisted));
+    }
+    term->top_level = term->top_level || top_level;
+
+    auto read = std::make_shared<MatcherNode>(MatcherNode::Kind::Compare, "==");
+    read->children.push_back(std::make_shared<MatcherNode>(MatcherNode::Kind::Identifier, std::string(kTarget) + "." + term->property));
+    read->children.push_back(std::make_shared<MatcherNode>(MatcherNode::Kind::String, "1"));
+    node = read;
+}
+
+void RequestHoist::Build(const std::shared_ptr<Model>& m) {
+    std::lock_guard<std::mutex> lock(m_idle_mutex);
+    m_applicable = false;
+    m_held_decides = false;
+    m_failed_decides = false;
+    m_g_keys.clear();
+    m_terms.clear();
+    m_idle.clear();
+    m_expression = nullptr;
+
+    if (!m->HasSection("m") || m->m["m"].assertion_map.count("m") == 0)
+        return;
+    const std::string& matcher = m->m["m"].assertion_map["m"]->value;
+    if (HasEval(matcher))
+        return;
+    std::shared_ptr<MatcherNode> root = ParseMatcher(matcher);
+    if (root == nullptr)
+        return;
+
+    if (m->HasSection("g"))
+        for (const auto& [key, _] : m->m["g"].assertion_map)
+            m_g_keys.insert(key);
+
+    bool junction = root->kind == MatcherNode::Kind::And || root->kind == MatcherNode::Kind::Or;
+    if (junction && Sources(*root, m_g_keys) != kRequest) {
+        m_held_decides = root->kind == MatcherNode::Kind::Or;
+        m_failed_decides = root->kind == MatcherNode::Kind::And;
+        for (auto& child : root->children)
+            this->Hoist(child, true);
+    } else {
+        // the matcher reading only the request is one term deciding it
+        m_held_decides = true;
+        m_failed_decides = true;
+        this->Hoist(root, true);
+    }
+    if (m_terms.empty())
+        return;
+
+    m_expression = std::make_shared<const std::string>(PrintMatcher(*root));
+    m_applicable = true;
+}
+
+bool RequestHoist::IsApplicable() const {
+    return m_applicable;
+}
+
+std::shared_ptr<const std::string> RequestHoist::GetExpression() const {
+    return m_expression;
+}
+
+void RequestHoist::InitialObject(IEvaluator& evaluator) const {
+    evaluator.InitialObject(kTarget);
+    for (const Term& term : m_terms)
+        evaluator.PushObjectString(kTarget, term.property, "");
+}
+
+RequestHoist::Decision RequestHoist::Evaluate(IEvaluator& evaluator, const std::function<void(const std::shared_ptr<IEvaluator>&)>& load_functions) {
+    std::unique_ptr<std::vector<std::shared_ptr<IEvaluator>>> evaluators;
+    {
+        std::lock_guard<std::mutex> lock(m_idle_mutex);
+        if (!m_idle.empty()) {
+            evaluators = std::move(m_idle.back());
+            m_idle.pop_back();
+        }
+    }
+    // the evaluators keep the terms compiled from one request to the next
+    if (evaluators == nullptr) {
+        evaluators = std::make_unique<std::vector<std::shared_ptr<IEvaluator>>>();
+        for (size_t i = 0; i < m_terms.size(); i++)
+            evaluators->push_back(IEvaluator::NewEvaluator());
+    }
+
+    Decision decision = Decision::None;
+    try {
+        for (size_t i = 0; i < m_terms.size() && decision != Decision::Unavailable; i++) {
+            const Term& term = m_terms[i];
+            const std::shared_ptr<IEvaluator>& term_evaluator = (*evaluators)[i];
+            for (const std::string& field : term.fields) {
+                // e.g. a JSON request value
+                const std::string* value = evaluator.GetObjectString("r", field);
+                if (value == nullptr) {
+                    decision = Decision::Unavailable;
+                    break;
+                }
+                term_evaluator->PushObjectString("r", field, *value);
+            }
+            if (decision == Decision::Unavailable)
+                break;
+            load_functions(term_evaluator);
+            if (!term_evaluator->Eval(term.expression)) {
+                decision = Decision::Unavailable;
+                break;
+            }
+
+            bool held = term_evaluator->GetBoolean();
+            evaluator.PushObjectString(kTarget, term.property, held ? "1" : "0");
+            if (term.top_level && decision == Decision::None) {
+                if (held && m_held_decides)
+                    decision = Decision::MatchesAll;
+                else if (!held && m_failed_decides)
+                    decision = Decision::MatchesNone;
+            }
+        }
+    } catch (...) {
+        // a term failing alone, e.g. on an invalid pattern, is left to the model matcher
+        decision = Decision::Unavailable;
+    }
+
+    std::lock_guard<std::mutex> lock(m_idle_mutex);
+    m_idle.push_back(std::move(evaluators));
+    return decision;
+}
+
+} // namespace casbin
+
+#endif // REQUEST_HOIST_CPP
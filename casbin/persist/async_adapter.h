@@ -0,0 +1,45 @@
+/*
+ * Copyright 2021 The casbin Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CASBIN_CPP_PERSIST_ASYNC_ADAPTER
+#define CASBIN_CPP_PERSIST_ASYNC_ADAPTER
+
+#include <future>
+
+#include "./adapter.h"
+
+namespace casbin {
+
+// AsyncAdapter is the interface for adapters storing policy changes in the background. The
+// changes are stored in the order they are made. The future of a change is ready once it is
+// stored, and holds the exception the storage failed with.
+class AsyncAdapter : virtual public Adapter {
+public:
+    // AddPolicyAsync adds a policy rule to the storage in the background.
+    virtual std::future<void> AddPolicyAsync(std::string sec, std::string p_type, std::vector<std::string> rule) = 0;
+    // RemovePolicyAsync removes a policy rule from the storage in the background.
+    virtual std::future<void> RemovePolicyAsync(std::string sec, std::string p_type, std::vector<std::string> rule) = 0;
+    // AddPoliciesAsync adds policy rules to the storage in the background.
+    virtual std::future<void> AddPoliciesAsync(std::string sec, std::string p_type, PoliciesValues rules) = 0;
+    // RemovePoliciesAsync removes policy rules from the storage in the background.
+    virtual std::future<void> RemovePoliciesAsync(std::string sec, std::string p_type, PoliciesValues rules) = 0;
+    // Flush returns a future that is ready once every change made before the call is stored.
+    virtual std::future<void> Flush() = 0;
+};
+
+}; // namespace casbin
+
+#endif
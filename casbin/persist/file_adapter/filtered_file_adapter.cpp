@@ -34,7 +34,7 @@ bool FilteredFileAdapter ::filterWords(std::vector<std::string> line, std::vecto
     if (line.size() < filter.size() + 1)
         return true;
 
-    bool skip_line;
+    bool skip_line = false;
     for (int i = 0; i < filter.size(); i++) {
         if (filter[i].length() > 0 && Trim(filter[i]) != Trim(line[i + 1])) {
             skip_line = true;
@@ -82,6 +82,7 @@ void FilteredFileAdapter ::LoadPolicy(const std::shared_ptr<Model>& model) {
 void FilteredFileAdapter ::LoadFilteredPolicy(const std::shared_ptr<Model>& model, Filter* filter) {
     if (filter == NULL) {
         this->LoadPolicy(model);
+        return;
     }
 
     if (this->file_path == "") {
@@ -33,7 +33,7 @@ public:
 class FilteredAdapter : virtual public Adapter {
 public:
     // LoadFilteredPolicy loads only policy rules that match the filter.
-    void LoadFilteredPolicy(const std::shared_ptr<Model>& model, Filter* filter);
+    virtual void LoadFilteredPolicy(const std::shared_ptr<Model>& model, Filter* filter) = 0;
     // IsFiltered returns true if the loaded policy has been filtered.
     virtual bool IsFiltered() = 0;
 };
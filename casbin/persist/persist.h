@@ -18,6 +18,7 @@
 #define CASBIN_CPP_PERSIST
 
 #include "adapter.h"
+#include "async_adapter.h"
 #include "batch_adapter.h"
 #include "default_watcher.h"
 #include "default_watcher_ex.h"
@@ -27,5 +28,6 @@
 #include "filtered_adapter.h"
 #include "watcher.h"
 #include "watcher_ex.h"
+#include "write_behind_adapter.h"
 
 #endif
\ No newline at end of file
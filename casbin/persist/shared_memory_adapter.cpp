@@ -0,0 +1,531 @@
+/*
+ * Copyright 2021 The casbin Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "casbin/pch.h"
+
+#ifndef SHARED_MEMORY_ADAPTER_CPP
+#define SHARED_MEMORY_ADAPTER_CPP
+
+#include <atomic>
+#include <cstring>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#endif
+
+#include "casbin/exception/casbin_adapter_exception.h"
+#include "casbin/exception/unsupported_operation_exception.h"
+#include "casbin/persist/shared_memory_adapter.h"
+
+namespace casbin {
+
+#ifndef _WIN32
+
+namespace {
+
+const uint32_t s_magic = 0x50534243; // "CBSP"
+const uint32_t s_version = 2;
+
+// Retries when a snapshot is unlinked between reading the generation and opening it
+const int s_max_open_attempts = 16;
+
+// The generation of a snapshot is reserved before it is written, publishers then race to make
+// theirs the current one and only a later generation replaces the current one.
+struct ControlBlock {
+    uint32_t magic;
+    uint32_t version;
+    std::atomic<uint64_t> generation;
+    std::atomic<uint64_t> reserved;
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "the generation is shared between processes");
+
+// A snapshot is a SegmentHeader followed by
+//   uint64_t string_offsets[string_count + 1]  (into the character data)
+//   AssertionEntry assertions[assertion_count]
+//   uint32_t rows[]                            (per row: field count, then string ids)
+//   char characters[]
+struct SegmentHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t size;
+    uint64_t string_count;
+    uint64_t assertion_count;
+    uint64_t rows_size;
+    uint64_t characters_size;
+};
+
+struct AssertionEntry {
+    uint32_t sec;
+    uint32_t key;
+    uint64_t row_count;
+    uint64_t rows_offset;
+};
+
+std::string ControlName(const std::string& name) {
+    return name.empty() || name[0] != '/' ? "/" + name : name;
+}
+
+std::string SegmentName(const std::string& name, uint64_t generation) {
+    return ControlName(name) + "." + std::to_string(generation);
+}
+
+// Mapping owns a shared memory mapping and unmaps it on destruction.
+class Mapping {
+public:
+    void* data = MAP_FAILED;
+    size_t size = 0;
+
+    Mapping() = default;
+    Mapping(const Mapping&) = delete;
+    Mapping& operator=(const Mapping&) = delete;
+
+    ~Mapping() {
+        if (data != MAP_FAILED)
+            munmap(data, size);
+    }
+
+    // Map maps the named segment, returns false with errno set if it does not exist.
+    bool Map(const std::string& name, bool writable, size_t create_size = 0) {
+        int flags = writable ? O_RDWR : O_RDONLY;
+        if (create_size > 0)
+            flags |= O_CREAT;
+        int fd = shm_open(name.c_str(), flags, 0644);
+        if (fd < 0)
+            return false;
+
+        struct stat st;
+        if (fstat(fd, &st) < 0) {
+            close(fd);
+            throw CasbinAdapterException("cannot stat shared memory segment " + name + ": " + std::strerror(errno));
+        }
+        if (st.st_size == 0 && create_size == 0) {
+            // Created but not sized yet by the publisher
+            close(fd);
+            errno = ENOENT;
+            return false;
+        }
+        if (st.st_size == 0 && ftruncate(fd, create_size) < 0) {
+            close(fd);
+            throw CasbinAdapterException("cannot size shared memory segment " + name + ": " + std::strerror(errno));
+        }
+        size = st.st_size == 0 ? create_size : st.st_size;
+        data = mmap(NULL, size, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if (data == MAP_FAILED)
+            throw CasbinAdapterException("cannot map shared memory segment " + name + ": " + std::strerror(errno));
+        return true;
+    }
+};
+
+size_t Align(size_t offset) {
+    return (offset + 7) & ~size_t(7);
+}
+
+// Snapshot builds the serialized form of the "p" and "g" assertions of a model.
+class Snapshot {
+private:
+    std::unordered_map<std::string, uint32_t> m_ids;
+    std::vector<const std::string*> m_strings;
+
+    uint32_t Intern(const std::string& str) {
+        auto [it, inserted] = m_ids.emplace(str, static_cast<uint32_t>(m_strings.size()));
+        if (inserted)
+            m_strings.push_back(&it->first);
+        return it->second;
+    }
+
+public:
+    std::vector<AssertionEntry> assertions;
+    std::vector<uint32_t> rows;
+
+    explicit Snapshot(const std::shared_ptr<Model>& model) {
+        for (const char* sec : {"p", "g"}) {
+            auto it = model->m.find(sec);
+            if (it == model->m.end())
+                continue;
+            for (const auto& [key, assertion] : it->second.assertion_map) {
+                AssertionEntry entry{Intern(sec), Intern(key), 0, rows.size()};
+                for (const std::vector<std::string>& rule : assertion->policy) {
+                    rows.push_back(static_cast<uint32_t>(rule.size()));
+                    for (const std::string& field : rule)
+                        rows.push_back(Intern(field));
+                    ++entry.row_count;
+                }
+                assertions.push_back(entry);
+            }
+        }
+    }
+
+    size_t Write(char* out) const {
+        size_t strings_at = Align(sizeof(SegmentHeader));
+        size_t assertions_at = Align(strings_at + (m_strings.size() + 1) * sizeof(uint64_t));
+        size_t rows_at = Align(assertions_at + assertions.size() * sizeof(AssertionEntry));
+        size_t characters_at = Align(rows_at + rows.size() * sizeof(uint32_t));
+
+        uint64_t characters_size = 0;
+        for (const std::string* str : m_strings)
+            characters_size += str->size();
+        size_t size = characters_at + characters_size;
+        if (out == nullptr)
+            return size;
+
+        SegmentHeader header{s_magic, s_version, size, m_strings.size(), assertions.size(), rows.size(), characters_size};
+        std::memcpy(out, &header, sizeof(header));
+
+        uint64_t offset = 0;
+        for (size_t i = 0; i < m_strings.size(); ++i) {
+            std::memcpy(out + strings_at + i * sizeof(uint64_t), &offset, sizeof(offset));
+            std::memcpy(out + characters_at + offset, m_strings[i]->data(), m_strings[i]->size());
+            offset += m_strings[i]->size();
+        }
+        std::memcpy(out + strings_at + m_strings.size() * sizeof(uint64_t), &offset, sizeof(offset));
+
+        std::memcpy(out + assertions_at, assertions.data(), assertions.size() * sizeof(AssertionEntry));
+        std::memcpy(out + rows_at, rows.data(), rows.size() * sizeof(uint32_t));
+        return size;
+    }
+};
+
+// SnapshotView is a mapped snapshot whose offsets, lengths and string ids were checked
+// against the size of the mapping.
+struct SnapshotView {
+    std::shared_ptr<const Mapping> mapping;
+    uint64_t string_count = 0;
+    const uint64_t* string_offsets = nullptr;
+    const uint32_t* rows = nullptr;
+    const char* characters = nullptr;
+
+    const char* String(uint32_t id, size_t& size) const {
+        size = string_offsets[id + 1] - string_offsets[id];
+        return characters + string_offsets[id];
+    }
+
+    std::string GetString(uint32_t id) const {
+        size_t size;
+        const char* data = this->String(id, size);
+        return std::string(data, size);
+    }
+};
+
+// MappedRows are the rules of an assertion of a snapshot, read from the mapping. A position
+// is the index of the field count of a rule in the rows of the snapshot.
+class MappedRows : public MappedPolicies {
+private:
+    std::shared_ptr<const SnapshotView> m_view;
+    size_t m_begin;
+    size_t m_end;
+    size_t m_count;
+
+public:
+    MappedRows(std::shared_ptr<const SnapshotView> view, size_t begin, size_t end, size_t count)
+        : m_view(std::move(view)), m_begin(begin), m_end(end), m_count(count) {}
+
+    size_t size() const override {
+        return m_count;
+    }
+
+    size_t Begin() const override {
+        return m_begin;
+    }
+
+    size_t End() const override {
+        return m_end;
+    }
+
+    size_t Next(size_t position) const override {
+        return position + m_view->rows[position] + 1;
+    }
+
+    void Read(size_t position, PolicyValues& rule) const override {
+        const uint32_t* row = m_view->rows + position;
+        rule.resize(row[0]);
+        for (uint32_t k = 0; k < row[0]; ++k) {
+            size_t size;
+            const char* data = m_view->String(row[k + 1], size);
+            rule[k].assign(data, size);
+        }
+    }
+};
+
+// OpenSnapshot checks every offset, length and string id of a mapped snapshot against the
+// size of the mapping, and returns the rows of its assertions by section and key.
+std::vector<std::pair<std::pair<std::string, std::string>, std::shared_ptr<const MappedRows>>> OpenSnapshot(std::shared_ptr<const Mapping> mapping) {
+    const char* base = static_cast<const char*>(mapping->data);
+    SegmentHeader header;
+    if (mapping->size < sizeof(header))
+        throw CasbinAdapterException("invalid shared memory policy snapshot: truncated header");
+    std::memcpy(&header, base, sizeof(header));
+    if (header.magic != s_magic || header.version != s_version || header.size > mapping->size)
+        throw CasbinAdapterException("invalid shared memory policy snapshot: bad header");
+
+    // the counts are bounded by the size first, so that the offsets below cannot overflow
+    uint64_t size = header.size;
+    if (header.string_count >= size / sizeof(uint64_t) || header.assertion_count >= size / sizeof(AssertionEntry) ||
+        header.rows_size >= size / sizeof(uint32_t) || header.characters_size > size)
+        throw CasbinAdapterException("invalid shared memory policy snapshot: sizes exceed the segment");
+    size_t strings_at = Align(sizeof(SegmentHeader));
+    size_t assertions_at = Align(strings_at + (header.string_count + 1) * sizeof(uint64_t));
+    size_t rows_at = Align(assertions_at + header.assertion_count * sizeof(AssertionEntry));
+    size_t characters_at = Align(rows_at + header.rows_size * sizeof(uint32_t));
+    if (characters_at > size || header.characters_size > size - characters_at)
+        throw CasbinAdapterException("invalid shared memory policy snapshot: sizes exceed the segment");
+
+    auto view = std::make_shared<SnapshotView>();
+    view->mapping = mapping;
+    view->string_count = header.string_count;
+    view->string_offsets = reinterpret_cast<const uint64_t*>(base + strings_at);
+    view->rows = reinterpret_cast<const uint32_t*>(base + rows_at);
+    view->characters = base + characters_at;
+    const AssertionEntry* assertions = reinterpret_cast<const AssertionEntry*>(base + assertions_at);
+
+    for (uint64_t i = 0; i < header.string_count; ++i) {
+        if (view->string_offsets[i] > view->string_offsets[i + 1])
+            throw CasbinAdapterException("invalid shared memory policy snapshot: bad string offset");
+    }
+    if (header.string_count > 0 && (view->string_offsets[0] != 0 || view->string_offsets[header.string_count] > header.characters_size))
+        throw CasbinAdapterException("invalid shared memory policy snapshot: bad string offset");
+
+    std::vector<std::pair<std::pair<std::string, std::string>, std::shared_ptr<const MappedRows>>> result;
+    result.reserve(header.assertion_count);
+    for (uint64_t i = 0; i < header.assertion_count; ++i) {
+        const AssertionEntry& entry = assertions[i];
+        if (entry.sec >= header.string_count || entry.key >= header.string_count || entry.rows_offset > header.rows_size)
+            throw CasbinAdapterException("invalid shared memory policy snapshot: bad assertion entry");
+
+        // every row must end within the rows and only name interned strings
+        uint64_t position = entry.rows_offset;
+        for (uint64_t j = 0; j < entry.row_count; ++j) {
+            if (position >= header.rows_size || view->rows[position] >= header.rows_size - position)
+                throw CasbinAdapterException("invalid shared memory policy snapshot: row out of bounds");
+            uint32_t field_count = view->rows[position];
+            for (uint32_t k = 1; k <= field_count; ++k) {
+                if (view->rows[position + k] >= header.string_count)
+                    throw CasbinAdapterException("invalid shared memory policy snapshot: bad string id");
+            }
+            position += field_count + 1;
+        }
+        result.emplace_back(std::make_pair(view->GetString(entry.sec), view->GetString(entry.key)),
+                            std::make_shared<MappedRows>(view, entry.rows_offset, position, entry.row_count));
+    }
+    return result;
+}
+
+// ReadSnapshot gives the assertions of the model the rules of a mapped snapshot. An empty
+// policy reads its rules from the mapping, rules are copied into a policy already holding
+// some.
+void ReadSnapshot(std::shared_ptr<const Mapping> mapping, const std::shared_ptr<Model>& model) {
+    for (auto& [name, rows] : OpenSnapshot(std::move(mapping))) {
+        auto sec_it = model->m.find(name.first);
+        if (sec_it == model->m.end())
+            continue;
+        auto assertion_it = sec_it->second.assertion_map.find(name.second);
+        if (assertion_it == sec_it->second.assertion_map.end())
+            continue;
+
+        PoliciesValues& policy = assertion_it->second->policy;
+        if (policy.empty()) {
+            policy = PoliciesValues::createMapped(rows);
+            continue;
+        }
+        PoliciesValues mapped = PoliciesValues::createMapped(rows);
+        for (const std::vector<std::string>& rule : mapped)
+            policy.emplace(rule);
+    }
+}
+
+// ReadGeneration reads the current generation of the store, 0 if it does not exist.
+uint64_t ReadGeneration(const std::string& name) {
+    Mapping control;
+    if (!control.Map(ControlName(name), false))
+        return 0;
+    if (control.size < sizeof(ControlBlock))
+        return 0;
+    const ControlBlock* block = static_cast<const ControlBlock*>(control.data);
+    // created by a publisher that has not initialized it yet
+    if (block->magic == 0)
+        return 0;
+    if (block->magic != s_magic || block->version != s_version)
+        throw CasbinAdapterException("invalid shared memory policy store " + name);
+    return block->generation.load(std::memory_order_acquire);
+}
+
+} // namespace
+
+// SharedMemoryAdapter is the constructor for SharedMemoryAdapter.
+SharedMemoryAdapter::SharedMemoryAdapter(const std::string& name)
+    : m_name(name), m_loaded_generation(0) {
+    this->filtered = false;
+}
+
+std::shared_ptr<SharedMemoryAdapter> SharedMemoryAdapter::NewSharedMemoryAdapter(const std::string& name) {
+    return std::make_shared<SharedMemoryAdapter>(name);
+}
+
+// Publish writes the policy of the model as a new snapshot of the store and makes it the current one.
+uint64_t SharedMemoryAdapter::Publish(const std::string& name, const std::shared_ptr<Model>& model) {
+    Mapping control;
+    if (!control.Map(ControlName(name), true, sizeof(ControlBlock)))
+        throw CasbinAdapterException("cannot create shared memory policy store " + name + ": " + std::strerror(errno));
+    ControlBlock* block = static_cast<ControlBlock*>(control.data);
+    if (block->magic == 0) {
+        block->magic = s_magic;
+        block->version = s_version;
+    } else if (block->magic != s_magic || block->version != s_version) {
+        throw CasbinAdapterException("invalid shared memory policy store " + name);
+    }
+
+    uint64_t generation = block->reserved.fetch_add(1, std::memory_order_acq_rel) + 1;
+    std::string segment_name = SegmentName(name, generation);
+
+    Snapshot snapshot(model);
+    size_t size = snapshot.Write(nullptr);
+
+    // A leftover segment of a crashed publisher must not be reused
+    shm_unlink(segment_name.c_str());
+    {
+        Mapping segment;
+        if (!segment.Map(segment_name, true, size))
+            throw CasbinAdapterException("cannot create shared memory policy snapshot " + segment_name + ": " + std::strerror(errno));
+        snapshot.Write(static_cast<char*>(segment.data));
+    }
+
+    uint64_t previous = block->generation.load(std::memory_order_acquire);
+    while (previous < generation && !block->generation.compare_exchange_weak(previous, generation, std::memory_order_acq_rel, std::memory_order_acquire)) {
+    }
+    // a publisher that reserved a later generation was faster, its snapshot stays current
+    if (previous > generation) {
+        shm_unlink(segment_name.c_str());
+        return generation;
+    }
+    if (previous > 0)
+        shm_unlink(SegmentName(name, previous).c_str());
+    return generation;
+}
+
+// Unlink removes the store. Processes that have it mapped are not affected.
+void SharedMemoryAdapter::Unlink(const std::string& name) {
+    uint64_t generation = ReadGeneration(name);
+    if (generation > 0)
+        shm_unlink(SegmentName(name, generation).c_str());
+    shm_unlink(ControlName(name).c_str());
+}
+
+// GetGeneration returns the generation of the current snapshot, 0 if none was published.
+uint64_t SharedMemoryAdapter::GetGeneration() {
+    return ReadGeneration(m_name);
+}
+
+// LoadPolicy loads all policy rules from the current snapshot. The rules are read from the
+// mapped snapshot, they are copied only into a policy that is changed.
+void SharedMemoryAdapter::LoadPolicy(const std::shared_ptr<Model>& model) {
+    for (int attempt = 0; attempt < s_max_open_attempts; ++attempt) {
+        uint64_t generation = ReadGeneration(m_name);
+        if (generation == 0)
+            throw CasbinAdapterException("no policy published in shared memory store " + m_name);
+
+        // the mapping lives as long as the rules read from it
+        auto segment = std::make_shared<Mapping>();
+        if (!segment->Map(SegmentName(m_name, generation), false)) {
+            if (errno == ENOENT)
+                continue;
+            throw CasbinAdapterException("cannot open shared memory policy snapshot: " + std::string(std::strerror(errno)));
+        }
+
+        ReadSnapshot(std::move(segment), model);
+        m_loaded_generation = generation;
+        return;
+    }
+    throw CasbinAdapterException("shared memory policy store " + m_name + " is changing too fast to be loaded");
+}
+
+#else
+
+// SharedMemoryAdapter is the constructor for SharedMemoryAdapter.
+SharedMemoryAdapter::SharedMemoryAdapter(const std::string& name)
+    : m_name(name), m_loaded_generation(0) {
+    this->filtered = false;
+}
+
+std::shared_ptr<SharedMemoryAdapter> SharedMemoryAdapter::NewSharedMemoryAdapter(const std::string& name) {
+    return std::make_shared<SharedMemoryAdapter>(name);
+}
+
+uint64_t SharedMemoryAdapter::Publish(const std::string& /*name*/, const std::shared_ptr<Model>& /*model*/) {
+    throw UnsupportedOperationException("shared memory policy stores require POSIX shared memory");
+}
+
+void SharedMemoryAdapter::Unlink(const std::string& /*name*/) {
+}
+
+uint64_t SharedMemoryAdapter::GetGeneration() {
+    return 0;
+}
+
+void SharedMemoryAdapter::LoadPolicy(const std::shared_ptr<Model>& /*model*/) {
+    throw UnsupportedOperationException("shared memory policy stores require POSIX shared memory");
+}
+
+#endif // _WIN32
+
+// GetLoadedGeneration returns the generation read by the last LoadPolicy.
+uint64_t SharedMemoryAdapter::GetLoadedGeneration() {
+    return m_loaded_generation;
+}
+
+// IsUpdated returns true if a snapshot newer than the loaded one was published.
+bool SharedMemoryAdapter::IsUpdated() {
+    return this->GetGeneration() != m_loaded_generation;
+}
+
+// SavePolicy publishes all policy rules as a new snapshot.
+void SharedMemoryAdapter::SavePolicy(const std::shared_ptr<Model>& model) {
+    m_loaded_generation = Publish(m_name, model);
+}
+
+// AddPolicy is not supported, snapshots are read-only.
+void SharedMemoryAdapter::AddPolicy(std::string /*sec*/, std::string /*p_type*/, std::vector<std::string> /*rule*/) {
+    throw UnsupportedOperationException("shared memory policy snapshots are read-only");
+}
+
+// RemovePolicy is not supported, snapshots are read-only.
+void SharedMemoryAdapter::RemovePolicy(std::string /*sec*/, std::string /*p_type*/, std::vector<std::string> /*rule*/) {
+    throw UnsupportedOperationException("shared memory policy snapshots are read-only");
+}
+
+// RemoveFilteredPolicy is not supported, snapshots are read-only.
+void SharedMemoryAdapter::RemoveFilteredPolicy(std::string /*sec*/, std::string /*p_type*/, int /*field_index*/, std::vector<std::string> /*field_values*/) {
+    throw UnsupportedOperationException("shared memory policy snapshots are read-only");
+}
+
+// IsFiltered returns true if the loaded policy has been filtered.
+bool SharedMemoryAdapter::IsFiltered() {
+    return false;
+}
+
+// IsValid returns true if the loaded policy is valid.
+bool SharedMemoryAdapter::IsValid() {
+    return true;
+}
+
+} // namespace casbin
+
+#endif // SHARED_MEMORY_ADAPTER_CPP
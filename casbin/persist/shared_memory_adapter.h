@@ -0,0 +1,105 @@
+/*
+ * Copyright 2021 The casbin Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CASBIN_CPP_PERSIST_SHARED_MEMORY_ADAPTER
+#define CASBIN_CPP_PERSIST_SHARED_MEMORY_ADAPTER
+
+#include <cstdint>
+
+#include "./adapter.h"
+
+namespace casbin {
+
+// SharedMemoryAdapter reads the policy from a snapshot kept in POSIX shared memory,
+// for prefork servers where one loader process publishes the policy and every worker
+// maps it read-only instead of querying the storage on its own.
+//
+// A store named "/name" consists of a small control segment holding the current
+// generation and one data segment "/name.<generation>" per published snapshot. The
+// snapshot interns every distinct string once and stores the rows as string ids.
+// Publishing writes a complete new data segment, switches the generation atomically
+// and unlinks the previous segment, so readers always see a whole snapshot. Each
+// publisher reserves its generation first, of concurrent publishers the one with the
+// latest generation wins.
+//
+// Loading checks the snapshot against the size of its segment, then the policy of the
+// model reads its rules from the mapping instead of copying them: the workers share one
+// copy of the rules. A policy changed locally copies its rules first. Role links and the
+// other runtime structures of an enforcer are still built per process after loading.
+//
+// Sharing the rules costs enforcement speed: each Enforce reads every rule it scans
+// from the mapping into strings, and the effect partition, domain partition and hot
+// rule order indexes are not built for a mapped policy. A worker trades enforcement
+// speed for memory: it enforces more slowly than a process owning its policy.
+class SharedMemoryAdapter : virtual public Adapter {
+private:
+    std::string m_name;
+    uint64_t m_loaded_generation;
+
+public:
+    // SharedMemoryAdapter is the constructor for SharedMemoryAdapter.
+    SharedMemoryAdapter(const std::string& name);
+
+    static std::shared_ptr<SharedMemoryAdapter> NewSharedMemoryAdapter(const std::string& name);
+
+    /**
+     * Publish writes the policy of the model as a new snapshot of the store and makes
+     * it the current one.
+     *
+     * @param name the name of the store, like "/casbin_policy".
+     * @param model the model holding the policy.
+     * @return the generation of the new snapshot.
+     */
+    static uint64_t Publish(const std::string& name, const std::shared_ptr<Model>& model);
+
+    // Unlink removes the store. Processes that have it mapped are not affected.
+    static void Unlink(const std::string& name);
+
+    // GetGeneration returns the generation of the current snapshot, 0 if none was published.
+    uint64_t GetGeneration();
+
+    // GetLoadedGeneration returns the generation read by the last LoadPolicy.
+    uint64_t GetLoadedGeneration();
+
+    // IsUpdated returns true if a snapshot newer than the loaded one was published.
+    bool IsUpdated();
+
+    // LoadPolicy loads all policy rules from the current snapshot. The rules are read from the
+    // mapped snapshot, they are copied only into a policy that is changed.
+    void LoadPolicy(const std::shared_ptr<Model>& model);
+
+    // SavePolicy publishes all policy rules as a new snapshot.
+    void SavePolicy(const std::shared_ptr<Model>& model);
+
+    // AddPolicy is not supported, snapshots are read-only.
+    void AddPolicy(std::string sec, std::string p_type, std::vector<std::string> rule);
+
+    // RemovePolicy is not supported, snapshots are read-only.
+    void RemovePolicy(std::string sec, std::string p_type, std::vector<std::string> rule);
+
+    // RemoveFilteredPolicy is not supported, snapshots are read-only.
+    void RemoveFilteredPolicy(std::string sec, std::string p_type, int field_index, std::vector<std::string> field_values);
+
+    // IsFiltered returns true if the loaded policy has been filtered.
+    bool IsFiltered();
+
+    // IsValid returns true if the loaded policy is valid.
+    bool IsValid();
+};
+
+}; // namespace casbin
+
+#endif
@@ -40,6 +40,18 @@ public:
     // UpdateForSavePolicy calls the update callback of other instances to synchronize their policy.
     // It is called after Enforcer.RemoveFilteredNamedGroupingPolicy()
     virtual void UpdateForSavePolicy(const std::shared_ptr<Model>& model) = 0;
+
+    // UpdateForAddPolicies calls the update callback of other instances to synchronize their policy.
+    // It is called after a batch of rules was added, by default it calls Update() once
+    virtual void UpdateForAddPolicies(const std::string& /*sec*/, const std::string& /*p_type*/, const PoliciesValues& /*rules*/) {
+        this->Update();
+    }
+
+    // UpdateForRemovePolicies calls the update callback of other instances to synchronize their policy.
+    // It is called after a batch of rules was removed, by default it calls Update() once
+    virtual void UpdateForRemovePolicies(const std::string& /*sec*/, const std::string& /*p_type*/, const PoliciesValues& /*rules*/) {
+        this->Update();
+    }
 };
 
 }; // namespace casbin
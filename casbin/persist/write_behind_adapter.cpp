@@ -0,0 +1,252 @@
+/*
+ * Copyright 2021 The casbin Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "casbin/pch.h"
+
+#ifndef WRITE_BEHIND_ADAPTER_CPP
+#define WRITE_BEHIND_ADAPTER_CPP
+
+#include "casbin/exception/casbin_adapter_exception.h"
+#include "casbin/exception/unsupported_operation_exception.h"
+#include "casbin/persist/write_behind_adapter.h"
+
+namespace casbin {
+
+// WriteBehindAdapter is the constructor for WriteBehindAdapter, it starts the writer thread.
+WriteBehindAdapter::WriteBehindAdapter(std::shared_ptr<Adapter> adapter, std::chrono::milliseconds interval, size_t max_batch)
+    : m_adapter(std::move(adapter)), m_interval(interval), m_max_batch(max_batch > 0 ? max_batch : 1) {
+    this->filtered = m_adapter->filtered;
+    m_writer = std::thread(&WriteBehindAdapter::Run, this);
+}
+
+std::shared_ptr<WriteBehindAdapter> WriteBehindAdapter::NewWriteBehindAdapter(std::shared_ptr<Adapter> adapter, std::chrono::milliseconds interval, size_t max_batch) {
+    return std::make_shared<WriteBehindAdapter>(std::move(adapter), interval, max_batch);
+}
+
+// ~WriteBehindAdapter stores the queued changes and stops the writer thread.
+WriteBehindAdapter::~WriteBehindAdapter() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wakeup.notify_one();
+    m_writer.join();
+}
+
+std::future<void> WriteBehindAdapter::Enqueue(policy_op op, const std::string& sec, const std::string& p_type, std::vector<std::vector<std::string>> rules, bool async) {
+    Change change{op, sec, p_type, std::move(rules), nullptr, false};
+    std::future<void> future;
+    if (async) {
+        change.promise = std::make_shared<std::promise<void>>();
+        future = change.promise->get_future();
+    }
+
+    bool due;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_queued_rules += change.rules.size();
+        m_queue.push_back(std::move(change));
+        due = m_queued_rules >= m_max_batch;
+    }
+    if (due)
+        m_wakeup.notify_one();
+    return future;
+}
+
+// Run stores the queued changes every interval, or sooner when a batch is full or a flush
+// waits, until the adapter is destroyed.
+void WriteBehindAdapter::Run() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_wakeup.wait_for(lock, m_interval, [this] {
+            return m_stopping || m_flush_requested || m_queued_rules >= m_max_batch;
+        });
+        if (m_queue.empty()) {
+            if (m_stopping)
+                return;
+            continue;
+        }
+
+        std::deque<Change> changes;
+        changes.swap(m_queue);
+        m_queued_rules = 0;
+        m_flush_requested = false;
+        lock.unlock();
+        this->Write(changes);
+        lock.lock();
+    }
+}
+
+// Write stores the changes in order, coalescing the consecutive changes of the same kind to
+// the same policy type into batches of at most m_max_batch rules.
+void WriteBehindAdapter::Write(std::deque<Change>& changes) {
+    size_t begin = 0;
+    while (begin < changes.size()) {
+        const Change& first = changes[begin];
+        if (first.flush) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_unreported_errors == 0) {
+                first.promise->set_value();
+            } else {
+                first.promise->set_exception(std::make_exception_ptr(CasbinAdapterException(std::to_string(m_unreported_errors) + " policy changes failed to be stored")));
+                m_unreported_errors = 0;
+            }
+            ++begin;
+            continue;
+        }
+
+        PoliciesValues rules;
+        size_t end = begin;
+        while (end < changes.size() && !changes[end].flush && changes[end].op == first.op && changes[end].sec == first.sec &&
+               changes[end].p_type == first.p_type && (end == begin || rules.size() + changes[end].rules.size() <= m_max_batch)) {
+            for (auto& rule : changes[end].rules)
+                rules.emplace(std::move(rule));
+            ++end;
+        }
+
+        std::exception_ptr error = this->Store(first.op, first.sec, first.p_type, rules);
+        for (size_t i = begin; i < end; i++) {
+            if (changes[i].promise == nullptr)
+                continue;
+            if (error)
+                changes[i].promise->set_exception(error);
+            else
+                changes[i].promise->set_value();
+        }
+        if (error) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_errors.push_back({first.op, first.sec, first.p_type, std::move(rules), error});
+            m_unreported_errors += end - begin;
+        }
+        begin = end;
+    }
+}
+
+std::exception_ptr WriteBehindAdapter::Store(policy_op op, const std::string& sec, const std::string& p_type, const PoliciesValues& rules) {
+    try {
+        auto batch_adapter = std::dynamic_pointer_cast<BatchAdapter>(m_adapter);
+        if (batch_adapter != nullptr && op == policy_add) {
+            batch_adapter->AddPolicies(sec, p_type, rules);
+        } else if (batch_adapter != nullptr) {
+            batch_adapter->RemovePolicies(sec, p_type, rules);
+        } else {
+            for (const auto& rule : rules) {
+                if (op == policy_add)
+                    m_adapter->AddPolicy(sec, p_type, rule);
+                else
+                    m_adapter->RemovePolicy(sec, p_type, rule);
+            }
+        }
+    } catch (const UnsupportedOperationException&) {
+    } catch (...) {
+        return std::current_exception();
+    }
+    return nullptr;
+}
+
+// LoadPolicy loads all policy rules from the adapter once the queued changes are stored.
+void WriteBehindAdapter::LoadPolicy(const std::shared_ptr<Model>& model) {
+    this->Flush().get();
+    m_adapter->LoadPolicy(model);
+    this->filtered = m_adapter->filtered;
+}
+
+// SavePolicy saves all policy rules to the adapter once the queued changes are stored.
+void WriteBehindAdapter::SavePolicy(const std::shared_ptr<Model>& model) {
+    this->Flush().get();
+    m_adapter->SavePolicy(model);
+}
+
+// AddPolicy queues adding a policy rule.
+void WriteBehindAdapter::AddPolicy(std::string sec, std::string p_type, std::vector<std::string> rule) {
+    this->Enqueue(policy_add, sec, p_type, {std::move(rule)}, false);
+}
+
+// RemovePolicy queues removing a policy rule.
+void WriteBehindAdapter::RemovePolicy(std::string sec, std::string p_type, std::vector<std::string> rule) {
+    this->Enqueue(policy_remove, sec, p_type, {std::move(rule)}, false);
+}
+
+// AddPolicies queues adding policy rules.
+void WriteBehindAdapter::AddPolicies(std::string sec, std::string p_type, PoliciesValues rules) {
+    this->Enqueue(policy_add, sec, p_type, std::vector<std::vector<std::string>>(rules.begin(), rules.end()), false);
+}
+
+// RemovePolicies queues removing policy rules.
+void WriteBehindAdapter::RemovePolicies(std::string sec, std::string p_type, PoliciesValues rules) {
+    this->Enqueue(policy_remove, sec, p_type, std::vector<std::vector<std::string>>(rules.begin(), rules.end()), false);
+}
+
+// RemoveFilteredPolicy removes the matching policy rules through the adapter once the
+// queued changes are stored.
+void WriteBehindAdapter::RemoveFilteredPolicy(std::string sec, std::string p_type, int field_index, std::vector<std::string> field_values) {
+    this->Flush().get();
+    m_adapter->RemoveFilteredPolicy(sec, p_type, field_index, field_values);
+}
+
+std::future<void> WriteBehindAdapter::AddPolicyAsync(std::string sec, std::string p_type, std::vector<std::string> rule) {
+    return this->Enqueue(policy_add, sec, p_type, {std::move(rule)}, true);
+}
+
+std::future<void> WriteBehindAdapter::RemovePolicyAsync(std::string sec, std::string p_type, std::vector<std::string> rule) {
+    return this->Enqueue(policy_remove, sec, p_type, {std::move(rule)}, true);
+}
+
+std::future<void> WriteBehindAdapter::AddPoliciesAsync(std::string sec, std::string p_type, PoliciesValues rules) {
+    return this->Enqueue(policy_add, sec, p_type, std::vector<std::vector<std::string>>(rules.begin(), rules.end()), true);
+}
+
+std::future<void> WriteBehindAdapter::RemovePoliciesAsync(std::string sec, std::string p_type, PoliciesValues rules) {
+    return this->Enqueue(policy_remove, sec, p_type, std::vector<std::vector<std::string>>(rules.begin(), rules.end()), true);
+}
+
+// Flush returns a future that is ready once every change queued before the call is stored.
+// It holds a CasbinAdapterException if changes failed since the previous flush.
+std::future<void> WriteBehindAdapter::Flush() {
+    Change flush;
+    flush.flush = true;
+    flush.promise = std::make_shared<std::promise<void>>();
+    std::future<void> future = flush.promise->get_future();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_queue.push_back(std::move(flush));
+        m_flush_requested = true;
+    }
+    m_wakeup.notify_one();
+    return future;
+}
+
+// TakeErrors returns the changes that failed to be stored and forgets them.
+std::vector<WriteBehindAdapter::WriteError> WriteBehindAdapter::TakeErrors() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<WriteError> errors;
+    errors.swap(m_errors);
+    return errors;
+}
+
+// IsFiltered returns true if the loaded policy has been filtered.
+bool WriteBehindAdapter::IsFiltered() {
+    return m_adapter->IsFiltered();
+}
+
+// IsValid returns true if the adapter is valid.
+bool WriteBehindAdapter::IsValid() {
+    return m_adapter->IsValid();
+}
+
+} // namespace casbin
+
+#endif // WRITE_BEHIND_ADAPTER_CPP
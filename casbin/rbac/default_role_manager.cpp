@@ -17,11 +17,18 @@
 #ifndef DEFAULT_ROLE_MANAGER_CPP
 #define DEFAULT_ROLE_MANAGER_CPP
 
+#include <unordered_set>
+
 #include "casbin/exception/casbin_rbac_exception.h"
 #include "casbin/rbac/default_role_manager.h"
+#include "casbin/util/memory_resource.h"
 
 namespace casbin {
 
+Role::Role(const allocator_type& allocator)
+    : roles(allocator) {
+}
+
 std::unique_ptr<Role> Role :: NewRole(const std::string& name) {
     auto role = std::make_unique<Role>();
     role->name = name;
@@ -98,6 +105,10 @@ std::vector<std::string> Role ::GetRoles() {
     return names;
 }
 
+size_t Role ::GetMemoryUsage() const {
+    return roles.capacity() * sizeof(Role*) + HeapBytes(name);
+}
+
 bool DefaultRoleManager ::HasRole(std::string name) {
     bool ok = false;
     if (this->has_pattern) {
@@ -112,27 +123,15 @@ bool DefaultRoleManager ::HasRole(std::string name) {
 }
 
 Role* DefaultRoleManager ::CreateRole(const std::string& name) {
-    Role* role;
-    bool ok = this->all_roles.find(name) != this->all_roles.end();
-    if (!ok) {
-        all_roles[name] = Role ::NewRole(name);
-        role = all_roles[name].get();
-    } else
-        role = all_roles[name].get();
+    auto [role_it, created] = this->all_roles.try_emplace(name);
+    Role* role = &role_it->second;
+    if (created)
+        role->name = name;
 
     if (this->has_pattern) {
         for (auto it = this->all_roles.begin(); it != this->all_roles.end(); it++) {
-            if (this->matching_func(name, it->first) && name != it->first) {
-                Role* role1 = nullptr;
-                bool ok1 = this->all_roles.find(it->first) != this->all_roles.end();
-                if (!ok1) {
-                    all_roles[it->first] = Role ::NewRole(it->first);
-                    role1 = all_roles[it->first].get();
-                } else
-                    role1 = all_roles[it->first].get();
-
-                role->AddRole(role1);
-            }
+            if (this->matching_func(name, it->first) && name != it->first)
+                role->AddRole(&it->second);
         }
     }
 
@@ -145,7 +144,8 @@ Role* DefaultRoleManager ::CreateRole(const std::string& name) {
  *
  * @param max_hierarchy_level the maximized allowed RBAC hierarchy level.
  */
-DefaultRoleManager ::DefaultRoleManager(int max_hierarchy_level) {
+DefaultRoleManager ::DefaultRoleManager(int max_hierarchy_level, std::pmr::memory_resource* resource)
+    : all_roles(resource) {
     this->max_hierarchy_level = max_hierarchy_level;
     this->has_pattern = false;
 }
@@ -158,6 +158,43 @@ void DefaultRoleManager ::AddMatchingFunc(MatchingFunc fn) {
     this->matching_func = fn;
 }
 
+// HasPattern returns true if role names are matched with a matching function.
+bool DefaultRoleManager ::HasPattern() {
+    return this->has_pattern;
+}
+
+// GetMaxHierarchyLevel returns the longest inheritance chain HasLink follows.
+int DefaultRoleManager ::GetMaxHierarchyLevel() {
+    return this->max_hierarchy_level;
+}
+
+// GetMemoryUsage estimates the bytes of the role graph from the buckets and nodes of the map
+// of the roles and what each role holds.
+size_t DefaultRoleManager ::GetMemoryUsage() const {
+    size_t bytes = all_roles.bucket_count() * sizeof(void*);
+    for (const auto& [name, role] : all_roles)
+        bytes += sizeof(std::pair<const std::string, Role>) + 2 * sizeof(void*) + HeapBytes(name) + role.GetMemoryUsage();
+    return bytes;
+}
+
+std::shared_ptr<DefaultRoleManager> DefaultRoleManager ::Copy() const {
+    auto copy = std::make_shared<DefaultRoleManager>(this->max_hierarchy_level, this->all_roles.get_allocator().resource());
+    copy->has_pattern = this->has_pattern;
+    copy->matching_func = this->matching_func;
+
+    copy->all_roles.reserve(this->all_roles.size());
+    for (const auto& [name, role] : this->all_roles)
+        copy->all_roles.try_emplace(name).first->second.name = role.name;
+    // the links are set once every role exists, the nodes of the map do not move
+    for (const auto& [name, role] : this->all_roles) {
+        Role& copied = copy->all_roles.find(name)->second;
+        copied.roles.reserve(role.roles.size());
+        for (const Role* linked : role.roles)
+            copied.roles.push_back(&copy->all_roles.find(linked->name)->second);
+    }
+    return copy;
+}
+
 /**
  * clear clears all stored data and resets the role manager to the initial state.
  */
@@ -247,6 +284,42 @@ std::vector<std::string> DefaultRoleManager ::GetRoles(std::string name, std::ve
     return roles;
 }
 
+// GetInheritedRoles sets roles to the names HasLink links name to, within the hierarchy
+// level and without the domain prefix, name included when it is a role. It returns false when a matching function is used,
+// the links must then be asked with HasLink.
+bool DefaultRoleManager ::GetInheritedRoles(const std::string& name, const std::vector<std::string>& domain, std::vector<std::string>& roles) {
+    roles.clear();
+    if (this->has_pattern)
+        return false;
+    if (domain.size() > 1)
+        throw CasbinRBACException("error: domain should be 1 parameter");
+    std::string prefix = domain.size() == 1 ? domain[0] + "::" : "";
+
+    auto role_it = this->all_roles.find(prefix + name);
+    if (role_it == this->all_roles.end())
+        return true;
+
+    // breadth first, so that every role is reached at its lowest level
+    std::unordered_set<const Role*> visited = {&role_it->second};
+    std::vector<const Role*> level = {&role_it->second};
+    for (int hierarchy_level = 0; hierarchy_level < max_hierarchy_level && !level.empty(); hierarchy_level++) {
+        std::vector<const Role*> next;
+        for (const Role* role : level) {
+            for (const Role* inherited : role->roles) {
+                if (visited.insert(inherited).second)
+                    next.push_back(inherited);
+            }
+        }
+        level = std::move(next);
+    }
+
+    for (const Role* role : visited) {
+        if (role->name.compare(0, prefix.size(), prefix) == 0)
+            roles.push_back(role->name.substr(prefix.size()));
+    }
+    return true;
+}
+
 std::vector<std::string> DefaultRoleManager ::GetUsers(std::string name, std::vector<std::string> domain) {
     if (domain.size() == 1)
         name = domain[0] + "::" + name;
@@ -258,7 +331,7 @@ std::vector<std::string> DefaultRoleManager ::GetUsers(std::string name, std::ve
 
     std::vector<std::string> names;
     for (auto it = this->all_roles.begin(); it != this->all_roles.end(); it++) {
-        auto role = it->second.get();
+        auto role = &it->second;
         if (role->HasDirectRole(name))
             names.push_back(role->name);
     }
@@ -281,11 +354,11 @@ void DefaultRoleManager ::PrintRoles() {
     // Logger *logger = &df_logger;
     // LogUtil::SetLogger(*logger);
 
-    std::string text = this->all_roles.begin()->second->ToString();
+    std::string text = this->all_roles.begin()->second.ToString();
     auto it = this->all_roles.begin();
     it++;
     for (; it != this->all_roles.end(); it++)
-        text += ", " + it->second->ToString();
+        text += ", " + it->second.ToString();
     // LogUtil::LogPrint(text);
 }
 
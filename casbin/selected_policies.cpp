@@ -17,19 +17,19 @@
 #include "casbin/selected_policies.h"
 
 
-std::vector<std::string> SelectedPolicies::requestedPolicy()
+const std::vector<std::string>& SelectedPolicies::requestedPolicy()
 {
-    auto policy_tokens = model->m["r"].assertion_map["r"]->tokens;
-    std::vector<std::string> ret;
-    ret.reserve(policy_tokens.size());
+    const auto& policy_tokens = model->m["r"].assertion_map["r"]->tokens;
+    // the strings of the buffer keep their capacity from one request to the next
+    thread_local std::vector<std::string> ret;
+    ret.resize(policy_tokens.size());
 
-    auto request_tokens_values_map = evaluator->requestValues();
-
-    for(const auto& p : policy_tokens)
+    for(size_t i = 0; i < policy_tokens.size(); ++i)
     {
+        const auto& p = policy_tokens[i];
         auto token = p.substr(2, p.size() - 2); // "p_token" -> "token"
-        if (auto it = request_tokens_values_map.find(token); it != request_tokens_values_map.end()) {
-            ret.emplace_back(it->second);
+        if (const std::string* value = evaluator->GetObjectString("r", token); value != nullptr) {
+            ret[i].assign(*value);
             continue;
         }
         throw std::logic_error("request and policy tokens names missmatch:" + p);
@@ -45,11 +45,21 @@ SelectedPolicies::SelectedPolicies(
 PoliciesValues& SelectedPolicies::operator*() {
     auto& policies = model->m["p"].assertion_map["p"]->policy;
     if (policies.is_hash()) {
-        if (auto policy_it = policies.find(requestedPolicy()); policy_it != policies.end()) {
-        	selected_policies = PoliciesValues({*policy_it});
+        if (const PolicyValues* rule = Find(); rule != nullptr) {
+        	selected_policies = PoliciesValues({*rule});
 	}
         return selected_policies;
     } 
     return policies;
 }
 
+bool SelectedPolicies::IsHashed() const {
+    return model->m["p"].assertion_map["p"]->policy.is_hash();
+}
+
+const PolicyValues* SelectedPolicies::Find() {
+    auto& policies = model->m["p"].assertion_map["p"]->policy;
+    if (auto policy_it = policies.find(requestedPolicy()); policy_it != policies.end())
+        return &*policy_it;
+    return nullptr;
+}
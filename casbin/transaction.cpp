@@ -0,0 +1,356 @@
+/*
+ * Copyright 2021 The casbin Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "casbin/pch.h"
+
+#ifndef TRANSACTION_CPP
+#define TRANSACTION_CPP
+
+#include "casbin/transaction.h"
+#include "casbin/exception/unsupported_operation_exception.h"
+#include "casbin/persist/batch_adapter.h"
+#include "casbin/persist/watcher_ex.h"
+
+namespace casbin {
+
+Transaction::Transaction(Enforcer& e)
+    : m_enforcer(&e) {
+}
+
+bool Transaction::PolicyChanges::RuleEqual::operator()(const std::vector<std::string>& a, const std::vector<std::string>& b) const {
+    return a.size() == b.size() && std::is_permutation(a.begin(), a.end(), b.begin());
+}
+
+size_t Transaction::PolicyChanges::RuleRefHash::operator()(const std::vector<std::string>* rule) const {
+    return std::hash<std::vector<std::string>>{}(*rule);
+}
+
+bool Transaction::PolicyChanges::RuleRefEqual::operator()(const std::vector<std::string>* a, const std::vector<std::string>* b) const {
+    return RuleEqual{}(*a, *b);
+}
+
+// HasPolicy returns true if the policy holds the rule now. The policy is indexed once and
+// again only after it changed, a mapped policy is scanned since its rules have no address.
+bool Transaction::PolicyChanges::HasPolicy(Model& m, const std::vector<std::string>& rule) {
+    const PoliciesValues& policy = m.m[sec].assertion_map[p_type]->policy;
+    if (policy.is_mapped())
+        return m.HasPolicy(sec, p_type, rule);
+    if (m_policy.empty() || policy.generation() != m_generation || policy.size() != m_size) {
+        m_policy.clear();
+        m_policy.reserve(policy.size());
+        for (const std::vector<std::string>& policy_rule : policy)
+            m_policy.insert(&policy_rule);
+        m_generation = policy.generation();
+        m_size = policy.size();
+    }
+    return m_policy.count(&rule) != 0;
+}
+
+// Holds returns true if the policy holds the rule once changed.
+bool Transaction::PolicyChanges::Holds(Model& m, const std::vector<std::string>& rule) {
+    if (added.count(rule) != 0)
+        return true;
+    return removed.count(rule) == 0 && this->HasPolicy(m, rule);
+}
+
+// Apply applies the operation to the changes, false if the policy once changed does not
+// allow it.
+bool Transaction::PolicyChanges::Apply(Model& m, const Operation& operation) {
+    auto add = [&](const std::vector<std::string>& rule) {
+        if (this->Holds(m, rule))
+            return false;
+        // a removed rule added again is left in place
+        if (removed.erase(rule) == 0)
+            added.emplace(rule, staged++);
+        return true;
+    };
+    auto remove = [&](const std::vector<std::string>& rule) {
+        if (!this->Holds(m, rule))
+            return false;
+        if (added.erase(rule) == 0)
+            removed.emplace(rule, staged++);
+        return true;
+    };
+
+    switch (operation.type) {
+        case OperationType::Add:
+            return add(operation.rule);
+        case OperationType::Remove:
+            return remove(operation.rule);
+        case OperationType::Update:
+            return !this->Holds(m, operation.new_rule) && remove(operation.rule) && add(operation.new_rule);
+    }
+    return false;
+}
+
+// Stage checks the operation against the policy through the enforcer, which locks the
+// policy it reads if it is shared between threads.
+bool Transaction::Stage(OperationType type, const std::string& sec, const std::string& p_type, const std::vector<std::string>& rule, const std::vector<std::string>& new_rule) {
+    Operation operation{type, sec, p_type, rule, new_rule};
+    auto stage = [&](Model& m) {
+        if (!m.HasSection(sec) || m.m[sec].assertion_map.count(p_type) == 0)
+            return false;
+        auto [it, inserted] = m_changes.try_emplace(sec + "." + p_type);
+        if (inserted) {
+            it->second.sec = sec;
+            it->second.p_type = p_type;
+        }
+        return it->second.Apply(m, operation);
+    };
+    if (!(m_locked ? m_enforcer->Enforcer::stageTransaction(stage) : m_enforcer->stageTransaction(stage)))
+        return false;
+    m_operations.push_back(std::move(operation));
+    return true;
+}
+
+// AddPolicy stages adding an authorization rule, false if the policy will already have it.
+bool Transaction::AddPolicy(const std::vector<std::string>& params) {
+    return this->AddNamedPolicy("p", params);
+}
+
+bool Transaction::AddNamedPolicy(const std::string& p_type, const std::vector<std::string>& params) {
+    return this->Stage(OperationType::Add, "p", p_type, params);
+}
+
+// RemovePolicy stages removing an authorization rule, false if the policy will not have it.
+bool Transaction::RemovePolicy(const std::vector<std::string>& params) {
+    return this->RemoveNamedPolicy("p", params);
+}
+
+bool Transaction::RemoveNamedPolicy(const std::string& p_type, const std::vector<std::string>& params) {
+    return this->Stage(OperationType::Remove, "p", p_type, params);
+}
+
+// UpdatePolicy stages replacing an authorization rule.
+bool Transaction::UpdatePolicy(const std::vector<std::string>& old_params, const std::vector<std::string>& new_params) {
+    return this->UpdateNamedPolicy("p", old_params, new_params);
+}
+
+bool Transaction::UpdateNamedPolicy(const std::string& p_type, const std::vector<std::string>& old_params, const std::vector<std::string>& new_params) {
+    return this->Stage(OperationType::Update, "p", p_type, old_params, new_params);
+}
+
+// AddGroupingPolicy stages adding a role inheritance rule.
+bool Transaction::AddGroupingPolicy(const std::vector<std::string>& params) {
+    return this->AddNamedGroupingPolicy("g", params);
+}
+
+bool Transaction::AddNamedGroupingPolicy(const std::string& p_type, const std::vector<std::string>& params) {
+    return this->Stage(OperationType::Add, "g", p_type, params);
+}
+
+// RemoveGroupingPolicy stages removing a role inheritance rule.
+bool Transaction::RemoveGroupingPolicy(const std::vector<std::string>& params) {
+    return this->RemoveNamedGroupingPolicy("g", params);
+}
+
+bool Transaction::RemoveNamedGroupingPolicy(const std::string& p_type, const std::vector<std::string>& params) {
+    return this->Stage(OperationType::Remove, "g", p_type, params);
+}
+
+// GetOperations returns the staged operations in order.
+const std::vector<Transaction::Operation>& Transaction::GetOperations() const {
+    return m_operations;
+}
+
+// Commit applies the staged operations to the enforcer. It returns false and leaves the
+// policy unchanged if an operation no longer applies. The transaction is empty afterwards.
+bool Transaction::Commit() {
+    bool committed;
+    try {
+        committed = m_enforcer->CommitTransaction(*this);
+    } catch (...) {
+        this->Rollback();
+        throw;
+    }
+    this->Rollback();
+    return committed;
+}
+
+// Rollback discards the staged operations.
+void Transaction::Rollback() {
+    m_operations.clear();
+    m_changes.clear();
+}
+
+namespace {
+
+// PolicyWrites are the net changes of a transaction to one policy type, written in the
+// order they were staged.
+struct PolicyWrites {
+    std::string sec;
+    std::string p_type;
+    PoliciesValues added;
+    PoliciesValues removed;
+};
+
+PoliciesValues InStagedOrder(const Transaction::PolicyChanges::StagedRules& staged) {
+    std::vector<std::pair<size_t, const std::vector<std::string>*>> order;
+    order.reserve(staged.size());
+    for (const auto& [rule, operation] : staged)
+        order.emplace_back(operation, &rule);
+    std::sort(order.begin(), order.end());
+
+    PoliciesValues rules;
+    rules.reserve(order.size());
+    for (const auto& [operation, rule] : order)
+        rules.emplace(*rule);
+    return rules;
+}
+
+} // namespace
+
+// BeginTransaction starts staging policy changes to commit at once.
+Transaction Enforcer::BeginTransaction() {
+    return Transaction(*this);
+}
+
+// stageTransaction calls stage with the model a transaction stages its operations against,
+// and returns its result.
+bool Enforcer::stageTransaction(const std::function<bool(Model&)>& stage) {
+    return stage(*m_model);
+}
+
+// CommitTransaction applies the operations staged in the transaction. Like UpdatePolicy,
+// it appends added and updated rules to the policy.
+bool Enforcer::CommitTransaction(Transaction& transaction) {
+    std::vector<Transaction::PolicyChanges> changes;
+    std::unordered_map<std::string, size_t> change_index;
+
+    // replay the operations against the current policy, nothing is modified before all apply
+    for (const Transaction::Operation& operation : transaction.GetOperations()) {
+        std::string key = operation.sec + "." + operation.p_type;
+        auto it = change_index.find(key);
+        if (it == change_index.end()) {
+            if (!m_model->HasSection(operation.sec) || m_model->m[operation.sec].assertion_map.count(operation.p_type) == 0)
+                return false;
+            Transaction::PolicyChanges policy_changes;
+            policy_changes.sec = operation.sec;
+            policy_changes.p_type = operation.p_type;
+            it = change_index.emplace(key, changes.size()).first;
+            changes.push_back(std::move(policy_changes));
+        }
+        if (!changes[it->second].Apply(*m_model, operation))
+            return false;
+    }
+
+    // the net rules of each policy type in the order they were staged
+    std::vector<PolicyWrites> writes;
+    writes.reserve(changes.size());
+    for (const Transaction::PolicyChanges& policy_changes : changes)
+        writes.push_back({policy_changes.sec, policy_changes.p_type, InStagedOrder(policy_changes.added), InStagedOrder(policy_changes.removed)});
+
+    // the changes applied to the model, undone in reverse order if a later step fails, and
+    // the writes to the adapter: a batch of rules, or a single rule without a BatchAdapter
+    size_t applied = 0;
+    std::vector<std::tuple<policy_op, const PolicyWrites*, const PoliciesValues*, const std::vector<std::string>*>> written;
+    auto restore = [&]() {
+        for (auto it = written.rbegin(); it != written.rend(); ++it) {
+            const auto& [op, policy_changes, rules, rule] = *it;
+            try {
+                if (rule != nullptr) {
+                    if (op == policy_add)
+                        m_adapter->RemovePolicy(policy_changes->sec, policy_changes->p_type, *rule);
+                    else
+                        m_adapter->AddPolicy(policy_changes->sec, policy_changes->p_type, *rule);
+                    continue;
+                }
+                auto batch_adapter = std::dynamic_pointer_cast<BatchAdapter>(m_adapter);
+                if (op == policy_add)
+                    batch_adapter->RemovePolicies(policy_changes->sec, policy_changes->p_type, *rules);
+                else
+                    batch_adapter->AddPolicies(policy_changes->sec, policy_changes->p_type, *rules);
+            } catch (...) {
+            }
+        }
+        for (size_t i = applied; i-- > 0;) {
+            const PolicyWrites& policy_changes = writes[i];
+            if (!policy_changes.added.empty())
+                m_model->RemovePolicies(policy_changes.sec, policy_changes.p_type, policy_changes.added);
+            if (!policy_changes.removed.empty())
+                m_model->AddPolicies(policy_changes.sec, policy_changes.p_type, policy_changes.removed);
+        }
+        Enforcer::BuildRoleLinks();
+    };
+
+    try {
+        for (const PolicyWrites& policy_changes : writes) {
+            if (!policy_changes.removed.empty())
+                m_model->RemovePolicies(policy_changes.sec, policy_changes.p_type, policy_changes.removed);
+            if (!policy_changes.added.empty())
+                m_model->AddPolicies(policy_changes.sec, policy_changes.p_type, policy_changes.added);
+            ++applied;
+        }
+
+        for (const PolicyWrites& policy_changes : writes) {
+            if (policy_changes.sec == "g") {
+                this->BuildIncrementalRoleLinks(policy_remove, policy_changes.p_type, policy_changes.removed);
+                this->BuildIncrementalRoleLinks(policy_add, policy_changes.p_type, policy_changes.added);
+            }
+            this->updateIndexes(policy_remove, policy_changes.sec, policy_changes.p_type, policy_changes.removed);
+            this->updateIndexes(policy_add, policy_changes.sec, policy_changes.p_type, policy_changes.added);
+
+            if (!m_adapter || !m_auto_save)
+                continue;
+            try {
+                auto batch_adapter = std::dynamic_pointer_cast<BatchAdapter>(m_adapter);
+                if (batch_adapter != nullptr) {
+                    if (!policy_changes.removed.empty()) {
+                        batch_adapter->RemovePolicies(policy_changes.sec, policy_changes.p_type, policy_changes.removed);
+                        written.emplace_back(policy_remove, &policy_changes, &policy_changes.removed, nullptr);
+                    }
+                    if (!policy_changes.added.empty()) {
+                        batch_adapter->AddPolicies(policy_changes.sec, policy_changes.p_type, policy_changes.added);
+                        written.emplace_back(policy_add, &policy_changes, &policy_changes.added, nullptr);
+                    }
+                } else {
+                    for (const auto& rule : policy_changes.removed) {
+                        m_adapter->RemovePolicy(policy_changes.sec, policy_changes.p_type, rule);
+                        written.emplace_back(policy_remove, &policy_changes, nullptr, &rule);
+                    }
+                    for (const auto& rule : policy_changes.added) {
+                        m_adapter->AddPolicy(policy_changes.sec, policy_changes.p_type, rule);
+                        written.emplace_back(policy_add, &policy_changes, nullptr, &rule);
+                    }
+                }
+            } catch (const UnsupportedOperationException&) {
+            }
+        }
+    } catch (...) {
+        restore();
+        throw;
+    }
+
+    // a WatcherEx hears of each batch of rules the commit changed
+    if (m_watcher && m_auto_notify_watcher) {
+        auto watcher_ex = std::dynamic_pointer_cast<WatcherEx>(m_watcher);
+        if (watcher_ex != nullptr) {
+            for (const PolicyWrites& policy_changes : writes) {
+                if (!policy_changes.removed.empty())
+                    watcher_ex->UpdateForRemovePolicies(policy_changes.sec, policy_changes.p_type, policy_changes.removed);
+                if (!policy_changes.added.empty())
+                    watcher_ex->UpdateForAddPolicies(policy_changes.sec, policy_changes.p_type, policy_changes.added);
+            }
+        } else
+            m_watcher->Update();
+    }
+
+    return true;
+}
+
+} // namespace casbin
+
+#endif // TRANSACTION_CPP
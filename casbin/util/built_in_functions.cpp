@@ -21,6 +21,7 @@
 
 #include <map>
 #include <regex>
+#include <unordered_map>
 
 #include "casbin/exception/illegal_argument_exception.h"
 #include "casbin/ip_parser/parser/CIDR.h"
@@ -61,9 +62,9 @@ bool KeyMatch(const std::string& key1, const std::string& key2) {
         return key1 == key2;
 
     if (key1.length() > pos)
-        return key1.substr(0, pos) == key2.substr(0, pos);
+        return key1.compare(0, pos, key2, 0, pos) == 0;
 
-    return key1 == key2.substr(0, pos);
+    return key1.length() == pos && key2.compare(0, pos, key1) == 0;
 }
 
 // KeyGet returns the matched part
@@ -199,8 +200,16 @@ bool KeyMatch4(const std::string& key1, const std::string& key2) {
 
 // RegexMatch determines whether key1 matches the pattern of key2 in regular expression.
 bool RegexMatch(const std::string& key1, const std::string& key2) {
-    std::regex regex_s(key2);
-    return std::regex_match(key1, regex_s);
+    // the patterns come from the policy, each thread compiles each of them once
+    constexpr size_t kMaxCachedPatterns = 1024;
+    thread_local std::unordered_map<std::string, std::regex> compiled;
+    auto it = compiled.find(key2);
+    if (it == compiled.end()) {
+        if (compiled.size() >= kMaxCachedPatterns)
+            compiled.clear();
+        it = compiled.emplace(key2, std::regex(key2)).first;
+    }
+    return std::regex_match(key1, it->second);
 }
 
 // IPMatch determines whether IP address ip1 matches the pattern of IP address ip2, ip2 can be an IP address or a CIDR pattern.
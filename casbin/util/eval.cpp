@@ -19,6 +19,8 @@
 #ifndef EVAL_CPP
 #define EVAL_CPP
 
+#include <algorithm>
+#include <cctype>
 #include <regex>
 
 #include "casbin/util/util.h"
@@ -30,6 +32,13 @@ std::regex evalReg("\\beval\\(([^)]*)\\)",
 
 // HasEval determine whether matcher contains function eval
 bool HasEval(const std::string& s) {
+    // most matchers have no "eval(" at all, those are answered without running the regex
+    static const std::string call = "eval(";
+    auto it = std::search(s.begin(), s.end(), call.begin(), call.end(), [](char a, char b) {
+        return std::tolower(static_cast<unsigned char>(a)) == b;
+    });
+    if (it == s.end())
+        return false;
     return std::regex_search(s, evalReg);
 }
 
@@ -0,0 +1,254 @@
+/*
+ * Copyright 2021 The casbin Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "casbin/pch.h"
+
+#ifndef MEMORY_RESOURCE_CPP
+#define MEMORY_RESOURCE_CPP
+
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <unordered_map>
+#include <utility>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+#include "casbin/util/memory_resource.h"
+
+namespace casbin {
+
+AccountingResource::AccountingResource(std::pmr::memory_resource* upstream)
+    : m_upstream(upstream) {
+}
+
+void* AccountingResource::do_allocate(size_t bytes, size_t alignment) {
+    void* p = m_upstream->allocate(bytes, alignment);
+    size_t in_use = m_bytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    size_t peak = m_peak_bytes.load(std::memory_order_relaxed);
+    while (peak < in_use && !m_peak_bytes.compare_exchange_weak(peak, in_use, std::memory_order_relaxed)) {
+    }
+    return p;
+}
+
+void AccountingResource::do_deallocate(void* p, size_t bytes, size_t alignment) {
+    m_upstream->deallocate(p, bytes, alignment);
+    m_bytes.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+bool AccountingResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+    return this == &other;
+}
+
+size_t AccountingResource::GetBytes() const {
+    return m_bytes.load(std::memory_order_relaxed);
+}
+
+size_t AccountingResource::GetPeakBytes() const {
+    return m_peak_bytes.load(std::memory_order_relaxed);
+}
+
+std::pmr::memory_resource* AccountingResource::GetUpstream() const {
+    return m_upstream;
+}
+
+// RegionResource maps the memory of a HugePageResource. Blocks below kOwnMappingSize are
+// carved from 2 MiB regions and only given back with the regions, the pool in front of it
+// recycles them. Larger blocks get mappings of their own, or come from the upstream heap when
+// they are aligned on more than a page.
+class HugePageResource::RegionResource : public std::pmr::memory_resource {
+private:
+    static constexpr size_t kRegionSize = size_t(2) << 20;
+    static constexpr size_t kPageSize = 4096;
+    static constexpr size_t kOwnMappingSize = size_t(64) << 10;
+
+    struct Mapping {
+        void* address;
+        size_t size;
+        bool huge;
+    };
+
+    mutable std::mutex m_mutex;
+    std::vector<Mapping> m_regions;
+    std::unordered_map<void*, Mapping> m_own_mappings;
+    std::pmr::memory_resource* m_upstream = std::pmr::new_delete_resource();
+    std::unordered_map<void*, std::pair<size_t, size_t>> m_upstream_blocks;
+    std::byte* m_cursor = nullptr;
+    size_t m_available = 0;
+    size_t m_mapped_bytes = 0;
+    size_t m_huge_page_bytes = 0;
+
+    static Mapping Map(size_t size) {
+#ifdef __linux__
+        if (size % kRegionSize == 0) {
+            void* p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            if (p != MAP_FAILED)
+                return {p, size, true};
+        }
+        // no huge pages are reserved, fall back to transparent huge pages
+        void* p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED)
+            throw std::bad_alloc();
+        if (size >= kRegionSize)
+            madvise(p, size, MADV_HUGEPAGE);
+        return {p, size, false};
+#else
+        return {::operator new(size, std::align_val_t(kPageSize)), size, false};
+#endif
+    }
+
+    static void Unmap(const Mapping& mapping) {
+#ifdef __linux__
+        munmap(mapping.address, mapping.size);
+#else
+        ::operator delete(mapping.address, std::align_val_t(kPageSize));
+#endif
+    }
+
+    void Track(const Mapping& mapping) {
+        m_mapped_bytes += mapping.size;
+        if (mapping.huge)
+            m_huge_page_bytes += mapping.size;
+    }
+
+    void Untrack(const Mapping& mapping) {
+        m_mapped_bytes -= mapping.size;
+        if (mapping.huge)
+            m_huge_page_bytes -= mapping.size;
+    }
+
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (bytes >= kOwnMappingSize && alignment > kPageSize) {
+            void* p = m_upstream->allocate(bytes, alignment);
+            m_upstream_blocks.emplace(p, std::make_pair(bytes, alignment));
+            return p;
+        }
+        if (bytes >= kOwnMappingSize) {
+            size_t granule = bytes >= kRegionSize ? kRegionSize : kPageSize;
+            Mapping mapping = Map((bytes + granule - 1) / granule * granule);
+            m_own_mappings.emplace(mapping.address, mapping);
+            this->Track(mapping);
+            return mapping.address;
+        }
+
+        size_t padding = m_cursor == nullptr ? 0 : (alignment - reinterpret_cast<uintptr_t>(m_cursor) % alignment) % alignment;
+        if (m_cursor == nullptr || padding + bytes > m_available) {
+            Mapping region = Map(kRegionSize);
+            m_regions.push_back(region);
+            this->Track(region);
+            m_cursor = static_cast<std::byte*>(region.address);
+            m_available = region.size;
+            padding = (alignment - reinterpret_cast<uintptr_t>(m_cursor) % alignment) % alignment;
+        }
+        void* p = m_cursor + padding;
+        m_cursor += padding + bytes;
+        m_available -= padding + bytes;
+        return p;
+    }
+
+    void do_deallocate(void* p, size_t, size_t) override {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (auto it = m_own_mappings.find(p); it != m_own_mappings.end()) {
+            this->Untrack(it->second);
+            Unmap(it->second);
+            m_own_mappings.erase(it);
+        } else if (auto block = m_upstream_blocks.find(p); block != m_upstream_blocks.end()) {
+            m_upstream->deallocate(p, block->second.first, block->second.second);
+            m_upstream_blocks.erase(block);
+        }
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+public:
+    ~RegionResource() override {
+        this->Release();
+    }
+
+    void Release() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (const Mapping& region : m_regions)
+            Unmap(region);
+        for (const auto& [_, mapping] : m_own_mappings)
+            Unmap(mapping);
+        for (const auto& [p, block] : m_upstream_blocks)
+            m_upstream->deallocate(p, block.first, block.second);
+        m_regions.clear();
+        m_upstream_blocks.clear();
+        m_own_mappings.clear();
+        m_cursor = nullptr;
+        m_available = 0;
+        m_mapped_bytes = 0;
+        m_huge_page_bytes = 0;
+    }
+
+    size_t GetMappedBytes() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_mapped_bytes;
+    }
+
+    size_t GetHugePageBytes() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_huge_page_bytes;
+    }
+
+    static std::pmr::pool_options PoolOptions() {
+        std::pmr::pool_options options;
+        options.largest_required_pool_block = kOwnMappingSize;
+        return options;
+    }
+};
+
+HugePageResource::HugePageResource()
+    : m_regions(std::make_unique<RegionResource>()), m_pool(RegionResource::PoolOptions(), m_regions.get()) {
+}
+
+HugePageResource::~HugePageResource() {
+}
+
+void* HugePageResource::do_allocate(size_t bytes, size_t alignment) {
+    return m_pool.allocate(bytes, alignment);
+}
+
+void HugePageResource::do_deallocate(void* p, size_t bytes, size_t alignment) {
+    m_pool.deallocate(p, bytes, alignment);
+}
+
+bool HugePageResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+    return this == &other;
+}
+
+void HugePageResource::Release() {
+    m_pool.release();
+    m_regions->Release();
+}
+
+size_t HugePageResource::GetMappedBytes() const {
+    return m_regions->GetMappedBytes();
+}
+
+size_t HugePageResource::GetHugePageBytes() const {
+    return m_regions->GetHugePageBytes();
+}
+
+} // namespace casbin
+
+#endif // MEMORY_RESOURCE_CPP
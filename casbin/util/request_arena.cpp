@@ -0,0 +1,122 @@
+/*
+ * Copyright 2021 The casbin Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "casbin/pch.h"
+
+#ifndef REQUEST_ARENA_CPP
+#define REQUEST_ARENA_CPP
+
+#include <memory>
+#include <optional>
+
+#include "casbin/util/request_arena.h"
+
+namespace casbin {
+
+namespace {
+
+constexpr size_t kInitialCapacity = 4096;
+
+// OverflowResource takes the memory a request needs beyond the buffer from the global heap
+// and records how much it took.
+class OverflowResource : public std::pmr::memory_resource {
+public:
+    size_t overflow = 0;
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        overflow += bytes;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+struct ThreadArena {
+    OverflowResource upstream;
+    std::unique_ptr<std::byte[]> buffer;
+    size_t capacity = 0;
+    std::optional<std::pmr::monotonic_buffer_resource> resource;
+    int depth = 0;
+
+    ThreadArena() {
+        this->Reset(kInitialCapacity);
+    }
+
+    void Reset(size_t new_capacity) {
+        // the monotonic resource gives its overflow back to the upstream here
+        resource.reset();
+        if (new_capacity != capacity) {
+            buffer = std::make_unique<std::byte[]>(new_capacity);
+            capacity = new_capacity;
+        }
+        upstream.overflow = 0;
+        resource.emplace(buffer.get(), capacity, &upstream);
+    }
+
+    // Release makes the whole buffer available to the next request, enlarged when the last
+    // requests did not fit in it.
+    void Release() {
+        if (upstream.overflow == 0) {
+            resource->release();
+            return;
+        }
+        size_t needed = capacity + upstream.overflow;
+        size_t new_capacity = capacity;
+        while (new_capacity < needed)
+            new_capacity *= 2;
+        this->Reset(new_capacity);
+    }
+};
+
+ThreadArena& CurrentArena() {
+    thread_local ThreadArena arena;
+    return arena;
+}
+
+} // namespace
+
+RequestArena::Scope::Scope()
+    : m_outermost(CurrentArena().depth++ == 0) {
+}
+
+RequestArena::Scope::~Scope() {
+    ThreadArena& arena = CurrentArena();
+    if (--arena.depth == 0)
+        arena.Release();
+}
+
+bool RequestArena::Scope::IsOutermost() const {
+    return m_outermost;
+}
+
+std::pmr::memory_resource* RequestArena::Resource() {
+    return &*CurrentArena().resource;
+}
+
+size_t RequestArena::Capacity() {
+    return CurrentArena().capacity;
+}
+
+} // namespace casbin
+
+#endif // REQUEST_ARENA_CPP
@@ -20,20 +20,28 @@
 #define CASBIN_CPP_CASBIN_H
 
 #include "casbin_types.h"
+#include "enforce_context.h"
 #include "enforcer.h"
 #include "enforcer_cached.h"
 #include "enforcer_interface.h"
 #include "enforcer_synced.h"
+#include "enforcer_tenant_host.h"
+#include "specialized_enforcer.h"
+#include "transaction.h"
+#include "typed_request.h"
 #include "pch.h"
 // persist
 #include "persist/adapter.h"
+#include "persist/async_adapter.h"
 #include "persist/batch_adapter.h"
 #include "persist/default_watcher.h"
 #include "persist/default_watcher_ex.h"
 #include "persist/filtered_adapter.h"
 #include "persist/persist.h"
+#include "persist/shared_memory_adapter.h"
 #include "persist/watcher.h"
 #include "persist/watcher_ex.h"
+#include "persist/write_behind_adapter.h"
 
 // persist/file_adapter
 #include "persist/file_adapter/batch_file_adapter.h"
@@ -83,20 +91,37 @@
 
 // model
 #include "model/assertion.h"
+#ifndef CASBIN_LITE
 #include "model/evaluator.h"
+#endif
+#include "model/evaluator_interface.h"
+#include "model/fast_reject_index.h"
 #include "model/function.h"
+#include "model/domain_partition_index.h"
+#include "model/effect_partition_index.h"
+#include "model/hot_rule_order.h"
+#include "model/literal_set.h"
+#include "model/matcher.h"
+#include "model/matcher_plan.h"
+#include "model/permission_bitmap_index.h"
+#include "model/request_hoist.h"
 #include "model/model.h"
+#include "model/native_evaluator.h"
 
 // util
 #include "util/built_in_functions.h"
+#include "util/memory_resource.h"
+#include "util/request_arena.h"
 #include "util/ticker.h"
 #include "util/util.h"
 
 // error
 #include "error/error.h"
 
-// exprtk
+// exprtk, left out of casbin_lite
+#ifndef CASBIN_LITE
 #include "exprtk/exprtk.hpp"
+#endif
 
 // rbac
 #include "rbac/default_role_manager.h"
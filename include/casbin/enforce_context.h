@@ -0,0 +1,48 @@
+/*
+ * Copyright 2021 The casbin Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CASBIN_CPP_ENFORCE_CONTEXT
+#define CASBIN_CPP_ENFORCE_CONTEXT
+
+#include <string>
+
+namespace casbin {
+
+// EnforceContext selects the request, policy, effect and matcher definitions a request is
+// enforced with, so that the numbered sections of a model (r2, p2, e2, m2, ...) can be
+// used next to the default ones.
+//
+// Example:
+//     e.EnforceWithContext(casbin::EnforceContext::NewEnforceContext("2"), {"alice", "data1", "read"});
+struct EnforceContext {
+    std::string r_type = "r";
+    std::string p_type = "p";
+    std::string e_type = "e";
+    std::string m_type = "m";
+
+    // NewEnforceContext selects the sections with the suffix, "2" for r2, p2, e2 and m2.
+    static EnforceContext NewEnforceContext(const std::string& suffix);
+
+    // IsDefault returns true if the context selects r, p, e and m.
+    bool IsDefault() const;
+
+    // GetKey returns a key identifying the selected sections.
+    std::string GetKey() const;
+};
+
+} // namespace casbin
+
+#endif
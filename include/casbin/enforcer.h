@@ -17,18 +17,34 @@
 #ifndef CASBIN_CPP_ENFORCER
 #define CASBIN_CPP_ENFORCER
 
+#include <functional>
+#include <memory_resource>
+#include <mutex>
+#include <string_view>
 #include <tuple>
 #include <vector>
 
+#include "casbin/enforce_context.h"
 #include "casbin/enforcer_interface.h"
 #include "casbin/log/log_util.h"
-#include "casbin/model/evaluator.h"
+#include "casbin/model/domain_partition_index.h"
+#include "casbin/model/effect_partition_index.h"
+#include "casbin/model/evaluator_interface.h"
+#include "casbin/model/fast_reject_index.h"
 #include "casbin/model/function.h"
+#include "casbin/model/hot_rule_order.h"
+#include "casbin/model/id_policy_index.h"
+#include "casbin/model/matcher_plan.h"
+#include "casbin/model/permission_bitmap_index.h"
+#include "casbin/model/request_hoist.h"
 #include "casbin/persist/filtered_adapter.h"
 #include "casbin/rbac/role_manager.h"
+#include "casbin/typed_request.h"
 
 namespace casbin {
 
+class Transaction;
+
 // Enforcer is the main interface for authorization enforcement and policy management.
 class Enforcer : public IEnforcer {
 private:
@@ -39,17 +55,94 @@ private:
     std::shared_ptr<Adapter> m_adapter;
     std::shared_ptr<Watcher> m_watcher;
     std::shared_ptr<IEvaluator> m_evalator;
+    // The idle evaluators of the non-default contexts, a request takes one of its context so
+    // that concurrent requests of a context each evaluate on their own
+    std::unordered_map<std::string, std::vector<std::shared_ptr<IEvaluator>>> m_context_evaluators;
+    // Storage of the request values in m_request_slots_evaluator, by request token
+    std::shared_ptr<IEvaluator> m_request_slots_evaluator;
+    std::vector<std::string*> m_request_slots;
     LogUtil m_log;
 
     bool m_enabled;
     bool m_auto_save;
     bool m_auto_build_role_links;
     bool m_auto_notify_watcher;
+    bool m_auto_warmup = false;
+
+    std::shared_ptr<FastRejectIndex> m_fast_reject;
+    std::shared_ptr<PermissionBitmapIndex> m_permission_bitmaps;
+    std::shared_ptr<EffectPartitionIndex> m_effect_partition;
+    std::shared_ptr<DomainPartitionIndex> m_domain_partition;
+    std::shared_ptr<IdPolicyIndex> m_id_policy;
+    std::shared_ptr<RequestHoist> m_request_hoist;
+    std::shared_ptr<MatcherPlan> m_matcher_plan;
+    std::shared_ptr<HotRuleOrder> m_hot_rules;
+
+    // ContextIndexes are the enabled indexes built for the definitions of a non-default context.
+    struct ContextIndexes {
+        std::shared_ptr<FastRejectIndex> fast_reject;
+        std::shared_ptr<PermissionBitmapIndex> permission_bitmaps;
+        std::shared_ptr<EffectPartitionIndex> effect_partition;
+        std::shared_ptr<DomainPartitionIndex> domain_partition;
+    };
+    // The indexes of the non-default contexts, by context key, built on their first request
+    std::unordered_map<std::string, std::shared_ptr<ContextIndexes>> m_context_indexes;
+    // Guards the context indexes and evaluators, which requests under a shared lock create
+    std::shared_ptr<std::mutex> m_context_mutex = std::make_shared<std::mutex>();
+
+    // true while the role graph is shared with a fork or the enforcer it was forked from
+    bool m_rm_shared = false;
+
+    // unshareRoleManager gives the enforcer its own copy of the role graph and of the "g"
+    // assertions linked in it when they are shared with a fork. It is called before either
+    // changes, the indexes reading the role graph are rebuilt on the copy.
+    void unshareRoleManager();
+
+    // buildMatcherPlans hoists and plans the model matcher, as enabled.
+    void buildMatcherPlans();
+    // rebuildIndexes rebuilds the enabled indexes after the model or its policy was replaced.
+    void rebuildIndexes();
+    // updateIndexes applies a policy change to the enabled indexes.
+    void updateIndexes(policy_op op, const std::string& sec, const std::string& p_type, const PoliciesValues& rules);
+    // clearContextIndexes drops the indexes of the non-default contexts, they are built again
+    // on their next request.
+    void clearContextIndexes();
+    // contextIndexes returns the enabled indexes of a non-default context, nullptr when none is.
+    std::shared_ptr<ContextIndexes> contextIndexes(const EnforceContext& context);
+
+    // unmatchedDecision returns the decision of the effect of the context when no rule of the
+    // policy matches.
+    bool unmatchedDecision(const EnforceContext& context);
+    // loadFunctions registers the built-in functions and the "g" functions of the model.
+    void loadFunctions(const std::shared_ptr<IEvaluator>& evalator);
+    // matchPolicy evaluates the matcher against one policy rule.
+    bool matchPolicy(const std::string& p_type, const std::string& exp_string, bool has_eval, const std::vector<std::string>& p_vals, const std::pmr::unordered_map<std::string_view, int>& p_int_tokens, const std::shared_ptr<IEvaluator>& evalator);
 
     // enforce use a custom matcher to decides whether a "subject" can access a "object"
     // with the operation "action", input parameters are usually: (matcher, sub, obj, act),
     // use model matcher by default when matcher is "".
     bool m_enforce(const std::string& matcher, std::vector<std::string>& explains, std::shared_ptr<IEvaluator> evalator) override;
+    // enforceWithContext decides the request with the definitions selected by the context.
+    bool enforceWithContext(const EnforceContext& context, const std::string& matcher, std::vector<std::string>& explains, std::shared_ptr<IEvaluator> evalator);
+    // withContextEvaluator decides a request of the context with an evaluator of the context,
+    // each context compiles its own matcher. The evaluator is returned to the context after.
+    bool withContextEvaluator(const EnforceContext& context, const std::function<bool(const std::shared_ptr<IEvaluator>&)>& decide);
+
+protected:
+    // forkInto makes a default constructed enforcer a fork of this one.
+    void forkInto(Enforcer& fork);
+
+    friend class Transaction;
+    // stageTransaction calls stage with the model a transaction stages its operations
+    // against, and returns its result.
+    virtual bool stageTransaction(const std::function<bool(Model&)>& stage);
+
+    // importPolicies moves rules into the current policy, then builds their role links and
+    // the enabled indexes once.
+    virtual size_t importPolicies(const std::string& sec, const std::string& p_type, std::vector<std::vector<std::string>>&& rules);
+
+    // enforceValues decides a request given as the values of the request tokens in order.
+    virtual bool enforceValues(const std::string_view* values, size_t count, std::vector<std::string>& explain);
 
 public:
     std::shared_ptr<RoleManager> rm;
@@ -126,7 +219,8 @@ public:
     void SetEvaluator(std::shared_ptr<IEvaluator> evaluator);
     // GetRoleManager gets the current role manager.
     std::shared_ptr<RoleManager> GetRoleManager() override;
-    // SetRoleManager sets the current role manager.
+    // SetRoleManager sets the current role manager. The role definitions linked in the
+    // previous one, and the indexes, read the new one from then on.
     void SetRoleManager(std::shared_ptr<RoleManager>& rm) override;
     // SetEffector sets the current effector.
     void SetEffector(std::shared_ptr<Effector> eft) override;
@@ -154,6 +248,69 @@ public:
     void EnableAutoBuildRoleLinks(bool auto_build_role_links) override;
     // BuildRoleLinks manually rebuild the role inheritance relations.
     void BuildRoleLinks() override;
+    // EnableFastReject controls whether requests with a value that appears in no rule the matcher
+    // requires it to equal are decided without scanning the policy.
+    void EnableFastReject(bool enable);
+    // EnablePermissionBitmaps controls whether closed-world RBAC requests are decided with
+    // precomputed permission bitmaps instead of evaluating the matcher.
+    void EnablePermissionBitmaps(bool enable);
+    // EnableEffectPartition controls whether deny and allow rules are kept apart so that
+    // deny-override effects stop at the first deciding rule.
+    void EnableEffectPartition(bool enable);
+    // EnableDomainPartition controls whether the rules of a domain model are partitioned by
+    // domain, so that requests and filtered operations naming a domain only touch its rules.
+    void EnableDomainPartition(bool enable);
+    // EnableValueIds controls whether the policy values are interned in a dictionary, so that
+    // requests given as value ids are decided on integers.
+    void EnableValueIds(bool enable);
+    // EnableHotRuleOrder controls whether the rules of first-match effects are scanned in the order
+    // of the requests they decided, so that the scan length follows the traffic.
+    void EnableHotRuleOrder(bool enable);
+    // EnableMatcherReordering controls whether the operands of the "&&" and "||" of the matcher
+    // are evaluated cheapest and most deciding first, as estimated and then measured.
+    void EnableMatcherReordering(bool enable);
+    // EnableRequestHoisting controls whether the parts of the matcher reading only the request
+    // are evaluated once per request instead of once per rule.
+    void EnableRequestHoisting(bool enable);
+    // GetValueDictionary returns a copy of the value dictionary to resolve request values
+    // with. The ids it resolves stay valid while its epoch is the epoch of the enforcer,
+    // ResolveValueIds resolves a request without copying it.
+    virtual ValueDictionary GetValueDictionary();
+    // ResolveValueIds returns the ids of the values of a request.
+    virtual ValueIds ResolveValueIds(const std::vector<std::string>& values);
+    // GetValueDictionaryEpoch returns the epoch of the value dictionary, ids resolved in an
+    // earlier epoch must be resolved again.
+    virtual uint64_t GetValueDictionaryEpoch();
+    // EnableAutoWarmup controls whether the enforcer is warmed up after every policy load.
+    void EnableAutoWarmup(bool enable);
+    // Warmup prepares the enforcer for its first request: it creates the evaluator, compiles
+    // the matcher on it and computes the role closures of the permission bitmaps.
+    virtual void Warmup();
+    // PrepareEvaluator registers the functions of the model on the evaluator and compiles
+    // the model matcher, so that the first request evaluated with it does not pay for either.
+    void PrepareEvaluator(const std::shared_ptr<IEvaluator>& evaluator);
+    // BeginTransaction starts staging policy changes to commit at once.
+    Transaction BeginTransaction();
+    // CommitTransaction applies the operations staged in the transaction, false if one no
+    // longer applies, in which case the policy is left unchanged.
+    virtual bool CommitTransaction(Transaction& transaction);
+    // Fork creates an enforcer to simulate policy changes with, e.g. to replay recorded
+    // requests against a change before applying it. The fork shares the model, the policy and
+    // the role graph with this enforcer: a "p" or "g" assertion is copied by the first of the
+    // two that changes it, and the role graph with the "g" assertions by the first that
+    // changes a role, so a fork costs the partitions it changes. The fork has no adapter nor
+    // watcher, its changes are never saved, and starts without indexes, it decides like this
+    // enforcer without them. The two may be used from different threads, each by one thread
+    // at a time, as long as the policy is changed through the enforcer API.
+    virtual std::shared_ptr<Enforcer> Fork();
+    // ImportPolicies adds authorization rules in bulk, moving them into the current policy.
+    // Rules the policy already has and repeated ones are skipped, and it returns the number
+    // of rules imported. Like LoadPolicy, the import is not written to the adapter.
+    size_t ImportPolicies(std::vector<std::vector<std::string>> rules);
+    size_t ImportNamedPolicies(const std::string& p_type, std::vector<std::vector<std::string>> rules);
+    // ImportGroupingPolicies adds role inheritance rules in bulk, like ImportPolicies.
+    size_t ImportGroupingPolicies(std::vector<std::vector<std::string>> rules);
+    size_t ImportNamedGroupingPolicies(const std::string& p_type, std::vector<std::vector<std::string>> rules);
     // BuildIncrementalRoleLinks provides incremental build the role inheritance relations.
     void BuildIncrementalRoleLinks(policy_op op, const std::string& p_type, const PoliciesValues& rules);
     // Enforce decides whether a "subject" can access a "object" with the operation "action", input parameters are usually: (sub, obj, act).
@@ -164,6 +321,9 @@ public:
     virtual bool Enforce(const DataVector& params);
     // Enforce with a map param,decides whether a "subject" can access a "object" with the operation "action", input parameters are usually: (sub, obj, act).
     virtual bool Enforce(const DataMap& params);
+    // Enforce with value ids decides a request resolved by the value dictionary. It throws a
+    // CasbinEnforcerException unless value ids are enabled for the model and a DefaultEffector.
+    virtual bool Enforce(const ValueIds& request);
     // EnforceWithMatcher use a custom matcher to decides whether a "subject" can access a "object" with the operation "action", input parameters are usually: (matcher, sub, obj, act), use model
     // matcher by default when matcher is "".
     bool EnforceWithMatcher(const std::string& matcher, std::shared_ptr<IEvaluator> evalator) override;
@@ -187,6 +347,23 @@ public:
     bool EnforceExWithMatcher(const std::string& matcher, const DataVector& params, std::vector<std::string>& explain);
     bool EnforceExWithMatcher(const std::string& matcher, const DataMap& params, std::vector<std::string>& explain);
 
+    // EnforceWithContext decides the request with the request, policy, effect and matcher
+    // definitions selected by the context.
+    virtual bool EnforceWithContext(const EnforceContext& context, const DataList& params);
+    virtual bool EnforceWithContext(const EnforceContext& context, const DataVector& params);
+    virtual bool EnforceWithContext(const EnforceContext& context, const DataMap& params);
+    // EnforceExWithContext explains the decision of EnforceWithContext.
+    virtual bool EnforceExWithContext(const EnforceContext& context, const DataList& params, std::vector<std::string>& explain);
+    virtual bool EnforceExWithContext(const EnforceContext& context, const DataVector& params, std::vector<std::string>& explain);
+    virtual bool EnforceExWithContext(const EnforceContext& context, const DataMap& params, std::vector<std::string>& explain);
+
+    // Enforce decides a request struct whose fields RequestTraits binds to the request definition.
+    template <typename Request, std::enable_if_t<IsBoundRequest<Request>::value, int> = 0>
+    bool Enforce(const Request& request);
+    // EnforceEx explains the decision for a request struct bound by RequestTraits.
+    template <typename Request, std::enable_if_t<IsBoundRequest<Request>::value, int> = 0>
+    bool EnforceEx(const Request& request, std::vector<std::string>& explain);
+
     // BatchEnforce enforce in batches
     std::vector<bool> BatchEnforce(const std::initializer_list<DataList>& requests) override;
     // BatchEnforceWithMatcher enforce with matcher in batches
@@ -278,6 +455,18 @@ public:
     bool DeleteRoleForUserInDomain(const std::string& user, const std::string& role, const std::string& domain = {}) override;
 };
 
+template <typename Request, std::enable_if_t<IsBoundRequest<Request>::value, int>>
+bool Enforcer::Enforce(const Request& request) {
+    std::vector<std::string> explain;
+    return this->EnforceEx(request, explain);
+}
+
+template <typename Request, std::enable_if_t<IsBoundRequest<Request>::value, int>>
+bool Enforcer::EnforceEx(const Request& request, std::vector<std::string>& explain) {
+    auto values = GetRequestValues(request, std::make_index_sequence<RequestFieldCount<Request>>());
+    return this->enforceValues(values.data(), values.size(), explain);
+}
+
 } // namespace casbin
 
 #endif
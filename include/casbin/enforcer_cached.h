@@ -26,6 +26,11 @@ namespace casbin {
 class CachedEnforcer : public Enforcer {
 public:
     std::unordered_map<std::string, bool> m;
+    // Decisions of the non-default contexts, one namespace per context key
+    std::unordered_map<std::string, std::unordered_map<std::string, bool>> context_cache;
+    // Decisions of requests given as value ids, for the dictionary epoch id_cache_epoch
+    std::unordered_map<std::vector<ValueId>, bool, ValueIdsHash> id_cache;
+    uint64_t id_cache_epoch = 0;
     bool enableCache;
     std::mutex locker;
 
@@ -35,8 +40,14 @@ public:
     void EnableCache(const bool& shouldEnableCache);
     std::pair<bool, bool> getCachedResult(const std::string& key);
     void setCachedResult(const std::string& key, const bool& res);
+    std::pair<bool, bool> getCachedResult(const EnforceContext& context, const std::string& key);
+    void setCachedResult(const EnforceContext& context, const std::string& key, const bool& res);
     void InvalidateCache();
 
+protected:
+    // importPolicies moves rules into the current policy and invalidates the cache once.
+    size_t importPolicies(const std::string& sec, const std::string& p_type, std::vector<std::vector<std::string>>&& rules) override;
+
 public:
     /**
      * Enforcer is the default constructor.
@@ -86,6 +97,18 @@ public:
 
     virtual ~CachedEnforcer() = default;
 
+    // CommitTransaction applies the operations staged in the transaction and invalidates
+    // the cache once.
+    bool CommitTransaction(Transaction& transaction) override;
+
+    // Fork creates a cached enforcer sharing the policy and the role graph of this one, with
+    // an empty cache.
+    std::shared_ptr<Enforcer> Fork() override;
+
+    // Request structs bound by RequestTraits are decided without the cache, building a cache
+    // key would cost what the binding saves.
+    using Enforcer::Enforce;
+
     bool Enforce(std::shared_ptr<IEvaluator> evalator);
 
     // Enforce with a vector param,decides whether a "subject" can access a
@@ -102,6 +125,10 @@ public:
     // with the operation "action", input parameters are usually: (sub, obj, act).
     bool Enforce(const DataMap& params);
 
+    // Enforce with value ids decides a request resolved by the value dictionary, its
+    // decision is cached by the ids.
+    bool Enforce(const ValueIds& request);
+
     // EnforceWithMatcher use a custom matcher to decides whether a "subject" can
     // access a "object" with the operation "action", input parameters are
     // usually: (matcher, sub, obj, act), use model matcher by default when
@@ -125,6 +152,12 @@ public:
     // usually: (matcher, sub, obj, act), use model matcher by default when
     // matcher is "".
     bool EnforceWithMatcher(const std::string& matcher, const DataMap& params);
+
+    // EnforceWithContext decides the request with the definitions selected by the context,
+    // its decision is cached in the namespace of the context.
+    bool EnforceWithContext(const EnforceContext& context, const DataList& params) override;
+    bool EnforceWithContext(const EnforceContext& context, const DataVector& params) override;
+    bool EnforceWithContext(const EnforceContext& context, const DataMap& params) override;
 };
 
 } // namespace casbin
@@ -19,7 +19,7 @@
 
 #include "casbin/data_types.h"
 #include "casbin/effect/effector.h"
-#include "casbin/model/evaluator.h"
+#include "casbin/model/evaluator_interface.h"
 #include "casbin/model/model.h"
 #include "casbin/persist/adapter.h"
 #include "casbin/persist/default_watcher.h"
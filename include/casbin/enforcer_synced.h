@@ -18,11 +18,14 @@
 #define CASBIN_H_ENFORCER_SYNC
 
 #include <atomic>
+#include <condition_variable>
+#include <exception>
 #include <memory>
 #include <mutex>
 #include <shared_mutex>
 
 #include "./enforcer.h"
+#include "./transaction.h"
 #include "./persist/watcher.h"
 #include "./util/ticker.h"
 
@@ -35,6 +38,40 @@ class SyncedEnforcer : public Enforcer {
     std::shared_ptr<Watcher> watcher;
     std::unique_ptr<Ticker> ticker;
 
+    // PendingWrite is a single rule mutation waiting for a combiner to apply it.
+    struct PendingWrite {
+        Transaction::OperationType type;
+        std::string sec;
+        std::string p_type;
+        std::vector<std::string> rule;
+        bool done = false;
+        bool result = false;
+        std::exception_ptr error;
+    };
+
+    std::mutex writesMutex;
+    std::condition_variable writesDone;
+    std::vector<PendingWrite*> pendingWrites;
+    bool combining = false;
+
+    // combineWrite queues a single rule mutation. The first writer to find no combiner running
+    // becomes it and applies the queued mutations, its own included, under one exclusive lock,
+    // the others wait for it to publish their results.
+    bool combineWrite(Transaction::OperationType type, const std::string& sec, const std::string& p_type, const std::vector<std::string>& rule);
+
+    // applyWrites applies a batch of queued mutations under one exclusive lock, as one
+    // transaction with one role link pass and one index update.
+    void applyWrites(const std::vector<PendingWrite*>& writes);
+
+    // stageTransaction calls stage with the model under the shared lock.
+    bool stageTransaction(const std::function<bool(Model&)>& stage) override;
+
+    // importPolicies moves rules into the current policy under one lock.
+    size_t importPolicies(const std::string& sec, const std::string& p_type, std::vector<std::vector<std::string>>&& rules) override;
+
+    // enforceValues decides a request given as the values of the request tokens under the lock.
+    bool enforceValues(const std::string_view* values, size_t count, std::vector<std::string>& explain) override;
+
 public:
     /**
      * Enforcer is the default constructor.
@@ -126,6 +163,25 @@ public:
     // BuildRoleLinks manually rebuild the role inheritance relations.
     void BuildRoleLinks() override;
 
+    // CommitTransaction applies the operations staged in the transaction under one lock.
+    bool CommitTransaction(Transaction& transaction) override;
+
+    // Fork creates an enforcer sharing the policy of this one under the lock. The fork itself
+    // is an Enforcer, to be used by one thread at a time.
+    std::shared_ptr<Enforcer> Fork() override;
+
+    using Enforcer::Enforce;
+    using Enforcer::EnforceEx;
+
+    // Warmup prepares the enforcer for its first request under the lock.
+    void Warmup() override;
+
+    // EnforceExWithContext explains the decision for the definitions selected by the context,
+    // under the shared lock for a non-default context.
+    bool EnforceExWithContext(const EnforceContext& context, const DataList& params, std::vector<std::string>& explain) override;
+    bool EnforceExWithContext(const EnforceContext& context, const DataVector& params, std::vector<std::string>& explain) override;
+    bool EnforceExWithContext(const EnforceContext& context, const DataMap& params, std::vector<std::string>& explain) override;
+
     // Enforce decides whether a "subject" can access a "object" with the operation "action", input parameters are usually: (sub, obj, act).
     bool Enforce(std::shared_ptr<IEvaluator>) override;
 
@@ -143,6 +199,19 @@ public:
     // with the operation "action", input parameters are usually: (sub, obj, act).
     bool Enforce(const DataMap& params) override;
 
+    // Enforce with value ids decides a request resolved by the value dictionary, requests
+    // given as ids share the lock as they do not use the evaluator.
+    bool Enforce(const ValueIds& request) override;
+
+    // GetValueDictionary returns a copy of the value dictionary taken under the lock.
+    ValueDictionary GetValueDictionary() override;
+
+    // ResolveValueIds returns the ids of the values of a request under the lock.
+    ValueIds ResolveValueIds(const std::vector<std::string>& values) override;
+
+    // GetValueDictionaryEpoch returns the epoch of the value dictionary under the lock.
+    uint64_t GetValueDictionaryEpoch() override;
+
     // BatchEnforce enforce in batches
     std::vector<bool> BatchEnforce(const std::initializer_list<DataList>& requests) override;
 
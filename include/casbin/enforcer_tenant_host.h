@@ -0,0 +1,225 @@
+/*
+ * Copyright 2020 The casbin Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CASBIN_CPP_ENFORCER_TENANT_HOST
+#define CASBIN_CPP_ENFORCER_TENANT_HOST
+
+#include <future>
+#include <list>
+#include <mutex>
+#include <shared_mutex>
+
+#include "casbin/enforcer.h"
+#include "casbin/persist/filtered_adapter.h"
+
+namespace casbin {
+
+// TenantHost serves many tenants that use the same model but keep separate policy.
+//
+// The model CONF is parsed once: every tenant model shares the request, effect and
+// matcher assertions of the host's template and only owns its "p" and "g" assertions
+// and role manager. Evaluators (and the exprtk parser / symbol tables inside them) are
+// not owned by tenants either, they are borrowed from a pool shared by the host for the
+// duration of a single Enforce call. Policy values are not pooled across tenants, each
+// tenant keeps its own rows (see Model::InternPolicy to compact them).
+//
+// The tenant registry is thread-safe. Concurrent Enforce calls for any tenants are
+// safe; mutating a tenant's policy concurrently with enforcing on the same tenant has
+// the same requirements as for a plain Enforcer.
+//
+// With lazy loading enabled (see EnableLazyLoading) the tenants are the domains of a
+// policy store: a domain's "p" and "g" rows are loaded through a FilteredAdapter on
+// the first request for it, and the least recently used domains are evicted once the
+// resident policy exceeds the memory budget.
+class TenantHost {
+public:
+    // kTenantBytes is the estimated heap of a lazily loaded tenant without policy: its
+    // enforcer, assertions and role manager. It is charged to the memory budget on top of
+    // the rows, so that domains without policy are evicted like the others.
+    static constexpr size_t kTenantBytes = 8192;
+
+private:
+    class LazyTenant;
+
+    std::shared_ptr<Model> m_template;
+    std::shared_ptr<Effector> m_eft;
+
+    std::unordered_map<std::string, std::shared_ptr<Enforcer>> m_tenants;
+    std::shared_mutex m_tenants_mutex;
+
+    std::vector<std::shared_ptr<IEvaluator>> m_evaluators;
+    std::mutex m_evaluators_mutex;
+    size_t m_max_pooled_evaluators;
+
+    std::shared_ptr<FilteredAdapter> m_loader;
+    int m_p_domain_index;
+    int m_g_domain_index;
+    size_t m_memory_budget;
+    // Loads in flight, guarded by m_tenants_mutex
+    std::unordered_map<std::string, std::shared_future<std::shared_ptr<Enforcer>>> m_loading;
+
+    // Cleared when the host is destroyed, so that lazily loaded tenants outliving it stop
+    // accounting. A tenant holds the mutex shared for as long as it reports to the host.
+    struct Self {
+        std::shared_mutex mutex;
+        TenantHost* host;
+    };
+    std::shared_ptr<Self> m_self;
+
+    // Lazily loaded tenants, most recently used first, with their estimated size
+    std::list<std::string> m_lru;
+    std::unordered_map<std::string, std::pair<std::list<std::string>::iterator, size_t>> m_resident;
+    size_t m_resident_bytes;
+    std::mutex m_lru_mutex;
+
+    std::shared_ptr<Enforcer> LoadTenant(const std::string& tenant);
+
+    std::shared_ptr<Enforcer> FindTenant(const std::string& tenant);
+
+    void Touch(const std::string& tenant);
+
+    void Account(const std::string& tenant, size_t bytes);
+
+    void Forget(const std::string& tenant);
+
+    // Resize changes the estimated size of a resident tenant after a policy change.
+    void Resize(const std::string& tenant, int64_t bytes);
+
+    void EvictOverBudget();
+
+    // EvaluatorLease borrows an evaluator from the pool and returns it when it goes out of
+    // scope, also when the enforcement throws.
+    class EvaluatorLease {
+    public:
+        explicit EvaluatorLease(TenantHost& host);
+        ~EvaluatorLease();
+        EvaluatorLease(const EvaluatorLease&) = delete;
+        EvaluatorLease& operator=(const EvaluatorLease&) = delete;
+
+        const std::shared_ptr<IEvaluator>& Get() const {
+            return m_evaluator;
+        }
+
+    private:
+        TenantHost& m_host;
+        std::shared_ptr<IEvaluator> m_evaluator;
+    };
+
+    std::shared_ptr<IEvaluator> AcquireEvaluator();
+
+    void ReleaseEvaluator(std::shared_ptr<IEvaluator> evaluator);
+
+    template <typename Params>
+    bool EnforceTenant(const std::string& tenant, const Params& params, std::vector<std::string>& explain);
+
+    template <typename Params>
+    bool EnforceDomain(const Params& params, std::vector<std::string>& explain);
+
+public:
+    /**
+     * TenantHost initializes a host with a model file shared by all tenants.
+     *
+     * @param model_path the path of the model file.
+     */
+    TenantHost(const std::string& model_path);
+    /**
+     * TenantHost initializes a host with a model shared by all tenants.
+     * Any policy already loaded into the model is ignored.
+     *
+     * @param m the model.
+     */
+    TenantHost(const std::shared_ptr<Model>& m);
+
+    ~TenantHost();
+
+    // GetModel gets the template model shared by all tenants.
+    std::shared_ptr<Model> GetModel();
+
+    // AddTenant creates the tenant and loads its policy from the adapter (if any).
+    // Returns the existing tenant when it was already added.
+    std::shared_ptr<Enforcer> AddTenant(const std::string& tenant, std::shared_ptr<Adapter> adapter = nullptr);
+
+    // GetTenant gets the tenant's enforcer for policy management, nullptr if the tenant does not exist.
+    // Lazily loaded tenants are loaded if needed.
+    std::shared_ptr<Enforcer> GetTenant(const std::string& tenant);
+
+    // HasTenant determines whether the tenant exists.
+    bool HasTenant(const std::string& tenant);
+
+    // RemoveTenant removes the tenant together with its policy and role data.
+    bool RemoveTenant(const std::string& tenant);
+
+    // GetAllTenants gets the names of all tenants.
+    std::vector<std::string> GetAllTenants();
+
+    // TenantCount returns the number of tenants.
+    size_t TenantCount();
+
+    // SetMaxPooledEvaluators bounds the number of idle evaluators kept for reuse.
+    void SetMaxPooledEvaluators(size_t max_pooled_evaluators);
+
+    // Warmup fills the evaluator pool with evaluators that have the matcher compiled, one
+    // for each of the given number of concurrent requests, as far as the pool bound allows.
+    void Warmup(size_t evaluators);
+
+    /**
+     * EnableLazyLoading makes unknown tenants load on demand: the first request for a
+     * domain loads the "p" rows whose field p_domain_index and the "g" rows whose field
+     * g_domain_index equal the domain. Concurrent first requests for the same domain
+     * share one load. The adapter is called concurrently for different domains.
+     *
+     * Loaded tenants keep the adapter, so with auto-save their policy changes are
+     * persisted and survive eviction.
+     *
+     * @param adapter the filtered adapter holding the policy of all domains.
+     * @param memory_budget the resident policy size in bytes above which the least
+     *                      recently used domains are evicted, 0 for no limit.
+     * @param p_domain_index the index of the domain field in "p" rows and requests.
+     * @param g_domain_index the index of the domain field in "g" rows.
+     */
+    void EnableLazyLoading(std::shared_ptr<FilteredAdapter> adapter, size_t memory_budget = 0, int p_domain_index = 1, int g_domain_index = 2);
+
+    // SetMemoryBudget changes the memory budget of lazily loaded tenants, 0 for no limit.
+    void SetMemoryBudget(size_t memory_budget);
+
+    // GetResidentBytes returns the estimated size of the lazily loaded tenants in memory, their
+    // rows and kTenantBytes each. It follows the policy changes made through the tenants.
+    size_t GetResidentBytes();
+
+    // Enforce decides whether a "subject" can access a "object" with the operation "action"
+    // under the tenant's policy. Unknown tenants are denied.
+    bool Enforce(const std::string& tenant, const DataList& params);
+    bool Enforce(const std::string& tenant, const DataVector& params);
+    bool Enforce(const std::string& tenant, const DataMap& params);
+
+    bool EnforceEx(const std::string& tenant, const DataList& params, std::vector<std::string>& explain);
+    bool EnforceEx(const std::string& tenant, const DataVector& params, std::vector<std::string>& explain);
+    bool EnforceEx(const std::string& tenant, const DataMap& params, std::vector<std::string>& explain);
+
+    // Enforce decides whether a "subject" can access a "object" with the operation "action"
+    // in the domain named by the request's domain field, loading the domain if needed.
+    bool Enforce(const DataList& params);
+    bool Enforce(const DataVector& params);
+    bool Enforce(const DataMap& params);
+
+    bool EnforceEx(const DataList& params, std::vector<std::string>& explain);
+    bool EnforceEx(const DataVector& params, std::vector<std::string>& explain);
+    bool EnforceEx(const DataMap& params, std::vector<std::string>& explain);
+};
+
+} // namespace casbin
+
+#endif
@@ -16,9 +16,10 @@ public:
     // GetLogger returns the current logger.
     static DefaultLogger GetLogger() { return s_logger; }
 
-    // LogPrint prints the log.
+    // LogPrint prints the log. The objects are taken by reference, so that a disabled log
+    // copies nothing.
     template <typename... Object>
-    static void LogPrint(Object... objects) {
+    static void LogPrint(const Object&... objects) {
         s_logger.Print(objects...);
     }
 
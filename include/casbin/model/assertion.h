@@ -18,6 +18,7 @@
 #define CASBIN_CPP_MODEL_ASSERTION
 
 #include <memory>
+#include <memory_resource>
 
 #include "policy_collection.hpp"
 #include "../rbac/role_manager.h"
@@ -35,10 +36,26 @@ public:
     std::string key;
     std::string value;
     std::vector<std::string> tokens;
+    // The tokens without the key and "_" ("sub" for "p_sub") and the position of the "eft"
+    // token, -1 without one. They are set with the tokens by SetTokens.
+    std::vector<std::string> field_names;
+    int eft_index = -1;
     PoliciesValues policy;
     std::shared_ptr<RoleManager> rm;
 
-    void BuildIncrementalRoleLinks(std::shared_ptr<RoleManager>& rm, policy_op op, const PoliciesValues& rules);
+    Assertion() = default;
+
+    // Assertion creates an assertion whose policy is allocated from the resource.
+    explicit Assertion(std::pmr::memory_resource* resource);
+
+    // SetTokens sets the tokens of a request or policy definition and their field names.
+    void SetTokens(std::vector<std::string> tokens);
+
+    // GetMemoryUsage returns the bytes held by the policy of the assertion.
+    size_t GetMemoryUsage() const;
+
+    // BuildIncrementalRoleLinks applies the rules from position first on to the role manager.
+    void BuildIncrementalRoleLinks(std::shared_ptr<RoleManager>& rm, policy_op op, const PoliciesValues& rules, size_t first = 0);
 
     void BuildRoleLinks(std::shared_ptr<RoleManager>& rm);
 };
@@ -0,0 +1,96 @@
+/*
+ * Copyright 2021 The casbin Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CASBIN_CPP_MODEL_DOMAIN_PARTITION_INDEX
+#define CASBIN_CPP_MODEL_DOMAIN_PARTITION_INDEX
+
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "../enforce_context.h"
+#include "./evaluator_interface.h"
+#include "./model.h"
+
+namespace casbin {
+
+// DomainPartitionIndex keeps the "p" rules of a domain model partitioned by their domain.
+//
+// The domain column is detected from the matcher: it is the policy field of a top-level
+// "r.X == p.Y" conjunct when r.X or p.Y is also the domain argument of a top-level
+// "g(_, _, dom)" call, as in examples/rbac_with_domains_model.conf. A request can then only
+// match the rules of its own domain, so the enforcer evaluates that partition alone, and
+// filtered reads and removals naming a domain only look at it. Each partition keeps the
+// policy order of its rules. The partitions point at the rules of the policy, they are not
+// read once the policy changed behind Update.
+class DomainPartitionIndex {
+public:
+    typedef std::vector<const PolicyValues*> Rules;
+
+private:
+    EnforceContext m_context;
+    bool m_applicable = false;
+    size_t m_column_count = 0;
+    size_t m_domain_column = 0;
+    std::string m_domain_token;
+    // rules without the expected number of columns, left to the full scan to report
+    size_t m_invalid_rules = 0;
+
+    // The policy partitioned, checked before the partitions are read
+    const PoliciesValues* m_policy = nullptr;
+    size_t m_policy_size = 0;
+    const PolicyValues* m_first_rule = nullptr;
+    uint64_t m_generation = 0;
+
+    std::unordered_map<std::string_view, Rules> m_partitions;
+
+    void AddRule(const PolicyValues& rule);
+
+    void PartitionPolicy(const PoliciesValues& policy);
+
+    // IsCurrent returns true if the partitions point at the rules of the policy.
+    bool IsCurrent(const PoliciesValues& policy) const;
+
+public:
+    // Build detects the domain column of the context and partitions its current policy.
+    void Build(const std::shared_ptr<Model>& m, const EnforceContext& context = EnforceContext());
+
+    // Update applies a policy change of the model made after Build.
+    void Update(const std::shared_ptr<Model>& m, policy_op op, const std::string& sec, const std::string& p_type, const PoliciesValues& rules);
+
+    // IsApplicable returns true if the model has a domain column.
+    bool IsApplicable() const;
+
+    // GetDomainColumn returns the index of the domain column in the "p" rules.
+    size_t GetDomainColumn() const;
+
+    // GetPartition returns the rules of the domain, nullptr when it has none.
+    const Rules* GetPartition(const std::string& domain) const;
+
+    // Select returns the rules of the policy the request pushed into the evaluator can match,
+    // or nullptr when the request has no string domain and every rule must be scanned.
+    const Rules* Select(IEvaluator& evaluator, const PoliciesValues& policy) const;
+
+    // GetFilteredPolicy reads the rules of the policy matching the field filters from the
+    // partition of the domain they name. It returns false when the filters leave the domain
+    // open.
+    bool GetFilteredPolicy(const PoliciesValues& policy, int field_index, const std::vector<std::string>& field_values, PoliciesValues& rules) const;
+};
+
+} // namespace casbin
+
+#endif
@@ -0,0 +1,91 @@
+/*
+ * Copyright 2021 The casbin Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CASBIN_CPP_MODEL_EFFECT_PARTITION_INDEX
+#define CASBIN_CPP_MODEL_EFFECT_PARTITION_INDEX
+
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "../enforce_context.h"
+#include "./evaluator_interface.h"
+#include "./model.h"
+
+namespace casbin {
+
+// EffectPartitionIndex keeps the deny and the allow rules of the policy apart so that
+// deny-override effects can stop at the first matching rule.
+//
+// With "some(where (p.eft == allow)) && !some(where (p.eft == deny))" the deny rules are
+// evaluated first, a matching one decides at once, and the allow rules are then evaluated
+// only until the first match. With "!some(where (p.eft == deny))" the allow rules are never
+// evaluated. Inside each partition the rules keep the policy order, so the reported rule
+// is the one a full scan reports. When the matcher has a top-level "r.X == p.Y" conjunct,
+// the rules are further bucketed by column Y and only the bucket of the request is read.
+// The partitions point at the rules of the policy, they are not read once the policy
+// changed behind Update.
+class EffectPartitionIndex {
+public:
+    typedef std::vector<const PolicyValues*> Rules;
+
+    enum class Mode { None, AllowAndDeny, DenyOverride };
+
+private:
+    EnforceContext m_context;
+    Mode m_mode = Mode::None;
+    size_t m_column_count = 0;
+    size_t m_eft_column = 0;
+    bool m_has_key = false;
+    size_t m_key_column = 0;
+    std::string m_key_token;
+    // rules without the expected number of columns, left to the full scan to report
+    size_t m_invalid_rules = 0;
+
+    // The policy partitioned, checked before the partitions are read
+    const PoliciesValues* m_policy = nullptr;
+    size_t m_policy_size = 0;
+    const PolicyValues* m_first_rule = nullptr;
+    uint64_t m_generation = 0;
+
+    std::unordered_map<std::string_view, Rules> m_deny;
+    std::unordered_map<std::string_view, Rules> m_allow;
+
+    std::unordered_map<std::string_view, Rules>* Partition(const PolicyValues& rule);
+
+    void AddRule(const PolicyValues& rule);
+
+    void PartitionPolicy(const PoliciesValues& policy);
+
+public:
+    // Build analyses the definitions of the context and partitions its current policy.
+    void Build(const std::shared_ptr<Model>& m, const EnforceContext& context = EnforceContext());
+
+    // Update applies a policy change of the model made after Build.
+    void Update(const std::shared_ptr<Model>& m, policy_op op, const std::string& sec, const std::string& p_type, const PoliciesValues& rules);
+
+    // GetMode returns the effect the partitions are used for, None when they do not apply.
+    Mode GetMode() const;
+
+    // Select points deny_rules and allow_rules at the candidates of the policy for the
+    // request pushed into the evaluator. It returns false when every rule must be scanned.
+    bool Select(IEvaluator& evaluator, const PoliciesValues& policy, const Rules*& deny_rules, const Rules*& allow_rules) const;
+};
+
+} // namespace casbin
+
+#endif
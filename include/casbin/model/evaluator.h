@@ -18,48 +18,17 @@
 #ifndef CASBIN_CPP_MODEL_EVALATOR_CONFIG
 #define CASBIN_CPP_MODEL_EVALATOR_CONFIG
 
-#include <nlohmann/json.hpp>
 #include <string>
 #include <vector>
 #include <unordered_map>
 
 #include "../exprtk/exprtk.hpp"
+#include "./evaluator_interface.h"
 #include "./exprtk_config.h"
-#include "./model.h"
+#include "./matcher.h"
 
 namespace casbin {
 
-enum class Type { Bool, Float };
-
-class IEvaluator {
-public:
-    std::list<std::string> func_list;
-    virtual bool Eval(const std::string& expression) = 0;
-
-    virtual void InitialObject(const std::string& target) = 0;
-
-    virtual void PushObjectString(const std::string& target, const std::string& proprity, const std::string& var) = 0;
-
-    virtual void PushObjectJson(const std::string& target, const std::string& proprity, const nlohmann::json& var) = 0;
-
-    virtual void LoadFunctions() = 0;
-
-    virtual void LoadGFunction(std::shared_ptr<RoleManager> rm, const std::string& name, int narg) = 0;
-
-    virtual void ProcessFunctions(const std::string& expression) = 0;
-
-    virtual Type CheckType() = 0;
-
-    virtual bool GetBoolean() = 0;
-
-    virtual float GetFloat() = 0;
-
-    virtual std::string GetString() = 0;
-
-    virtual void Clean(AssertionMap& section, bool after_enforce = true) = 0;
-    virtual std::unordered_map<std::string, std::string> requestValues() const = 0;
-};
-
 class ExprtkEvaluator : public IEvaluator {
 private:
     std::string expression_string_;
@@ -67,10 +36,22 @@ private:
     symbol_table_t symbol_table;
     symbol_table_t glbl_variable_symbol_table;
     bool enable_get{false};
+    // the built-in functions are in the symbol table until it is cleaned
+    bool functions_loaded_{false};
+    // "&&" and "||" are compiled to the short-circuit "&" and "|" instead of "and" and "or"
+    bool short_circuit_{false};
     expression_t expression;
     parser_t parser;
     std::vector<std::shared_ptr<exprtk_func_t>> Functions;
+    std::unordered_map<std::string, std::shared_ptr<ExprtkGFunction>> g_functions_;
     std::unordered_map<std::string, std::unique_ptr<std::string>> identifiers_;
+    // the names of the functions testing the literal sets of "in", by their literals
+    std::unordered_map<std::string, std::string> in_functions_;
+
+    // RewriteIn rewrites the "in" of the expression, which exprtk does not know.
+    std::string RewriteIn(const std::string& expression);
+
+    void RewriteIn(MatcherNode& node);
 
 public:
     ExprtkEvaluator() {
@@ -87,6 +68,12 @@ public:
 
     void PushObjectJson(const std::string& target, const std::string& proprity, const nlohmann::json& var) override;
 
+    const std::string* GetObjectString(const std::string& target, const std::string& proprity) override;
+
+    std::string* GetObjectSlot(const std::string& target, const std::string& proprity) override;
+
+    void SetShortCircuit(bool enable) override;
+
     void LoadFunctions() override;
 
     void LoadGFunction(std::shared_ptr<RoleManager> rm, const std::string& name, int narg) override;
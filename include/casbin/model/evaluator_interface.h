@@ -0,0 +1,88 @@
+
+/*
+ * Copyright 2020 The casbin Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CASBIN_CPP_MODEL_EVALUATOR_INTERFACE
+#define CASBIN_CPP_MODEL_EVALUATOR_INTERFACE
+
+#include <list>
+#include <memory>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <unordered_map>
+
+#include "../rbac/role_manager.h"
+#include "./model.h"
+
+namespace casbin {
+
+enum class Type { Bool, Float };
+
+class IEvaluator {
+public:
+    std::list<std::string> func_list;
+
+    // NewEvaluator returns an evaluator of the engine the library is built with: exprtk,
+    // or the native evaluator for the casbin_lite library.
+    static std::shared_ptr<IEvaluator> NewEvaluator();
+
+    virtual bool Eval(const std::string& expression) = 0;
+
+    virtual void InitialObject(const std::string& target) = 0;
+
+    virtual void PushObjectString(const std::string& target, const std::string& proprity, const std::string& var) = 0;
+
+    virtual void PushObjectJson(const std::string& target, const std::string& proprity, const nlohmann::json& var) = 0;
+
+    // GetObjectString returns the string pushed for target.proprity, nullptr if there is none.
+    // Evaluators that do not expose their values return nullptr.
+    virtual const std::string* GetObjectString(const std::string&, const std::string&) {
+        return nullptr;
+    }
+
+    // GetObjectSlot returns the storage of target.proprity, created if needed, so that values
+    // can be assigned to it without a lookup until the evaluator is cleaned. nullptr if the
+    // evaluator has no such storage.
+    virtual std::string* GetObjectSlot(const std::string&, const std::string&) {
+        return nullptr;
+    }
+
+    // SetShortCircuit controls whether "&&" and "||" skip the operands after one deciding
+    // them, for matchers ordered by a MatcherPlan. Evaluators doing it always ignore it.
+    virtual void SetShortCircuit(bool) {
+    }
+
+    virtual void LoadFunctions() = 0;
+
+    virtual void LoadGFunction(std::shared_ptr<RoleManager> rm, const std::string& name, int narg) = 0;
+
+    virtual void ProcessFunctions(const std::string& expression) = 0;
+
+    virtual Type CheckType() = 0;
+
+    virtual bool GetBoolean() = 0;
+
+    virtual float GetFloat() = 0;
+
+    virtual std::string GetString() = 0;
+
+    virtual void Clean(AssertionMap& section, bool after_enforce = true) = 0;
+    virtual std::unordered_map<std::string, std::string> requestValues() const = 0;
+};
+
+} // namespace casbin
+
+#endif
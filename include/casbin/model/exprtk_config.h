@@ -20,6 +20,7 @@
 #include <memory>
 
 #include "casbin/exprtk/exprtk.hpp"
+#include "casbin/model/literal_set.h"
 #include "casbin/rbac/default_role_manager.h"
 #include "casbin/rbac/role_manager.h"
 #include "casbin/util/util.h"
@@ -130,8 +131,13 @@ public:
             }
         }
 
-        std::string name1 = exprtk::to_str(string_t(parameters[0]));
-        std::string name2 = exprtk::to_str(string_t(parameters[1]));
+        // the arguments are copied into buffers of the thread that keep their capacity
+        thread_local std::string name1;
+        thread_local std::string name2;
+        string_t arg1(parameters[0]);
+        string_t arg2(parameters[1]);
+        name1.assign(arg1.begin(), arg1.size());
+        name2.assign(arg2.begin(), arg2.size());
 
         if (this->func_ == nullptr)
             res = name1 == name2;
@@ -143,6 +149,34 @@ public:
     }
 };
 
+// ExprtkInFunction tests its argument against the literals of an "in" of the matcher.
+struct ExprtkInFunction final : public exprtk::igeneric_function<numerical_type> {
+    typedef typename exprtk::igeneric_function<numerical_type>::generic_type generic_type;
+
+    typedef typename generic_type::string_view string_t;
+
+    typedef typename exprtk::igeneric_function<numerical_type>::parameter_list_t parameter_list_t;
+
+private:
+    std::shared_ptr<const LiteralSet> set_;
+
+public:
+    ExprtkInFunction(std::shared_ptr<const LiteralSet> set) : exprtk::igeneric_function<numerical_type>("S"), set_(std::move(set)) {}
+
+    inline numerical_type operator()(parameter_list_t parameters) override {
+        if (parameters.size() != 1 || parameters[0].type != generic_type::e_string) {
+            return numerical_type(false);
+        }
+
+        // the argument is copied into a buffer of the thread that keeps its capacity
+        thread_local std::string value;
+        string_t arg(parameters[0]);
+        value.assign(arg.begin(), arg.size());
+
+        return numerical_type(this->set_->Contains(value));
+    }
+};
+
 // KeyGet
 struct ExprtkGetFunction final : public exprtk::igeneric_function<numerical_type> {
     typedef exprtk::igeneric_function<numerical_type> igenfunct_t;
@@ -0,0 +1,73 @@
+/*
+ * Copyright 2021 The casbin Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CASBIN_CPP_MODEL_FAST_REJECT_INDEX
+#define CASBIN_CPP_MODEL_FAST_REJECT_INDEX
+
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../enforce_context.h"
+#include "./evaluator_interface.h"
+#include "./model.h"
+
+namespace casbin {
+
+// FastRejectIndex decides without scanning the policy that a request cannot match any rule.
+//
+// The matcher is analysed once: every top-level conjunct "r.X == p.Y" (or "p.Y == r.X")
+// requires r.X to be a value of the policy column Y, and every top-level "g(r.X, p.Y, ...)"
+// requires r.X to be a value of column Y or a member name of a role definition sharing
+// that role manager. The index keeps counted sets of those values, updated on each policy
+// change, so a request missing from one of them takes the default decision immediately.
+class FastRejectIndex {
+private:
+    struct Requirement {
+        std::string r_token;
+        size_t p_column;
+        // The member names of a g() requirement, absent for an equality
+        std::optional<size_t> g_names;
+    };
+
+    EnforceContext m_context;
+    std::vector<Requirement> m_requirements;
+    std::unordered_map<size_t, std::unordered_map<std::string, size_t>> m_p_values;
+    // Member names counted per role manager, since role definitions sharing one link each other's names
+    std::vector<std::unordered_map<std::string, size_t>> m_g_names;
+    std::unordered_map<std::string, size_t> m_g_sources;
+
+    void Count(std::unordered_map<std::string, size_t>& values, const std::string& value, policy_op op);
+    size_t AddRoleManager(const std::shared_ptr<Model>& m, const std::shared_ptr<RoleManager>& rm);
+
+public:
+    // Build analyses the matcher of the context and indexes its current policy.
+    void Build(const std::shared_ptr<Model>& m, const EnforceContext& context = EnforceContext());
+
+    // Update applies a policy change made after Build.
+    void Update(policy_op op, const std::string& sec, const std::string& p_type, const PoliciesValues& rules);
+
+    // IsApplicable returns true if the matcher has conjuncts the index can check.
+    bool IsApplicable() const;
+
+    // Rejects returns true if the request pushed into the evaluator cannot match any rule.
+    bool Rejects(IEvaluator& evaluator) const;
+};
+
+} // namespace casbin
+
+#endif
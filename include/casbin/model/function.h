@@ -20,7 +20,7 @@
 #include <list>
 
 #include "../util/built_in_functions.h"
-#include "evaluator.h"
+#include "evaluator_interface.h"
 
 namespace casbin {
 
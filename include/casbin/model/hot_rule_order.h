@@ -0,0 +1,155 @@
+/*
+ * Copyright 2021 The casbin Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CASBIN_CPP_MODEL_HOT_RULE_ORDER
+#define CASBIN_CPP_MODEL_HOT_RULE_ORDER
+
+#include <atomic>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "./model.h"
+
+namespace casbin {
+
+// HotRuleOrder scans the rules of the policy most deciding first.
+//
+// It applies to the allow-override, deny-override and allow-and-deny effects, whose decision
+// does not depend on the order of the rules, only the rule reported for it may change. Each
+// rule counts the requests it decided, and every kReorderInterval decisions the scan order is
+// sorted by these counts, which are then halved so that the order follows the traffic. Rules
+// deciding equally often keep the policy order. The hottest rules are remembered by value, a
+// policy change keeps their place instead of starting over from the policy order: the changed
+// policy is indexed again on the next GetOrder.
+class HotRuleOrder {
+public:
+    static constexpr uint64_t kReorderInterval = 1024;
+    static constexpr size_t kRememberedRules = 256;
+
+    // Rules are the indexed rules of the policy in policy order and the decisions of each, empty
+    // when the policy cannot be ordered. The policy, its size and its first rule tell whether
+    // the policy is still the indexed one.
+    struct Rules {
+        const PoliciesValues* policy = nullptr;
+        size_t policy_size = 0;
+        const PolicyValues* first_rule = nullptr;
+        std::vector<const PolicyValues*> rules;
+        std::unique_ptr<std::atomic<uint32_t>[]> hits;
+    };
+
+    // Order is a scan order of the indexed rules. It shares the rules and their hits, so that a
+    // reader holding it keeps what it indexes alive while the policy is indexed again.
+    struct Order {
+        std::shared_ptr<Rules> rules;
+        std::vector<uint32_t> ids;
+
+        size_t size() const {
+            return ids.size();
+        }
+    };
+
+    // Range is the range of the rules of the policy in a scan order.
+    class Range {
+    public:
+        class const_iterator {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using difference_type = std::ptrdiff_t;
+            using value_type = const PolicyValues;
+            using pointer = value_type*;
+            using reference = value_type&;
+
+            const_iterator(const Rules* rules, std::vector<uint32_t>::const_iterator it) : m_rules(rules), m_it(it) {}
+
+            const PolicyValues& operator*() const {
+                return *m_rules->rules[*m_it];
+            }
+            const_iterator& operator++() {
+                ++m_it;
+                return *this;
+            }
+            bool operator==(const const_iterator& other) const {
+                return m_it == other.m_it;
+            }
+            bool operator!=(const const_iterator& other) const {
+                return m_it != other.m_it;
+            }
+
+        private:
+            const Rules* m_rules;
+            std::vector<uint32_t>::const_iterator m_it;
+        };
+
+        explicit Range(const Order* order) : m_order(order) {}
+
+        const_iterator begin() const {
+            return const_iterator(m_order->rules.get(), m_order->ids.begin());
+        }
+        const_iterator end() const {
+            return const_iterator(m_order->rules.get(), m_order->ids.end());
+        }
+
+    private:
+        const Order* m_order;
+    };
+
+private:
+    bool m_applicable = false;
+    size_t m_column_count = 0;
+    // The policy changed since its rules were indexed
+    std::atomic<bool> m_stale{false};
+
+    std::atomic<uint64_t> m_decisions{0};
+    std::mutex m_reorder_mutex;
+    // The scan order of the indexed policy, read by the scans without the mutex and replaced
+    // under it
+    std::shared_ptr<const Order> m_order;
+    std::unordered_map<PolicyValues, uint32_t> m_remembered;
+
+    void Reorder(bool decay);
+
+    // Index reads the rules of the policy and orders them by the remembered hits. The caller
+    // must hold m_reorder_mutex.
+    void Index(const PoliciesValues& policy);
+
+public:
+    // Build analyses the model and orders its current policy by the remembered hits.
+    void Build(const std::shared_ptr<Model>& m);
+
+    // IsApplicable returns true if the model has an effect the scan order does not change.
+    bool IsApplicable() const;
+
+    // Update marks the rules of the policy stale after it changed.
+    void Update(const std::string& sec, const std::string& p_type);
+
+    // GetOrder returns the scan order of the policy, indexing it again when it changed, nullptr
+    // when its rules cannot be ordered.
+    std::shared_ptr<const Order> GetOrder(const PoliciesValues& policy);
+
+    // GetRules returns the rules of the policy in the order.
+    static Range GetRules(const Order& order);
+
+    // Hit counts a decision by the rule at the position of the scan order.
+    void Hit(const Order& order, size_t position);
+};
+
+} // namespace casbin
+
+#endif
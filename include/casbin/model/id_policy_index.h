@@ -0,0 +1,177 @@
+/*
+ * Copyright 2021 The casbin Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CASBIN_CPP_MODEL_ID_POLICY_INDEX
+#define CASBIN_CPP_MODEL_ID_POLICY_INDEX
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "./model.h"
+#include "../effect/effect.h"
+#include "../effect/effector.h"
+#include "../rbac/default_role_manager.h"
+
+namespace casbin {
+
+typedef uint32_t ValueId;
+
+// kUnknownValueId stands for a value no rule holds, it never matches a policy value.
+constexpr ValueId kUnknownValueId = std::numeric_limits<ValueId>::max();
+
+// ValueIds is a request given as the dictionary ids of its values, in the order of the
+// request definition, tagged with the epoch of the dictionary that resolved them.
+struct ValueIds {
+    uint64_t epoch = 0;
+    std::vector<ValueId> ids;
+};
+
+// ValueIdsHash hashes the ids of a request, to key caches of decisions by them.
+struct ValueIdsHash {
+    size_t operator()(const std::vector<ValueId>& ids) const {
+        uint64_t hash = 14695981039346656037ULL;
+        for (ValueId id : ids)
+            hash = (hash ^ id) * 1099511628211ULL;
+        return static_cast<size_t>(hash);
+    }
+};
+
+// ValueDictionary interns the values of the policy as dense ids. The empty string is
+// always id 0. Ids stay stable within an epoch: values added to the policy get new ids and
+// removed values keep theirs, a new epoch starts only when the dictionary is compacted.
+class ValueDictionary {
+private:
+    uint64_t m_epoch = 0;
+    std::unordered_map<std::string, ValueId> m_ids;
+    std::vector<std::string> m_values;
+
+public:
+    explicit ValueDictionary(uint64_t epoch = 0);
+
+    // Intern returns the id of the value, adding it when it is new.
+    ValueId Intern(const std::string& value);
+
+    // GetId returns the id of the value, kUnknownValueId when no rule holds it.
+    ValueId GetId(const std::string& value) const;
+
+    // GetValue returns the value of an id of the dictionary.
+    const std::string& GetValue(ValueId id) const;
+
+    // Resolve returns the ids of the values of a request.
+    ValueIds Resolve(const std::vector<std::string>& values) const;
+
+    uint64_t GetEpoch() const;
+
+    size_t Size() const;
+};
+
+// IdPolicyIndex decides requests given as value ids without touching a string.
+//
+// It applies to allow-override, deny-override and allow-and-deny models whose matcher is a conjunction of
+// "r.X == p.Y" conjuncts and at most one "g(r.X, p.Y)" or "g(r.X, p.Y, r.D)" call backed by
+// a DefaultRoleManager without pattern matching. The "p" rules are kept as id tuples
+// grouped by their subject, and the role closure of a requested subject is cached as ids,
+// so a request costs integer compares over the rules of the roles of its subject.
+class IdPolicyIndex {
+private:
+    struct Rule {
+        // The ids of the compared columns, in the order of m_columns
+        std::vector<ValueId> values;
+        ValueId eft;
+        Effect effect;
+        size_t count;
+    };
+
+    // The policy effect: some(where (p.eft == allow)), !some(where (p.eft == deny)) or
+    // some(where (p.eft == allow)) && !some(where (p.eft == deny))
+    enum class Mode { AllowOverride, DenyOverride, AllowAndDeny };
+
+    typedef std::vector<ValueId> Closure;
+
+    bool m_applicable = false;
+    // The modes stand for the effect of a DefaultEffector only
+    bool m_default_effector = true;
+    Mode m_mode = Mode::AllowOverride;
+    bool m_hashed = false;
+    ValueDictionary m_dictionary;
+    size_t m_request_size = 0;
+    size_t m_column_count = 0;
+    int m_eft_column = -1;
+
+    std::string m_g_key;
+    std::shared_ptr<DefaultRoleManager> m_rm;
+    size_t m_subject_request = 0;
+    size_t m_subject_column = 0;
+    // The request index of the domain argument of the role check, -1 without one
+    int m_domain_request = -1;
+    // The compared request values and policy columns besides the subject
+    std::vector<size_t> m_requests;
+    std::vector<size_t> m_columns;
+
+    size_t m_rule_count = 0;
+    // rules without the expected number of columns, the generic evaluation rejects them
+    size_t m_invalid_rules = 0;
+    std::unordered_map<ValueId, std::vector<Rule>> m_rules;
+
+    // The closures are shared with the requests reading them, so that the cache can start
+    // over while they are read
+    mutable std::mutex m_closures_mutex;
+    mutable std::unordered_map<uint64_t, std::shared_ptr<const Closure>> m_closures;
+
+    void BuildRules(const std::shared_ptr<Model>& m);
+
+    void AddRule(const std::vector<std::string>& rule);
+
+    void RemoveRule(const std::vector<std::string>& rule);
+
+    // GetClosure returns the subject and the roles it inherits. m_closures_mutex is held only
+    // to look the closure up and to cache it.
+    std::shared_ptr<const Closure> GetClosure(ValueId subject, ValueId domain) const;
+
+public:
+    // Build analyses the model and interns its current policy. The dictionary and its epoch
+    // are kept, unless it grew much larger than the policy it interns.
+    void Build(const std::shared_ptr<Model>& m);
+
+    // Update applies a policy change made after Build.
+    void Update(policy_op op, const std::string& sec, const std::string& p_type, const PoliciesValues& rules);
+
+    // SetRoleManager points the index reading the role graph from at a copy of it, with the
+    // same links.
+    void SetRoleManager(const std::shared_ptr<RoleManager>& from, const std::shared_ptr<RoleManager>& to);
+
+    // SetEffector sets the effector of the enforcer, the index decides for a DefaultEffector.
+    void SetEffector(const std::shared_ptr<Effector>& eft);
+
+    // IsApplicable returns true if the model has the shape the index can decide, with the
+    // effect of a DefaultEffector.
+    bool IsApplicable() const;
+
+    const ValueDictionary& GetDictionary() const;
+
+    // Decide returns the decision for the request. It throws a CasbinEnforcerException when
+    // the ids are from another epoch or do not fit the request definition.
+    bool Decide(const ValueIds& request) const;
+};
+
+} // namespace casbin
+
+#endif
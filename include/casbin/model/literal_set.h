@@ -0,0 +1,50 @@
+
+/*
+ * Copyright 2020 The casbin Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CASBIN_CPP_MODEL_LITERAL_SET
+#define CASBIN_CPP_MODEL_LITERAL_SET
+
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace casbin {
+
+// LiteralSet is the set of the string literals an "in" of a matcher tests a value against,
+// like ('data2', 'data3') in "r.obj in ('data2', 'data3')". It is built once when the
+// matcher is compiled. Small sets are a sorted array searched by bisection, which beats
+// hashing the value, larger ones a hash set.
+class LiteralSet {
+public:
+    static constexpr size_t kMaxSortedSize = 8;
+
+private:
+    std::vector<std::string> m_sorted;
+    std::unordered_set<std::string> m_hashed;
+
+public:
+    explicit LiteralSet(const std::vector<std::string>& literals);
+
+    // Contains returns true if the value is one of the literals.
+    bool Contains(const std::string& value) const;
+
+    size_t Size() const;
+};
+
+} // namespace casbin
+
+#endif
@@ -0,0 +1,65 @@
+/*
+ * Copyright 2021 The casbin Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CASBIN_CPP_MODEL_MATCHER
+#define CASBIN_CPP_MODEL_MATCHER
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace casbin {
+
+// MatcherNode is a node of the syntax tree of a matcher expression.
+//
+// Or and And are n-ary, Compare and Arithmetic hold their operator in value, Call and
+// Identifier their name ("g", "r.sub"), String and Number their literal text. In holds
+// the tested operand followed by the List of candidates.
+class MatcherNode {
+public:
+    enum class Kind { Or, And, Not, Compare, Arithmetic, In, List, Call, Identifier, String, Number };
+
+    Kind kind;
+    std::string value;
+    std::vector<std::shared_ptr<MatcherNode>> children;
+
+    MatcherNode(Kind kind, const std::string& value = "");
+
+    // IsRequestField returns true if the node is a request field like "r.sub".
+    bool IsRequestField() const;
+
+    // IsPolicyField returns true if the node is a policy field like "p.sub".
+    bool IsPolicyField() const;
+};
+
+// ParseMatcher parses a matcher expression. It returns nullptr when the expression uses
+// syntax it does not know, callers must then treat the matcher as opaque.
+std::shared_ptr<MatcherNode> ParseMatcher(const std::string& expression);
+
+// ParseMatcher parses a matcher reading the request and policy definitions r_type and p_type,
+// like "r2" and "p2", and names their fields as those of the default ones ("r2.sub" -> "r.sub").
+std::shared_ptr<MatcherNode> ParseMatcher(const std::string& expression, const std::string& r_type, const std::string& p_type);
+
+// PrintMatcher formats a syntax tree back into an expression the evaluator accepts.
+std::string PrintMatcher(const MatcherNode& node);
+
+// GetConjuncts returns the operands of the top-level "&&" of the expression, or the
+// expression itself when it is not a conjunction.
+std::vector<std::shared_ptr<MatcherNode>> GetConjuncts(const std::shared_ptr<MatcherNode>& node);
+
+} // namespace casbin
+
+#endif
@@ -0,0 +1,106 @@
+/*
+ * Copyright 2021 The casbin Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CASBIN_CPP_MODEL_MATCHER_PLAN
+#define CASBIN_CPP_MODEL_MATCHER_PLAN
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "./evaluator_interface.h"
+#include "./matcher.h"
+#include "./model.h"
+
+namespace casbin {
+
+// MatcherPlan orders the operands of the "&&" and "||" of the model matcher, so that the
+// evaluator, which stops at the first operand deciding them, tries cheap and deciding
+// operands first. The decisions are those of the matcher as written.
+//
+// The operands are first ordered by an estimated cost: comparisons, then role checks, then
+// key and ip matching, then regular expressions. An operand calling a function not known
+// to be pure, like keyGet or a custom function, keeps its place and the others only move
+// between such operands. The operands of the top-level "&&" or "||" are then sampled: one
+// rule evaluation in kSampleInterval also evaluates each of them alone, recording its time
+// and whether it held. Every kSampleWindow samples they are ordered by their cost over
+// their chance to decide, when that order is expected to be cheaper than the current one.
+class MatcherPlan {
+public:
+    static constexpr uint64_t kSampleInterval = 64;
+    static constexpr uint64_t kSampleWindow = 128;
+
+private:
+    struct Operand {
+        std::shared_ptr<MatcherNode> node;
+        std::string expression;
+        // The request and policy fields the operand reads, as target and property
+        std::vector<std::pair<std::string, std::string>> fields;
+        bool pure = true;
+        std::shared_ptr<IEvaluator> evaluator;
+        double samples = 0;
+        double held = 0;
+        double nanos = 0;
+    };
+
+    bool m_applicable = false;
+    std::unordered_set<std::string> m_g_keys;
+    std::shared_ptr<MatcherNode> m_root;
+    // The operands of the root in their current order, sampled when there are several
+    std::vector<Operand> m_operands;
+    bool m_conjunction = false;
+    // Read by every rule evaluation, written by the sample holding m_sample_mutex
+    std::atomic<bool> m_sampling{false};
+    uint64_t m_window = 0;
+
+    std::mutex m_sample_mutex;
+    std::atomic<uint64_t> m_evaluations{0};
+    std::shared_ptr<const std::string> m_expression;
+
+    // Order orders the operands of the "&&" and "||" of the tree by their estimated cost and
+    // returns the cost of the node, it sets pure to false when the node calls an unknown function.
+    double Order(MatcherNode& node, bool& pure) const;
+
+    // Replan orders the operands by their sampled statistics.
+    void Replan();
+
+public:
+    // Build analyses the matcher of the model, or the given one derived from it like the
+    // hoisted matcher. Matchers using eval() or that do not parse are left as they are.
+    void Build(const std::shared_ptr<Model>& m, std::shared_ptr<const std::string> matcher = nullptr);
+
+    // IsApplicable returns true if the matcher is evaluated in the order of the plan.
+    bool IsApplicable() const;
+
+    // GetExpression returns the matcher in its current order.
+    std::shared_ptr<const std::string> GetExpression() const;
+
+    // ShouldSample counts a rule evaluation and returns true for the ones to sample.
+    bool ShouldSample();
+
+    // Sample evaluates each operand alone with the request and rule pushed into the
+    // evaluator. load_functions registers the functions of the model on an operand evaluator.
+    void Sample(IEvaluator& evaluator, const std::function<void(const std::shared_ptr<IEvaluator>&)>& load_functions);
+};
+
+} // namespace casbin
+
+#endif
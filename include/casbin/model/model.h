@@ -17,7 +17,9 @@
 #ifndef CASBIN_CPP_MODEL_MODEL
 #define CASBIN_CPP_MODEL_MODEL
 
+#include <memory_resource>
 #include <unordered_map>
+#include <unordered_set>
 
 #include "../config/config.h"
 #include "../config/config_interface.h"
@@ -31,11 +33,31 @@ public:
     std::unordered_map<std::string, std::shared_ptr<Assertion>> assertion_map;
 };
 
+// MemoryUsage reports the bytes held by the policy and the role graph of a model.
+struct MemoryUsage {
+    // The bytes of the policy of each "p" and "g" assertion, by assertion key
+    std::unordered_map<std::string, size_t> assertions;
+    // The bytes of the role graphs the "g" assertions are linked in
+    size_t role_graph = 0;
+
+    size_t Total() const;
+};
+
 // Model represents the whole access control model.
 class Model {
 private:
     static std::unordered_map<std::string, std::string> section_name_map;
 
+    // The policy of the assertions is allocated from it
+    std::pmr::memory_resource* m_resource = std::pmr::get_default_resource();
+
+    // The "p" and "g" assertions shared with a fork, they are copied before their policy changes
+    std::unordered_set<const Assertion*> m_shared;
+
+    // ownAssertion returns the assertion of the policy type, after copying it if it is shared
+    // with a fork, with the rules of a mapped policy copied into the model.
+    const std::shared_ptr<Assertion>& ownAssertion(const std::string& sec, const std::string& p_type);
+
     static void LoadSection(Model* raw_ptr, std::shared_ptr<ConfigInterface> cfg, const std::string& sec);
 
     static std::string GetKeySuffix(int i);
@@ -47,6 +69,23 @@ public:
 
     Model(const std::string& path);
 
+    // Model creates an empty model whose policy is allocated from the resource, e.g. an
+    // AccountingResource or a HugePageResource. The resource must outlive the model.
+    explicit Model(std::pmr::memory_resource* resource);
+
+    std::pmr::memory_resource* GetMemoryResource() const;
+
+    // GetMemoryUsage returns the bytes held by the policy of each assertion and by the
+    // DefaultRoleManager role graphs the assertions are linked in.
+    MemoryUsage GetMemoryUsage();
+
+    // InternPolicy interns the rules of the loaded policies into the memory resource of the
+    // model, strings included. It trades scan speed for memory: an interned rule is decoded
+    // into strings each time it is read, and the indexes addressing rules do not apply to it.
+    // A policy is copied into a vector before it is changed, and is loaded into one again.
+    // Models on the default resource and hash set policies are left as they are.
+    void InternPolicy();
+
     std::unordered_map<std::string, AssertionMap> m;
 
     // Minimal required sections for a model to be valid
@@ -77,6 +116,23 @@ public:
     // NewModel creates a model from a std::string which contains model text.
     static std::shared_ptr<Model> NewModelFromString(const std::string& text);
 
+    // NewModelSharingDefinition creates a model without policy that shares the request,
+    // effect and matcher assertions of an existing model instead of parsing them again.
+    static std::shared_ptr<Model> NewModelSharingDefinition(const std::shared_ptr<Model>& model);
+
+    // Fork creates a model sharing the definition and the policy of this one. A "p" or "g"
+    // assertion stays shared until one of the two models changes its policy through the Model
+    // API, which copies the assertion first. The copy shares the rules in chunks, so a fork
+    // costs the chunks of rules it changes.
+    std::shared_ptr<Model> Fork();
+
+    // IsShared returns true if the assertion of the policy type is shared with a fork.
+    bool IsShared(const std::string& sec, const std::string& p_type) const;
+
+    // Unshare copies the assertion of the policy type if it is shared with a fork, it must be
+    // called before changing the policy of the assertion directly.
+    void Unshare(const std::string& sec, const std::string& p_type);
+
     void BuildIncrementalRoleLinks(std::shared_ptr<RoleManager>& rm, policy_op op, const std::string& sec, const std::string& p_type, const PoliciesValues& rules);
 
     // BuildRoleLinks initializes the roles in RBAC.
@@ -103,6 +159,10 @@ public:
     // AddPolicies adds policy rules to the model.
     bool AddPolicies(const std::string& sec, const std::string& p_type, const PoliciesValues& rules);
 
+    // ImportPolicies moves the rules into the model, skipping those it already has and
+    // repeated ones. It returns the number of rules imported.
+    size_t ImportPolicies(const std::string& sec, const std::string& p_type, std::vector<std::vector<std::string>>&& rules);
+
     // UpdatePolicy updates a policy rule from the model.
     bool UpdatePolicy(const std::string& sec, const std::string& p_type, const std::vector<std::string>& oldRule, const std::vector<std::string>& newRule);
 
@@ -112,8 +172,9 @@ public:
     // RemovePolicy removes a policy rule from the model.
     bool RemovePolicy(const std::string& sec, const std::string& p_type, const std::vector<std::string>& rule);
 
-    // RemovePolicies removes policy rules from the model.
-    bool RemovePolicies(const std::string& sec, const std::string& p_type, const PoliciesValues& rules);
+    // RemovePolicies removes policy rules from the model. A rule listed twice is removed as
+    // many times as the policy holds it, the rules actually erased are added to removed_rules.
+    bool RemovePolicies(const std::string& sec, const std::string& p_type, const PoliciesValues& rules, PoliciesValues* removed_rules = nullptr);
 
     // RemoveFilteredPolicy removes policy rules based on field filters from the model.
     std::pair<bool, PoliciesValues> RemoveFilteredPolicy(const std::string& sec, const std::string& p_type, int field_index, const std::vector<std::string>& field_values);
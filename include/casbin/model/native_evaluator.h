@@ -0,0 +1,121 @@
+
+/*
+ * Copyright 2020 The casbin Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CASBIN_CPP_MODEL_NATIVE_EVALUATOR
+#define CASBIN_CPP_MODEL_NATIVE_EVALUATOR
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "./evaluator_interface.h"
+#include "./matcher.h"
+
+namespace casbin {
+
+// NativeEvaluator evaluates matchers without exprtk.
+//
+// An expression is parsed with ParseMatcher and compiled into a tree of typed nodes that
+// read the pushed values in place and call the functions directly, the compiled tree is
+// kept until another expression is evaluated. It accepts the syntax ParseMatcher knows,
+// with the semantics exprtk gives it: strings compare and concatenate with "+", numbers
+// hold the results of comparisons and functions, and "&&" and "||" stop at the first
+// operand deciding them. An expression that does not compile, e.g. for an unknown
+// identifier or a string compared to a number, makes Eval return false.
+class NativeEvaluator : public IEvaluator {
+public:
+    struct Node;
+
+    // Function is a function the matcher can call.
+    struct Function {
+        enum class Kind { Match, Get, GetWithPath, Role };
+
+        Function(Kind kind, size_t arg_count) : kind(kind), arg_count(arg_count) {}
+
+        Kind kind;
+        size_t arg_count;
+        std::function<bool(const std::string&, const std::string&)> match;
+        std::function<std::string(const std::string&, const std::string&)> get;
+        std::function<std::string(const std::string&, const std::string&, const std::string&)> get_with_path;
+        std::shared_ptr<RoleManager> rm;
+    };
+
+private:
+    std::unordered_map<std::string, std::unique_ptr<std::string>> m_identifiers;
+    std::unordered_map<std::string, std::unique_ptr<Function>> m_functions;
+    bool m_functions_loaded = false;
+
+    std::string m_expression_string;
+    std::shared_ptr<Node> m_root;
+    std::string m_error;
+
+    // the result of the last CheckType, for the GetBoolean or GetFloat following it
+    bool m_checked = false;
+    float m_result = 0;
+
+    std::shared_ptr<Node> Compile(const MatcherNode& node);
+
+    float Evaluate();
+
+public:
+    NativeEvaluator();
+
+    ~NativeEvaluator();
+
+    bool Eval(const std::string& expression) override;
+
+    void InitialObject(const std::string& target) override;
+
+    void PushObjectString(const std::string& target, const std::string& proprity, const std::string& var) override;
+
+    void PushObjectJson(const std::string& target, const std::string& proprity, const nlohmann::json& var) override;
+
+    const std::string* GetObjectString(const std::string& target, const std::string& proprity) override;
+
+    std::string* GetObjectSlot(const std::string& target, const std::string& proprity) override;
+
+    void LoadFunctions() override;
+
+    void LoadGFunction(std::shared_ptr<RoleManager> rm, const std::string& name, int narg) override;
+
+    void ProcessFunctions(const std::string& expression) override;
+
+    Type CheckType() override;
+
+    bool GetBoolean() override;
+
+    float GetFloat() override;
+
+    std::string GetString() override;
+
+    void Clean(AssertionMap& section, bool after_enforce = true) override;
+
+    // AddFunction makes a function callable from the matchers, the first registration of a
+    // name wins until the evaluator is cleaned.
+    void AddFunction(const std::string& name, const Function& function);
+
+    // AddIdentifier sets the value of an identifier of the matchers.
+    void AddIdentifier(const std::string& identifier, const std::string& var);
+
+    std::unordered_map<std::string, std::string> requestValues() const override;
+};
+
+} // namespace casbin
+
+#endif
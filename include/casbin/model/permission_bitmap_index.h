@@ -0,0 +1,146 @@
+/*
+ * Copyright 2021 The casbin Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CASBIN_CPP_MODEL_PERMISSION_BITMAP_INDEX
+#define CASBIN_CPP_MODEL_PERMISSION_BITMAP_INDEX
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "../enforce_context.h"
+#include "./evaluator_interface.h"
+#include "./model.h"
+#include "../rbac/default_role_manager.h"
+
+namespace casbin {
+
+// PermissionBitmap is a compressed set of permission ids. Only the non-empty 64 bit
+// blocks are stored, sorted by their position, so sparse sets stay small.
+class PermissionBitmap {
+private:
+    struct Block {
+        uint32_t key;
+        uint64_t bits;
+    };
+
+    std::vector<Block> m_blocks;
+
+    std::vector<Block>::iterator Find(uint32_t key);
+
+public:
+    void Set(uint32_t id);
+
+    void Reset(uint32_t id);
+
+    bool Test(uint32_t id) const;
+
+    // Union adds every id of other to the bitmap.
+    void Union(const PermissionBitmap& other);
+
+    bool Empty() const;
+};
+
+// PermissionBitmapIndex materializes the permissions of every subject for closed-world RBAC.
+//
+// It applies to allow-override models whose matcher is a conjunction of one
+// "g(r.X, p.Y)" (or "r.X == p.Y") selecting the subject and "r.A == p.B" or
+// "keyMatch(r.A, p.B)" conjuncts selecting the permission. Every distinct permission
+// tuple gets a bit, every subject the bitmap of its directly granted permissions, and the
+// effective bitmap of a requested subject is the union over its role closure, so a request
+// is decided by a single bit test. Rules whose keyMatch column holds a pattern are left to
+// the normal evaluation, which takes over whenever the bit is not set and such rules exist.
+class PermissionBitmapIndex {
+private:
+    struct Grant {
+        size_t count;
+        // The first rule granting the permission, reported as explanation
+        std::vector<std::string> rule;
+    };
+
+    struct Closure {
+        std::vector<std::string> subjects;
+        PermissionBitmap permissions;
+    };
+
+    EnforceContext m_context;
+    bool m_applicable = false;
+    std::string m_g_key;
+    std::shared_ptr<DefaultRoleManager> m_rm;
+    size_t m_column_count = 0;
+    int m_eft_column = -1;
+    size_t m_subject_column = 0;
+    std::string m_subject_token;
+    std::vector<size_t> m_permission_columns;
+    std::vector<std::string> m_permission_tokens;
+    std::vector<bool> m_pattern_columns;
+
+    std::unordered_map<std::string, uint32_t> m_permission_ids;
+    std::unordered_map<std::string, std::unordered_map<uint32_t, Grant>> m_grants;
+    std::unordered_map<std::string, PermissionBitmap> m_direct;
+    size_t m_pattern_rules = 0;
+
+    mutable std::mutex m_closures_mutex;
+    mutable std::unordered_map<std::string, Closure> m_closures;
+    // The requested subjects whose cached closure includes a subject, by subject
+    mutable std::unordered_map<std::string, std::unordered_set<std::string>> m_dependents;
+
+    void AddRule(const std::vector<std::string>& rule);
+
+    void RemoveRule(const std::vector<std::string>& rule);
+
+    bool IsPatternRule(const std::vector<std::string>& rule) const;
+
+    std::string PermissionKey(const std::vector<const std::string*>& values) const;
+
+    const Closure& GetClosure(const std::string& subject) const;
+
+    // EraseClosures drops the cached closures including the subject. The caller must hold
+    // m_closures_mutex.
+    void EraseClosures(const std::string& subject);
+
+    // ClearClosures drops every cached closure. The caller must hold m_closures_mutex.
+    void ClearClosures() const;
+
+public:
+    // Build analyses the definitions of the context and materializes the bitmaps of its
+    // current policy.
+    void Build(const std::shared_ptr<Model>& m, const EnforceContext& context = EnforceContext());
+
+    // Update applies a policy change made after Build.
+    void Update(policy_op op, const std::string& sec, const std::string& p_type, const PoliciesValues& rules);
+
+    // SetRoleManager points the index reading the role graph from at a copy of it, with the
+    // same links.
+    void SetRoleManager(const std::shared_ptr<RoleManager>& from, const std::shared_ptr<RoleManager>& to);
+
+    // IsApplicable returns true if the model has the shape the index can decide.
+    bool IsApplicable() const;
+
+    // Prepare computes the role closures of the subjects of the policy ahead of requests.
+    void Prepare(const std::shared_ptr<Model>& m) const;
+
+    // Decide sets allowed to the decision for the request pushed into the evaluator, and
+    // explains to the granting rule. It returns false when the normal evaluation must decide.
+    bool Decide(IEvaluator& evaluator, bool& allowed, std::vector<std::string>& explains) const;
+};
+
+} // namespace casbin
+
+#endif
@@ -16,9 +16,14 @@
 
 #pragma once
 
+#include <memory>
+#include <cstdint>
+#include <memory_resource>
 #include <unordered_set>
 #include <optional>
 
+#include "../util/memory_resource.h"
+
 template<>
 struct std::hash<std::vector<std::string>> {
        auto operator()(const std::vector<std::string>& rules) const -> size_t {
@@ -33,34 +38,162 @@ using PolicyValues = std::vector<std::string>;
 using PoliciesVector = std::vector<PolicyValues>;
 using PoliciesHashset = std::unordered_set<PolicyValues>;
 
+// MappedPolicies is a read-only sequence of rules stored outside of the process heap, like
+// the rules of a shared memory snapshot. The rules are addressed by positions, a rule is read
+// into the strings of the iterator reading it.
+class MappedPolicies {
+public:
+    virtual ~MappedPolicies() = default;
+    virtual size_t size() const = 0;
+    // Begin returns the position of the first rule, End the position past the last one.
+    virtual size_t Begin() const = 0;
+    virtual size_t End() const = 0;
+    // Next returns the position of the rule following the one at position.
+    virtual size_t Next(size_t position) const = 0;
+    // Read reads the rule at position into rule, reusing its strings.
+    virtual void Read(size_t position, PolicyValues& rule) const = 0;
+    // GetMemoryResource returns the resource the rules are copied into before they are changed.
+    virtual std::pmr::memory_resource* GetMemoryResource() const { return std::pmr::get_default_resource(); }
+    // GetMemoryUsage returns the bytes the rules hold in the process, 0 for a mapping.
+    virtual size_t GetMemoryUsage() const { return 0; }
+};
+
+// PoliciesValues is the collection of the rules of a policy. Its vector or hash set is
+// allocated from the memory resource it is created with, the rules themselves are
+// std::vector<std::string>. A copy is made with the default resource, a moved-to collection
+// takes the resource of the one it is moved from.
+//
+// A mapped collection reads its rules from a MappedPolicies, copies of it share the rules.
+// It is read-only: it copies the rules into a vector before it is changed, and the rules an
+// iterator returns are only valid until it is incremented.
+//
+// A chunked collection keeps its rules in chunks of up to kChunkRules rules, which copies of
+// it share. A change copies the chunk it changes when the chunk is shared, so a copy costs
+// the chunks changed after it. The rules of a shared chunk must not be changed through an
+// iterator.
 class PoliciesValues final {
 public:
 using PolicyValues = std::vector<std::string>;
-using PoliciesVector = std::vector<PolicyValues>;
-using PoliciesHashset = std::unordered_set<PolicyValues>;
+using PoliciesVector = std::pmr::vector<PolicyValues>;
+using PoliciesHashset = std::pmr::unordered_set<PolicyValues>;
+
+    static constexpr size_t kChunkRules = 1024;
 private:
+    // Chunk is a run of the rules of a chunked collection: the rules it holds, or a range of
+    // rules of a collection that owner keeps alive and that is never changed.
+    struct Chunk {
+        std::shared_ptr<PoliciesVector> rules;
+        std::shared_ptr<const void> owner;
+        const PolicyValues* first = nullptr;
+        size_t count = 0;
+
+        size_t size() const;
+        const PolicyValues& at(size_t index) const;
+    };
+    using PoliciesChunks = std::vector<Chunk>;
+
+    // Generation is a process-wide unique stamp of the state of the rules. A copied or
+    // assigned collection takes a new one.
+    struct Generation {
+        uint64_t value = Next();
+
+        Generation() = default;
+        Generation(const Generation&) noexcept : value(Next()) {}
+        Generation& operator=(const Generation&) noexcept {
+            value = Next();
+            return *this;
+        }
+        void Bump() noexcept {
+            value = Next();
+        }
+        static uint64_t Next() noexcept;
+    };
+
     std::optional<PoliciesVector> opt_base_vector;
     std::optional<PoliciesHashset> opt_base_hashset;
+    std::shared_ptr<const MappedPolicies> mapped_rules;
+    std::optional<PoliciesChunks> opt_base_chunks;
+    size_t chunked_size = 0;
+    std::pmr::memory_resource* chunk_resource = nullptr;
+    // Stamped again by every change but appending rules
+    Generation changes;
+
+    // ownChunk returns the rules of the chunk, copied first if they are shared.
+    PoliciesVector& ownChunk(size_t index);
+    // appendChunk returns the rules of the last chunk when it has room and is not shared,
+    // or of a new last chunk.
+    PoliciesVector& appendChunk();
 
     PoliciesValues(PoliciesVector&& base_collection);
     PoliciesValues(PoliciesHashset&& base_collection);
+
+    // MappedCursor is the position of an iterator over a mapped collection and the rule read
+    // there.
+    struct MappedCursor {
+        const MappedPolicies* rules = nullptr;
+        size_t position = 0;
+        mutable PolicyValues rule;
+        mutable bool is_read = false;
+
+        PolicyValues& Get() const;
+        void Advance();
+    };
+
+    // ChunkCursor is the position of an iterator over a chunked collection.
+    struct ChunkCursor {
+        const PoliciesChunks* chunks = nullptr;
+        size_t chunk = 0;
+        size_t rule = 0;
+
+        const PolicyValues& Get() const;
+        void Advance();
+    };
 public:
     PoliciesValues(const std::initializer_list<PolicyValues>& list={});
     PoliciesValues(size_t capacity);
-    static PoliciesValues createWithVector(const std::initializer_list<PolicyValues>& list={});
-    static PoliciesValues createWithHashset(const std::initializer_list<PolicyValues>& list={});
+    PoliciesValues(const PoliciesValues& other) = default;
+    PoliciesValues(PoliciesValues&& other) noexcept = default;
+    PoliciesValues& operator=(const PoliciesValues& other) = default;
+    PoliciesValues& operator=(PoliciesValues&& other) noexcept;
+    static PoliciesValues createWithVector(const std::initializer_list<PolicyValues>& list={}, std::pmr::memory_resource* resource=std::pmr::get_default_resource());
+    static PoliciesValues createWithHashset(const std::initializer_list<PolicyValues>& list={}, std::pmr::memory_resource* resource=std::pmr::get_default_resource());
+    static PoliciesValues createMapped(std::shared_ptr<const MappedPolicies> rules);
+    // createInterned creates a mapped collection reading the rules interned into resource.
+    static PoliciesValues createInterned(const PoliciesValues& rules, std::pmr::memory_resource* resource);
+    // createShared creates a chunked collection sharing the rules of a vector or chunked
+    // collection, which owner keeps alive and which is never changed again. Other collections
+    // are copied.
+    static PoliciesValues createShared(const PoliciesValues& rules, std::shared_ptr<const void> owner, std::pmr::memory_resource* resource=std::pmr::get_default_resource());
 
     size_t size() const;
     bool empty() const;
     bool is_hash() const;
+    bool is_mapped() const;
+    bool is_chunked() const;
+    // generation returns a value that changes with every change of the rules but appending
+    // rules at the end. With the size and the address of the first rule it tells whether the
+    // rules are still where they were.
+    uint64_t generation() const;
+    // detach copies the rules of a mapped collection into a vector allocated from resource.
+    void detach(std::pmr::memory_resource* resource=std::pmr::get_default_resource());
+    // get_memory_resource returns the resource the collection allocates from.
+    std::pmr::memory_resource* get_memory_resource() const;
+    // memory_usage returns the bytes held by the collection and its rules.
+    size_t memory_usage() const;
+    void reserve(size_t capacity);
     void emplace(const PolicyValues& element);
+    void emplace(PolicyValues&& element);
     class iterator final : std::input_iterator_tag {
         private:
             bool is_vector_iterator;
             mutable PoliciesVector::iterator opt_vector_iterator;
             mutable PoliciesHashset::iterator opt_hashset_iterator;
+            MappedCursor mapped_cursor;
+            ChunkCursor chunk_cursor;
             iterator(const PoliciesVector::iterator& base_iterator_);
             iterator(const PoliciesHashset::iterator& base_iterator_);
+            iterator(const MappedPolicies* rules, size_t position);
+            iterator(const PoliciesChunks* chunks, size_t chunk);
             friend class PoliciesValues;
         public:
             using iterator_category = std::input_iterator_tag;
@@ -69,7 +202,7 @@ public:
             using pointer = value_type*;
             using reference = value_type&;
             PolicyValues& operator*() const;
-            iterator operator++();
+            iterator& operator++();
             bool operator!=(const iterator& other) const;
     };
 
@@ -81,8 +214,12 @@ public:
             bool is_vector_iterator;
             mutable PoliciesVector::const_iterator opt_vector_iterator;
             mutable PoliciesHashset::const_iterator opt_hashset_iterator;
+            MappedCursor mapped_cursor;
+            ChunkCursor chunk_cursor;
             const_iterator(const PoliciesVector::const_iterator& base_iterator_);
             const_iterator(const PoliciesHashset::const_iterator& base_iterator_);
+            const_iterator(const MappedPolicies* rules, size_t position);
+            const_iterator(const PoliciesChunks* chunks, size_t chunk);
             friend class PoliciesValues;
         public:
             using iterator_category = std::input_iterator_tag;
@@ -91,7 +228,7 @@ public:
             using pointer = value_type*;
             using reference = value_type&;
             const PolicyValues& operator*() const;
-            const_iterator operator++();
+            const_iterator& operator++();
             bool operator!=(const const_iterator& other) const;
     };
 
@@ -103,3 +240,26 @@ public:
 
     void erase(const iterator&);
 };
+
+// InternedPolicies keeps rules in a memory resource, strings included: each distinct value
+// once in a buffer of characters, and each rule as the ids of its values.
+class InternedPolicies final : public MappedPolicies {
+private:
+    std::pmr::memory_resource* m_resource;
+    // Value i is the characters [m_values[i], m_values[i + 1]) of m_bytes
+    std::pmr::vector<char> m_bytes;
+    std::pmr::vector<size_t> m_values;
+    // Rule i is the value ids [m_rules[i], m_rules[i + 1]) of m_fields
+    std::pmr::vector<uint32_t> m_fields;
+    std::pmr::vector<size_t> m_rules;
+
+public:
+    InternedPolicies(const PoliciesValues& rules, std::pmr::memory_resource* resource);
+    size_t size() const override;
+    size_t Begin() const override;
+    size_t End() const override;
+    size_t Next(size_t position) const override;
+    void Read(size_t position, PolicyValues& rule) const override;
+    std::pmr::memory_resource* GetMemoryResource() const override;
+    size_t GetMemoryUsage() const override;
+};
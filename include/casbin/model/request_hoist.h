@@ -0,0 +1,109 @@
+/*
+ * Copyright 2021 The casbin Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CASBIN_CPP_MODEL_REQUEST_HOIST
+#define CASBIN_CPP_MODEL_REQUEST_HOIST
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "./evaluator_interface.h"
+#include "./matcher.h"
+#include "./model.h"
+
+namespace casbin {
+
+// RequestHoist evaluates the parts of the model matcher reading only the request once per
+// request instead of once per rule.
+//
+// The subexpressions of the matcher are classified by the fields they read. The largest ones
+// reading request fields and no policy field, and calling only functions known to be pure,
+// are the hoisted terms, when they call a function or test an "in" list, or when they are an
+// operand of the top-level "&&" or "||". The hoisted matcher reads the value of each term as
+// hoisted.tN, which Evaluate pushes into the evaluator of the request before the rules are
+// scanned. A term deciding the top-level "&&" or "||" decides the matcher for all the rules.
+class RequestHoist {
+public:
+    static constexpr const char* kTarget = "hoisted";
+
+    // Decision is what the hoisted terms tell about the matcher for a request.
+    enum class Decision {
+        // The terms were not evaluated, the request must use the model matcher
+        Unavailable,
+        // The matcher depends on the rules
+        None,
+        // The matcher holds for every rule
+        MatchesAll,
+        // The matcher holds for no rule
+        MatchesNone
+    };
+
+private:
+    struct Term {
+        std::string expression;
+        std::string property;
+        // The request fields the term reads, without the "r." prefix
+        std::vector<std::string> fields;
+        // The term is an operand of the top-level "&&" or "||", or the whole matcher
+        bool top_level = false;
+    };
+
+    bool m_applicable = false;
+    // Whether a top-level term holding, or failing, decides the matcher
+    bool m_held_decides = false;
+    bool m_failed_decides = false;
+    std::unordered_set<std::string> m_g_keys;
+    std::vector<Term> m_terms;
+    std::shared_ptr<const std::string> m_expression;
+
+    // The evaluators of the terms, one set per concurrent request
+    std::mutex m_idle_mutex;
+    std::vector<std::unique_ptr<std::vector<std::shared_ptr<IEvaluator>>>> m_idle;
+
+    // Hoist replaces the largest request-only subexpressions of the tree by the reads of their
+    // terms.
+    void Hoist(std::shared_ptr<MatcherNode>& node, bool top_level);
+
+public:
+    // Build analyses the matcher of the model. Matchers using eval(), that do not parse or
+    // without a request-only part are left as they are.
+    void Build(const std::shared_ptr<Model>& m);
+
+    // IsApplicable returns true if the matcher has hoisted terms.
+    bool IsApplicable() const;
+
+    // GetExpression returns the hoisted matcher.
+    std::shared_ptr<const std::string> GetExpression() const;
+
+    // InitialObject pushes empty term values, so that the hoisted matcher compiles before the
+    // first request.
+    void InitialObject(IEvaluator& evaluator) const;
+
+    // Evaluate evaluates the terms with the request values pushed into the evaluator and
+    // pushes their values next to them. load_functions registers the functions of the model
+    // on a term evaluator. The terms are not evaluated when a request value is not a string,
+    // or when a term fails alone.
+    Decision Evaluate(IEvaluator& evaluator, const std::function<void(const std::shared_ptr<IEvaluator>&)>& load_functions);
+};
+
+} // namespace casbin
+
+#endif
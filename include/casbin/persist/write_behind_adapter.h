@@ -0,0 +1,147 @@
+/*
+ * Copyright 2021 The casbin Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CASBIN_CPP_PERSIST_WRITE_BEHIND_ADAPTER
+#define CASBIN_CPP_PERSIST_WRITE_BEHIND_ADAPTER
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "./async_adapter.h"
+#include "./batch_adapter.h"
+
+namespace casbin {
+
+// WriteBehindAdapter stores the policy changes of the enforcer in the background through
+// another adapter, so that the management API returns without waiting for the storage.
+//
+// The changes are queued in order and a writer thread stores them every interval, or as soon
+// as max_batch rules are queued. Consecutive changes of the same kind to the same policy type
+// are coalesced into one AddPolicies or RemovePolicies call of a BatchAdapter, other adapters
+// get them one rule at a time. LoadPolicy, SavePolicy and RemoveFilteredPolicy first wait for
+// the queued changes, then call the adapter directly.
+//
+// A change the adapter fails to store is kept with its exception until TakeErrors, and the
+// next Flush reports it, or LoadPolicy, SavePolicy and RemoveFilteredPolicy throw it without
+// calling the adapter. Changes the adapter does not support are skipped, as the enforcer does
+// with a synchronous adapter.
+class WriteBehindAdapter : public BatchAdapter, public AsyncAdapter {
+public:
+    // WriteError is a change the adapter failed to store.
+    struct WriteError {
+        policy_op op;
+        std::string sec;
+        std::string p_type;
+        PoliciesValues rules;
+        std::exception_ptr error;
+    };
+
+private:
+    struct Change {
+        policy_op op;
+        std::string sec;
+        std::string p_type;
+        std::vector<std::vector<std::string>> rules;
+        // Set for the changes made through the async interface and for flushes
+        std::shared_ptr<std::promise<void>> promise;
+        bool flush = false;
+    };
+
+    std::shared_ptr<Adapter> m_adapter;
+    std::chrono::milliseconds m_interval;
+    size_t m_max_batch;
+
+    std::mutex m_mutex;
+    std::condition_variable m_wakeup;
+    std::deque<Change> m_queue;
+    size_t m_queued_rules = 0;
+    bool m_flush_requested = false;
+    bool m_stopping = false;
+    std::vector<WriteError> m_errors;
+    // changes failed since the last flush was reported
+    size_t m_unreported_errors = 0;
+    std::thread m_writer;
+
+    std::future<void> Enqueue(policy_op op, const std::string& sec, const std::string& p_type, std::vector<std::vector<std::string>> rules, bool async);
+
+    void Run();
+
+    void Write(std::deque<Change>& changes);
+
+    std::exception_ptr Store(policy_op op, const std::string& sec, const std::string& p_type, const PoliciesValues& rules);
+
+public:
+    // WriteBehindAdapter is the constructor for WriteBehindAdapter, it starts the writer thread.
+    WriteBehindAdapter(std::shared_ptr<Adapter> adapter, std::chrono::milliseconds interval = std::chrono::milliseconds(10), size_t max_batch = 256);
+
+    static std::shared_ptr<WriteBehindAdapter> NewWriteBehindAdapter(std::shared_ptr<Adapter> adapter, std::chrono::milliseconds interval = std::chrono::milliseconds(10), size_t max_batch = 256);
+
+    // ~WriteBehindAdapter stores the queued changes and stops the writer thread.
+    ~WriteBehindAdapter();
+
+    // LoadPolicy loads all policy rules from the adapter once the queued changes are stored.
+    void LoadPolicy(const std::shared_ptr<Model>& model);
+
+    // SavePolicy saves all policy rules to the adapter once the queued changes are stored.
+    void SavePolicy(const std::shared_ptr<Model>& model);
+
+    // AddPolicy queues adding a policy rule.
+    void AddPolicy(std::string sec, std::string p_type, std::vector<std::string> rule);
+
+    // RemovePolicy queues removing a policy rule.
+    void RemovePolicy(std::string sec, std::string p_type, std::vector<std::string> rule);
+
+    // AddPolicies queues adding policy rules.
+    void AddPolicies(std::string sec, std::string p_type, PoliciesValues rules);
+
+    // RemovePolicies queues removing policy rules.
+    void RemovePolicies(std::string sec, std::string p_type, PoliciesValues rules);
+
+    // RemoveFilteredPolicy removes the matching policy rules through the adapter once the
+    // queued changes are stored.
+    void RemoveFilteredPolicy(std::string sec, std::string p_type, int field_index, std::vector<std::string> field_values);
+
+    std::future<void> AddPolicyAsync(std::string sec, std::string p_type, std::vector<std::string> rule);
+
+    std::future<void> RemovePolicyAsync(std::string sec, std::string p_type, std::vector<std::string> rule);
+
+    std::future<void> AddPoliciesAsync(std::string sec, std::string p_type, PoliciesValues rules);
+
+    std::future<void> RemovePoliciesAsync(std::string sec, std::string p_type, PoliciesValues rules);
+
+    // Flush returns a future that is ready once every change queued before the call is stored.
+    // It holds a CasbinAdapterException if changes failed since the previous flush.
+    std::future<void> Flush();
+
+    // TakeErrors returns the changes that failed to be stored and forgets them.
+    std::vector<WriteError> TakeErrors();
+
+    // IsFiltered returns true if the loaded policy has been filtered.
+    bool IsFiltered();
+
+    // IsValid returns true if the adapter is valid.
+    bool IsValid();
+};
+
+}; // namespace casbin
+
+#endif
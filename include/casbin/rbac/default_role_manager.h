@@ -17,6 +17,7 @@
 #ifndef CASBIN_CPP_RBAC_DEFAULT_ROLE_MANAGER
 #define CASBIN_CPP_RBAC_DEFAULT_ROLE_MANAGER
 
+#include <memory_resource>
 #include <unordered_map>
 
 #include "casbin/pch.h"
@@ -31,11 +32,20 @@ typedef bool (*MatchingFunc)(const std::string&, const std::string&);
  */
 class Role {
 private:
-    std::vector<Role*> roles;
+    std::pmr::vector<Role*> roles;
+
+    friend class DefaultRoleManager;
 
 public:
+    using allocator_type = std::pmr::polymorphic_allocator<Role*>;
+
     std::string name;
 
+    Role() = default;
+
+    // Role creates a role whose links are allocated with the allocator.
+    explicit Role(const allocator_type& allocator);
+
     static std::unique_ptr<Role> NewRole(const std::string& name);
 
     void AddRole(Role* role);
@@ -49,33 +59,54 @@ public:
     std::string ToString();
 
     std::vector<std::string> GetRoles();
+
+    // GetMemoryUsage returns the bytes the role holds outside of itself.
+    size_t GetMemoryUsage() const;
 };
 
 class DefaultRoleManager : public RoleManager {
 private:
-    std::unordered_map<std::string, std::unique_ptr<Role>> all_roles;
+    // The roles are kept in the nodes of the map, allocated from its memory resource
+    std::pmr::unordered_map<std::string, Role> all_roles;
     bool has_pattern;
     int max_hierarchy_level;
-    MatchingFunc matching_func;
+    MatchingFunc matching_func = nullptr;
 
     bool HasRole(std::string name);
 
     Role* CreateRole(const std::string& name);
 
 public:
+    // The indexes keep the inherited roles of this many subjects before their caches start over.
+    static constexpr size_t kMaxCachedClosures = 1 << 16;
+
     /**
      * DefaultRoleManager is the constructor for creating an instance of the
      * default RoleManager implementation.
      *
      * @param max_hierarchy_level the maximized allowed RBAC hierarchy level.
+     * @param resource the memory resource of the role graph, it must outlive the role manager.
      */
-    DefaultRoleManager(int max_hierarchy_level);
+    DefaultRoleManager(int max_hierarchy_level, std::pmr::memory_resource* resource = std::pmr::get_default_resource());
 
     // e.BuildRoleLinks must be called after AddMatchingFunc().
     //
     // example: e.GetRoleManager().(*defaultrolemanager.RoleManager).AddMatchingFunc('matcher', util.KeyMatch)
     void AddMatchingFunc(MatchingFunc fn);
 
+    // HasPattern returns true if role names are matched with a matching function.
+    bool HasPattern();
+
+    // GetMaxHierarchyLevel returns the longest inheritance chain HasLink follows.
+    int GetMaxHierarchyLevel();
+
+    // GetMemoryUsage returns the bytes held by the role graph.
+    size_t GetMemoryUsage() const;
+
+    // Copy returns a role manager with a copy of the role graph and of the matching function,
+    // allocated from the same memory resource.
+    std::shared_ptr<DefaultRoleManager> Copy() const;
+
     /**
      * clear clears all stored data and resets the role manager to the initial state.
      */
@@ -107,6 +138,11 @@ public:
 
     std::vector<std::string> GetUsers(std::string name, std::vector<std::string> domain = {});
 
+    // GetInheritedRoles sets roles to the names HasLink links name to, including name itself
+    // when it is a role, without the domain prefix. It returns false when a matching function
+    // is used, the links must then be asked with HasLink.
+    bool GetInheritedRoles(const std::string& name, const std::vector<std::string>& domain, std::vector<std::string>& roles);
+
     /**
      * printRoles prints all the roles to log.
      */
@@ -22,7 +22,7 @@
 #include <regex>
 
 #include "casbin/model/policy_collection.hpp"
-#include "casbin/model/evaluator.h"
+#include "casbin/model/evaluator_interface.h"
 
 class SelectedPolicies final {
 private:
@@ -30,10 +30,17 @@ private:
     std::shared_ptr<casbin::Model> model;
     PoliciesValues selected_policies;
 
-    std::vector<std::string> requestedPolicy();
+    // requestedPolicy returns the request values as a rule, in a buffer of the thread.
+    const std::vector<std::string>& requestedPolicy();
 
 public:
     SelectedPolicies(
         const std::shared_ptr<casbin::IEvaluator>& evaluator, const std::string& matcher_, std::shared_ptr<casbin::Model> model);
     PoliciesValues& operator*();
+
+    // IsHashed returns true if the policy hands the matcher only the rule equal to the request.
+    bool IsHashed() const;
+
+    // Find returns the rule equal to the request, nullptr if the policy has none.
+    const PolicyValues* Find();
 };
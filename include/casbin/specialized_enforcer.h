@@ -0,0 +1,303 @@
+/*
+ * Copyright 2021 The casbin Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CASBIN_CPP_SPECIALIZED_ENFORCER
+#define CASBIN_CPP_SPECIALIZED_ENFORCER
+
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "./effect/effect.h"
+#include "./enforcer_interface.h"
+#include "./exception/casbin_enforcer_exception.h"
+#include "./model/matcher.h"
+#include "./model/model.h"
+#include "./rbac/default_role_manager.h"
+#include "./rbac/role_manager.h"
+
+namespace casbin {
+
+// EffectPolicy selects the policy effect of a SpecializedEnforcer.
+enum class EffectPolicy {
+    // e = some(where (p.eft == allow))
+    AllowOverride,
+    // e = !some(where (p.eft == deny))
+    DenyOverride,
+    // e = some(where (p.eft == allow)) && !some(where (p.eft == deny))
+    AllowAndDeny
+};
+
+// RoleQuery tells whether the subject of one request has the roles of the rules. With a
+// DefaultRoleManager without a matching function, the roles of the subject are collected
+// on the first question and the rules are checked against them without allocating; other
+// role managers are asked through HasLink.
+class RoleQuery {
+private:
+    RoleManager* m_rm;
+    std::string_view m_subject;
+    std::vector<std::string> m_domain;
+    mutable bool m_collected = false;
+    mutable bool m_complete = false;
+    mutable std::string m_subject_string;
+    // sorted
+    mutable std::vector<std::string> m_roles;
+
+    void Collect() const {
+        m_collected = true;
+        m_subject_string = std::string(m_subject);
+        if (auto* drm = dynamic_cast<DefaultRoleManager*>(m_rm); drm != nullptr)
+            m_complete = drm->GetInheritedRoles(m_subject_string, m_domain, m_roles);
+        std::sort(m_roles.begin(), m_roles.end());
+    }
+
+public:
+    RoleQuery(RoleManager* rm, std::string_view subject)
+        : m_rm(rm), m_subject(subject) {}
+
+    RoleQuery(RoleManager* rm, std::string_view subject, std::string_view domain)
+        : m_rm(rm), m_subject(subject), m_domain{std::string(domain)} {}
+
+    bool HasLink(const std::string& role) const {
+        if (m_rm == nullptr)
+            return false;
+        if (!m_collected)
+            this->Collect();
+        if (m_complete)
+            return std::binary_search(m_roles.begin(), m_roles.end(), role);
+        return m_rm->HasLink(m_subject_string, role, m_domain);
+    }
+};
+
+// AclMatcher is the matcher of examples/basic_model.conf.
+struct AclMatcher {
+    static constexpr size_t request_size = 3;
+    static constexpr std::array<const char*, 3> request_tokens = {"r_sub", "r_obj", "r_act"};
+    static constexpr std::array<const char*, 3> policy_tokens = {"p_sub", "p_obj", "p_act"};
+    // The underscores of the "g" definition, 0 when the model has no roles
+    static constexpr size_t role_arity = 0;
+    static constexpr const char* matcher = "r.sub == p.sub && r.obj == p.obj && r.act == p.act";
+
+    static RoleQuery Roles(RoleManager* rm, const std::string_view* r) {
+        return RoleQuery(rm, r[0]);
+    }
+
+    static bool Match(const RoleQuery&, const std::string_view* r, const std::vector<std::string>& p) {
+        return r[0] == p[0] && r[1] == p[1] && r[2] == p[2];
+    }
+};
+
+// RbacMatcher is the matcher of examples/rbac_model.conf.
+struct RbacMatcher {
+    static constexpr size_t request_size = 3;
+    static constexpr std::array<const char*, 3> request_tokens = {"r_sub", "r_obj", "r_act"};
+    static constexpr std::array<const char*, 3> policy_tokens = {"p_sub", "p_obj", "p_act"};
+    static constexpr size_t role_arity = 2;
+    static constexpr const char* matcher = "g(r.sub, p.sub) && r.obj == p.obj && r.act == p.act";
+
+    static RoleQuery Roles(RoleManager* rm, const std::string_view* r) {
+        return RoleQuery(rm, r[0]);
+    }
+
+    // The role check runs last, a subject always has its own role.
+    static bool Match(const RoleQuery& roles, const std::string_view* r, const std::vector<std::string>& p) {
+        if (r[1] != p[1] || r[2] != p[2])
+            return false;
+        if (r[0] == p[0])
+            return true;
+        return roles.HasLink(p[0]);
+    }
+};
+
+// RbacWithDomainsMatcher is the matcher of examples/rbac_with_domains_model.conf.
+struct RbacWithDomainsMatcher {
+    static constexpr size_t request_size = 4;
+    static constexpr std::array<const char*, 4> request_tokens = {"r_sub", "r_dom", "r_obj", "r_act"};
+    static constexpr std::array<const char*, 4> policy_tokens = {"p_sub", "p_dom", "p_obj", "p_act"};
+    static constexpr size_t role_arity = 3;
+    static constexpr const char* matcher = "g(r.sub, p.sub, r.dom) && r.dom == p.dom && r.obj == p.obj && r.act == p.act";
+
+    static RoleQuery Roles(RoleManager* rm, const std::string_view* r) {
+        return RoleQuery(rm, r[0], r[1]);
+    }
+
+    static bool Match(const RoleQuery& roles, const std::string_view* r, const std::vector<std::string>& p) {
+        if (r[1] != p[1] || r[2] != p[2] || r[3] != p[3])
+            return false;
+        if (r[0] == p[0])
+            return true;
+        return roles.HasLink(p[0]);
+    }
+};
+
+// SpecializedEnforcer decides requests of one of the stock models with its matcher and
+// effect compiled in, instead of evaluating the CONF expressions.
+//
+// It reads the policy and the role manager of the model it is created from, so policy
+// changes made through the enforcer owning the model are seen right away. The model is
+// checked to be the one of the matcher at construction, a CasbinEnforcerException is
+// thrown otherwise. A "p.eft" column after the matcher columns is honored. The decisions
+// are those of the generic enforcer with the default effector; after the enforcer loads
+// another model, a new SpecializedEnforcer must be created. Like Enforcer, it does no
+// locking of its own.
+//
+// Example:
+//     casbin::Enforcer e("examples/rbac_model.conf", "examples/rbac_policy.csv");
+//     casbin::SpecializedEnforcer<casbin::RbacMatcher> rbac(e);
+//     rbac.Enforce("alice", "data1", "read");
+template <typename Matcher, EffectPolicy effect_policy = EffectPolicy::AllowOverride>
+class SpecializedEnforcer {
+private:
+    std::shared_ptr<Model> m_model;
+    size_t m_column_count = 0;
+    bool m_has_eft = false;
+
+    template <size_t N>
+    static bool HasTokens(const std::vector<std::string>& tokens, const std::array<const char*, N>& expected, size_t extra) {
+        if (tokens.size() != N + extra)
+            return false;
+        return std::equal(expected.begin(), expected.end(), tokens.begin());
+    }
+
+    static const std::vector<std::string>& EmptyRule() {
+        static const std::vector<std::string> rule(Matcher::policy_tokens.size());
+        return rule;
+    }
+
+    // Definition returns the assertion of the model. It is looked up for every request, the
+    // enforcer owning the model replaces an assertion it shares with a fork before changing it.
+    const Assertion& Definition(const std::string& sec, const std::string& key) const {
+        return *m_model->m.find(sec)->second.assertion_map.find(key)->second;
+    }
+
+    bool Decide(const std::string_view* request) const {
+        static const std::string p = "p";
+        static const std::string g = "g";
+        RoleQuery roles = Matcher::Roles(Matcher::role_arity != 0 ? this->Definition(g, g).rm.get() : nullptr, request);
+        const PoliciesValues& policy = this->Definition(p, p).policy;
+
+        // like the generic enforcer, an empty policy is matched as one rule of empty values,
+        // which deny-override allows whether it matches or not
+        if (policy.empty())
+            return effect_policy == EffectPolicy::DenyOverride || Matcher::Match(roles, request, EmptyRule());
+
+        bool allowed = false;
+        bool matched = false;
+        for (const auto& rule : policy) {
+            if (rule.size() != m_column_count)
+                throw CasbinEnforcerException("invalid policy size");
+            if (!Matcher::Match(roles, request, rule))
+                continue;
+            matched = true;
+
+            Effect effect = Effect::Allow;
+            if (m_has_eft) {
+                const std::string& eft = rule[m_column_count - 1];
+                effect = eft == "allow" ? Effect::Allow : eft == "deny" ? Effect::Deny : Effect::Indeterminate;
+            }
+            if constexpr (effect_policy == EffectPolicy::AllowOverride) {
+                if (effect == Effect::Allow)
+                    return true;
+            } else {
+                if (effect == Effect::Deny)
+                    return false;
+                allowed = allowed || effect == Effect::Allow;
+            }
+        }
+
+        // deny-override allows every request no matching rule denies
+        if constexpr (effect_policy == EffectPolicy::DenyOverride)
+            return true;
+        // a hashed policy only hands the rule equal to the request to the generic enforcer,
+        // without it the request is decided like for an empty policy
+        if (!matched && policy.is_hash())
+            return Matcher::Match(roles, request, EmptyRule());
+        return allowed;
+    }
+
+    static const char* ExpectedEffect() {
+        switch (effect_policy) {
+        case EffectPolicy::AllowOverride:
+            return "some(where (p.eft == allow))";
+        case EffectPolicy::DenyOverride:
+            return "!some(where (p.eft == deny))";
+        default:
+            return "some(where (p.eft == allow)) && !some(where (p.eft == deny))";
+        }
+    }
+
+public:
+    explicit SpecializedEnforcer(const std::shared_ptr<Model>& m)
+        : m_model(m) {
+        auto definition = [this](const std::string& sec, const std::string& key) -> const Assertion& {
+            if (!m_model->HasSection(sec) || m_model->m[sec].assertion_map.count(key) == 0)
+                throw CasbinEnforcerException("the model has no definition for " + key);
+            return this->Definition(sec, key);
+        };
+
+        if (!HasTokens(definition("r", "r").tokens, Matcher::request_tokens, 0))
+            throw CasbinEnforcerException("the request definition does not fit the specialized matcher");
+
+        const std::vector<std::string>& p_tokens = definition("p", "p").tokens;
+        m_has_eft = HasTokens(p_tokens, Matcher::policy_tokens, 1) && p_tokens.back() == "p_eft";
+        if (!m_has_eft && !HasTokens(p_tokens, Matcher::policy_tokens, 0))
+            throw CasbinEnforcerException("the policy definition does not fit the specialized matcher");
+        m_column_count = p_tokens.size();
+
+        std::shared_ptr<MatcherNode> expected = ParseMatcher(Matcher::matcher);
+        std::shared_ptr<MatcherNode> actual = ParseMatcher(definition("m", "m").value);
+        if (actual == nullptr || PrintMatcher(*actual) != PrintMatcher(*expected))
+            throw CasbinEnforcerException("the matcher does not fit the specialized matcher");
+
+        const std::string& effect = definition("e", "e").value;
+        if (effect != ExpectedEffect())
+            throw CasbinEnforcerException("the policy effect does not fit the specialized enforcer");
+
+        if (Matcher::role_arity != 0) {
+            const std::string& g_value = definition("g", "g").value;
+            if (size_t(std::count(g_value.begin(), g_value.end(), '_')) != Matcher::role_arity)
+                throw CasbinEnforcerException("the role definition does not fit the specialized matcher");
+        }
+    }
+
+    explicit SpecializedEnforcer(IEnforcer& e)
+        : SpecializedEnforcer(e.GetModel()) {
+    }
+
+    // Enforce decides whether a subject can access an object with an action, the values
+    // are given in the order of the request definition.
+    template <typename... Values>
+    bool Enforce(const Values&... values) const {
+        static_assert(sizeof...(Values) == Matcher::request_size, "the request needs one value per request definition token");
+        const std::string_view request[] = {std::string_view(values)...};
+        return this->Decide(request);
+    }
+
+    bool Enforce(const std::vector<std::string>& params) const {
+        if (params.size() != Matcher::request_size)
+            throw CasbinEnforcerException("invalid request size");
+        std::array<std::string_view, Matcher::request_size> request;
+        std::copy(params.begin(), params.end(), request.begin());
+        return this->Decide(request.data());
+    }
+};
+
+} // namespace casbin
+
+#endif // CASBIN_CPP_SPECIALIZED_ENFORCER
@@ -0,0 +1,149 @@
+/*
+ * Copyright 2021 The casbin Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CASBIN_CPP_TRANSACTION
+#define CASBIN_CPP_TRANSACTION
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "./enforcer.h"
+
+namespace casbin {
+
+// Transaction stages policy changes and applies them to an enforcer in one commit.
+//
+// Every staged operation is checked against the rules the policy will hold once the
+// operations staged before it are applied, so an invalid operation is refused when it is
+// staged. Only the net changes are kept. A rule is looked up in them and in an index of the
+// policy by hash, and compared like the model compares rules. Commit applies all of them
+// under one lock of a SyncedEnforcer, with one incremental role link pass, one batch per
+// policy type to the adapter and the watcher, and one cache invalidation. If any step
+// fails, the changes are undone.
+//
+// Example:
+//     casbin::Transaction transaction = e.BeginTransaction();
+//     transaction.AddPolicy({"alice", "data1", "read"});
+//     transaction.AddGroupingPolicy({"alice", "admin"});
+//     transaction.Commit();
+class Transaction {
+public:
+    enum class OperationType { Add, Remove, Update };
+
+    struct Operation {
+        OperationType type;
+        std::string sec;
+        std::string p_type;
+        std::vector<std::string> rule;
+        // The replacement of rule for an update
+        std::vector<std::string> new_rule;
+    };
+
+    // PolicyChanges are the net changes of operations to one policy type: the rules the
+    // policy does not hold yet and the rules of the policy that are removed.
+    struct PolicyChanges {
+        // RuleEqual compares rules like the model does, whatever the order of their values.
+        struct RuleEqual {
+            bool operator()(const std::vector<std::string>& a, const std::vector<std::string>& b) const;
+        };
+        // The rules, each with the number of the operation that staged it
+        using StagedRules = std::unordered_map<std::vector<std::string>, size_t, std::hash<std::vector<std::string>>, RuleEqual>;
+
+        std::string sec;
+        std::string p_type;
+        StagedRules added;
+        StagedRules removed;
+        size_t staged = 0;
+
+        // Holds returns true if the policy holds the rule once changed.
+        bool Holds(Model& m, const std::vector<std::string>& rule);
+
+        // Apply applies the operation to the changes, false if the policy once changed does
+        // not allow it.
+        bool Apply(Model& m, const Operation& operation);
+
+    private:
+        struct RuleRefHash {
+            size_t operator()(const std::vector<std::string>* rule) const;
+        };
+        struct RuleRefEqual {
+            bool operator()(const std::vector<std::string>* a, const std::vector<std::string>* b) const;
+        };
+
+        // The rules of the policy, indexed again when it changed since
+        std::unordered_set<const std::vector<std::string>*, RuleRefHash, RuleRefEqual> m_policy;
+        uint64_t m_generation = 0;
+        size_t m_size = 0;
+
+        // HasPolicy returns true if the policy holds the rule now.
+        bool HasPolicy(Model& m, const std::vector<std::string>& rule);
+    };
+
+private:
+    Enforcer* m_enforcer;
+    // Set when the transaction is staged by the holder of the enforcer's exclusive lock
+    bool m_locked = false;
+    friend class SyncedEnforcer;
+    std::vector<Operation> m_operations;
+    // The changes to every touched policy type, by "sec.p_type"
+    std::unordered_map<std::string, PolicyChanges> m_changes;
+
+    bool Stage(OperationType type, const std::string& sec, const std::string& p_type, const std::vector<std::string>& rule, const std::vector<std::string>& new_rule = {});
+
+public:
+    explicit Transaction(Enforcer& e);
+
+    // AddPolicy stages adding an authorization rule, false if the policy will already have it.
+    bool AddPolicy(const std::vector<std::string>& params);
+
+    bool AddNamedPolicy(const std::string& p_type, const std::vector<std::string>& params);
+
+    // RemovePolicy stages removing an authorization rule, false if the policy will not have it.
+    bool RemovePolicy(const std::vector<std::string>& params);
+
+    bool RemoveNamedPolicy(const std::string& p_type, const std::vector<std::string>& params);
+
+    // UpdatePolicy stages replacing an authorization rule.
+    bool UpdatePolicy(const std::vector<std::string>& old_params, const std::vector<std::string>& new_params);
+
+    bool UpdateNamedPolicy(const std::string& p_type, const std::vector<std::string>& old_params, const std::vector<std::string>& new_params);
+
+    // AddGroupingPolicy stages adding a role inheritance rule.
+    bool AddGroupingPolicy(const std::vector<std::string>& params);
+
+    bool AddNamedGroupingPolicy(const std::string& p_type, const std::vector<std::string>& params);
+
+    // RemoveGroupingPolicy stages removing a role inheritance rule.
+    bool RemoveGroupingPolicy(const std::vector<std::string>& params);
+
+    bool RemoveNamedGroupingPolicy(const std::string& p_type, const std::vector<std::string>& params);
+
+    // GetOperations returns the staged operations in order.
+    const std::vector<Operation>& GetOperations() const;
+
+    // Commit applies the staged operations to the enforcer. It returns false and leaves the
+    // policy unchanged if an operation no longer applies. The transaction is empty afterwards.
+    bool Commit();
+
+    // Rollback discards the staged operations.
+    void Rollback();
+};
+
+} // namespace casbin
+
+#endif
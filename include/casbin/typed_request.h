@@ -0,0 +1,67 @@
+/*
+ * Copyright 2021 The casbin Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CASBIN_CPP_TYPED_REQUEST
+#define CASBIN_CPP_TYPED_REQUEST
+
+#include <array>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace casbin {
+
+// RequestTraits binds the fields of a request struct to the tokens of the request
+// definition, in order. Specialize it with a tuple of pointers to members convertible to
+// std::string_view:
+//
+//     struct Req { std::string_view sub, obj, act; };
+//
+//     namespace casbin {
+//     template <>
+//     struct RequestTraits<Req> {
+//         static constexpr auto fields = std::make_tuple(&Req::sub, &Req::obj, &Req::act);
+//     };
+//     }
+//
+//     e.Enforce(Req{"alice", "data1", "read"});
+//
+// The fields are written straight into the evaluator, without variants, name lookups or
+// temporary strings.
+template <typename Request>
+struct RequestTraits;
+
+// IsBoundRequest is true for the request types RequestTraits is specialized for.
+template <typename Request, typename = void>
+struct IsBoundRequest : std::false_type {};
+
+template <typename Request>
+struct IsBoundRequest<Request, std::void_t<decltype(RequestTraits<Request>::fields)>> : std::true_type {};
+
+// RequestFieldCount is the number of fields RequestTraits binds for the request type.
+template <typename Request>
+constexpr size_t RequestFieldCount = std::tuple_size_v<std::decay_t<decltype(RequestTraits<Request>::fields)>>;
+
+// GetRequestValues reads the bound fields of the request in order.
+template <typename Request, size_t... I>
+std::array<std::string_view, sizeof...(I)> GetRequestValues(const Request& request, std::index_sequence<I...>) {
+    return {std::string_view(request.*std::get<I>(RequestTraits<Request>::fields))...};
+}
+
+} // namespace casbin
+
+#endif
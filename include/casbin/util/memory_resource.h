@@ -0,0 +1,121 @@
+/*
+ * Copyright 2021 The casbin Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CASBIN_CPP_UTIL_MEMORY_RESOURCE
+#define CASBIN_CPP_UTIL_MEMORY_RESOURCE
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+namespace casbin {
+
+// HeapBytes returns the bytes a string holds outside of itself, 0 for a short string.
+inline size_t HeapBytes(const std::string& s) {
+    static const size_t inline_capacity = std::string().capacity();
+    return s.capacity() > inline_capacity ? s.capacity() + 1 : 0;
+}
+
+// HeapBytes returns the bytes a rule holds outside of itself.
+inline size_t HeapBytes(const std::vector<std::string>& rule) {
+    size_t bytes = rule.capacity() * sizeof(std::string);
+    for (const std::string& value : rule)
+        bytes += HeapBytes(value);
+    return bytes;
+}
+
+// AccountingResource counts the bytes allocated through it and not given back yet.
+//
+// Example:
+//     casbin::AccountingResource resource;
+//     auto m = std::make_shared<casbin::Model>(&resource);
+//     m->LoadModel("examples/rbac_model.conf");
+//     casbin::Enforcer e(m, std::make_shared<casbin::FileAdapter>("examples/rbac_policy.csv"));
+//     resource.GetBytes();
+class AccountingResource : public std::pmr::memory_resource {
+private:
+    std::pmr::memory_resource* m_upstream;
+    std::atomic<size_t> m_bytes{0};
+    std::atomic<size_t> m_peak_bytes{0};
+
+    void* do_allocate(size_t bytes, size_t alignment) override;
+
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+public:
+    explicit AccountingResource(std::pmr::memory_resource* upstream = std::pmr::get_default_resource());
+
+    // GetBytes returns the bytes in use.
+    size_t GetBytes() const;
+
+    // GetPeakBytes returns the most bytes that were in use at once.
+    size_t GetPeakBytes() const;
+
+    std::pmr::memory_resource* GetUpstream() const;
+};
+
+// HugePageResource serves allocations from memory mapped in huge pages, so that the policy
+// and the role graph are packed in few TLB entries.
+//
+// Small blocks are pooled in 2 MiB regions mapped with MAP_HUGETLB. When the system has no
+// huge pages reserved, the regions are mapped normally and advised with MADV_HUGEPAGE for
+// transparent huge pages. Large blocks get mappings of their own, large blocks aligned on
+// more than a page come from the global heap. Outside of Linux, the
+// regions come from the global heap. The memory goes back to the system when the resource
+// is released or destroyed; the resource must outlive what is allocated from it.
+class HugePageResource : public std::pmr::memory_resource {
+public:
+    class RegionResource;
+
+private:
+    std::unique_ptr<RegionResource> m_regions;
+    std::pmr::synchronized_pool_resource m_pool;
+
+    void* do_allocate(size_t bytes, size_t alignment) override;
+
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+public:
+    HugePageResource();
+
+    ~HugePageResource() override;
+
+    HugePageResource(const HugePageResource&) = delete;
+
+    HugePageResource& operator=(const HugePageResource&) = delete;
+
+    // Release gives all the memory back to the system at once. Nothing allocated from the
+    // resource may be used afterwards.
+    void Release();
+
+    // GetMappedBytes returns the bytes mapped from the system.
+    size_t GetMappedBytes() const;
+
+    // GetHugePageBytes returns the bytes mapped with MAP_HUGETLB, the others are at most
+    // advised to be backed by transparent huge pages.
+    size_t GetHugePageBytes() const;
+};
+
+} // namespace casbin
+
+#endif // CASBIN_CPP_UTIL_MEMORY_RESOURCE
@@ -0,0 +1,60 @@
+/*
+ * Copyright 2021 The casbin Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CASBIN_CPP_UTIL_REQUEST_ARENA
+#define CASBIN_CPP_UTIL_REQUEST_ARENA
+
+#include <cstddef>
+#include <memory_resource>
+
+namespace casbin {
+
+// RequestArena is the memory of the temporaries of the requests of a thread.
+//
+// It is a monotonic buffer that is released when the outermost request of the thread ends.
+// A request that outgrows the buffer takes the rest from the global heap, and the buffer is
+// then enlarged to fit it, so steady-state requests never reach the global heap.
+class RequestArena {
+public:
+    // Scope marks a request of the calling thread. Memory taken from Resource() must be given
+    // back before the scope ends.
+    class Scope {
+    private:
+        bool m_outermost;
+
+    public:
+        Scope();
+
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+
+        Scope& operator=(const Scope&) = delete;
+
+        // IsOutermost returns true if no other request of the thread is in progress.
+        bool IsOutermost() const;
+    };
+
+    // Resource returns the memory resource of the requests of the calling thread.
+    static std::pmr::memory_resource* Resource();
+
+    // Capacity returns the size in bytes of the buffer of the calling thread.
+    static size_t Capacity();
+};
+
+} // namespace casbin
+
+#endif // CASBIN_CPP_UTIL_REQUEST_ARENA
@@ -0,0 +1,136 @@
+/*
+ * Copyright 2021 The casbin Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file replaces the global operator new to count the heap allocations of the benchmarks of
+ * casbin_allocation_benchmark, the other benchmarks are built without it
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+#include "allocation_counter.h"
+
+namespace {
+
+std::atomic<uint64_t> s_allocations{0};
+std::atomic<int64_t> s_live_bytes{0};
+
+// Every allocation is preceded by its size, kept in a header that preserves the alignment
+constexpr std::size_t kHeaderSize = alignof(std::max_align_t);
+
+void* CountedAllocate(std::size_t size) {
+    s_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(kHeaderSize + size)) {
+        *static_cast<std::size_t*>(ptr) = size;
+        s_live_bytes.fetch_add(static_cast<int64_t>(size), std::memory_order_relaxed);
+        return static_cast<char*>(ptr) + kHeaderSize;
+    }
+    throw std::bad_alloc();
+}
+
+void CountedFree(void* ptr) {
+    if (ptr == nullptr)
+        return;
+    void* block = static_cast<char*>(ptr) - kHeaderSize;
+    s_live_bytes.fetch_sub(static_cast<int64_t>(*static_cast<std::size_t*>(block)), std::memory_order_relaxed);
+    std::free(block);
+}
+
+// An over-aligned allocation is preceded by a whole alignment, its size is kept at the end of it
+std::size_t AlignedHeaderSize(std::align_val_t alignment) {
+    return std::max(kHeaderSize, static_cast<std::size_t>(alignment));
+}
+
+void* CountedAllocate(std::size_t size, std::align_val_t alignment) {
+    s_allocations.fetch_add(1, std::memory_order_relaxed);
+    std::size_t align = static_cast<std::size_t>(alignment);
+    std::size_t header = AlignedHeaderSize(alignment);
+    if (void* ptr = std::aligned_alloc(align, (header + size + align - 1) / align * align)) {
+        char* result = static_cast<char*>(ptr) + header;
+        *reinterpret_cast<std::size_t*>(result - kHeaderSize) = size;
+        s_live_bytes.fetch_add(static_cast<int64_t>(size), std::memory_order_relaxed);
+        return result;
+    }
+    throw std::bad_alloc();
+}
+
+void CountedFree(void* ptr, std::align_val_t alignment) {
+    if (ptr == nullptr)
+        return;
+    char* result = static_cast<char*>(ptr);
+    s_live_bytes.fetch_sub(static_cast<int64_t>(*reinterpret_cast<std::size_t*>(result - kHeaderSize)), std::memory_order_relaxed);
+    std::free(result - AlignedHeaderSize(alignment));
+}
+
+} // namespace
+
+uint64_t AllocationCount() {
+    return s_allocations.load(std::memory_order_relaxed);
+}
+
+int64_t LiveBytes() {
+    return s_live_bytes.load(std::memory_order_relaxed);
+}
+
+void* operator new(std::size_t size) {
+    return CountedAllocate(size);
+}
+
+void* operator new[](std::size_t size) {
+    return CountedAllocate(size);
+}
+
+void operator delete(void* ptr) noexcept {
+    CountedFree(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    CountedFree(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    CountedFree(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept {
+    CountedFree(ptr);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    return CountedAllocate(size, alignment);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return CountedAllocate(size, alignment);
+}
+
+void operator delete(void* ptr, std::align_val_t alignment) noexcept {
+    CountedFree(ptr, alignment);
+}
+
+void operator delete[](void* ptr, std::align_val_t alignment) noexcept {
+    CountedFree(ptr, alignment);
+}
+
+void operator delete(void* ptr, std::size_t, std::align_val_t alignment) noexcept {
+    CountedFree(ptr, alignment);
+}
+
+void operator delete[](void* ptr, std::size_t, std::align_val_t alignment) noexcept {
+    CountedFree(ptr, alignment);
+}
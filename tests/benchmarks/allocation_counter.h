@@ -0,0 +1,30 @@
+/*
+ * Copyright 2021 The casbin Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file declares the counter of global heap allocations made by the benchmarks
+ */
+
+#ifndef CASBIN_BENCHMARK_ALLOCATION_COUNTER
+#define CASBIN_BENCHMARK_ALLOCATION_COUNTER
+
+#include <cstdint>
+
+// AllocationCount returns the number of global operator new calls since the start.
+uint64_t AllocationCount();
+
+// LiveBytes returns the bytes allocated by global operator new and not deleted yet.
+int64_t LiveBytes();
+
+#endif
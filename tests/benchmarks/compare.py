@@ -0,0 +1,161 @@
+#!/usr/bin/env python3
+#  Copyright 2021 The casbin Authors. All Rights Reserved.
+#
+#  Licensed under the Apache License, Version 2.0 (the "License");
+#  you may not use this file except in compliance with the License.
+#  You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+#  Unless required by applicable law or agreed to in writing, software
+#  distributed under the License is distributed on an "AS IS" BASIS,
+#  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+#  See the License for the specific language governing permissions and
+#  limitations under the License.
+
+"""Compares two casbin_benchmark JSON reports.
+
+Usage:
+    compare.py baseline.json contender.json [--threshold 0.05] [--alpha 0.05]
+
+Every benchmark present in both files is reported with its relative change. When both
+runs have repetitions (--benchmark_repetitions=N), a two-sided Mann-Whitney U test decides
+whether the change is significant. A benchmark is flagged as a regression when it became
+slower by more than the threshold and the change is significant. Benchmarks with fewer
+than --min-repetitions samples on either side are reported but never flagged, a single
+noisy run is not evidence of a regression. The exit status is 1 if any regression was
+flagged.
+"""
+
+import argparse
+import json
+import math
+import sys
+
+TIME_UNIT_NS = {"ns": 1.0, "us": 1e3, "ms": 1e6, "s": 1e9}
+
+CONTEXT_KEYS = ["casbin_commit", "casbin_compiler", "casbin_build_type", "casbin_cpu_model",
+                "casbin_intensive_benchmark", "num_cpus", "mhz_per_cpu", "library_build_type"]
+
+# Below this number of samples per side the normal approximation is meaningless.
+MIN_SAMPLES = 5
+
+
+def load_report(path, metric):
+    with open(path) as f:
+        report = json.load(f)
+
+    samples = {}
+    for bench in report.get("benchmarks", []):
+        if bench.get("run_type", "iteration") != "iteration" or bench.get("error_occurred"):
+            continue
+        name = bench.get("run_name", bench["name"])
+        scale = TIME_UNIT_NS.get(bench.get("time_unit", "ns"), 1.0)
+        samples.setdefault(name, []).append(bench[metric] * scale)
+
+    return report.get("context", {}), samples
+
+
+def mann_whitney_p(xs, ys):
+    """Two-sided p-value of the Mann-Whitney U test, normal approximation with tie correction."""
+    n1, n2 = len(xs), len(ys)
+    ranked = sorted([(v, 0) for v in xs] + [(v, 1) for v in ys])
+    ranks = [0.0] * len(ranked)
+    tie_term = 0.0
+    i = 0
+    while i < len(ranked):
+        j = i
+        while j + 1 < len(ranked) and ranked[j + 1][0] == ranked[i][0]:
+            j += 1
+        for k in range(i, j + 1):
+            ranks[k] = (i + j) / 2.0 + 1.0
+        t = j - i + 1
+        tie_term += t ** 3 - t
+        i = j + 1
+
+    r1 = sum(r for r, (_, group) in zip(ranks, ranked) if group == 0)
+    u1 = r1 - n1 * (n1 + 1) / 2.0
+    n = n1 + n2
+    mean = n1 * n2 / 2.0
+    var = n1 * n2 / 12.0 * ((n + 1) - tie_term / (n * (n - 1)))
+    if var <= 0:
+        return 1.0
+    z = (abs(u1 - mean) - 0.5) / math.sqrt(var)
+    return max(0.0, min(1.0, math.erfc(max(z, 0.0) / math.sqrt(2.0))))
+
+
+def mean(values):
+    return sum(values) / len(values)
+
+
+def format_ns(value):
+    for unit in ("s", "ms", "us"):
+        if value >= TIME_UNIT_NS[unit]:
+            return "%.3f %s" % (value / TIME_UNIT_NS[unit], unit)
+    return "%.1f ns" % value
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("baseline")
+    parser.add_argument("contender")
+    parser.add_argument("--metric", choices=["cpu_time", "real_time"], default="cpu_time")
+    parser.add_argument("--threshold", type=float, default=0.05, help="relative slowdown considered a regression")
+    parser.add_argument("--alpha", type=float, default=0.05, help="significance level of the U test")
+    parser.add_argument("--min-repetitions", type=int, default=MIN_SAMPLES,
+                        help="samples needed on both sides before a change is tested")
+    args = parser.parse_args()
+
+    base_ctx, base = load_report(args.baseline, args.metric)
+    cont_ctx, cont = load_report(args.contender, args.metric)
+
+    print("%-28s %-40s %s" % ("context", "baseline", "contender"))
+    for key in CONTEXT_KEYS:
+        if key in base_ctx or key in cont_ctx:
+            print("%-28s %-40s %s" % (key, base_ctx.get(key, "-"), cont_ctx.get(key, "-")))
+    if base_ctx.get("casbin_intensive_benchmark") != cont_ctx.get("casbin_intensive_benchmark"):
+        print("warning: reports were built with different INTENSIVE_BENCHMARK settings")
+    print()
+
+    regressions = []
+    too_few = 0
+    print("%-52s %14s %14s %9s %8s  %s" % ("benchmark", "baseline", "contender", "change", "p", "verdict"))
+    for name in [n for n in base if n in cont]:
+        xs, ys = base[name], cont[name]
+        old, new = mean(xs), mean(ys)
+        change = (new - old) / old if old else 0.0
+
+        p = None
+        if len(xs) >= max(args.min_repetitions, 2) and len(ys) >= max(args.min_repetitions, 2):
+            p = mann_whitney_p(xs, ys)
+        significant = p is not None and p < args.alpha
+
+        verdict = ""
+        if p is None:
+            verdict = "too few repetitions"
+            too_few += 1
+        elif significant and change > args.threshold:
+            verdict = "REGRESSION"
+            regressions.append(name)
+        elif significant and change < -args.threshold:
+            verdict = "improvement"
+
+        print("%-52s %14s %14s %+8.1f%% %8s  %s" % (name, format_ns(old), format_ns(new), change * 100.0,
+                                                    "-" if p is None else "%.4f" % p, verdict))
+
+    for name in [n for n in base if n not in cont]:
+        print("%-52s only in baseline" % name)
+    for name in [n for n in cont if n not in base]:
+        print("%-52s only in contender" % name)
+
+    if too_few:
+        print("\n%d benchmark(s) not tested, run both with --benchmark_repetitions=%d or more"
+              % (too_few, args.min_repetitions))
+    if regressions:
+        print("\n%d regression(s) above %.1f%%" % (len(regressions), args.threshold * 100.0))
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
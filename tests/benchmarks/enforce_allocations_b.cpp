@@ -0,0 +1,61 @@
+/*
+ * Copyright 2021 The casbin Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This is a test file for counting the heap allocations of steady-state enforcement
+ */
+
+#include <benchmark/benchmark.h>
+#include <casbin/casbin.h>
+
+#include "allocation_counter.h"
+#include "config_path.h"
+
+// EnforceWithAllocations reports the global heap allocations per request as "allocs".
+static void EnforceWithAllocations(benchmark::State& state, casbin::Enforcer& e, const casbin::DataList& params) {
+    // the first request compiles the matcher and sizes the per-thread arena
+    e.Enforce(params);
+
+    uint64_t allocations = AllocationCount();
+    for (auto _ : state) benchmark::DoNotOptimize(e.Enforce(params));
+    state.counters["allocs"] = benchmark::Counter(static_cast<double>(AllocationCount() - allocations), benchmark::Counter::kAvgIterations);
+}
+
+static void BenchmarkBasicModelAllocations(benchmark::State& state) {
+    casbin::Enforcer e(basic_model_path, basic_policy_path, false);
+    EnforceWithAllocations(state, e, {"alice", "data1", "read"});
+}
+
+BENCHMARK(BenchmarkBasicModelAllocations);
+
+static void BenchmarkRBACModelAllocations(benchmark::State& state) {
+    casbin::Enforcer e(rbac_model_path, rbac_policy_path, false);
+    EnforceWithAllocations(state, e, {"alice", "data2", "read"});
+}
+
+BENCHMARK(BenchmarkRBACModelAllocations);
+
+static void BenchmarkRBACModelWithDenyAllocations(benchmark::State& state) {
+    casbin::Enforcer e(rbac_with_deny_model_path, rbac_with_deny_policy_path, false);
+    EnforceWithAllocations(state, e, {"alice", "data1", "read"});
+}
+
+BENCHMARK(BenchmarkRBACModelWithDenyAllocations);
+
+static void BenchmarkKeyMatchModelAllocations(benchmark::State& state) {
+    casbin::Enforcer e(keymatch_model_path, keymatch_policy_path, false);
+    EnforceWithAllocations(state, e, {"alice", "/alice_data/resource1", "GET"});
+}
+
+BENCHMARK(BenchmarkKeyMatchModelAllocations);
@@ -0,0 +1,40 @@
+#  Copyright 2021 The casbin Authors. All Rights Reserved.
+#
+#  Licensed under the Apache License, Version 2.0 (the "License");
+#  you may not use this file except in compliance with the License.
+#  You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+#  Unless required by applicable law or agreed to in writing, software
+#  distributed under the License is distributed on an "AS IS" BASIS,
+#  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+#  See the License for the specific language governing permissions and
+#  limitations under the License.
+
+# Writes the current git commit into OUTPUT as CASBIN_GIT_COMMIT. It runs on every build,
+# the header is only rewritten when the commit changed so that main.cpp is not rebuilt.
+
+set(CASBIN_GIT_COMMIT "unknown")
+if(GIT_EXECUTABLE)
+    execute_process(
+        COMMAND ${GIT_EXECUTABLE} rev-parse --short HEAD
+        WORKING_DIRECTORY ${SOURCE_DIR}
+        OUTPUT_VARIABLE CASBIN_GIT_COMMIT_OUTPUT
+        OUTPUT_STRIP_TRAILING_WHITESPACE
+        ERROR_QUIET
+        RESULT_VARIABLE CASBIN_GIT_COMMIT_RESULT
+    )
+    if(CASBIN_GIT_COMMIT_RESULT EQUAL 0)
+        set(CASBIN_GIT_COMMIT ${CASBIN_GIT_COMMIT_OUTPUT})
+    endif()
+endif()
+
+set(CASBIN_GIT_COMMIT_HEADER "#define CASBIN_GIT_COMMIT \"${CASBIN_GIT_COMMIT}\"\n")
+set(CASBIN_GIT_COMMIT_PREVIOUS "")
+if(EXISTS ${OUTPUT})
+    file(READ ${OUTPUT} CASBIN_GIT_COMMIT_PREVIOUS)
+endif()
+if(NOT CASBIN_GIT_COMMIT_PREVIOUS STREQUAL CASBIN_GIT_COMMIT_HEADER)
+    file(WRITE ${OUTPUT} ${CASBIN_GIT_COMMIT_HEADER})
+endif()
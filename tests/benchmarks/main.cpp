@@ -18,4 +18,91 @@
 
 #include <benchmark/benchmark.h>
 
-BENCHMARK_MAIN();
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#if __has_include("git_commit.h")
+#include "git_commit.h"
+#endif
+
+#ifndef CASBIN_GIT_COMMIT
+#define CASBIN_GIT_COMMIT "unknown"
+#endif
+
+#ifndef CASBIN_BENCHMARK_OUT
+#define CASBIN_BENCHMARK_OUT "casbin_benchmark.json"
+#endif
+
+#ifndef CASBIN_COMPILER
+#define CASBIN_COMPILER "unknown"
+#endif
+
+#ifndef CASBIN_BUILD_TYPE
+#define CASBIN_BUILD_TYPE "unknown"
+#endif
+
+#ifndef CASBIN_INTENSIVE_BENCHMARK
+#define CASBIN_INTENSIVE_BENCHMARK 0
+#endif
+
+namespace {
+
+const char* const s_default_out = CASBIN_BENCHMARK_OUT;
+
+// cpuModel returns the human readable CPU model, Google Benchmark only reports counts and caches.
+std::string cpuModel() {
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    std::string line;
+    while (std::getline(cpuinfo, line)) {
+        if (line.rfind("model name", 0) != 0)
+            continue;
+        auto pos = line.find(':');
+        if (pos == std::string::npos)
+            break;
+        pos = line.find_first_not_of(' ', pos + 1);
+        return pos == std::string::npos ? "" : line.substr(pos);
+    }
+    return "unknown";
+}
+
+bool hasFlag(int argc, char** argv, const char* flag) {
+    size_t len = std::strlen(flag);
+    for (int i = 1; i < argc; ++i)
+        if (std::strncmp(argv[i], flag, len) == 0)
+            return true;
+    return false;
+}
+
+} // namespace
+
+// Results are always written as JSON next to the console report so that two runs can be
+// diffed with compare.py, by default into the build directory of the benchmark. Passing
+// --benchmark_out explicitly overrides the default file.
+int main(int argc, char** argv) {
+    std::vector<char*> args(argv, argv + argc);
+    std::string out_flag = std::string("--benchmark_out=") + s_default_out;
+    std::string format_flag = "--benchmark_out_format=json";
+
+    if (!hasFlag(argc, argv, "--benchmark_out=")) {
+        args.push_back(out_flag.data());
+        if (!hasFlag(argc, argv, "--benchmark_out_format="))
+            args.push_back(format_flag.data());
+    }
+
+    int args_count = static_cast<int>(args.size());
+    benchmark::Initialize(&args_count, args.data());
+    if (benchmark::ReportUnrecognizedArguments(args_count, args.data()))
+        return 1;
+
+    benchmark::AddCustomContext("casbin_commit", CASBIN_GIT_COMMIT);
+    benchmark::AddCustomContext("casbin_compiler", CASBIN_COMPILER);
+    benchmark::AddCustomContext("casbin_build_type", CASBIN_BUILD_TYPE);
+    benchmark::AddCustomContext("casbin_cpu_model", cpuModel());
+    benchmark::AddCustomContext("casbin_intensive_benchmark", CASBIN_INTENSIVE_BENCHMARK ? "ON" : "OFF");
+
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
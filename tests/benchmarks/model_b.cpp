@@ -47,6 +47,15 @@ static void BenchmarkBasicModel(benchmark::State& state) {
 
 BENCHMARK(BenchmarkBasicModel);
 
+static void BenchmarkSpecializedBasicModel(benchmark::State& state) {
+    casbin::Enforcer e(basic_model_path, basic_policy_path, false);
+    casbin::SpecializedEnforcer<casbin::AclMatcher> acl(e);
+
+    for (auto _ : state) acl.Enforce("alice", "data1", "read");
+}
+
+BENCHMARK(BenchmarkSpecializedBasicModel);
+
 static void BenchmarkBasicModelLargeSize(benchmark::State& state) {
     casbin::Enforcer e(basic_model_path, "", false);
 
@@ -83,6 +92,25 @@ static void BenchmarkRBACModel(benchmark::State& state) {
 
 BENCHMARK(BenchmarkRBACModel);
 
+static void BenchmarkSpecializedRBACModel(benchmark::State& state) {
+    casbin::Enforcer e(rbac_model_path, rbac_policy_path, false);
+    casbin::SpecializedEnforcer<casbin::RbacMatcher> rbac(e);
+
+    for (auto _ : state) rbac.Enforce("alice", "data2", "read");
+}
+
+BENCHMARK(BenchmarkSpecializedRBACModel);
+
+static void BenchmarkRBACModelValueIds(benchmark::State& state) {
+    casbin::Enforcer e(rbac_model_path, rbac_policy_path, false);
+    e.EnableValueIds(true);
+    casbin::ValueIds request = e.GetValueDictionary().Resolve({"alice", "data2", "read"});
+
+    for (auto _ : state) e.Enforce(request);
+}
+
+BENCHMARK(BenchmarkRBACModelValueIds);
+
 static void BenchmarkRBACModelSizesSmall(benchmark::State& state) {
     int num_roles = 100, num_resources = 10, num_users = 1000;
 
@@ -145,6 +173,15 @@ static void BenchmarkRBACModelWithDomains(benchmark::State& state) {
 
 BENCHMARK(BenchmarkRBACModelWithDomains);
 
+static void BenchmarkSpecializedRBACModelWithDomains(benchmark::State& state) {
+    casbin::Enforcer e(rbac_with_domains_model_path, rbac_with_domains_policy_path, false);
+    casbin::SpecializedEnforcer<casbin::RbacWithDomainsMatcher> rbac(e);
+
+    for (auto _ : state) rbac.Enforce("alice", "domain1", "data1", "read");
+}
+
+BENCHMARK(BenchmarkSpecializedRBACModelWithDomains);
+
 // ------ TODO ------
 // static void BenchmarkABACModel(benchmark::State& state) {
 //     casbin::Enforcer e("examples/abac_model.conf")
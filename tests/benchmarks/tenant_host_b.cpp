@@ -0,0 +1,61 @@
+/*
+ * Copyright 2021 The casbin Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This is a test file for benchmarking the memory of tenants
+ */
+
+#include <benchmark/benchmark.h>
+#include <casbin/casbin.h>
+
+#include "allocation_counter.h"
+#include "config_path.h"
+
+static const int s_tenants = 64;
+
+// The heap kept per tenant, counted after each tenant decided a request so that the matcher
+// is compiled, is reported as "bytes_per_tenant".
+
+static void BenchmarkTenantHostMemory(benchmark::State& state) {
+    int64_t bytes = 0;
+    for (auto _ : state) {
+        int64_t before = LiveBytes();
+        casbin::TenantHost host(rbac_model_path);
+        for (int i = 0; i < s_tenants; i++) {
+            std::string tenant = "tenant" + std::to_string(i);
+            host.AddTenant(tenant, std::make_shared<casbin::FileAdapter>(rbac_policy_path));
+            benchmark::DoNotOptimize(host.Enforce(tenant, {"alice", "data2", "read"}));
+        }
+        bytes += LiveBytes() - before;
+    }
+    state.counters["bytes_per_tenant"] = benchmark::Counter(static_cast<double>(bytes) / s_tenants, benchmark::Counter::kAvgIterations);
+}
+
+BENCHMARK(BenchmarkTenantHostMemory)->Unit(benchmark::kMillisecond);
+
+static void BenchmarkEnforcerPerTenantMemory(benchmark::State& state) {
+    int64_t bytes = 0;
+    for (auto _ : state) {
+        int64_t before = LiveBytes();
+        std::vector<std::unique_ptr<casbin::Enforcer>> tenants;
+        for (int i = 0; i < s_tenants; i++) {
+            tenants.push_back(std::make_unique<casbin::Enforcer>(rbac_model_path, rbac_policy_path));
+            benchmark::DoNotOptimize(tenants.back()->Enforce({"alice", "data2", "read"}));
+        }
+        bytes += LiveBytes() - before;
+    }
+    state.counters["bytes_per_tenant"] = benchmark::Counter(static_cast<double>(bytes) / s_tenants, benchmark::Counter::kAvgIterations);
+}
+
+BENCHMARK(BenchmarkEnforcerPerTenantMemory)->Unit(benchmark::kMillisecond);
@@ -44,6 +44,23 @@ TEST(TestBuiltInFunctions, TestKeyMatch) {
     TestKeyMatchFn("/foobar", "/foo/*", false);
 }
 
+TEST(TestBuiltInFunctions, TestShortCircuitOperators) {
+    auto evaluator = casbin::ExprtkEvaluator();
+    evaluator.InitialObject("r");
+    evaluator.PushObjectString("r", "sub", "alice");
+    evaluator.PushObjectString("r", "obj", "data1");
+    // switching the operators compiles the expression again, with the same results
+    for (bool short_circuit : {false, true, false}) {
+        evaluator.SetShortCircuit(short_circuit);
+        ASSERT_TRUE(evaluator.Eval("r.sub == 'alice' && r.obj == 'data1'"));
+        EXPECT_TRUE(evaluator.GetBoolean());
+        ASSERT_TRUE(evaluator.Eval("r.sub == 'bob' || r.obj == 'data2'"));
+        EXPECT_FALSE(evaluator.GetBoolean());
+        ASSERT_TRUE(evaluator.Eval("r.sub == 'bob' || r.obj == 'data1' && r.sub == 'alice'"));
+        EXPECT_TRUE(evaluator.GetBoolean());
+    }
+}
+
 void testKeyGetFn(std::string key1, std::string key2, std::string res) {
     //    std::string my_res = casbin::KeyGet(key1, key2);
     //    ASSERT_EQ(res, my_res);
@@ -35,6 +35,7 @@ static const std::string basic_with_root_model_path = relative_path + "/examples
 static const std::string rbac_with_not_deny_model_path = relative_path + "/examples/rbac_with_not_deny_model.conf";
 static const std::string rbac_model_path = relative_path + "/examples/rbac_model.conf";
 static const std::string rbac_policy_path = relative_path + "/examples/rbac_policy.csv";
+static const std::string rbac_matcher_using_in_op_model_path = relative_path + "/examples/rbac_model_matcher_using_in_op.conf";
 static const std::string rbac_with_resource_roles_model_path = relative_path + "/examples/rbac_with_resource_roles_model.conf";
 static const std::string rbac_with_resource_roles_policy_path = relative_path + "/examples/rbac_with_resource_roles_policy.csv";
 static const std::string rbac_with_domains_model_path = relative_path + "/examples/rbac_with_domains_model.conf";
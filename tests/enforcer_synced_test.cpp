@@ -28,6 +28,13 @@ std::string global_obj;
 std::string global_act;
 std::string global_domain;
 
+// the evaluator of the library under test, casbin_lite has no exprtk
+#ifdef CASBIN_LITE
+using TestEvaluator = casbin::NativeEvaluator;
+#else
+using TestEvaluator = casbin::ExprtkEvaluator;
+#endif
+
 template <typename T>
 std::shared_ptr<casbin::IEvaluator> InitializeParams(const std::string& sub, const std::string& obj, const std::string& act) {
     auto evaluator = std::make_shared<T>();
@@ -214,7 +221,7 @@ TEST(TestEnforcerSynced, TestMultiThreadEnforce) {
             std::shared_ptr<casbin::IEvaluator> evaluator;
             {
                 std::scoped_lock lock(mtx);
-                evaluator = InitializeParams<casbin::ExprtkEvaluator>("alice", "data1", "read");
+                evaluator = InitializeParams<TestEvaluator>("alice", "data1", "read");
             }
             ASSERT_EQ(e.Enforce(evaluator), true);
         });
@@ -222,7 +229,7 @@ TEST(TestEnforcerSynced, TestMultiThreadEnforce) {
             std::shared_ptr<casbin::IEvaluator> evaluator;
             {
                 std::scoped_lock lock(mtx);
-                evaluator = InitializeParams<casbin::ExprtkEvaluator>("alice", "data1", "write");
+                evaluator = InitializeParams<TestEvaluator>("alice", "data1", "write");
             }
             ASSERT_EQ(e.Enforce(evaluator), false);
         });
@@ -230,7 +237,7 @@ TEST(TestEnforcerSynced, TestMultiThreadEnforce) {
             std::shared_ptr<casbin::IEvaluator> evaluator;
             {
                 std::scoped_lock lock(mtx);
-                evaluator = InitializeParams<casbin::ExprtkEvaluator>("alice", "data2", "read");
+                evaluator = InitializeParams<TestEvaluator>("alice", "data2", "read");
             }
             ASSERT_EQ(e.Enforce(evaluator), false);
         });
@@ -238,7 +245,7 @@ TEST(TestEnforcerSynced, TestMultiThreadEnforce) {
             std::shared_ptr<casbin::IEvaluator> evaluator;
             {
                 std::scoped_lock lock(mtx);
-                evaluator = InitializeParams<casbin::ExprtkEvaluator>("alice", "data2", "write");
+                evaluator = InitializeParams<TestEvaluator>("alice", "data2", "write");
             }
             ASSERT_EQ(e.Enforce(evaluator), false);
         });
@@ -246,7 +253,7 @@ TEST(TestEnforcerSynced, TestMultiThreadEnforce) {
             std::shared_ptr<casbin::IEvaluator> evaluator;
             {
                 std::scoped_lock lock(mtx);
-                evaluator = InitializeParams<casbin::ExprtkEvaluator>("bob", "data1", "read");
+                evaluator = InitializeParams<TestEvaluator>("bob", "data1", "read");
             }
             ASSERT_EQ(e.Enforce(evaluator), false);
         });
@@ -254,7 +261,7 @@ TEST(TestEnforcerSynced, TestMultiThreadEnforce) {
             std::shared_ptr<casbin::IEvaluator> evaluator;
             {
                 std::scoped_lock lock(mtx);
-                evaluator = InitializeParams<casbin::ExprtkEvaluator>("bob", "data1", "write");
+                evaluator = InitializeParams<TestEvaluator>("bob", "data1", "write");
             }
             ASSERT_EQ(e.Enforce(evaluator), false);
         });
@@ -262,7 +269,7 @@ TEST(TestEnforcerSynced, TestMultiThreadEnforce) {
             std::shared_ptr<casbin::IEvaluator> evaluator;
             {
                 std::scoped_lock lock(mtx);
-                evaluator = InitializeParams<casbin::ExprtkEvaluator>("bob", "data2", "read");
+                evaluator = InitializeParams<TestEvaluator>("bob", "data2", "read");
             }
             ASSERT_EQ(e.Enforce(evaluator), false);
         });
@@ -270,7 +277,7 @@ TEST(TestEnforcerSynced, TestMultiThreadEnforce) {
             std::shared_ptr<casbin::IEvaluator> evaluator;
             {
                 std::scoped_lock lock(mtx);
-                evaluator = InitializeParams<casbin::ExprtkEvaluator>("bob", "data2", "write");
+                evaluator = InitializeParams<TestEvaluator>("bob", "data2", "write");
             }
             ASSERT_EQ(e.Enforce(evaluator), true);
         });
@@ -334,6 +341,42 @@ TEST(TestEnforcerSynced, TestMultiThreadBatchEnforce) {
     EXPECT_EQ(e.IsAutoLoadingRunning(), false);
 }
 
+TEST(TestEnforcerSynced, TestMultiThreadEnforceWithContext) {
+    casbin::SyncedEnforcer e(casbin::Model::NewModelFromString(
+        "[request_definition]\n"
+        "r = sub, obj, act\n"
+        "r2 = sub, obj\n"
+        "[policy_definition]\n"
+        "p = sub, obj, act\n"
+        "p2 = sub, obj\n"
+        "[policy_effect]\n"
+        "e = some(where (p.eft == allow))\n"
+        "e2 = some(where (p.eft == allow))\n"
+        "[matchers]\n"
+        "m = r.sub == p.sub && r.obj == p.obj && r.act == p.act\n"
+        "m2 = r2.sub == p2.sub && keyMatch(r2.obj, p2.obj)\n"));
+    e.EnableFastReject(true);
+    e.AddPolicy({"alice", "data1", "read"});
+    e.AddNamedPolicy("p2", {"alice", "/files/*"});
+    e.AddNamedPolicy("p2", {"bob", "/reports/*"});
+
+    // the requests of a context share the lock, each on an evaluator of its own
+    casbin::EnforceContext context = casbin::EnforceContext::NewEnforceContext("2");
+    for (int i = 0; i < 100; ++i) {
+        std::thread t1([&] { ASSERT_TRUE(e.EnforceWithContext(context, {"alice", "/files/a"})); });
+        std::thread t2([&] { ASSERT_FALSE(e.EnforceWithContext(context, {"alice", "/reports/a"})); });
+        std::thread t3([&] { ASSERT_TRUE(e.EnforceWithContext(context, casbin::DataMap{{"sub", "bob"}, {"obj", "/reports/a"}})); });
+        std::thread t4([&] { ASSERT_FALSE(e.EnforceWithContext(context, casbin::DataVector{"carol", "/files/a"})); });
+        std::thread t5([&] { ASSERT_TRUE(e.Enforce({"alice", "data1", "read"})); });
+
+        t1.join();
+        t2.join();
+        t3.join();
+        t4.join();
+        t5.join();
+    }
+}
+
 void testSyncedEnforcerGetPolicy(casbin::SyncedEnforcer& e, PoliciesVector expected) {
     auto myRes = e.GetPolicy();
     PoliciesVector actual;
@@ -357,5 +400,104 @@ TEST(TestSyncedEnforcer, GetPolicy) {
 }
 
 
+class CountingWatcherEx : public casbin::WatcherEx {
+public:
+    std::atomic<int> updates{0};
+    std::atomic<int> added{0};
+    std::atomic<int> removed{0};
+
+    void Update() override {
+        ++updates;
+    }
+
+    void Close() override {
+    }
+
+    void UpdateForAddPolicy(std::vector<std::string> /*params*/) override {
+        ++added;
+    }
+
+    void UpdateForRemovePolicy(std::vector<std::string> /*params*/) override {
+        ++removed;
+    }
+
+    void UpdateForRemoveFilteredPolicy(int /*field_index*/, std::vector<std::string> /*field_values*/) override {
+    }
+
+    void UpdateForSavePolicy(const std::shared_ptr<casbin::Model>& /*model*/) override {
+    }
+
+    void UpdateForAddPolicies(const std::string& /*sec*/, const std::string& /*p_type*/, const PoliciesValues& rules) override {
+        added += static_cast<int>(rules.size());
+    }
+
+    void UpdateForRemovePolicies(const std::string& /*sec*/, const std::string& /*p_type*/, const PoliciesValues& rules) override {
+        removed += static_cast<int>(rules.size());
+    }
+};
+
+TEST(TestSyncedEnforcer, TestCombinedWritesNotifyWatcherEx) {
+    casbin::SyncedEnforcer e(rbac_model_path, rbac_policy_path);
+    e.EnableAutoSave(false);
+    auto watcher = std::make_shared<CountingWatcherEx>();
+    e.SetWatcher(watcher);
+    constexpr int kThreads = 8;
+    constexpr int kRules = 50;
+
+    // alone or combined, each write is told by rule to a watcher with batch methods
+    std::vector<std::thread> threads;
+    for (int i = 0; i < kThreads; ++i) {
+        threads.emplace_back([&, i] {
+            for (int j = 0; j < kRules; ++j) {
+                std::string user = "user" + std::to_string(i * kRules + j);
+                ASSERT_TRUE(e.AddPolicy({user, "data1", "read"}));
+                ASSERT_TRUE(e.AddGroupingPolicy({user, "data2_admin"}));
+                ASSERT_TRUE(e.RemovePolicy({user, "data1", "read"}));
+            }
+        });
+    }
+    for (auto& thread : threads)
+        thread.join();
+
+    ASSERT_EQ(watcher->updates, 0);
+    // a rule added and removed in one combined batch leaves no change to tell
+    ASSERT_EQ(watcher->added - watcher->removed, kThreads * kRules);
+    ASSERT_GE(watcher->added, kThreads * kRules);
+}
+
+TEST(TestSyncedEnforcer, TestCombinedWrites) {
+    casbin::SyncedEnforcer e(rbac_model_path, rbac_policy_path);
+    e.EnableAutoSave(false);
+    constexpr int kThreads = 8;
+    constexpr int kRules = 50;
+
+    // the writes of the threads are combined, each reports its own result
+    std::atomic<int> changed(0), shared_added(0);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < kThreads; ++i) {
+        threads.emplace_back([&, i] {
+            for (int j = 0; j < kRules; ++j) {
+                std::string user = "user" + std::to_string(i * kRules + j);
+                changed += e.AddPolicy({user, "data1", "read"}) ? 1 : 0;
+                changed += e.AddGroupingPolicy({user, "data2_admin"}) ? 1 : 0;
+                shared_added += e.AddPolicy({"shared", "data3", "read"}) ? 1 : 0;
+                ASSERT_TRUE(e.Enforce({user, "data2", "write"}));
+                changed += e.RemovePolicy({user, "data1", "read"}) ? 1 : 0;
+                changed += e.RemovePolicy({user, "data1", "read"}) ? 1 : 0;
+            }
+        });
+    }
+    for (auto& thread : threads)
+        thread.join();
+
+    ASSERT_EQ(changed, 3 * kThreads * kRules);
+    ASSERT_EQ(shared_added, 1);
+    ASSERT_EQ(e.GetPolicy().size(), 5);
+    ASSERT_EQ(e.GetGroupingPolicy().size(), kThreads * kRules + 1);
+    ASSERT_FALSE(e.Enforce({"user0", "data1", "read"}));
+    ASSERT_TRUE(e.RemoveGroupingPolicy({"user0", "data2_admin"}));
+    ASSERT_FALSE(e.Enforce({"user0", "data2", "write"}));
+    ASSERT_FALSE(e.RemoveNamedGroupingPolicy("g", {"user0", "data2_admin"}));
+}
 
 } // namespace
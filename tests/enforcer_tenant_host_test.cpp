@@ -0,0 +1,240 @@
+/*
+ * Copyright 2021 The casbin Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This is a test file for testing the multi-tenant enforcer host
+ */
+
+#include <casbin/casbin.h>
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+
+#include "config_path.h"
+
+namespace {
+
+class CountingFilteredAdapter : public casbin::FilteredFileAdapter {
+public:
+    std::atomic<int> loads{0};
+
+    CountingFilteredAdapter(std::string file_path)
+        : casbin::FilteredFileAdapter(file_path) {}
+
+    void LoadFilteredPolicy(const std::shared_ptr<casbin::Model>& model, casbin::Filter* filter) override {
+        ++loads;
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        casbin::FilteredFileAdapter::LoadFilteredPolicy(model, filter);
+    }
+};
+
+TEST(TestTenantHost, TestSeparatePolicies) {
+    casbin::TenantHost host(rbac_model_path);
+
+    auto acme = host.AddTenant("acme", std::make_shared<casbin::FileAdapter>(rbac_policy_path));
+    auto globex = host.AddTenant("globex");
+    globex->AddPolicy({"bob", "data1", "read"});
+
+    ASSERT_EQ(host.TenantCount(), 2);
+    ASSERT_TRUE(host.Enforce("acme", {"alice", "data1", "read"}));
+    ASSERT_TRUE(host.Enforce("acme", {"alice", "data2", "write"}));
+    ASSERT_FALSE(host.Enforce("acme", {"bob", "data1", "read"}));
+
+    ASSERT_FALSE(host.Enforce("globex", {"alice", "data1", "read"}));
+    ASSERT_FALSE(host.Enforce("globex", {"alice", "data2", "write"}));
+    ASSERT_TRUE(host.Enforce("globex", {"bob", "data1", "read"}));
+
+    ASSERT_FALSE(host.Enforce("initech", {"alice", "data1", "read"}));
+}
+
+TEST(TestTenantHost, TestRoleManagerPerTenant) {
+    casbin::TenantHost host(rbac_model_path);
+    host.SetMaxPooledEvaluators(1);
+
+    auto acme = host.AddTenant("acme");
+    auto globex = host.AddTenant("globex");
+    acme->AddPolicy({"admin", "data1", "read"});
+    globex->AddPolicy({"admin", "data1", "read"});
+    acme->AddGroupingPolicy({"alice", "admin"});
+
+    // The single pooled evaluator is reused across tenants and must follow each tenant's roles
+    for (int i = 0; i < 3; ++i) {
+        ASSERT_TRUE(host.Enforce("acme", {"alice", "data1", "read"}));
+        ASSERT_FALSE(host.Enforce("globex", {"alice", "data1", "read"}));
+    }
+
+    std::vector<std::string> explain;
+    ASSERT_TRUE(host.EnforceEx("acme", {"alice", "data1", "read"}, explain));
+    ASSERT_EQ(explain, std::vector<std::string>({"admin", "data1", "read"}));
+}
+
+TEST(TestTenantHost, TestSharedDefinition) {
+    casbin::TenantHost host(rbac_model_path);
+    auto acme = host.AddTenant("acme");
+    auto globex = host.AddTenant("globex");
+
+    auto m = host.GetModel();
+    ASSERT_EQ(acme->GetModel()->m["m"].assertion_map["m"], m->m["m"].assertion_map["m"]);
+    ASSERT_EQ(acme->GetModel()->m["r"].assertion_map["r"], globex->GetModel()->m["r"].assertion_map["r"]);
+    ASSERT_NE(acme->GetModel()->m["p"].assertion_map["p"], globex->GetModel()->m["p"].assertion_map["p"]);
+    ASSERT_NE(acme->GetRoleManager(), globex->GetRoleManager());
+}
+
+TEST(TestTenantHost, TestAddAndRemoveTenant) {
+    casbin::TenantHost host(basic_model_path);
+    auto acme = host.AddTenant("acme", std::make_shared<casbin::FileAdapter>(basic_policy_path));
+
+    ASSERT_EQ(host.AddTenant("acme"), acme);
+    ASSERT_TRUE(host.HasTenant("acme"));
+    ASSERT_EQ(host.GetAllTenants(), std::vector<std::string>({"acme"}));
+    ASSERT_TRUE(host.Enforce("acme", casbin::DataVector({"alice", "data1", "read"})));
+
+    ASSERT_TRUE(host.RemoveTenant("acme"));
+    ASSERT_FALSE(host.RemoveTenant("acme"));
+    ASSERT_FALSE(host.HasTenant("acme"));
+    ASSERT_EQ(host.GetTenant("acme"), nullptr);
+    ASSERT_FALSE(host.Enforce("acme", {"alice", "data1", "read"}));
+}
+
+TEST(TestTenantHost, TestLazyLoading) {
+    casbin::TenantHost host(rbac_with_domains_model_path);
+    auto adapter = std::make_shared<CountingFilteredAdapter>(rbac_with_domains_policy_path);
+    host.EnableLazyLoading(adapter);
+
+    ASSERT_EQ(host.TenantCount(), 0);
+    ASSERT_TRUE(host.Enforce({"alice", "domain1", "data1", "read"}));
+    ASSERT_EQ(host.GetAllTenants(), std::vector<std::string>({"domain1"}));
+    ASSERT_FALSE(host.Enforce({"alice", "domain2", "data2", "read"}));
+    ASSERT_TRUE(host.Enforce(casbin::DataVector({"bob", "domain2", "data2", "write"})));
+    ASSERT_TRUE(host.Enforce(casbin::DataMap({{"sub", "bob"}, {"dom", "domain2"}, {"obj", "data2"}, {"act", "read"}})));
+    ASSERT_EQ(adapter->loads, 2);
+    ASSERT_EQ(host.TenantCount(), 2);
+
+    // Only the domain's own rows are loaded
+    ASSERT_EQ(host.GetTenant("domain1")->GetPolicy().size(), 2);
+    ASSERT_EQ(host.GetTenant("domain1")->GetGroupingPolicy().size(), 1);
+    ASSERT_TRUE(host.GetTenant("domain1")->HasGroupingPolicy({"alice", "admin", "domain1"}));
+    ASSERT_GT(host.GetResidentBytes(), 0);
+}
+
+TEST(TestTenantHost, TestLazyLoadingCoalesced) {
+    casbin::TenantHost host(rbac_with_domains_model_path);
+    auto adapter = std::make_shared<CountingFilteredAdapter>(rbac_with_domains_policy_path);
+    host.EnableLazyLoading(adapter);
+
+    std::atomic<int> allowed{0};
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 8; ++i)
+        threads.emplace_back([&] {
+            if (host.Enforce({"alice", "domain1", "data1", "read"}))
+                ++allowed;
+        });
+    for (auto& thread : threads)
+        thread.join();
+
+    ASSERT_EQ(allowed, 8);
+    ASSERT_EQ(adapter->loads, 1);
+}
+
+TEST(TestTenantHost, TestLazyLoadingEviction) {
+    casbin::TenantHost host(rbac_with_domains_model_path);
+    auto adapter = std::make_shared<CountingFilteredAdapter>(rbac_with_domains_policy_path);
+    host.EnableLazyLoading(adapter);
+
+    ASSERT_TRUE(host.Enforce({"alice", "domain1", "data1", "read"}));
+    size_t one_domain = host.GetResidentBytes();
+
+    // Room for a single domain: loading domain2 evicts domain1
+    host.SetMemoryBudget(one_domain);
+    ASSERT_TRUE(host.Enforce({"bob", "domain2", "data2", "read"}));
+    ASSERT_EQ(host.GetAllTenants(), std::vector<std::string>({"domain2"}));
+    ASSERT_LE(host.GetResidentBytes(), one_domain);
+
+    // An evicted domain is transparently reloaded
+    ASSERT_TRUE(host.Enforce({"alice", "domain1", "data1", "write"}));
+    ASSERT_EQ(adapter->loads, 3);
+    ASSERT_EQ(host.GetAllTenants(), std::vector<std::string>({"domain1"}));
+
+    ASSERT_FALSE(host.Enforce({"alice", "domain3", "data1", "read"}));
+    ASSERT_FALSE(host.Enforce({"alice", "", "data1", "read"}));
+}
+
+TEST(TestTenantHost, TestLazyLoadingAccounting) {
+    casbin::TenantHost host(rbac_with_domains_model_path);
+    auto adapter = std::make_shared<CountingFilteredAdapter>(rbac_with_domains_policy_path);
+    host.EnableLazyLoading(adapter);
+    auto domain1 = host.GetTenant("domain1");
+    domain1->EnableAutoSave(false);
+    size_t loaded = host.GetResidentBytes();
+
+    // the estimate follows the policy changes made through the tenant
+    ASSERT_TRUE(domain1->AddPolicy({"carol", "domain1", "a_rather_long_object_name_of_data3", "read"}));
+    ASSERT_GT(host.GetResidentBytes(), loaded);
+    ASSERT_TRUE(domain1->RemovePolicy({"carol", "domain1", "a_rather_long_object_name_of_data3", "read"}));
+    ASSERT_EQ(host.GetResidentBytes(), loaded);
+    ASSERT_TRUE(domain1->RemoveFilteredPolicy(1, {"domain1"}));
+    ASSERT_LT(host.GetResidentBytes(), loaded);
+    ASSERT_GT(host.GetResidentBytes(), casbin::TenantHost::kTenantBytes);
+
+    // domains without policy are charged too and evicted under the budget
+    host.SetMemoryBudget(4 * casbin::TenantHost::kTenantBytes);
+    for (int i = 0; i < 100; ++i)
+        ASSERT_FALSE(host.Enforce({"alice", "unknown" + std::to_string(i), "data1", "read"}));
+    ASSERT_LE(host.TenantCount(), 4);
+}
+
+TEST(TestTenantHost, TestTenantOutlivesHost) {
+    std::shared_ptr<casbin::Enforcer> domain1;
+    {
+        casbin::TenantHost host(rbac_with_domains_model_path);
+        host.EnableLazyLoading(std::make_shared<CountingFilteredAdapter>(rbac_with_domains_policy_path));
+        domain1 = host.GetTenant("domain1");
+    }
+
+    // a tenant outliving its host no longer reports its size to it
+    domain1->EnableAutoSave(false);
+    ASSERT_TRUE(domain1->AddPolicy({"carol", "domain1", "data3", "read"}));
+    ASSERT_TRUE(domain1->RemoveFilteredPolicy(0, {"carol"}));
+    ASSERT_TRUE(domain1->HasPolicy({"admin", "domain1", "data1", "read"}));
+}
+
+TEST(TestTenantHost, TestWarmup) {
+    casbin::TenantHost host(rbac_model_path);
+    host.Warmup(4);
+
+    auto acme = host.AddTenant("acme", std::make_shared<casbin::FileAdapter>(rbac_policy_path));
+    auto globex = host.AddTenant("globex");
+    globex->AddPolicy({"bob", "data1", "read"});
+
+    ASSERT_TRUE(host.Enforce("acme", {"alice", "data2", "write"}));
+    ASSERT_FALSE(host.Enforce("acme", {"bob", "data1", "read"}));
+    ASSERT_TRUE(host.Enforce("globex", {"bob", "data1", "read"}));
+    ASSERT_FALSE(host.Enforce("globex", {"alice", "data2", "write"}));
+}
+
+TEST(TestTenantHost, TestEvaluatorReturnedOnThrow) {
+    casbin::TenantHost host(rbac_model_path);
+    host.SetMaxPooledEvaluators(1);
+    auto acme = host.AddTenant("acme");
+    acme->GetModel()->AddPolicy("p", "p", {"alice", "data1"});
+
+    ASSERT_THROW(host.Enforce("acme", {"alice", "data1", "read"}), casbin::CasbinEnforcerException);
+    acme->GetModel()->RemovePolicy("p", "p", {"alice", "data1"});
+    acme->AddPolicy({"alice", "data1", "read"});
+    ASSERT_TRUE(host.Enforce("acme", {"alice", "data1", "read"}));
+    ASSERT_FALSE(host.Enforce("acme", {"bob", "data1", "read"}));
+}
+
+} // namespace
@@ -21,6 +21,31 @@
 
 #include "config_path.h"
 
+struct TypedRequest {
+    std::string_view sub;
+    std::string_view obj;
+    std::string act;
+};
+
+struct ShortRequest {
+    std::string_view sub;
+    std::string_view obj;
+};
+
+namespace casbin {
+
+template <>
+struct RequestTraits<TypedRequest> {
+    static constexpr auto fields = std::make_tuple(&TypedRequest::sub, &TypedRequest::obj, &TypedRequest::act);
+};
+
+template <>
+struct RequestTraits<ShortRequest> {
+    static constexpr auto fields = std::make_tuple(&ShortRequest::sub, &ShortRequest::obj);
+};
+
+} // namespace casbin
+
 namespace {
 
 std::string global_sub;
@@ -28,6 +53,13 @@ std::string global_obj;
 std::string global_act;
 std::string global_domain;
 
+// the evaluator of the library under test, casbin_lite has no exprtk
+#ifdef CASBIN_LITE
+using TestEvaluator = casbin::NativeEvaluator;
+#else
+using TestEvaluator = casbin::ExprtkEvaluator;
+#endif
+
 template <typename T>
 std::shared_ptr<casbin::IEvaluator> InitializeParams(const std::string& sub, const std::string& obj, const std::string& act) {
     auto evaluator = std::make_shared<T>();
@@ -88,6 +120,46 @@ std::shared_ptr<casbin::IEvaluator> InitializeParamsWithDomains(const std::strin
     return evaluator;
 }
 
+// A model and its policy, with the matcher replaced when one is given.
+struct ModelCase {
+    ModelCase(const std::string& model_path, const std::string& policy_path, const std::string& matcher = "") : model_path(model_path), policy_path(policy_path), matcher(matcher) {}
+
+    std::string model_path;
+    std::string policy_path;
+    std::string matcher;
+};
+
+// ExpectSameDecisions expects an enforcer with a feature switched on by enable to decide
+// each request as the full scan of the same model does, rounds times over. The explains
+// are compared when compare_explains is set, decide replaces EnforceEx for the enforcer
+// under test.
+void ExpectSameDecisions(const std::vector<ModelCase>& models, const std::vector<std::vector<std::string>>& requests, const std::function<void(casbin::Enforcer&)>& enable, bool compare_explains, int rounds = 1,
+                         const std::function<bool(casbin::Enforcer&, const std::vector<std::string>&)>& decide = nullptr) {
+    for (const ModelCase& model : models) {
+        casbin::Enforcer e(model.model_path, model.policy_path);
+        casbin::Enforcer tested(model.model_path, model.policy_path);
+        if (!model.matcher.empty()) {
+            e.GetModel()->m["m"].assertion_map["m"]->value = model.matcher;
+            tested.GetModel()->m["m"].assertion_map["m"]->value = model.matcher;
+        }
+        enable(tested);
+        for (int i = 0; i < rounds; i++) {
+            for (const auto& request : requests) {
+                std::string context = model.model_path + " " + model.policy_path + " " + model.matcher;
+                for (const std::string& value : request)
+                    context += " " + value;
+                std::vector<std::string> explain, expected_explain;
+                casbin::DataVector params(request.begin(), request.end());
+                bool expected = e.EnforceEx(params, expected_explain);
+                ASSERT_EQ(decide ? decide(tested, request) : tested.EnforceEx(params, explain), expected) << context;
+                if (compare_explains) {
+                    ASSERT_EQ(explain, expected_explain) << context;
+                }
+            }
+        }
+    }
+}
+
 TEST(TestEnforcer, TestFourParams) {
     casbin::Enforcer e(rbac_with_domains_model_path, rbac_with_domains_policy_path);
 
@@ -167,82 +239,82 @@ TEST(TestEnforcerEx, TestEvaluatorParams) {
     casbin::Enforcer e(basic_model_without_spaces_path, basic_policy_path);
     std::shared_ptr<casbin::IEvaluator> evaluator;
 
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("alice", "data1", "read");
+    evaluator = InitializeParams<TestEvaluator>("alice", "data1", "read");
     TestEnforceEx(e, evaluator, true, {"alice", "data1", "read"});
 
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("alice", "data1", "write");
+    evaluator = InitializeParams<TestEvaluator>("alice", "data1", "write");
     TestEnforceEx(e, evaluator, false, {});
 
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("alice", "data2", "read");
+    evaluator = InitializeParams<TestEvaluator>("alice", "data2", "read");
     TestEnforceEx(e, evaluator, false, {});
 
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("alice", "data2", "write");
+    evaluator = InitializeParams<TestEvaluator>("alice", "data2", "write");
     TestEnforceEx(e, evaluator, false, {});
 
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("bob", "data1", "read");
+    evaluator = InitializeParams<TestEvaluator>("bob", "data1", "read");
     TestEnforceEx(e, evaluator, false, {});
 
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("bob", "data1", "write");
+    evaluator = InitializeParams<TestEvaluator>("bob", "data1", "write");
     TestEnforceEx(e, evaluator, false, {});
 
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("bob", "data2", "read");
+    evaluator = InitializeParams<TestEvaluator>("bob", "data2", "read");
     TestEnforceEx(e, evaluator, false, {});
 
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("bob", "data2", "write");
+    evaluator = InitializeParams<TestEvaluator>("bob", "data2", "write");
     TestEnforceEx(e, evaluator, true, {"bob", "data2", "write"});
 
     // RBAC_MODEL
     e = casbin::Enforcer(rbac_model_path, rbac_policy_path);
 
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("alice", "data1", "read");
+    evaluator = InitializeParams<TestEvaluator>("alice", "data1", "read");
     TestEnforceEx(e, evaluator, true, {"alice", "data1", "read"});
 
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("alice", "data1", "write");
+    evaluator = InitializeParams<TestEvaluator>("alice", "data1", "write");
     TestEnforceEx(e, evaluator, false, {});
 
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("alice", "data2", "read");
+    evaluator = InitializeParams<TestEvaluator>("alice", "data2", "read");
     TestEnforceEx(e, evaluator, true, {"data2_admin", "data2", "read"});
 
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("alice", "data2", "write");
+    evaluator = InitializeParams<TestEvaluator>("alice", "data2", "write");
     TestEnforceEx(e, evaluator, true, {"data2_admin", "data2", "write"});
 
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("bob", "data1", "read");
+    evaluator = InitializeParams<TestEvaluator>("bob", "data1", "read");
     TestEnforceEx(e, evaluator, false, {});
 
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("bob", "data1", "write");
+    evaluator = InitializeParams<TestEvaluator>("bob", "data1", "write");
     TestEnforceEx(e, evaluator, false, {});
 
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("bob", "data2", "read");
+    evaluator = InitializeParams<TestEvaluator>("bob", "data2", "read");
     TestEnforceEx(e, evaluator, false, {});
 
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("bob", "data2", "write");
+    evaluator = InitializeParams<TestEvaluator>("bob", "data2", "write");
     TestEnforceEx(e, evaluator, true, {"bob", "data2", "write"});
 
     // PRIORITY_MODEL
     e = casbin::Enforcer(priority_model_path, priority_policy_path);
 
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("alice", "data1", "read");
+    evaluator = InitializeParams<TestEvaluator>("alice", "data1", "read");
     TestEnforceEx(e, evaluator, true, {"alice", "data1", "read", "allow"});
 
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("alice", "data1", "write");
+    evaluator = InitializeParams<TestEvaluator>("alice", "data1", "write");
     TestEnforceEx(e, evaluator, false, {"data1_deny_group", "data1", "write", "deny"});
 
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("alice", "data2", "read");
+    evaluator = InitializeParams<TestEvaluator>("alice", "data2", "read");
     TestEnforceEx(e, evaluator, false, {});
 
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("alice", "data2", "write");
+    evaluator = InitializeParams<TestEvaluator>("alice", "data2", "write");
     TestEnforceEx(e, evaluator, false, {});
 
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("bob", "data1", "read");
+    evaluator = InitializeParams<TestEvaluator>("bob", "data1", "read");
     TestEnforceEx(e, evaluator, false, {});
 
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("bob", "data1", "write");
+    evaluator = InitializeParams<TestEvaluator>("bob", "data1", "write");
     TestEnforceEx(e, evaluator, false, {});
 
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("bob", "data2", "read");
+    evaluator = InitializeParams<TestEvaluator>("bob", "data2", "read");
     TestEnforceEx(e, evaluator, true, {"data2_allow_group", "data2", "read", "allow"});
 
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("bob", "data2", "write");
+    evaluator = InitializeParams<TestEvaluator>("bob", "data2", "write");
     TestEnforceEx(e, evaluator, false, {"bob", "data2", "write", "deny"});
 }
 
@@ -359,6 +431,421 @@ TEST(TestEnforcerEx, TestMapParams) {
     TestEnforceEx(e, casbin::DataMap{{"sub", "bob"}, {"obj", "data2"}, {"act", "write"}}, false, {"bob", "data2", "write", "deny"});
 }
 
+TEST(TestEnforcer, TestFastRejectMatchesFullScan) {
+    std::vector<ModelCase> models = {
+        {basic_model_path, basic_policy_path},
+        {rbac_model_path, rbac_policy_path},
+        {rbac_with_deny_model_path, rbac_with_deny_policy_path},
+        {rbac_with_not_deny_model_path, rbac_with_deny_policy_path},
+        {rbac_with_resource_roles_model_path, rbac_with_resource_roles_policy_path},
+    };
+    std::vector<std::vector<std::string>> requests = {
+        {"alice", "data1", "read"}, {"alice", "data2", "write"}, {"bob", "data2", "write"},
+        {"data2_admin", "data2", "read"}, {"crawler", "data1", "read"}, {"alice", "data9", "read"},
+        {"bob", "data2", "delete"}, {"data_group_admin", "data1", "write"}, {"alice", "data_group", "write"},
+    };
+
+    ExpectSameDecisions(models, requests, [](casbin::Enforcer& e) { e.EnableFastReject(true); }, false);
+}
+
+TEST(TestEnforcer, TestFastRejectSharedRoleManager) {
+    // g and g2 link through one role manager, so a name linked by g also reaches g2's roles
+    casbin::Enforcer e(rbac_with_resource_roles_model_path, rbac_with_resource_roles_policy_path);
+    casbin::Enforcer tested(rbac_with_resource_roles_model_path, rbac_with_resource_roles_policy_path);
+    e.EnableAutoSave(false);
+    tested.EnableAutoSave(false);
+    tested.EnableFastReject(true);
+
+    for (casbin::Enforcer* enforcer : {&e, &tested})
+        enforcer->AddNamedGroupingPolicy("g", {"data3", "data1"});
+    ASSERT_TRUE(e.Enforce({"data_group_admin", "data3", "write"}));
+    ASSERT_TRUE(tested.Enforce({"data_group_admin", "data3", "write"}));
+
+    for (casbin::Enforcer* enforcer : {&e, &tested})
+        enforcer->RemoveNamedGroupingPolicy("g", {"data3", "data1"});
+    ASSERT_FALSE(e.Enforce({"data_group_admin", "data3", "write"}));
+    ASSERT_FALSE(tested.Enforce({"data_group_admin", "data3", "write"}));
+
+    // the same holds for the rules indexed when the index is built
+    tested.EnableFastReject(false);
+    tested.AddNamedGroupingPolicy("g", {"data3", "data1"});
+    tested.EnableFastReject(true);
+    ASSERT_TRUE(tested.Enforce({"data_group_admin", "data3", "write"}));
+}
+
+TEST(TestEnforcer, TestFastRejectIncremental) {
+    casbin::Enforcer e(rbac_model_path, rbac_policy_path);
+    e.EnableAutoSave(false);
+    e.EnableFastReject(true);
+
+    // carol only appears in a grouping rule
+    ASSERT_FALSE(e.Enforce({"carol", "data2", "read"}));
+    e.AddRoleForUser("carol", "data2_admin");
+    ASSERT_TRUE(e.Enforce({"carol", "data2", "read"}));
+    e.DeleteRoleForUser("carol", "data2_admin");
+    ASSERT_FALSE(e.Enforce({"carol", "data2", "read"}));
+
+    e.AddPolicy({"dave", "data3", "read"});
+    ASSERT_TRUE(e.Enforce({"dave", "data3", "read"}));
+    e.UpdatePolicy({"dave", "data3", "read"}, {"dave", "data4", "read"});
+    ASSERT_FALSE(e.Enforce({"dave", "data3", "read"}));
+    ASSERT_TRUE(e.Enforce({"dave", "data4", "read"}));
+    e.RemoveFilteredPolicy(0, {"dave"});
+    ASSERT_FALSE(e.Enforce({"dave", "data4", "read"}));
+
+    // a rule listed twice in a batch is removed once, its values are counted down once
+    e.AddPolicies({{"erin", "data5", "read"}, {"frank", "data5", "write"}});
+    ASSERT_TRUE(e.RemovePolicies({{"frank", "data5", "write"}, {"frank", "data5", "write"}}));
+    ASSERT_TRUE(e.HasPolicy({"erin", "data5", "read"}));
+    ASSERT_TRUE(e.Enforce({"erin", "data5", "read"}));
+    ASSERT_FALSE(e.Enforce({"frank", "data5", "write"}));
+
+    e.ClearPolicy();
+    e.LoadPolicy();
+    ASSERT_TRUE(e.Enforce({"alice", "data1", "read"}));
+    ASSERT_FALSE(e.Enforce({"dave", "data4", "read"}));
+}
+
+TEST(TestEnforcer, TestPermissionBitmapsMatchFullScan) {
+    std::vector<ModelCase> models = {
+        {basic_model_path, basic_policy_path},
+        {rbac_model_path, rbac_policy_path},
+        {rbac_model_path, rbac_with_hierarchy_policy_path},
+        {rbac_with_deny_model_path, rbac_with_deny_policy_path},
+    };
+    std::vector<std::vector<std::string>> requests = {
+        {"alice", "data1", "read"}, {"alice", "data2", "write"}, {"bob", "data2", "write"},
+        {"data2_admin", "data2", "read"}, {"admin", "data1", "write"}, {"alice", "data9", "read"},
+        {"bob", "data1", "read"},
+    };
+
+    ExpectSameDecisions(models, requests, [](casbin::Enforcer& e) { e.EnablePermissionBitmaps(true); }, false);
+}
+
+TEST(TestEnforcer, TestPermissionBitmapsIncremental) {
+    casbin::Enforcer e(rbac_model_path, rbac_with_hierarchy_policy_path);
+    e.EnableAutoSave(false);
+    e.EnablePermissionBitmaps(true);
+
+    std::vector<std::string> explain;
+    ASSERT_TRUE(e.EnforceEx({"alice", "data2", "write"}, explain));
+    ASSERT_EQ(explain, std::vector<std::string>({"data2_admin", "data2", "write"}));
+
+    e.RemovePolicy({"data2_admin", "data2", "write"});
+    ASSERT_FALSE(e.Enforce({"alice", "data2", "write"}));
+    e.AddPolicy({"admin", "data2", "write"});
+    ASSERT_TRUE(e.Enforce({"alice", "data2", "write"}));
+
+    e.DeleteRoleForUser("alice", "admin");
+    ASSERT_FALSE(e.Enforce({"alice", "data2", "write"}));
+    ASSERT_TRUE(e.Enforce({"alice", "data1", "read"}));
+    e.AddRoleForUser("alice", "data1_admin");
+    ASSERT_TRUE(e.Enforce({"alice", "data1", "write"}));
+    ASSERT_TRUE(e.Enforce({"bob", "data2", "write"}));
+    ASSERT_FALSE(e.Enforce({"bob", "data1", "write"}));
+
+    // the bitmaps read a new role manager, once its links are built
+    std::shared_ptr<casbin::RoleManager> rm = std::make_shared<casbin::DefaultRoleManager>(10);
+    e.SetRoleManager(rm);
+    ASSERT_FALSE(e.Enforce({"alice", "data1", "write"}));
+    e.BuildRoleLinks();
+    ASSERT_TRUE(e.Enforce({"alice", "data1", "write"}));
+    e.DeleteRoleForUser("alice", "data1_admin");
+    ASSERT_FALSE(e.Enforce({"alice", "data1", "write"}));
+    ASSERT_FALSE(rm->HasLink("alice", "data1_admin"));
+}
+
+TEST(TestEnforcer, TestPermissionBitmapsPatternRules) {
+    auto model = casbin::Model::NewModelFromString(
+        "[request_definition]\n"
+        "r = sub, obj, act\n"
+        "[policy_definition]\n"
+        "p = sub, obj, act\n"
+        "[role_definition]\n"
+        "g = _, _\n"
+        "[policy_effect]\n"
+        "e = some(where (p.eft == allow))\n"
+        "[matchers]\n"
+        "m = g(r.sub, p.sub) && keyMatch(r.obj, p.obj) && r.act == p.act\n");
+    casbin::Enforcer e(model);
+    e.EnablePermissionBitmaps(true);
+    e.AddPolicy({"reader", "/data/1", "GET"});
+    e.AddGroupingPolicy({"alice", "reader"});
+
+    ASSERT_TRUE(e.Enforce({"alice", "/data/1", "GET"}));
+    ASSERT_FALSE(e.Enforce({"alice", "/data/2", "GET"}));
+
+    // a pattern rule is evaluated by the matcher
+    e.AddPolicy({"reader", "/data/*", "GET"});
+    ASSERT_TRUE(e.Enforce({"alice", "/data/2", "GET"}));
+    ASSERT_FALSE(e.Enforce({"alice", "/other", "GET"}));
+    e.RemovePolicy({"reader", "/data/*", "GET"});
+    ASSERT_FALSE(e.Enforce({"alice", "/data/2", "GET"}));
+}
+
+TEST(TestEnforcer, TestIndexesFollowMatchingFunc) {
+    std::vector<std::function<void(casbin::Enforcer&)>> enables = {
+        [](casbin::Enforcer& e) { e.EnableFastReject(true); },
+        [](casbin::Enforcer& e) { e.EnablePermissionBitmaps(true); },
+        [](casbin::Enforcer& e) { e.EnableValueIds(true); },
+    };
+    std::vector<std::vector<std::string>> requests = {
+        {"alice", "/book/1", "GET"}, {"alice", "/pen/1", "GET"}, {"alice", "/pen/2", "GET"},
+        {"bob", "/book/1", "GET"}, {"bob", "/pen/2", "GET"}, {"cathy", "/pen/2", "GET"},
+    };
+    for (const auto& enable : enables) {
+        casbin::Enforcer e(rbac_with_pattern_model_path, rbac_with_pattern_policy_path);
+        casbin::Enforcer tested(rbac_with_pattern_model_path, rbac_with_pattern_policy_path);
+        enable(tested);
+        // the indexes were built before the role manager matched patterns
+        e.AddNamedMatchingFunc("g", "KeyMatch2", casbin::KeyMatch2);
+        tested.AddNamedMatchingFunc("g", "KeyMatch2", casbin::KeyMatch2);
+        for (const auto& request : requests)
+            ASSERT_EQ(tested.Enforce(casbin::DataVector(request.begin(), request.end())), e.Enforce(casbin::DataVector(request.begin(), request.end()))) << request[0] << " " << request[1];
+    }
+}
+
+TEST(TestEnforcer, TestEffectPartitionMatchesFullScan) {
+    std::vector<ModelCase> models = {
+        {rbac_with_deny_model_path, rbac_with_deny_policy_path},
+        {rbac_with_not_deny_model_path, rbac_with_deny_policy_path},
+    };
+    std::vector<std::vector<std::string>> requests = {
+        {"alice", "data1", "read"}, {"alice", "data2", "read"}, {"alice", "data2", "write"},
+        {"bob", "data2", "write"}, {"bob", "data1", "read"}, {"alice", "data9", "read"},
+    };
+
+    ExpectSameDecisions(models, requests, [](casbin::Enforcer& e) { e.EnableEffectPartition(true); }, true);
+}
+
+TEST(TestEnforcer, TestEffectPartitionIncremental) {
+    casbin::Enforcer e(rbac_with_deny_model_path, rbac_with_deny_policy_path);
+    e.EnableAutoSave(false);
+    e.EnableEffectPartition(true);
+
+    ASSERT_TRUE(e.Enforce({"alice", "data1", "read"}));
+    e.AddPolicy({"alice", "data1", "read", "deny"});
+    std::vector<std::string> explain;
+    ASSERT_FALSE(e.EnforceEx({"alice", "data1", "read"}, explain));
+    ASSERT_EQ(explain, std::vector<std::string>({"alice", "data1", "read", "deny"}));
+
+    e.UpdatePolicy({"alice", "data1", "read", "deny"}, {"alice", "data1", "write", "deny"});
+    ASSERT_TRUE(e.Enforce({"alice", "data1", "read"}));
+    ASSERT_FALSE(e.Enforce({"alice", "data1", "write"}));
+    e.RemovePolicy({"alice", "data1", "write", "deny"});
+    ASSERT_FALSE(e.Enforce({"alice", "data1", "write"}));
+    e.AddPolicy({"alice", "data1", "write", "allow"});
+    ASSERT_TRUE(e.Enforce({"alice", "data1", "write"}));
+
+    // an update to a rule already in the policy still removes the old rule
+    e.AddPolicy({"alice", "data1", "read", "deny"});
+    ASSERT_FALSE(e.UpdatePolicy({"alice", "data1", "read", "deny"}, {"alice", "data1", "write", "allow"}));
+    ASSERT_FALSE(e.HasPolicy({"alice", "data1", "read", "deny"}));
+    ASSERT_TRUE(e.Enforce({"alice", "data1", "read"}));
+
+    // a policy changed behind the index is scanned in full, also when it keeps its size and
+    // its first rule
+    e.GetModel()->AddPolicy("p", "p", {"alice", "data1", "read", "deny"});
+    ASSERT_FALSE(e.Enforce({"alice", "data1", "read"}));
+    ASSERT_TRUE(e.RemovePolicy({"alice", "data1", "read", "deny"}));
+    ASSERT_TRUE(e.GetModel()->RemovePolicy("p", "p", {"bob", "data2", "write", "allow"}));
+    ASSERT_TRUE(e.GetModel()->AddPolicy("p", "p", {"bob", "data2", "write", "deny"}));
+    ASSERT_FALSE(e.Enforce({"alice", "data2", "write"}));
+    ASSERT_FALSE(e.Enforce({"bob", "data2", "write"}));
+}
+
+TEST(TestEnforcer, TestHotRuleOrder) {
+    casbin::Enforcer e(keymatch_model_path, keymatch_policy_path);
+    e.EnableAutoSave(false);
+    casbin::HotRuleOrder hot_rules;
+    hot_rules.Build(e.GetModel());
+    const auto& policy = e.GetModel()->m["p"].assertion_map["p"]->policy;
+    ASSERT_TRUE(hot_rules.IsApplicable());
+    ASSERT_EQ(hot_rules.GetOrder(policy)->ids, std::vector<uint32_t>({0, 1, 2, 3, 4}));
+
+    // the rule deciding most requests moves first, and keeps its place across a policy change
+    for (uint64_t i = 0; i < casbin::HotRuleOrder::kReorderInterval; i++)
+        hot_rules.Hit(*hot_rules.GetOrder(policy), 4);
+    ASSERT_EQ(hot_rules.GetOrder(policy)->ids, std::vector<uint32_t>({4, 0, 1, 2, 3}));
+    ASSERT_EQ(*hot_rules.GetRules(*hot_rules.GetOrder(policy)).begin(), std::vector<std::string>({"cathy", "/cathy_data", "(GET)|(POST)"}));
+
+    // an order held across indexing the policy again keeps its rules and hits
+    auto held = hot_rules.GetOrder(policy);
+    hot_rules.Update("p", "p");
+    ASSERT_NE(hot_rules.GetOrder(policy), held);
+    ASSERT_EQ(*hot_rules.GetRules(*held).begin(), std::vector<std::string>({"cathy", "/cathy_data", "(GET)|(POST)"}));
+    hot_rules.Hit(*held, 0);
+    ASSERT_TRUE(e.AddPolicy({"carol", "/carol_data/*", "GET"}));
+    ASSERT_EQ(hot_rules.GetOrder(e.GetModel()->m["p"].assertion_map["p"]->policy)->ids, std::vector<uint32_t>({4, 0, 1, 2, 3, 5}));
+    hot_rules.Update("p", "p");
+    ASSERT_TRUE(e.RemovePolicy({"alice", "/alice_data/*", "GET"}));
+    ASSERT_EQ(hot_rules.GetOrder(e.GetModel()->m["p"].assertion_map["p"]->policy)->ids, std::vector<uint32_t>({3, 0, 1, 2, 4}));
+    hot_rules.Build(e.GetModel());
+    ASSERT_EQ(hot_rules.GetOrder(e.GetModel()->m["p"].assertion_map["p"]->policy)->ids, std::vector<uint32_t>({3, 0, 1, 2, 4}));
+
+    casbin::Enforcer priority(priority_model_path, priority_policy_path);
+    hot_rules.Build(priority.GetModel());
+    ASSERT_FALSE(hot_rules.IsApplicable());
+}
+
+TEST(TestEnforcer, TestHotRuleOrderAfterWrites) {
+    casbin::Enforcer e(keymatch_model_path, keymatch_policy_path);
+    e.EnableAutoSave(false);
+    e.EnableHotRuleOrder(true);
+    e.AddPolicy({"erin", "/erin/hot", "GET"});
+    e.AddPolicy({"erin", "/erin/*", "GET"});
+
+    // the pattern deciding most requests is scanned, and reported, before the exact rule
+    for (uint64_t i = 0; i < casbin::HotRuleOrder::kReorderInterval; i++)
+        ASSERT_TRUE(e.Enforce({"erin", "/erin/other", "GET"}));
+    std::vector<std::string> explain;
+    ASSERT_TRUE(e.EnforceEx({"erin", "/erin/hot", "GET"}, explain));
+    ASSERT_EQ(explain, std::vector<std::string>({"erin", "/erin/*", "GET"}));
+
+    // the order outlives writes to the policy
+    ASSERT_TRUE(e.AddPolicy({"frank", "/frank/*", "GET"}));
+    ASSERT_TRUE(e.EnforceEx({"erin", "/erin/hot", "GET"}, explain));
+    ASSERT_EQ(explain, std::vector<std::string>({"erin", "/erin/*", "GET"}));
+    ASSERT_TRUE(e.RemovePolicy({"frank", "/frank/*", "GET"}));
+    ASSERT_TRUE(e.EnforceEx({"erin", "/erin/hot", "GET"}, explain));
+    ASSERT_EQ(explain, std::vector<std::string>({"erin", "/erin/*", "GET"}));
+    ASSERT_FALSE(e.Enforce({"frank", "/frank/data", "GET"}));
+}
+
+TEST(TestEnforcer, TestHotRuleOrderMatchesPolicyOrder) {
+    std::vector<ModelCase> models = {
+        {basic_model_path, basic_policy_path},
+        {rbac_model_path, rbac_policy_path},
+        {rbac_with_deny_model_path, rbac_with_deny_policy_path},
+        {rbac_with_not_deny_model_path, rbac_with_deny_policy_path},
+    };
+    std::vector<std::vector<std::string>> requests = {
+        {"alice", "data1", "read"}, {"alice", "data2", "read"}, {"alice", "data2", "write"},
+        {"bob", "data2", "write"}, {"bob", "data1", "read"}, {"alice", "data9", "read"},
+    };
+
+    // enough decisions for the rules to be reordered a few times
+    ExpectSameDecisions(models, requests, [](casbin::Enforcer& e) { e.EnableHotRuleOrder(true); }, false, 1000);
+}
+
+TEST(TestEnforcer, TestMatcherReorderingMatchesWrittenOrder) {
+    std::vector<ModelCase> models = {
+        {basic_model_path, basic_policy_path},
+        {rbac_model_path, rbac_policy_path},
+        {keymatch_model_path, keymatch_policy_path},
+        {rbac_with_deny_model_path, rbac_with_deny_policy_path},
+    };
+    std::vector<std::vector<std::string>> requests = {
+        {"alice", "data1", "read"}, {"alice", "data2", "read"}, {"bob", "data2", "write"},
+        {"alice", "/alice_data/resource1", "POST"}, {"cathy", "/cathy_data", "GET"}, {"bob", "/bob_data/x", "GET"},
+    };
+
+    // enough rule evaluations for the samples to reorder the matcher
+    ExpectSameDecisions(models, requests, [](casbin::Enforcer& e) { e.EnableMatcherReordering(true); }, true, 500);
+}
+
+TEST(TestEnforcer, TestRequestHoistingMatchesFullScan) {
+    std::vector<ModelCase> models = {
+        {rbac_matcher_using_in_op_model_path, rbac_policy_path},
+        {basic_with_root_model_path, basic_policy_path},
+        {rbac_with_deny_model_path, rbac_with_deny_policy_path},
+        {keymatch_model_path, keymatch_policy_path},
+        {priority_model_path, priority_policy_path},
+        {rbac_model_path, rbac_policy_path, "keyMatch(r.obj, 'data*') && r.act in ('read', 'write') && g(r.sub, p.sub) && r.obj == p.obj"},
+        {rbac_model_path, rbac_policy_path, "keyMatch(r.obj, '/public/*') || r.sub == 'root'"},
+        {rbac_with_deny_model_path, rbac_with_deny_policy_path, "r.obj == p.obj && g(r.sub, p.sub) || g(r.sub, 'data2_admin') && r.act == p.act"},
+        // a hashed policy reports the rule the request selects
+        {basic_model_path, basic_policy_path, "r.sub == p.sub && r.obj == p.obj && r.act == p.act || r.sub == 'root'"},
+    };
+    std::vector<std::vector<std::string>> requests = {
+        {"alice", "data1", "read"}, {"alice", "data2", "write"}, {"bob", "data2", "write"}, {"bob", "data3", "read"},
+        {"root", "data9", "read"}, {"cathy", "/public/index", "GET"}, {"alice", "/alice_data/resource1", "GET"}, {"bob", "data1", "delete"},
+    };
+
+    ExpectSameDecisions(models, requests, [](casbin::Enforcer& e) { e.EnableRequestHoisting(true); }, true);
+    ExpectSameDecisions(
+        models, requests,
+        [](casbin::Enforcer& e) {
+            e.EnableMatcherReordering(true);
+            e.EnableRequestHoisting(true);
+        },
+        true, 200);
+
+    // a matcher reading only the request is decided without scanning the rules
+    casbin::Enforcer e(rbac_model_path, rbac_policy_path);
+    e.GetModel()->m["m"].assertion_map["m"]->value = "keyMatch(r.obj, '/public/*')";
+    e.EnableRequestHoisting(true);
+    e.Warmup();
+    ASSERT_TRUE(e.Enforce({"anyone", "/public/index", "read"}));
+    ASSERT_FALSE(e.Enforce({"anyone", "/private/index", "read"}));
+    e.ClearPolicy();
+    ASSERT_TRUE(e.Enforce({"anyone", "/public/index", "read"}));
+
+    // and reports the first rule of an interned policy
+    casbin::AccountingResource resource;
+    auto interned_model = std::make_shared<casbin::Model>(&resource);
+    interned_model->LoadModel(rbac_model_path);
+    casbin::Enforcer interned(interned_model, std::make_shared<casbin::FileAdapter>(rbac_policy_path));
+    interned_model->m["m"].assertion_map["m"]->value = "keyMatch(r.obj, '/public/*')";
+    interned_model->InternPolicy();
+    ASSERT_TRUE(interned_model->m["p"].assertion_map["p"]->policy.is_mapped());
+    interned.EnableRequestHoisting(true);
+    std::vector<std::string> explain;
+    ASSERT_TRUE(interned.EnforceEx({"anyone", "/public/index", "read"}, explain));
+    ASSERT_EQ(explain, std::vector<std::string>({"alice", "data1", "read"}));
+
+    // a request no rule matches still fails on a rule of the wrong size, as the scan does
+    casbin::Enforcer invalid(rbac_model_path, rbac_policy_path);
+    invalid.GetModel()->m["m"].assertion_map["m"]->value = "keyMatch(r.obj, '/public/*') && r.sub == p.sub";
+    invalid.EnableRequestHoisting(true);
+    invalid.GetModel()->AddPolicy("p", "p", {"alice", "data1"});
+    ASSERT_THROW(invalid.Enforce({"anyone", "/private/index", "read"}), casbin::CasbinEnforcerException);
+}
+
+TEST(TestEnforcer, TestDomainPartitionMatchesFullScan) {
+    std::vector<ModelCase> models = {
+        {rbac_with_domains_model_path, rbac_with_domains_policy_path},
+        {rbac_with_domains_model_path, rbac_with_hierarchy_with_domains_policy_path},
+    };
+    std::vector<std::vector<std::string>> requests = {
+        {"alice", "domain1", "data1", "read"}, {"alice", "domain2", "data2", "read"}, {"bob", "domain2", "data2", "write"},
+        {"bob", "domain1", "data1", "write"}, {"admin", "domain1", "data1", "read"}, {"alice", "domain9", "data1", "read"},
+    };
+
+    ExpectSameDecisions(models, requests, [](casbin::Enforcer& e) { e.EnableDomainPartition(true); }, true);
+}
+
+TEST(TestEnforcer, TestDomainPartitionFilteredOperations) {
+    casbin::Enforcer e(rbac_with_domains_model_path, rbac_with_domains_policy_path);
+    e.EnableAutoSave(false);
+    e.EnableDomainPartition(true);
+
+    auto permissions = e.GetPermissionsForUserInDomain("admin", "domain1");
+    ASSERT_EQ(permissions.size(), 2);
+    ASSERT_TRUE(permissions.find({"admin", "domain1", "data1", "write"}) != permissions.end());
+    ASSERT_TRUE(e.GetPermissionsForUserInDomain("admin", "domain9").empty());
+
+    ASSERT_FALSE(e.RemoveFilteredPolicy(1, {"domain9"}));
+    ASSERT_TRUE(e.RemoveFilteredPolicy(1, {"domain1", "data1", "write"}));
+    ASSERT_FALSE(e.Enforce({"alice", "domain1", "data1", "write"}));
+    ASSERT_TRUE(e.Enforce({"alice", "domain1", "data1", "read"}));
+    ASSERT_EQ(e.GetPermissionsForUserInDomain("admin", "domain1").size(), 1);
+
+    e.AddPolicy({"admin", "domain3", "data3", "read"});
+    e.AddRoleForUserInDomain("alice", "admin", "domain3");
+    ASSERT_TRUE(e.Enforce({"alice", "domain3", "data3", "read"}));
+    ASSERT_EQ(e.GetPolicy().size(), 4);
+
+    // a policy changed behind the index keeping its size and its first rule is scanned in full
+    casbin::Enforcer changed(rbac_with_domains_model_path, rbac_with_domains_policy_path);
+    changed.EnableDomainPartition(true);
+    ASSERT_TRUE(changed.GetModel()->RemovePolicy("p", "p", {"admin", "domain1", "data1", "write"}));
+    ASSERT_TRUE(changed.GetModel()->AddPolicy("p", "p", {"admin", "domain2", "data2", "delete"}));
+    ASSERT_TRUE(changed.Enforce({"bob", "domain2", "data2", "read"}));
+    ASSERT_TRUE(changed.Enforce({"bob", "domain2", "data2", "delete"}));
+    ASSERT_FALSE(changed.Enforce({"alice", "domain1", "data1", "write"}));
+}
+
 // TEST(TestEnforcer, JsonData) {
 //     using json = nlohmann::json;
 //     casbin::Scope scope = casbin::InitializeScope();
@@ -416,4 +903,390 @@ TEST(TestEnforcerEx, TestMapParams) {
 //     ASSERT_TRUE(!EvalAndGetTop(scope, s6));
 // }
 
+TEST(TestEnforcer, TestValueIdsMatchFullScan) {
+    std::vector<ModelCase> models = {
+        {basic_model_path, basic_policy_path},
+        {rbac_model_path, rbac_policy_path},
+        {rbac_model_path, rbac_with_hierarchy_policy_path},
+        {rbac_with_deny_model_path, rbac_with_deny_policy_path},
+        {rbac_with_not_deny_model_path, rbac_with_deny_policy_path},
+    };
+    std::vector<std::vector<std::string>> requests = {
+        {"alice", "data1", "read"}, {"alice", "data2", "write"}, {"bob", "data2", "write"},
+        {"data2_admin", "data2", "read"}, {"admin", "data1", "write"}, {"alice", "data9", "read"},
+        {"bob", "data1", "read"}, {"", "", ""},
+    };
+    auto enable = [](casbin::Enforcer& e) { e.EnableValueIds(true); };
+    auto decide = [](casbin::Enforcer& e, const std::vector<std::string>& request) { return e.Enforce(e.ResolveValueIds(request)); };
+
+    ExpectSameDecisions(models, requests, enable, false, 1, decide);
+
+    std::vector<ModelCase> domain_models = {{rbac_with_domains_model_path, rbac_with_hierarchy_with_domains_policy_path}};
+    std::vector<std::vector<std::string>> domain_requests = {
+        {"alice", "domain1", "data1", "read"}, {"alice", "domain2", "data2", "read"}, {"bob", "domain2", "data2", "write"},
+        {"bob", "domain1", "data1", "write"}, {"admin", "domain1", "data1", "read"}, {"alice", "domain9", "data1", "read"},
+    };
+    ExpectSameDecisions(domain_models, domain_requests, enable, false, 1, decide);
+}
+
+// DenyingEffector denies every request.
+class DenyingEffector : public casbin::Effector {
+public:
+    casbin::Effect MergeEffects(const std::string& /*expr*/, const std::vector<casbin::Effect>& /*effects*/, const std::vector<float>& /*matches*/, int /*policyIndex*/, int /*policyLength*/, int& explainIndex) override {
+        explainIndex = -1;
+        return casbin::Effect::Deny;
+    }
+};
+
+TEST(TestEnforcer, TestValueIdsIncremental) {
+    casbin::Enforcer e(rbac_model_path, rbac_policy_path);
+    e.EnableAutoSave(false);
+    ASSERT_THROW(e.GetValueDictionary(), casbin::CasbinEnforcerException);
+    e.EnableValueIds(true);
+
+    casbin::ValueDictionary dictionary = e.GetValueDictionary();
+    ASSERT_EQ(dictionary.GetId(""), 0);
+    ASSERT_EQ(dictionary.GetId("carol"), casbin::kUnknownValueId);
+    ASSERT_EQ(dictionary.GetValue(dictionary.GetId("alice")), "alice");
+    casbin::ValueIds request = dictionary.Resolve({"alice", "data2", "read"});
+    ASSERT_TRUE(e.Enforce(request));
+
+    // ids stay valid while the policy changes
+    e.DeleteRoleForUser("alice", "data2_admin");
+    ASSERT_FALSE(e.Enforce(request));
+    e.AddPolicy({"carol", "data3", "read"});
+    e.AddRoleForUser("alice", "carol");
+    ASSERT_EQ(e.GetValueDictionaryEpoch(), dictionary.GetEpoch());
+    dictionary = e.GetValueDictionary();
+    ASSERT_TRUE(e.Enforce(dictionary.Resolve({"alice", "data3", "read"})));
+    ASSERT_EQ(dictionary.Resolve({"alice", "data2", "read"}).ids, request.ids);
+
+    // reloading keeps the ids, ids of another dictionary are refused
+    e.LoadPolicy();
+    ASSERT_EQ(e.GetValueDictionaryEpoch(), dictionary.GetEpoch());
+    ASSERT_TRUE(e.Enforce(request));
+    casbin::Enforcer other(rbac_model_path, rbac_policy_path);
+    other.EnableValueIds(true);
+    ASSERT_NE(other.GetValueDictionaryEpoch(), dictionary.GetEpoch());
+    ASSERT_THROW(other.Enforce(request), casbin::CasbinEnforcerException);
+    ASSERT_THROW(e.Enforce(casbin::ValueIds{e.GetValueDictionaryEpoch(), {0, 0}}), casbin::CasbinEnforcerException);
+
+    casbin::Enforcer abac(abac_rule_model_path);
+    abac.EnableValueIds(true);
+    ASSERT_THROW(abac.GetValueDictionary(), casbin::CasbinEnforcerException);
+
+    // the index decides with the effect of a DefaultEffector only
+    request = e.ResolveValueIds({"alice", "data2", "read"});
+    std::shared_ptr<casbin::Effector> effector = std::make_shared<DenyingEffector>();
+    e.SetEffector(effector);
+    ASSERT_THROW(e.Enforce(request), casbin::CasbinEnforcerException);
+    e.EnableValueIds(true);
+    ASSERT_THROW(e.Enforce(request), casbin::CasbinEnforcerException);
+    e.SetEffector(std::make_shared<casbin::DefaultEffector>());
+    ASSERT_TRUE(e.Enforce(request));
+
+    casbin::SyncedEnforcer synced(rbac_model_path, rbac_policy_path);
+    synced.EnableValueIds(true);
+    ASSERT_TRUE(synced.Enforce(synced.ResolveValueIds({"alice", "data2", "read"})));
+    ASSERT_TRUE(synced.Enforce(synced.GetValueDictionary().Resolve({"alice", "data2", "read"})));
+
+    casbin::CachedEnforcer cached(rbac_model_path, rbac_policy_path);
+    cached.EnableAutoSave(false);
+    cached.EnableValueIds(true);
+    request = cached.GetValueDictionary().Resolve({"bob", "data2", "write"});
+    ASSERT_TRUE(cached.Enforce(request));
+    cached.RemovePolicy({"bob", "data2", "write"});
+    cached.InvalidateCache();
+    ASSERT_FALSE(cached.Enforce(request));
+}
+
+TEST(TestEnforcer, TestWarmup) {
+    std::vector<std::pair<std::string, std::string>> models = {
+        {basic_model_path, basic_policy_path},
+        {rbac_model_path, rbac_with_hierarchy_policy_path},
+        {rbac_with_domains_model_path, rbac_with_domains_policy_path},
+        {keymatch_model_path, keymatch_policy_path},
+    };
+    std::vector<std::vector<std::string>> requests = {
+        {"alice", "data1", "read"}, {"alice", "data2", "write"}, {"bob", "data2", "write"},
+        {"alice", "/alice_data/resource1", "GET"}, {"bob", "/bob_data/resource2", "POST"},
+    };
+
+    for (const auto& [model_path, policy_path] : models) {
+        casbin::Enforcer e(model_path, policy_path);
+        casbin::Enforcer warm(model_path, policy_path);
+        warm.EnablePermissionBitmaps(true);
+        warm.Warmup();
+        for (auto request : requests) {
+            if (model_path == rbac_with_domains_model_path)
+                request.insert(request.begin() + 1, "domain1");
+            casbin::DataVector params(request.begin(), request.end());
+            ASSERT_EQ(warm.Enforce(params), e.Enforce(params)) << model_path << " " << request[0] << " " << request[1];
+        }
+    }
+
+    // matchers using eval() are compiled per rule on demand
+    casbin::Enforcer abac(abac_rule_model_path, abac_rule_policy_path);
+    ASSERT_NO_THROW(abac.Warmup());
+
+    casbin::Enforcer reloaded(rbac_model_path, rbac_policy_path);
+    reloaded.EnableAutoWarmup(true);
+    reloaded.LoadPolicy();
+    ASSERT_TRUE(reloaded.Enforce({"alice", "data2", "read"}));
+    ASSERT_FALSE(reloaded.Enforce({"bob", "data1", "read"}));
+}
+
+TEST(TestEnforcer, TestEnforceWithContext) {
+    auto m = casbin::Model::NewModelFromString(
+        "[request_definition]\n"
+        "r = sub, obj, act\n"
+        "r2 = sub, obj\n"
+        "[policy_definition]\n"
+        "p = sub, obj, act\n"
+        "p2 = sub, obj, eft\n"
+        "[role_definition]\n"
+        "g = _, _\n"
+        "[policy_effect]\n"
+        "e = some(where (p.eft == allow))\n"
+        "e2 = some(where (p.eft == allow)) && !some(where (p.eft == deny))\n"
+        "[matchers]\n"
+        "m = g(r.sub, p.sub) && r.obj == p.obj && r.act == p.act\n"
+        "m2 = r2.sub == p2.sub && keyMatch(r2.obj, p2.obj)\n");
+    casbin::Enforcer e(m);
+    e.AddPolicy({"admin", "data1", "read"});
+    e.AddGroupingPolicy({"alice", "admin"});
+    e.AddNamedPolicy("p2", {"alice", "/files/*", "allow"});
+    e.AddNamedPolicy("p2", {"alice", "/files/secret", "deny"});
+
+    casbin::EnforceContext context = casbin::EnforceContext::NewEnforceContext("2");
+    ASSERT_EQ(context.p_type, "p2");
+    ASSERT_FALSE(context.IsDefault());
+
+    // alternating between the definitions keeps each on its own evaluator
+    for (int i = 0; i < 2; i++) {
+        ASSERT_TRUE(e.Enforce({"alice", "data1", "read"}));
+        ASSERT_TRUE(e.EnforceWithContext(context, {"alice", "/files/report"}));
+        ASSERT_FALSE(e.EnforceWithContext(context, {"alice", "/files/secret"}));
+        ASSERT_FALSE(e.EnforceWithContext(context, {"bob", "/files/report"}));
+        ASSERT_TRUE(e.EnforceWithContext(casbin::EnforceContext(), {"alice", "data1", "read"}));
+    }
+
+    std::vector<std::string> explain;
+    ASSERT_TRUE(e.EnforceExWithContext(context, casbin::DataMap{{"sub", "alice"}, {"obj", "/files/a"}}, explain));
+    ASSERT_EQ(explain, std::vector<std::string>({"alice", "/files/*", "allow"}));
+    ASSERT_FALSE(e.EnforceWithContext(context, {"alice", "/files/a", "read"}));
+    ASSERT_THROW(e.EnforceWithContext(casbin::EnforceContext::NewEnforceContext("3"), {"alice", "/files/a"}), casbin::CasbinEnforcerException);
+}
+
+TEST(TestEnforcer, TestEnforceWithContextIndexes) {
+    std::string model_text =
+        "[request_definition]\n"
+        "r = sub, obj, act\n"
+        "r2 = sub, obj\n"
+        "[policy_definition]\n"
+        "p = sub, obj, act\n"
+        "p2 = sub, obj, eft\n"
+        "[policy_effect]\n"
+        "e = some(where (p.eft == allow))\n"
+        "e2 = some(where (p.eft == allow)) && !some(where (p.eft == deny))\n"
+        "[matchers]\n"
+        "m = r.sub == p.sub && r.obj == p.obj && r.act == p.act\n"
+        "m2 = r2.sub == p2.sub && r2.obj == p2.obj\n";
+    casbin::Enforcer plain(casbin::Model::NewModelFromString(model_text));
+    casbin::Enforcer indexed(casbin::Model::NewModelFromString(model_text));
+    indexed.EnableFastReject(true);
+    indexed.EnableEffectPartition(true);
+    for (casbin::Enforcer* e : {&plain, &indexed}) {
+        e->AddPolicy({"alice", "data1", "read"});
+        e->AddNamedPolicy("p2", {"bob", "data2", "allow"});
+        e->AddNamedPolicy("p2", {"bob", "data3", "deny"});
+    }
+
+    // the context reads its own indexes, those of the default definitions hold no "p2" value
+    casbin::EnforceContext context = casbin::EnforceContext::NewEnforceContext("2");
+    std::vector<std::vector<std::string>> requests = {{"bob", "data2"}, {"bob", "data3"}, {"alice", "data2"}, {"carol", "data1"}};
+    auto check = [&]() {
+        for (const auto& request : requests) {
+            casbin::DataVector params(request.begin(), request.end());
+            ASSERT_EQ(indexed.EnforceWithContext(context, params), plain.EnforceWithContext(context, params));
+        }
+        ASSERT_TRUE(indexed.Enforce({"alice", "data1", "read"}));
+    };
+    check();
+    ASSERT_TRUE(indexed.EnforceWithContext(context, {"bob", "data2"}));
+    casbin::FastRejectIndex fast_reject;
+    fast_reject.Build(indexed.GetModel(), context);
+    ASSERT_TRUE(fast_reject.IsApplicable());
+
+    // the indexes of the context follow its policy
+    for (casbin::Enforcer* e : {&plain, &indexed})
+        e->AddNamedPolicy("p2", {"carol", "data1", "allow"});
+    check();
+    ASSERT_TRUE(indexed.EnforceWithContext(context, {"carol", "data1"}));
+    for (casbin::Enforcer* e : {&plain, &indexed})
+        e->RemoveNamedPolicy("p2", {"bob", "data2", "allow"});
+    check();
+    ASSERT_FALSE(indexed.EnforceWithContext(context, {"bob", "data2"}));
+}
+
+TEST(TestEnforcer, TestCachedEnforceWithContext) {
+    casbin::CachedEnforcer e(casbin::Model::NewModelFromString(
+        "[request_definition]\n"
+        "r = sub, obj\n"
+        "r2 = sub, obj\n"
+        "[policy_definition]\n"
+        "p = sub, obj\n"
+        "p2 = sub, obj\n"
+        "[policy_effect]\n"
+        "e = some(where (p.eft == allow))\n"
+        "e2 = some(where (p.eft == allow))\n"
+        "[matchers]\n"
+        "m = r.sub == p.sub && r.obj == p.obj\n"
+        "m2 = r2.sub == p2.sub && r2.obj == p2.obj\n"));
+    e.AddPolicy({"alice", "data1"});
+    e.AddNamedPolicy("p2", {"alice", "data2"});
+
+    // the same request keeps one decision per context
+    casbin::EnforceContext context = casbin::EnforceContext::NewEnforceContext("2");
+    for (int i = 0; i < 2; i++) {
+        ASSERT_FALSE(e.Enforce({"alice", "data2"}));
+        ASSERT_TRUE(e.EnforceWithContext(context, {"alice", "data2"}));
+        ASSERT_TRUE(e.EnforceWithContext(casbin::EnforceContext(), {"alice", "data1"}));
+        ASSERT_FALSE(e.EnforceWithContext(context, casbin::DataMap{{"sub", "alice"}, {"obj", "data1"}}));
+    }
+    ASSERT_EQ(e.context_cache.size(), 1);
+    ASSERT_EQ(e.context_cache[context.GetKey()].size(), 2);
+
+    e.InvalidateCache();
+    ASSERT_TRUE(e.context_cache.empty());
+}
+
+TEST(TestEnforcer, TestTypedRequest) {
+    casbin::Enforcer e(rbac_model_path, rbac_with_hierarchy_policy_path);
+    std::vector<std::vector<std::string>> requests = {
+        {"alice", "data1", "read"}, {"alice", "data2", "write"}, {"bob", "data2", "write"},
+        {"bob", "data1", "read"}, {"alice", "data9", "read"},
+    };
+
+    // typed and variant requests share the evaluator
+    for (const auto& request : requests) {
+        bool expected = e.Enforce(casbin::DataVector(request.begin(), request.end()));
+        ASSERT_EQ(e.Enforce(TypedRequest{request[0], request[1], request[2]}), expected) << request[0] << " " << request[1];
+    }
+
+    std::vector<std::string> explain;
+    ASSERT_TRUE(e.EnforceEx(TypedRequest{"alice", "data2", "write"}, explain));
+    ASSERT_EQ(explain, std::vector<std::string>({"data2_admin", "data2", "write"}));
+    ASSERT_FALSE(e.Enforce(ShortRequest{"alice", "data1"}));
+
+    casbin::SyncedEnforcer synced(rbac_model_path, rbac_policy_path);
+    ASSERT_TRUE(synced.Enforce(TypedRequest{"alice", "data1", "read"}));
+    ASSERT_FALSE(synced.Enforce(TypedRequest{"bob", "data1", "read"}));
+
+    casbin::CachedEnforcer cached(rbac_model_path, rbac_policy_path);
+    ASSERT_TRUE(cached.Enforce(TypedRequest{"alice", "data2", "read"}));
+}
+
+TEST(TestEnforcer, TestFork) {
+    casbin::Enforcer e(rbac_model_path, rbac_policy_path);
+    casbin::SpecializedEnforcer<casbin::RbacMatcher> specialized(e);
+    std::shared_ptr<casbin::Enforcer> fork = e.Fork();
+    auto p_assertion = [](casbin::IEnforcer& enforcer) { return enforcer.GetModel()->m["p"].assertion_map["p"].get(); };
+    auto g_assertion = [](casbin::IEnforcer& enforcer) { return enforcer.GetModel()->m["g"].assertion_map["g"].get(); };
+
+    ASSERT_EQ(p_assertion(*fork), p_assertion(e));
+    ASSERT_EQ(fork->GetRoleManager(), e.GetRoleManager());
+    ASSERT_TRUE(fork->Enforce({"alice", "data2", "read"}));
+    ASSERT_FALSE(fork->Enforce({"bob", "data1", "read"}));
+
+    // a role change copies the role graph and the "g" assertion only
+    ASSERT_TRUE(fork->RemoveGroupingPolicy({"alice", "data2_admin"}));
+    ASSERT_FALSE(fork->Enforce({"alice", "data2", "read"}));
+    ASSERT_TRUE(e.Enforce({"alice", "data2", "read"}));
+    ASSERT_NE(g_assertion(*fork), g_assertion(e));
+    ASSERT_NE(fork->GetRoleManager(), e.GetRoleManager());
+    ASSERT_EQ(p_assertion(*fork), p_assertion(e));
+
+    ASSERT_TRUE(fork->AddPolicy({"bob", "data1", "read"}));
+    ASSERT_TRUE(fork->Enforce({"bob", "data1", "read"}));
+    ASSERT_FALSE(e.Enforce({"bob", "data1", "read"}));
+    ASSERT_NE(p_assertion(*fork), p_assertion(e));
+
+    // the enforcer forked from copies what it still shares before changing it
+    std::shared_ptr<casbin::Enforcer> second = e.Fork();
+    // a rejected add copies nothing
+    ASSERT_FALSE(second->AddPolicies({{"carol", "data3", "read"}, {"alice", "data1", "read"}}));
+    ASSERT_EQ(p_assertion(*second), p_assertion(e));
+    ASSERT_TRUE(e.AddPolicy({"carol", "data3", "read"}));
+    ASSERT_TRUE(e.AddGroupingPolicy({"bob", "data2_admin"}));
+    ASSERT_TRUE(e.Enforce({"carol", "data3", "read"}));
+    ASSERT_TRUE(specialized.Enforce("carol", "data3", "read"));
+    ASSERT_TRUE(specialized.Enforce("bob", "data2", "read"));
+    ASSERT_FALSE(second->Enforce({"carol", "data3", "read"}));
+    ASSERT_FALSE(second->Enforce({"bob", "data2", "read"}));
+    ASSERT_FALSE(fork->Enforce({"carol", "data3", "read"}));
+
+    // clearing the policy of a fork leaves the shared one alone
+    second->ClearPolicy();
+    ASSERT_TRUE(second->GetPolicy().empty());
+    ASSERT_FALSE(e.GetPolicy().empty());
+
+    // a cached enforcer forks with an empty cache
+    casbin::CachedEnforcer cached(rbac_model_path, rbac_policy_path);
+    ASSERT_TRUE(cached.Enforce({"alice", "data2", "read"}));
+    auto cached_fork = std::dynamic_pointer_cast<casbin::CachedEnforcer>(cached.Fork());
+    ASSERT_NE(cached_fork, nullptr);
+    ASSERT_TRUE(cached_fork->m.empty());
+    ASSERT_TRUE(cached_fork->RemoveGroupingPolicy({"alice", "data2_admin"}));
+    ASSERT_FALSE(cached_fork->Enforce({"alice", "data2", "read"}));
+    ASSERT_TRUE(cached.Enforce({"alice", "data2", "read"}));
+}
+
+TEST(TestEnforcer, TestForkSharesChunks) {
+    casbin::Enforcer e(rbac_model_path);
+    PoliciesValues rules;
+    for (int i = 0; i < 3000; i++)
+        rules.emplace({"user" + std::to_string(i), "data", "read"});
+    ASSERT_TRUE(e.AddPolicies(rules));
+    std::shared_ptr<casbin::Enforcer> fork = e.Fork();
+    auto p_policy = [](casbin::IEnforcer& enforcer) -> const PoliciesValues& { return enforcer.GetModel()->m["p"].assertion_map["p"]->policy; };
+
+    // the fork copies the chunk it changes, it shares the others
+    ASSERT_TRUE(fork->RemovePolicy({"user1500", "data", "read"}));
+    ASSERT_TRUE(fork->AddPolicy({"carol", "data", "write"}));
+    ASSERT_TRUE(p_policy(*fork).is_chunked());
+    ASSERT_LT(p_policy(*fork).memory_usage(), p_policy(e).memory_usage() / 2);
+    ASSERT_EQ(p_policy(*fork).size(), 3000);
+
+    ASSERT_FALSE(fork->Enforce({"user1500", "data", "read"}));
+    ASSERT_TRUE(fork->Enforce({"user1499", "data", "read"}));
+    ASSERT_TRUE(fork->Enforce({"user2999", "data", "read"}));
+    ASSERT_TRUE(fork->Enforce({"carol", "data", "write"}));
+    ASSERT_TRUE(e.Enforce({"user1500", "data", "read"}));
+    ASSERT_FALSE(e.Enforce({"carol", "data", "write"}));
+
+    // the enforcer forked from changes a copy too, the fork keeps reading the rules it shares
+    ASSERT_TRUE(e.RemovePolicy({"user0", "data", "read"}));
+    ASSERT_FALSE(e.Enforce({"user0", "data", "read"}));
+    ASSERT_TRUE(fork->Enforce({"user0", "data", "read"}));
+    ASSERT_TRUE(fork->HasPolicy({"user2000", "data", "read"}));
+    ASSERT_EQ(fork->GetPolicy().size(), 3000);
+}
+
+TEST(TestEnforcer, TestInOperator) {
+    casbin::Enforcer e(rbac_matcher_using_in_op_model_path, rbac_policy_path);
+    ASSERT_TRUE(e.Enforce({"alice", "data1", "read"}));
+    ASSERT_FALSE(e.Enforce({"bob", "data1", "read"}));
+    ASSERT_TRUE(e.Enforce({"bob", "data3", "read"}));
+    ASSERT_TRUE(e.Enforce({"anyone", "data2", "delete"}));
+    ASSERT_FALSE(e.Enforce({"anyone", "data4", "read"}));
+
+    // candidates other than string literals are compared one by one
+    e.GetModel()->m["m"].assertion_map["m"]->value = "r.obj in ('data4', r.sub, p.obj + '_x')";
+    ASSERT_TRUE(e.Enforce({"data1", "data1", "read"}));
+    ASSERT_TRUE(e.Enforce({"alice", "data4", "read"}));
+    ASSERT_TRUE(e.Enforce({"alice", "data1_x", "read"}));
+    ASSERT_FALSE(e.Enforce({"alice", "data1", "read"}));
+}
+
 } // namespace
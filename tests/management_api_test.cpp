@@ -166,6 +166,29 @@ TEST(TestManagementAPI, TestModifyPolicyAPI) {
     TestGetPolicy(e, PoliciesValues({{"eve", "data3", "read"}, {"leyo", "data4", "write"}, {"katy", "data1", "write"}}));
 }
 
+TEST(TestManagementAPI, TestRemovePoliciesUpdatesRoleLinks) {
+    casbin::Enforcer e(rbac_model_path, rbac_policy_path);
+    e.EnableAutoSave(false);
+
+    // removing grouping rules removes their role links
+    ASSERT_TRUE(e.Enforce({"alice", "data2", "read"}));
+    ASSERT_TRUE(e.RemoveGroupingPolicy({"alice", "data2_admin"}));
+    ASSERT_FALSE(e.Enforce({"alice", "data2", "read"}));
+
+    PoliciesValues grouping_rules({{"ham", "data2_admin"}, {"jack", "data2_admin"}});
+    ASSERT_TRUE(e.AddGroupingPolicies(grouping_rules));
+    ASSERT_TRUE(e.Enforce({"ham", "data2", "write"}));
+    ASSERT_TRUE(e.RemoveGroupingPolicies(grouping_rules));
+    ASSERT_FALSE(e.Enforce({"ham", "data2", "write"}));
+    ASSERT_FALSE(e.Enforce({"jack", "data2", "write"}));
+    ASSERT_TRUE(e.GetGroupingPolicy().empty());
+
+    // every rule removed at once is removed, and only once
+    ASSERT_TRUE(e.RemovePolicies(PoliciesValues({{"alice", "data1", "read"}, {"bob", "data2", "write"}})));
+    TestGetPolicy(e, PoliciesValues({{"data2_admin", "data2", "read"}, {"data2_admin", "data2", "write"}}));
+    ASSERT_FALSE(e.RemovePolicies(PoliciesValues({{"alice", "data1", "read"}})));
+}
+
 TEST(TestManagementAPI, TestModifyGroupingPolicyAPI) {
     std::shared_ptr<casbin::Adapter> adapter = std::make_shared<casbin::BatchFileAdapter>(rbac_policy_path);
     casbin::Enforcer e(rbac_model_path, adapter);
@@ -246,4 +269,30 @@ TEST(TestManagementAPI, TestModifyGroupingPolicyAPI) {
     ASSERT_TRUE(casbin::ArrayEquals({"data4_admin"}, e.GetRolesForUser("admin")));
 }
 
+TEST(TestManagementAPI, TestImportPolicyAPI) {
+    casbin::Enforcer e(rbac_model_path, rbac_policy_path);
+    e.EnableFastReject(true);
+
+    std::vector<std::vector<std::string>> rules{
+        {"alice", "data1", "read"},
+        {"carol", "data3", "read"},
+        {"dave", "data3", "write"},
+        {"carol", "data3", "read"},
+    };
+    ASSERT_EQ(e.ImportPolicies(rules), 2);
+    ASSERT_EQ(e.GetPolicy().size(), 6);
+    ASSERT_TRUE(e.Enforce({"carol", "data3", "read"}));
+    ASSERT_TRUE(e.Enforce({"dave", "data3", "write"}));
+    ASSERT_EQ(e.ImportPolicies(rules), 0);
+
+    ASSERT_EQ(e.ImportGroupingPolicies({{"alice", "data2_admin"}, {"carol", "data2_admin"}, {"eve", "carol"}}), 2);
+    ASSERT_TRUE(e.Enforce({"carol", "data2", "write"}));
+    ASSERT_TRUE(e.Enforce({"eve", "data3", "read"}));
+    ASSERT_TRUE(casbin::ArrayEquals({"alice", "carol"}, e.GetUsersForRole("data2_admin")));
+
+    // rules holding the same values in another order are duplicates, like for AddPolicies
+    ASSERT_EQ(e.ImportNamedPolicies("p", {{"read", "data1", "alice"}}), 0);
+    ASSERT_EQ(e.ImportNamedPolicies("p9", {{"frank", "data1", "read"}}), 0);
+}
+
 } // namespace
@@ -0,0 +1,106 @@
+/*
+ * Copyright 2021 The casbin Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This is a test file for testing the matcher parser
+ */
+
+#include <casbin/casbin.h>
+#include <gtest/gtest.h>
+
+namespace {
+
+using casbin::MatcherNode;
+
+TEST(TestMatcher, TestParseConjunction) {
+    auto root = casbin::ParseMatcher("g(r.sub, p.sub, r.dom) && r.dom == p.dom && keyMatch(r.obj, p.obj) && r.act == p.act");
+    ASSERT_NE(root, nullptr);
+    ASSERT_EQ(root->kind, MatcherNode::Kind::And);
+
+    auto conjuncts = casbin::GetConjuncts(root);
+    ASSERT_EQ(conjuncts.size(), 4);
+    ASSERT_EQ(conjuncts[0]->kind, MatcherNode::Kind::Call);
+    ASSERT_EQ(conjuncts[0]->value, "g");
+    ASSERT_EQ(conjuncts[0]->children.size(), 3);
+    ASSERT_TRUE(conjuncts[0]->children[0]->IsRequestField());
+    ASSERT_TRUE(conjuncts[0]->children[1]->IsPolicyField());
+    ASSERT_EQ(conjuncts[1]->kind, MatcherNode::Kind::Compare);
+    ASSERT_EQ(conjuncts[1]->value, "==");
+}
+
+TEST(TestMatcher, TestPrecedence) {
+    auto root = casbin::ParseMatcher("r.sub == p.sub && r.obj == p.obj || r.sub == \"root\"");
+    ASSERT_NE(root, nullptr);
+    ASSERT_EQ(root->kind, MatcherNode::Kind::Or);
+    ASSERT_EQ(root->children[0]->kind, MatcherNode::Kind::And);
+    ASSERT_EQ(casbin::GetConjuncts(root).size(), 1);
+    ASSERT_EQ(casbin::PrintMatcher(*root), "(r.sub == p.sub && r.obj == p.obj) || r.sub == 'root'");
+
+    root = casbin::ParseMatcher("!(r.age > 18 + 2) && r.obj in ('data2', 'data3')");
+    ASSERT_NE(root, nullptr);
+    ASSERT_EQ(root->children[0]->kind, MatcherNode::Kind::Not);
+    ASSERT_EQ(root->children[1]->kind, MatcherNode::Kind::In);
+    ASSERT_EQ(root->children[1]->children[1]->children.size(), 2);
+    ASSERT_EQ(casbin::PrintMatcher(*root), "!(r.age > 18 + 2) && r.obj in ('data2', 'data3')");
+}
+
+TEST(TestMatcher, TestRoundTrip) {
+    for (const std::string matcher : {
+             "g(r.sub, p.sub) && r.obj == p.obj && r.act == p.act",
+             "r.sub.Owner == r.obj && regexMatch(r.act, p.act)",
+             "eval(p.sub_rule) && r.obj == p.obj",
+         }) {
+        auto root = casbin::ParseMatcher(matcher);
+        ASSERT_NE(root, nullptr) << matcher;
+        ASSERT_EQ(casbin::PrintMatcher(*root), matcher);
+    }
+}
+
+TEST(TestMatcher, TestParseContextMatcher) {
+    auto root = casbin::ParseMatcher("g(r2.sub, p2.sub) && r2.obj == p2.obj && keyMatch(r2.act, p2.act)", "r2", "p2");
+    ASSERT_NE(root, nullptr);
+    ASSERT_EQ(casbin::PrintMatcher(*root), "g(r.sub, p.sub) && r.obj == p.obj && keyMatch(r.act, p.act)");
+    ASSERT_TRUE(casbin::GetConjuncts(root)[1]->children[0]->IsRequestField());
+    ASSERT_TRUE(casbin::GetConjuncts(root)[1]->children[1]->IsPolicyField());
+}
+
+TEST(TestMatcher, TestPlanStaticOrder) {
+    auto plan_of = [](const std::string& matcher) {
+        auto m = casbin::Model::NewModelFromString(
+            "[request_definition]\nr = sub, obj, act\n[policy_definition]\np = sub, obj, act\n"
+            "[role_definition]\ng = _, _\n[policy_effect]\ne = some(where (p.eft == allow))\n[matchers]\nm = " +
+            matcher + "\n");
+        casbin::MatcherPlan plan;
+        plan.Build(m);
+        return plan.IsApplicable() ? *plan.GetExpression() : std::string();
+    };
+
+    ASSERT_EQ(plan_of("regexMatch(r.act, p.act) && keyMatch(r.obj, p.obj) && g(r.sub, p.sub) && r.act == p.act"),
+              "r.act == p.act && g(r.sub, p.sub) && keyMatch(r.obj, p.obj) && regexMatch(r.act, p.act)");
+    ASSERT_EQ(plan_of("(keyMatch(r.obj, p.obj) || r.obj == p.obj) && r.sub == p.sub"),
+              "r.sub == p.sub && (r.obj == p.obj || keyMatch(r.obj, p.obj))");
+    // operands only move between calls to functions not known to be pure
+    ASSERT_EQ(plan_of("regexMatch(r.act, p.act) && keyGet(r.obj, p.obj) == '' && keyMatch(r.obj, p.obj) && r.sub == p.sub"),
+              "regexMatch(r.act, p.act) && keyGet(r.obj, p.obj) == '' && r.sub == p.sub && keyMatch(r.obj, p.obj)");
+    ASSERT_EQ(plan_of("eval(p.sub) && r.obj == p.obj"), "");
+}
+
+TEST(TestMatcher, TestUnsupportedSyntax) {
+    ASSERT_EQ(casbin::ParseMatcher("r.sub == p.sub &&"), nullptr);
+    ASSERT_EQ(casbin::ParseMatcher("r.sub == 'p.sub"), nullptr);
+    ASSERT_EQ(casbin::ParseMatcher("r.sub := p.sub"), nullptr);
+    ASSERT_EQ(casbin::ParseMatcher("(r.sub == p.sub"), nullptr);
+}
+
+} // namespace
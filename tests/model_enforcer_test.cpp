@@ -27,6 +27,13 @@ std::string global_obj;
 std::string global_act;
 std::string global_domain;
 
+// the evaluator of the library under test, casbin_lite has no exprtk
+#ifdef CASBIN_LITE
+using TestEvaluator = casbin::NativeEvaluator;
+#else
+using TestEvaluator = casbin::ExprtkEvaluator;
+#endif
+
 template <typename T>
 std::shared_ptr<casbin::IEvaluator> InitializeParams(const std::string& sub, const std::string& obj, const std::string& act) {
     auto evaluator = std::make_shared<T>();
@@ -113,21 +120,21 @@ TEST(TestModelEnforcer, TestBasicModel) {
 
     std::shared_ptr<casbin::IEvaluator> evaluator;
 
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("alice", "data1", "read");
+    evaluator = InitializeParams<TestEvaluator>("alice", "data1", "read");
     TestEnforce(e, evaluator, true);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("alice", "data1", "write");
+    evaluator = InitializeParams<TestEvaluator>("alice", "data1", "write");
     TestEnforce(e, evaluator, false);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("alice", "data2", "read");
+    evaluator = InitializeParams<TestEvaluator>("alice", "data2", "read");
     TestEnforce(e, evaluator, false);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("alice", "data2", "write");
+    evaluator = InitializeParams<TestEvaluator>("alice", "data2", "write");
     TestEnforce(e, evaluator, false);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("bob", "data1", "read");
+    evaluator = InitializeParams<TestEvaluator>("bob", "data1", "read");
     TestEnforce(e, evaluator, false);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("bob", "data1", "write");
+    evaluator = InitializeParams<TestEvaluator>("bob", "data1", "write");
     TestEnforce(e, evaluator, false);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("bob", "data2", "read");
+    evaluator = InitializeParams<TestEvaluator>("bob", "data2", "read");
     TestEnforce(e, evaluator, false);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("bob", "data2", "write");
+    evaluator = InitializeParams<TestEvaluator>("bob", "data2", "write");
     TestEnforce(e, evaluator, true);
 }
 
@@ -136,21 +143,21 @@ TEST(TestModelEnforcer, TestBasicModelWithoutSpaces) {
 
     std::shared_ptr<casbin::IEvaluator> evaluator;
 
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("alice", "data1", "read");
+    evaluator = InitializeParams<TestEvaluator>("alice", "data1", "read");
     TestEnforce(e, evaluator, true);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("alice", "data1", "write");
+    evaluator = InitializeParams<TestEvaluator>("alice", "data1", "write");
     TestEnforce(e, evaluator, false);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("alice", "data2", "read");
+    evaluator = InitializeParams<TestEvaluator>("alice", "data2", "read");
     TestEnforce(e, evaluator, false);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("alice", "data2", "write");
+    evaluator = InitializeParams<TestEvaluator>("alice", "data2", "write");
     TestEnforce(e, evaluator, false);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("bob", "data1", "read");
+    evaluator = InitializeParams<TestEvaluator>("bob", "data1", "read");
     TestEnforce(e, evaluator, false);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("bob", "data1", "write");
+    evaluator = InitializeParams<TestEvaluator>("bob", "data1", "write");
     TestEnforce(e, evaluator, false);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("bob", "data2", "read");
+    evaluator = InitializeParams<TestEvaluator>("bob", "data2", "read");
     TestEnforce(e, evaluator, false);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("bob", "data2", "write");
+    evaluator = InitializeParams<TestEvaluator>("bob", "data2", "write");
     TestEnforce(e, evaluator, true);
 }
 
@@ -159,21 +166,21 @@ TEST(TestModelEnforcer, TestBasicModelNoPolicy) {
 
     std::shared_ptr<casbin::IEvaluator> evaluator;
 
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("alice", "data1", "read");
+    evaluator = InitializeParams<TestEvaluator>("alice", "data1", "read");
     TestEnforce(e, evaluator, false);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("alice", "data1", "write");
+    evaluator = InitializeParams<TestEvaluator>("alice", "data1", "write");
     TestEnforce(e, evaluator, false);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("alice", "data2", "read");
+    evaluator = InitializeParams<TestEvaluator>("alice", "data2", "read");
     TestEnforce(e, evaluator, false);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("alice", "data2", "write");
+    evaluator = InitializeParams<TestEvaluator>("alice", "data2", "write");
     TestEnforce(e, evaluator, false);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("bob", "data1", "read");
+    evaluator = InitializeParams<TestEvaluator>("bob", "data1", "read");
     TestEnforce(e, evaluator, false);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("bob", "data1", "write");
+    evaluator = InitializeParams<TestEvaluator>("bob", "data1", "write");
     TestEnforce(e, evaluator, false);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("bob", "data2", "read");
+    evaluator = InitializeParams<TestEvaluator>("bob", "data2", "read");
     TestEnforce(e, evaluator, false);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("bob", "data2", "write");
+    evaluator = InitializeParams<TestEvaluator>("bob", "data2", "write");
     TestEnforce(e, evaluator, false);
 }
 
@@ -182,29 +189,29 @@ TEST(TestModelEnforcer, TestBasicModelWithRoot) {
 
     std::shared_ptr<casbin::IEvaluator> evaluator;
 
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("alice", "data1", "read");
+    evaluator = InitializeParams<TestEvaluator>("alice", "data1", "read");
     TestEnforce(e, evaluator, true);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("alice", "data1", "write");
+    evaluator = InitializeParams<TestEvaluator>("alice", "data1", "write");
     TestEnforce(e, evaluator, false);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("alice", "data2", "read");
+    evaluator = InitializeParams<TestEvaluator>("alice", "data2", "read");
     TestEnforce(e, evaluator, false);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("alice", "data2", "write");
+    evaluator = InitializeParams<TestEvaluator>("alice", "data2", "write");
     TestEnforce(e, evaluator, false);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("bob", "data1", "read");
+    evaluator = InitializeParams<TestEvaluator>("bob", "data1", "read");
     TestEnforce(e, evaluator, false);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("bob", "data1", "write");
+    evaluator = InitializeParams<TestEvaluator>("bob", "data1", "write");
     TestEnforce(e, evaluator, false);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("bob", "data2", "read");
+    evaluator = InitializeParams<TestEvaluator>("bob", "data2", "read");
     TestEnforce(e, evaluator, false);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("bob", "data2", "write");
+    evaluator = InitializeParams<TestEvaluator>("bob", "data2", "write");
     TestEnforce(e, evaluator, true);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("root", "data1", "read");
+    evaluator = InitializeParams<TestEvaluator>("root", "data1", "read");
     TestEnforce(e, evaluator, true);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("root", "data1", "write");
+    evaluator = InitializeParams<TestEvaluator>("root", "data1", "write");
     TestEnforce(e, evaluator, true);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("root", "data2", "read");
+    evaluator = InitializeParams<TestEvaluator>("root", "data2", "read");
     TestEnforce(e, evaluator, true);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("root", "data2", "write");
+    evaluator = InitializeParams<TestEvaluator>("root", "data2", "write");
     TestEnforce(e, evaluator, true);
 }
 
@@ -213,55 +220,55 @@ TEST(TestModelEnforcer, TestBasicModelWithRootNoPolicy) {
 
     std::shared_ptr<casbin::IEvaluator> evaluator;
 
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("alice", "data1", "read");
+    evaluator = InitializeParams<TestEvaluator>("alice", "data1", "read");
     TestEnforce(e, evaluator, false);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("alice", "data1", "write");
+    evaluator = InitializeParams<TestEvaluator>("alice", "data1", "write");
     TestEnforce(e, evaluator, false);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("alice", "data2", "read");
+    evaluator = InitializeParams<TestEvaluator>("alice", "data2", "read");
     TestEnforce(e, evaluator, false);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("alice", "data2", "write");
+    evaluator = InitializeParams<TestEvaluator>("alice", "data2", "write");
     TestEnforce(e, evaluator, false);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("bob", "data1", "read");
+    evaluator = InitializeParams<TestEvaluator>("bob", "data1", "read");
     TestEnforce(e, evaluator, false);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("bob", "data1", "write");
+    evaluator = InitializeParams<TestEvaluator>("bob", "data1", "write");
     TestEnforce(e, evaluator, false);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("bob", "data2", "read");
+    evaluator = InitializeParams<TestEvaluator>("bob", "data2", "read");
     TestEnforce(e, evaluator, false);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("bob", "data2", "write");
+    evaluator = InitializeParams<TestEvaluator>("bob", "data2", "write");
     TestEnforce(e, evaluator, false);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("root", "data1", "read");
+    evaluator = InitializeParams<TestEvaluator>("root", "data1", "read");
     TestEnforce(e, evaluator, true);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("root", "data1", "write");
+    evaluator = InitializeParams<TestEvaluator>("root", "data1", "write");
     TestEnforce(e, evaluator, true);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("root", "data2", "read");
+    evaluator = InitializeParams<TestEvaluator>("root", "data2", "read");
     TestEnforce(e, evaluator, true);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("root", "data2", "write");
+    evaluator = InitializeParams<TestEvaluator>("root", "data2", "write");
     TestEnforce(e, evaluator, true);
 }
 
 TEST(TestModelEnforcer, TestBasicModelWithoutUsers) {
     casbin::Enforcer e(basic_without_users_model_path, basic_without_users_policy_path);
 
-    auto evaluator = InitializeParamsWithoutUsers<casbin::ExprtkEvaluator>("data1", "read");
+    auto evaluator = InitializeParamsWithoutUsers<TestEvaluator>("data1", "read");
     TestEnforce(e, evaluator, true);
-    evaluator = InitializeParamsWithoutUsers<casbin::ExprtkEvaluator>("data1", "write");
+    evaluator = InitializeParamsWithoutUsers<TestEvaluator>("data1", "write");
     TestEnforce(e, evaluator, false);
-    evaluator = InitializeParamsWithoutUsers<casbin::ExprtkEvaluator>("data2", "read");
+    evaluator = InitializeParamsWithoutUsers<TestEvaluator>("data2", "read");
     TestEnforce(e, evaluator, false);
-    evaluator = InitializeParamsWithoutUsers<casbin::ExprtkEvaluator>("data2", "write");
+    evaluator = InitializeParamsWithoutUsers<TestEvaluator>("data2", "write");
     TestEnforce(e, evaluator, true);
 }
 
 TEST(TestModelEnforcer, TestBasicModelWithoutResources) {
     casbin::Enforcer e(basic_without_resources_model_path, basic_without_resources_policy_path);
 
-    auto evaluator = InitializeParamsWithoutResources<casbin::ExprtkEvaluator>("alice", "read");
+    auto evaluator = InitializeParamsWithoutResources<TestEvaluator>("alice", "read");
     TestEnforce(e, evaluator, true);
-    evaluator = InitializeParamsWithoutResources<casbin::ExprtkEvaluator>("alice", "write");
+    evaluator = InitializeParamsWithoutResources<TestEvaluator>("alice", "write");
     TestEnforce(e, evaluator, false);
-    evaluator = InitializeParamsWithoutResources<casbin::ExprtkEvaluator>("bob", "read");
+    evaluator = InitializeParamsWithoutResources<TestEvaluator>("bob", "read");
     TestEnforce(e, evaluator, false);
-    evaluator = InitializeParamsWithoutResources<casbin::ExprtkEvaluator>("bob", "write");
+    evaluator = InitializeParamsWithoutResources<TestEvaluator>("bob", "write");
     TestEnforce(e, evaluator, true);
 }
 
@@ -270,21 +277,21 @@ TEST(TestModelEnforcer, TestRBACModel) {
 
     std::shared_ptr<casbin::IEvaluator> evaluator;
 
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("alice", "data1", "read");
+    evaluator = InitializeParams<TestEvaluator>("alice", "data1", "read");
     TestEnforce(e, evaluator, true);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("alice", "data1", "write");
+    evaluator = InitializeParams<TestEvaluator>("alice", "data1", "write");
     TestEnforce(e, evaluator, false);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("alice", "data2", "read");
+    evaluator = InitializeParams<TestEvaluator>("alice", "data2", "read");
     TestEnforce(e, evaluator, true);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("alice", "data2", "write");
+    evaluator = InitializeParams<TestEvaluator>("alice", "data2", "write");
     TestEnforce(e, evaluator, true);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("bob", "data1", "read");
+    evaluator = InitializeParams<TestEvaluator>("bob", "data1", "read");
     TestEnforce(e, evaluator, false);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("bob", "data1", "write");
+    evaluator = InitializeParams<TestEvaluator>("bob", "data1", "write");
     TestEnforce(e, evaluator, false);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("bob", "data2", "read");
+    evaluator = InitializeParams<TestEvaluator>("bob", "data2", "read");
     TestEnforce(e, evaluator, false);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("bob", "data2", "write");
+    evaluator = InitializeParams<TestEvaluator>("bob", "data2", "write");
     TestEnforce(e, evaluator, true);
 }
 
@@ -293,42 +300,42 @@ TEST(TestModelEnforcer, TestRBACModelWithResourceRoles) {
 
     std::shared_ptr<casbin::IEvaluator> evaluator;
 
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("alice", "data1", "read");
+    evaluator = InitializeParams<TestEvaluator>("alice", "data1", "read");
     TestEnforce(e, evaluator, true);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("alice", "data1", "write");
+    evaluator = InitializeParams<TestEvaluator>("alice", "data1", "write");
     TestEnforce(e, evaluator, true);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("alice", "data2", "read");
+    evaluator = InitializeParams<TestEvaluator>("alice", "data2", "read");
     TestEnforce(e, evaluator, false);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("alice", "data2", "write");
+    evaluator = InitializeParams<TestEvaluator>("alice", "data2", "write");
     TestEnforce(e, evaluator, true);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("bob", "data1", "read");
+    evaluator = InitializeParams<TestEvaluator>("bob", "data1", "read");
     TestEnforce(e, evaluator, false);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("bob", "data1", "write");
+    evaluator = InitializeParams<TestEvaluator>("bob", "data1", "write");
     TestEnforce(e, evaluator, false);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("bob", "data2", "read");
+    evaluator = InitializeParams<TestEvaluator>("bob", "data2", "read");
     TestEnforce(e, evaluator, false);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("bob", "data2", "write");
+    evaluator = InitializeParams<TestEvaluator>("bob", "data2", "write");
     TestEnforce(e, evaluator, true);
 }
 
 TEST(TestModelEnforcer, TestRBACModelWithDomains) {
     casbin::Enforcer e(rbac_with_domains_model_path, rbac_with_domains_policy_path);
 
-    auto evaluator = InitializeParamsWithDomains<casbin::ExprtkEvaluator>("alice", "domain1", "data1", "read");
+    auto evaluator = InitializeParamsWithDomains<TestEvaluator>("alice", "domain1", "data1", "read");
     TestEnforce(e, evaluator, true);
-    evaluator = InitializeParamsWithDomains<casbin::ExprtkEvaluator>("alice", "domain1", "data1", "write");
+    evaluator = InitializeParamsWithDomains<TestEvaluator>("alice", "domain1", "data1", "write");
     TestEnforce(e, evaluator, true);
-    evaluator = InitializeParamsWithDomains<casbin::ExprtkEvaluator>("alice", "domain1", "data2", "read");
+    evaluator = InitializeParamsWithDomains<TestEvaluator>("alice", "domain1", "data2", "read");
     TestEnforce(e, evaluator, false);
-    evaluator = InitializeParamsWithDomains<casbin::ExprtkEvaluator>("alice", "domain1", "data2", "write");
+    evaluator = InitializeParamsWithDomains<TestEvaluator>("alice", "domain1", "data2", "write");
     TestEnforce(e, evaluator, false);
-    evaluator = InitializeParamsWithDomains<casbin::ExprtkEvaluator>("bob", "domain2", "data1", "read");
+    evaluator = InitializeParamsWithDomains<TestEvaluator>("bob", "domain2", "data1", "read");
     TestEnforce(e, evaluator, false);
-    evaluator = InitializeParamsWithDomains<casbin::ExprtkEvaluator>("bob", "domain2", "data1", "write");
+    evaluator = InitializeParamsWithDomains<TestEvaluator>("bob", "domain2", "data1", "write");
     TestEnforce(e, evaluator, false);
-    evaluator = InitializeParamsWithDomains<casbin::ExprtkEvaluator>("bob", "domain2", "data2", "read");
+    evaluator = InitializeParamsWithDomains<TestEvaluator>("bob", "domain2", "data2", "read");
     TestEnforce(e, evaluator, true);
-    evaluator = InitializeParamsWithDomains<casbin::ExprtkEvaluator>("bob", "domain2", "data2", "write");
+    evaluator = InitializeParamsWithDomains<TestEvaluator>("bob", "domain2", "data2", "write");
     TestEnforce(e, evaluator, true);
 }
 
@@ -349,63 +356,63 @@ TEST(TestModelEnforcer, TestRBACModelWithDomainsAtRuntime) {
     params = std::vector<std::string>{"bob", "admin", "domain2"};
     e.AddGroupingPolicy(params);
 
-    auto evaluator = InitializeParamsWithDomains<casbin::ExprtkEvaluator>("alice", "domain1", "data1", "read");
+    auto evaluator = InitializeParamsWithDomains<TestEvaluator>("alice", "domain1", "data1", "read");
     TestEnforce(e, evaluator, true);
-    evaluator = InitializeParamsWithDomains<casbin::ExprtkEvaluator>("alice", "domain1", "data1", "write");
+    evaluator = InitializeParamsWithDomains<TestEvaluator>("alice", "domain1", "data1", "write");
     TestEnforce(e, evaluator, true);
-    evaluator = InitializeParamsWithDomains<casbin::ExprtkEvaluator>("alice", "domain1", "data2", "read");
+    evaluator = InitializeParamsWithDomains<TestEvaluator>("alice", "domain1", "data2", "read");
     TestEnforce(e, evaluator, false);
-    evaluator = InitializeParamsWithDomains<casbin::ExprtkEvaluator>("alice", "domain1", "data2", "write");
+    evaluator = InitializeParamsWithDomains<TestEvaluator>("alice", "domain1", "data2", "write");
     TestEnforce(e, evaluator, false);
-    evaluator = InitializeParamsWithDomains<casbin::ExprtkEvaluator>("bob", "domain2", "data1", "read");
+    evaluator = InitializeParamsWithDomains<TestEvaluator>("bob", "domain2", "data1", "read");
     TestEnforce(e, evaluator, false);
-    evaluator = InitializeParamsWithDomains<casbin::ExprtkEvaluator>("bob", "domain2", "data1", "write");
+    evaluator = InitializeParamsWithDomains<TestEvaluator>("bob", "domain2", "data1", "write");
     TestEnforce(e, evaluator, false);
-    evaluator = InitializeParamsWithDomains<casbin::ExprtkEvaluator>("bob", "domain2", "data2", "read");
+    evaluator = InitializeParamsWithDomains<TestEvaluator>("bob", "domain2", "data2", "read");
     TestEnforce(e, evaluator, true);
-    evaluator = InitializeParamsWithDomains<casbin::ExprtkEvaluator>("bob", "domain2", "data2", "write");
+    evaluator = InitializeParamsWithDomains<TestEvaluator>("bob", "domain2", "data2", "write");
     TestEnforce(e, evaluator, true);
 
     // Remove all policy rules related to domain1 and data1.
     params = std::vector<std::string>{"domain1", "data1"};
     e.RemoveFilteredPolicy(1, params);
 
-    evaluator = InitializeParamsWithDomains<casbin::ExprtkEvaluator>("alice", "domain1", "data1", "read");
+    evaluator = InitializeParamsWithDomains<TestEvaluator>("alice", "domain1", "data1", "read");
     TestEnforce(e, evaluator, false);
-    evaluator = InitializeParamsWithDomains<casbin::ExprtkEvaluator>("alice", "domain1", "data1", "write");
+    evaluator = InitializeParamsWithDomains<TestEvaluator>("alice", "domain1", "data1", "write");
     TestEnforce(e, evaluator, false);
-    evaluator = InitializeParamsWithDomains<casbin::ExprtkEvaluator>("alice", "domain1", "data2", "read");
+    evaluator = InitializeParamsWithDomains<TestEvaluator>("alice", "domain1", "data2", "read");
     TestEnforce(e, evaluator, false);
-    evaluator = InitializeParamsWithDomains<casbin::ExprtkEvaluator>("alice", "domain1", "data2", "read");
+    evaluator = InitializeParamsWithDomains<TestEvaluator>("alice", "domain1", "data2", "read");
     TestEnforce(e, evaluator, false);
-    evaluator = InitializeParamsWithDomains<casbin::ExprtkEvaluator>("bob", "domain2", "data1", "read");
+    evaluator = InitializeParamsWithDomains<TestEvaluator>("bob", "domain2", "data1", "read");
     TestEnforce(e, evaluator, false);
-    evaluator = InitializeParamsWithDomains<casbin::ExprtkEvaluator>("bob", "domain2", "data1", "write");
+    evaluator = InitializeParamsWithDomains<TestEvaluator>("bob", "domain2", "data1", "write");
     TestEnforce(e, evaluator, false);
-    evaluator = InitializeParamsWithDomains<casbin::ExprtkEvaluator>("bob", "domain2", "data2", "read");
+    evaluator = InitializeParamsWithDomains<TestEvaluator>("bob", "domain2", "data2", "read");
     TestEnforce(e, evaluator, true);
-    evaluator = InitializeParamsWithDomains<casbin::ExprtkEvaluator>("bob", "domain2", "data2", "write");
+    evaluator = InitializeParamsWithDomains<TestEvaluator>("bob", "domain2", "data2", "write");
     TestEnforce(e, evaluator, true);
 
     // Remove the specified policy rule.
     params = std::vector<std::string>{"admin", "domain2", "data2", "read"};
     e.RemovePolicy(params);
 
-    evaluator = InitializeParamsWithDomains<casbin::ExprtkEvaluator>("alice", "domain1", "data1", "read");
+    evaluator = InitializeParamsWithDomains<TestEvaluator>("alice", "domain1", "data1", "read");
     TestEnforce(e, evaluator, false);
-    evaluator = InitializeParamsWithDomains<casbin::ExprtkEvaluator>("alice", "domain1", "data1", "write");
+    evaluator = InitializeParamsWithDomains<TestEvaluator>("alice", "domain1", "data1", "write");
     TestEnforce(e, evaluator, false);
-    evaluator = InitializeParamsWithDomains<casbin::ExprtkEvaluator>("alice", "domain1", "data2", "read");
+    evaluator = InitializeParamsWithDomains<TestEvaluator>("alice", "domain1", "data2", "read");
     TestEnforce(e, evaluator, false);
-    evaluator = InitializeParamsWithDomains<casbin::ExprtkEvaluator>("alice", "domain1", "data2", "write");
+    evaluator = InitializeParamsWithDomains<TestEvaluator>("alice", "domain1", "data2", "write");
     TestEnforce(e, evaluator, false);
-    evaluator = InitializeParamsWithDomains<casbin::ExprtkEvaluator>("bob", "domain2", "data1", "read");
+    evaluator = InitializeParamsWithDomains<TestEvaluator>("bob", "domain2", "data1", "read");
     TestEnforce(e, evaluator, false);
-    evaluator = InitializeParamsWithDomains<casbin::ExprtkEvaluator>("bob", "domain2", "data1", "write");
+    evaluator = InitializeParamsWithDomains<TestEvaluator>("bob", "domain2", "data1", "write");
     TestEnforce(e, evaluator, false);
-    evaluator = InitializeParamsWithDomains<casbin::ExprtkEvaluator>("bob", "domain2", "data2", "read");
+    evaluator = InitializeParamsWithDomains<TestEvaluator>("bob", "domain2", "data2", "read");
     TestEnforce(e, evaluator, false);
-    evaluator = InitializeParamsWithDomains<casbin::ExprtkEvaluator>("bob", "domain2", "data2", "write");
+    evaluator = InitializeParamsWithDomains<TestEvaluator>("bob", "domain2", "data2", "write");
     TestEnforce(e, evaluator, true);
 }
 
@@ -418,24 +425,24 @@ TEST(TestModelEnforcer, TestRBACModelWithDomainsAtRuntimeMockAdapter) {
     params = std::vector<std::string>{"alice", "admin", "domain3"};
     e.AddGroupingPolicy(params);
 
-    auto evaluator = InitializeParamsWithDomains<casbin::ExprtkEvaluator>("alice", "domain3", "data1", "read");
+    auto evaluator = InitializeParamsWithDomains<TestEvaluator>("alice", "domain3", "data1", "read");
     TestEnforce(e, evaluator, true);
 
-    evaluator = InitializeParamsWithDomains<casbin::ExprtkEvaluator>("alice", "domain1", "data1", "read");
+    evaluator = InitializeParamsWithDomains<TestEvaluator>("alice", "domain1", "data1", "read");
     TestEnforce(e, evaluator, true);
 
     params = std::vector<std::string>{"domain1", "data1"};
     e.RemoveFilteredPolicy(1, params);
 
-    evaluator = InitializeParamsWithDomains<casbin::ExprtkEvaluator>("alice", "domain1", "data1", "read");
+    evaluator = InitializeParamsWithDomains<TestEvaluator>("alice", "domain1", "data1", "read");
     TestEnforce(e, evaluator, false);
 
-    evaluator = InitializeParamsWithDomains<casbin::ExprtkEvaluator>("bob", "domain2", "data2", "read");
+    evaluator = InitializeParamsWithDomains<TestEvaluator>("bob", "domain2", "data2", "read");
     TestEnforce(e, evaluator, true);
     params = std::vector<std::string>{"admin", "domain2", "data2", "read"};
     e.RemovePolicy(params);
 
-    evaluator = InitializeParamsWithDomains<casbin::ExprtkEvaluator>("bob", "domain2", "data2", "read");
+    evaluator = InitializeParamsWithDomains<TestEvaluator>("bob", "domain2", "data2", "read");
     TestEnforce(e, evaluator, false);
 }
 
@@ -444,28 +451,28 @@ TEST(TestModelEnforcer, TestRBACModelWithDeny) {
 
     std::shared_ptr<casbin::IEvaluator> evaluator;
 
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("alice", "data1", "read");
+    evaluator = InitializeParams<TestEvaluator>("alice", "data1", "read");
     TestEnforce(e, evaluator, true);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("alice", "data1", "write");
+    evaluator = InitializeParams<TestEvaluator>("alice", "data1", "write");
     TestEnforce(e, evaluator, false);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("alice", "data2", "read");
+    evaluator = InitializeParams<TestEvaluator>("alice", "data2", "read");
     TestEnforce(e, evaluator, true);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("alice", "data2", "write");
+    evaluator = InitializeParams<TestEvaluator>("alice", "data2", "write");
     TestEnforce(e, evaluator, false);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("bob", "data1", "read");
+    evaluator = InitializeParams<TestEvaluator>("bob", "data1", "read");
     TestEnforce(e, evaluator, false);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("bob", "data1", "write");
+    evaluator = InitializeParams<TestEvaluator>("bob", "data1", "write");
     TestEnforce(e, evaluator, false);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("bob", "data2", "read");
+    evaluator = InitializeParams<TestEvaluator>("bob", "data2", "read");
     TestEnforce(e, evaluator, false);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("bob", "data2", "write");
+    evaluator = InitializeParams<TestEvaluator>("bob", "data2", "write");
     TestEnforce(e, evaluator, true);
 }
 
 TEST(TestModelEnforcer, TestRBACModelWithOnlyDeny) {
     casbin::Enforcer e(rbac_with_not_deny_model_path, rbac_with_deny_policy_path);
 
-    auto evaluator = InitializeParams<casbin::ExprtkEvaluator>("alice", "data2", "write");
+    auto evaluator = InitializeParams<TestEvaluator>("alice", "data2", "write");
     TestEnforce(e, evaluator, false);
 }
 
@@ -478,21 +485,21 @@ TEST(TestModelEnforcer, TestRBACModelWithCustomData) {
     std::vector<std::string> params{"bob", "data2_admin", "custom_data"};
     e.AddGroupingPolicy(params);
 
-    auto evaluator = InitializeParams<casbin::ExprtkEvaluator>("alice", "data1", "read");
+    auto evaluator = InitializeParams<TestEvaluator>("alice", "data1", "read");
     TestEnforce(e, evaluator, true);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("alice", "data1", "write");
+    evaluator = InitializeParams<TestEvaluator>("alice", "data1", "write");
     TestEnforce(e, evaluator, false);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("alice", "data2", "read");
+    evaluator = InitializeParams<TestEvaluator>("alice", "data2", "read");
     TestEnforce(e, evaluator, true);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("alice", "data2", "write");
+    evaluator = InitializeParams<TestEvaluator>("alice", "data2", "write");
     TestEnforce(e, evaluator, true);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("bob", "data1", "read");
+    evaluator = InitializeParams<TestEvaluator>("bob", "data1", "read");
     TestEnforce(e, evaluator, false);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("bob", "data1", "write");
+    evaluator = InitializeParams<TestEvaluator>("bob", "data1", "write");
     TestEnforce(e, evaluator, false);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("bob", "data2", "read");
+    evaluator = InitializeParams<TestEvaluator>("bob", "data2", "read");
     TestEnforce(e, evaluator, true);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("bob", "data2", "write");
+    evaluator = InitializeParams<TestEvaluator>("bob", "data2", "write");
     TestEnforce(e, evaluator, true);
 
     // You should also take the custom data as a parameter when deleting a grouping policy.
@@ -501,21 +508,21 @@ TEST(TestModelEnforcer, TestRBACModelWithCustomData) {
     params = std::vector<std::string>{"bob", "data2_admin", "custom_data"};
     e.RemoveGroupingPolicy(params);
 
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("alice", "data1", "read");
+    evaluator = InitializeParams<TestEvaluator>("alice", "data1", "read");
     TestEnforce(e, evaluator, true);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("alice", "data1", "write");
+    evaluator = InitializeParams<TestEvaluator>("alice", "data1", "write");
     TestEnforce(e, evaluator, false);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("alice", "data2", "read");
+    evaluator = InitializeParams<TestEvaluator>("alice", "data2", "read");
     TestEnforce(e, evaluator, true);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("alice", "data2", "write");
+    evaluator = InitializeParams<TestEvaluator>("alice", "data2", "write");
     TestEnforce(e, evaluator, true);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("bob", "data1", "read");
+    evaluator = InitializeParams<TestEvaluator>("bob", "data1", "read");
     TestEnforce(e, evaluator, false);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("bob", "data1", "write");
+    evaluator = InitializeParams<TestEvaluator>("bob", "data1", "write");
     TestEnforce(e, evaluator, false);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("bob", "data2", "read");
+    evaluator = InitializeParams<TestEvaluator>("bob", "data2", "read");
     TestEnforce(e, evaluator, false);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("bob", "data2", "write");
+    evaluator = InitializeParams<TestEvaluator>("bob", "data2", "write");
     TestEnforce(e, evaluator, true);
 }
 
@@ -529,41 +536,41 @@ TEST(TestModelEnforcer, TestRBACModelWithPattern) {
     // You can see it as normal RBAC: "/book/:id" == "/book/1" becomes KeyMatch2("/book/:id", "/book/1")
     e.AddNamedMatchingFunc("p", "", casbin::KeyMatch2);
 
-    auto evaluator = InitializeParams<casbin::ExprtkEvaluator>("alice", "/book/1", "GET");
+    auto evaluator = InitializeParams<TestEvaluator>("alice", "/book/1", "GET");
     TestEnforce(e, evaluator, true);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("alice", "/book/2", "GET");
+    evaluator = InitializeParams<TestEvaluator>("alice", "/book/2", "GET");
     TestEnforce(e, evaluator, true);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("alice", "/pen/1", "GET");
+    evaluator = InitializeParams<TestEvaluator>("alice", "/pen/1", "GET");
     TestEnforce(e, evaluator, true);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("alice", "/pen/2", "GET");
+    evaluator = InitializeParams<TestEvaluator>("alice", "/pen/2", "GET");
     TestEnforce(e, evaluator, false);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("bob", "/book/1", "GET");
+    evaluator = InitializeParams<TestEvaluator>("bob", "/book/1", "GET");
     TestEnforce(e, evaluator, false);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("bob", "/book/2", "GET");
+    evaluator = InitializeParams<TestEvaluator>("bob", "/book/2", "GET");
     TestEnforce(e, evaluator, false);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("bob", "/pen/1", "GET");
+    evaluator = InitializeParams<TestEvaluator>("bob", "/pen/1", "GET");
     TestEnforce(e, evaluator, true);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("bob", "/pen/2", "GET");
+    evaluator = InitializeParams<TestEvaluator>("bob", "/pen/2", "GET");
     TestEnforce(e, evaluator, true);
 
     // AddMatchingFunc() is actually setting a function because only one function is allowed,
     // so when we set "KeyMatch3", we are actually replacing "KeyMatch2" with "KeyMatch3".
     e.AddNamedMatchingFunc("p", "", casbin::KeyMatch3);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("alice", "/book2/1", "GET");
+    evaluator = InitializeParams<TestEvaluator>("alice", "/book2/1", "GET");
     TestEnforce(e, evaluator, true);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("alice", "/book2/2", "GET");
+    evaluator = InitializeParams<TestEvaluator>("alice", "/book2/2", "GET");
     TestEnforce(e, evaluator, true);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("alice", "/pen2/1", "GET");
+    evaluator = InitializeParams<TestEvaluator>("alice", "/pen2/1", "GET");
     TestEnforce(e, evaluator, true);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("alice", "/pen2/2", "GET");
+    evaluator = InitializeParams<TestEvaluator>("alice", "/pen2/2", "GET");
     TestEnforce(e, evaluator, false);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("bob", "/book2/1", "GET");
+    evaluator = InitializeParams<TestEvaluator>("bob", "/book2/1", "GET");
     TestEnforce(e, evaluator, false);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("bob", "/book2/2", "GET");
+    evaluator = InitializeParams<TestEvaluator>("bob", "/book2/2", "GET");
     TestEnforce(e, evaluator, false);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("bob", "/pen2/1", "GET");
+    evaluator = InitializeParams<TestEvaluator>("bob", "/pen2/1", "GET");
     TestEnforce(e, evaluator, true);
-    evaluator = InitializeParams<casbin::ExprtkEvaluator>("bob", "/pen2/2", "GET");
+    evaluator = InitializeParams<TestEvaluator>("bob", "/pen2/2", "GET");
     TestEnforce(e, evaluator, true);
 }
 
@@ -94,4 +94,74 @@ TEST(TestModel, TestModel_AddDef) {
     ASSERT_FALSE(ok);
 }
 
+TEST(TestModel, TestMemoryResource) {
+    casbin::AccountingResource resource;
+    {
+        auto model = std::make_shared<casbin::Model>(&resource);
+        model->LoadModel(rbac_model_path);
+        casbin::Enforcer e(model, std::make_shared<casbin::FileAdapter>(rbac_policy_path));
+        ASSERT_EQ(model->GetMemoryResource(), &resource);
+        ASSERT_EQ(model->m["p"].assertion_map["p"]->policy.get_memory_resource(), &resource);
+        ASSERT_TRUE(e.Enforce({"alice", "data2", "read"}));
+        ASSERT_GT(resource.GetBytes(), 0);
+
+        // the loaded rules stay in a vector on the resource
+        ASSERT_FALSE(model->m["p"].assertion_map["p"]->policy.is_mapped());
+        ASSERT_FALSE(model->m["g"].assertion_map["g"]->policy.is_mapped());
+
+        casbin::MemoryUsage usage = model->GetMemoryUsage();
+        ASSERT_GT(usage.assertions["p"], 0);
+        ASSERT_GT(usage.assertions["g"], 0);
+        ASSERT_GT(usage.role_graph, 0);
+        ASSERT_EQ(usage.Total(), usage.assertions["p"] + usage.assertions["g"] + usage.role_graph);
+
+        // a reload gives the memory of the previous policy back
+        size_t loaded = resource.GetBytes();
+        e.LoadPolicy();
+        e.LoadPolicy();
+        ASSERT_LE(resource.GetBytes(), loaded);
+
+        // interning moves the rules into the resource, strings included
+        model->InternPolicy();
+        ASSERT_TRUE(model->m["p"].assertion_map["p"]->policy.is_mapped());
+        ASSERT_TRUE(model->m["g"].assertion_map["g"]->policy.is_mapped());
+        ASSERT_TRUE(e.Enforce({"alice", "data2", "read"}));
+
+        // a change copies the rules into a vector on the resource
+        ASSERT_TRUE(e.AddPolicy({"carol", "data1", "read"}));
+        ASSERT_FALSE(model->m["p"].assertion_map["p"]->policy.is_mapped());
+        ASSERT_EQ(model->m["p"].assertion_map["p"]->policy.get_memory_resource(), &resource);
+        ASSERT_TRUE(e.Enforce({"carol", "data1", "read"}));
+        ASSERT_TRUE(e.Enforce({"alice", "data2", "read"}));
+
+        e.ClearPolicy();
+        ASSERT_LT(model->GetMemoryUsage().assertions["p"], usage.assertions["p"]);
+    }
+    ASSERT_EQ(resource.GetBytes(), 0);
+}
+
+TEST(TestModel, TestHugePageResource) {
+    casbin::HugePageResource resource;
+    auto model = std::make_shared<casbin::Model>(&resource);
+    model->LoadModel(rbac_model_path);
+    casbin::Enforcer e(model, std::make_shared<casbin::FileAdapter>(rbac_policy_path));
+    ASSERT_TRUE(e.Enforce({"alice", "data2", "read"}));
+    ASSERT_FALSE(e.Enforce({"bob", "data2", "read"}));
+    ASSERT_GT(resource.GetMappedBytes(), 0);
+    ASSERT_LE(resource.GetHugePageBytes(), resource.GetMappedBytes());
+
+    // large blocks get mappings of their own and give them back
+    size_t mapped = resource.GetMappedBytes();
+    void* block = resource.allocate(size_t(1) << 20);
+    ASSERT_GT(resource.GetMappedBytes(), mapped);
+    resource.deallocate(block, size_t(1) << 20);
+    ASSERT_EQ(resource.GetMappedBytes(), mapped);
+
+    // so do large blocks aligned on more than a page, from the heap
+    block = resource.allocate(size_t(1) << 17, size_t(1) << 14);
+    ASSERT_EQ(reinterpret_cast<uintptr_t>(block) % (size_t(1) << 14), 0);
+    ASSERT_EQ(resource.GetMappedBytes(), mapped);
+    resource.deallocate(block, size_t(1) << 17, size_t(1) << 14);
+}
+
 } // namespace
@@ -0,0 +1,150 @@
+/*
+ * Copyright 2021 The casbin Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This is a test file for testing the native evaluator
+ */
+
+#include <casbin/casbin.h>
+#include <gtest/gtest.h>
+
+#include "config_path.h"
+
+namespace {
+
+bool Evaluate(casbin::NativeEvaluator& evaluator, const std::string& expression) {
+    EXPECT_TRUE(evaluator.Eval(expression)) << expression;
+    EXPECT_EQ(evaluator.CheckType(), casbin::Type::Bool) << expression;
+    return evaluator.GetBoolean();
+}
+
+TEST(TestNativeEvaluator, TestOperators) {
+    casbin::NativeEvaluator evaluator;
+    evaluator.PushObjectString("r", "sub", "alice");
+    evaluator.PushObjectString("r", "obj", "data2");
+    evaluator.PushObjectString("p", "sub", "alice");
+
+    ASSERT_TRUE(Evaluate(evaluator, "r.sub == p.sub"));
+    ASSERT_FALSE(Evaluate(evaluator, "r.sub != p.sub"));
+    ASSERT_TRUE(Evaluate(evaluator, "r.sub == p.sub && r.obj == 'data2'"));
+    ASSERT_TRUE(Evaluate(evaluator, "r.sub == 'bob' || r.obj == \"data2\""));
+    ASSERT_TRUE(Evaluate(evaluator, "!(r.sub == 'bob') and not false"));
+    ASSERT_TRUE(Evaluate(evaluator, "r.sub + '/' + r.obj == 'alice/data2'"));
+    ASSERT_TRUE(Evaluate(evaluator, "r.obj in ('data1', 'data2')"));
+    ASSERT_FALSE(Evaluate(evaluator, "r.obj in ('data1', 'data3')"));
+    ASSERT_TRUE(Evaluate(evaluator, "'alice' < 'bob' && 2 * 3 % 4 == 2 && 1 + 1 >= 2"));
+
+    ASSERT_TRUE(evaluator.Eval("1.5 + 1"));
+    ASSERT_EQ(evaluator.CheckType(), casbin::Type::Float);
+    ASSERT_EQ(evaluator.GetFloat(), 2.5);
+
+    // the compiled expression reads the values pushed after it
+    ASSERT_TRUE(evaluator.Eval("r.sub == p.sub"));
+    evaluator.PushObjectString("p", "sub", "bob");
+    ASSERT_FALSE(evaluator.GetBoolean());
+    *evaluator.GetObjectSlot("r", "sub") = "bob";
+    ASSERT_TRUE(evaluator.GetBoolean());
+    ASSERT_EQ(evaluator.requestValues().at("sub"), "bob");
+}
+
+TEST(TestNativeEvaluator, TestInOperator) {
+    casbin::NativeEvaluator evaluator;
+    evaluator.PushObjectString("r", "obj", "data9");
+    evaluator.PushObjectString("p", "obj", "data9");
+
+    // up to LiteralSet::kMaxSortedSize literals are bisected, more are hashed
+    ASSERT_TRUE(Evaluate(evaluator, "r.obj in ('data1', 'data9', 'data1')"));
+    ASSERT_FALSE(Evaluate(evaluator, "r.obj in ('data1', 'data2')"));
+    ASSERT_TRUE(Evaluate(evaluator, "r.obj in ('data0', 'data1', 'data2', 'data3', 'data4', 'data5', 'data6', 'data7', 'data8', 'data9')"));
+    ASSERT_FALSE(Evaluate(evaluator, "r.obj in ('data0', 'data1', 'data2', 'data3', 'data4', 'data5', 'data6', 'data7', 'data8')"));
+    ASSERT_FALSE(Evaluate(evaluator, "r.obj in ()"));
+    ASSERT_TRUE(Evaluate(evaluator, "r.obj in ('data1', p.obj)"));
+
+    casbin::LiteralSet sorted({"b", "a", "b", "c"});
+    ASSERT_EQ(sorted.Size(), 3);
+    ASSERT_TRUE(sorted.Contains("a") && sorted.Contains("c") && !sorted.Contains("d"));
+    std::vector<std::string> values;
+    for (int i = 0; i < 20; i++)
+        values.push_back("v" + std::to_string(i));
+    casbin::LiteralSet hashed(values);
+    ASSERT_EQ(hashed.Size(), 20);
+    ASSERT_TRUE(hashed.Contains("v19") && !hashed.Contains("v20"));
+}
+
+TEST(TestNativeEvaluator, TestFunctions) {
+    casbin::NativeEvaluator evaluator;
+    evaluator.LoadFunctions();
+    auto rm = std::make_shared<casbin::DefaultRoleManager>(10);
+    rm->AddLink("alice", "admin");
+    evaluator.LoadGFunction(rm, "g", 2);
+    evaluator.PushObjectString("r", "sub", "alice");
+    evaluator.PushObjectString("r", "obj", "/alice_data/resource1");
+
+    ASSERT_TRUE(Evaluate(evaluator, "g(r.sub, 'admin') && keyMatch(r.obj, '/alice_data/*')"));
+    ASSERT_FALSE(Evaluate(evaluator, "g('bob', 'admin') || regexMatch(r.obj, '^/bob')"));
+    ASSERT_TRUE(Evaluate(evaluator, "keyMatch2(r.obj, '/:owner/resource1') && ipMatch('192.168.2.1', '192.168.2.0/24')"));
+
+    ASSERT_TRUE(evaluator.Eval("keyGet2(r.obj, '/:owner/:id', 'id')"));
+    ASSERT_EQ(evaluator.GetString(), "resource1");
+
+    // a compiled expression follows the role manager bound to the function
+    ASSERT_TRUE(evaluator.Eval("g(r.sub, 'admin')"));
+    evaluator.LoadGFunction(std::make_shared<casbin::DefaultRoleManager>(10), "g", 2);
+    ASSERT_FALSE(evaluator.GetBoolean());
+}
+
+TEST(TestNativeEvaluator, TestInvalidExpressions) {
+    casbin::NativeEvaluator evaluator;
+    evaluator.LoadFunctions();
+    evaluator.PushObjectString("r", "sub", "alice");
+
+    for (const std::string expression : {"r.sub == r.unknown", "unknown(r.sub)", "keyMatch(r.sub)", "r.sub == 1", "r.sub && 1", "r.sub ==", "r.sub[0]"}) {
+        ASSERT_FALSE(evaluator.Eval(expression)) << expression;
+        ASSERT_THROW(evaluator.CheckType(), casbin::CasbinEnforcerException) << expression;
+    }
+}
+
+TEST(TestNativeEvaluator, TestEnforcerDecisions) {
+    std::vector<std::tuple<std::string, std::string, std::vector<std::vector<std::string>>>> cases = {
+        {basic_model_path, basic_policy_path, {{"alice", "data1", "read"}, {"alice", "data2", "read"}, {"bob", "data2", "write"}}},
+        {basic_with_root_model_path, basic_policy_path, {{"root", "data1", "read"}, {"bob", "data1", "read"}}},
+        {rbac_model_path, rbac_policy_path, {{"alice", "data2", "read"}, {"bob", "data2", "read"}, {"bob", "data2", "write"}}},
+        {rbac_matcher_using_in_op_model_path, rbac_policy_path, {{"alice", "data1", "read"}, {"bob", "data1", "read"}, {"bob", "data3", "write"}}},
+        {rbac_with_deny_model_path, rbac_with_deny_policy_path, {{"alice", "data2", "write"}, {"alice", "data2", "read"}}},
+        {rbac_with_domains_model_path, rbac_with_domains_policy_path, {{"alice", "domain1", "data1", "read"}, {"alice", "domain2", "data2", "read"}}},
+        {keymatch_model_path, keymatch_policy_path, {{"alice", "/alice_data/resource1", "GET"}, {"bob", "/alice_data/resource1", "GET"}, {"cathy", "/cathy_data", "POST"}}},
+        {priority_model_path, priority_policy_path, {{"alice", "data1", "read"}, {"bob", "data2", "write"}}},
+        {abac_rule_model_path, abac_rule_policy_path, {{"alice", "/data1", "read"}}},
+    };
+
+    for (const auto& [model_path, policy_path, requests] : cases) {
+        casbin::Enforcer expected(model_path, policy_path);
+        casbin::Enforcer e(model_path, policy_path);
+        e.SetEvaluator(std::make_shared<casbin::NativeEvaluator>());
+        for (const auto& request : requests) {
+            casbin::DataVector params(request.begin(), request.end());
+            bool allowed = false;
+            try {
+                allowed = expected.Enforce(params);
+            } catch (...) {
+                // exprtk throws the error of a matcher it does not compile, e.g. for r.sub.Age
+                ASSERT_ANY_THROW(e.Enforce(params)) << model_path;
+                continue;
+            }
+            ASSERT_EQ(e.Enforce(params), allowed) << model_path;
+        }
+    }
+}
+
+} // namespace
@@ -192,4 +192,25 @@ TEST(TestRoleManager, TestClear) {
     TestRole(rm, "u4", "g3", false);
 }
 
+TEST(TestRoleManager, TestMemoryResource) {
+    casbin::AccountingResource resource;
+    {
+        casbin::DefaultRoleManager rm(3, &resource);
+        rm.AddLink("u1", "g1");
+        rm.AddLink("u2", "g1");
+        rm.AddLink("g1", "g2");
+
+        TestRole(rm, "u1", "g2", true);
+        TestRole(rm, "u2", "g2", true);
+        ASSERT_GT(resource.GetBytes(), 0);
+        size_t usage = rm.GetMemoryUsage();
+        ASSERT_GT(usage, 0);
+
+        rm.Clear();
+        TestRole(rm, "u1", "g1", false);
+        ASSERT_LT(rm.GetMemoryUsage(), usage);
+    }
+    ASSERT_EQ(resource.GetBytes(), 0);
+}
+
 } // namespace
@@ -0,0 +1,175 @@
+/*
+ * Copyright 2021 The casbin Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This is a test file for testing the shared memory policy store
+ */
+
+#ifndef _WIN32
+
+#include <casbin/casbin.h>
+#include <fcntl.h>
+#include <gtest/gtest.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <thread>
+
+#include "config_path.h"
+
+namespace {
+
+std::string StoreName(const std::string& test) {
+    return "/casbin_test_" + test + "_" + std::to_string(getpid());
+}
+
+TEST(TestSharedMemoryAdapter, TestPublishAndLoad) {
+    std::string name = StoreName("load");
+    casbin::Enforcer loader(rbac_model_path, rbac_policy_path);
+    ASSERT_EQ(casbin::SharedMemoryAdapter::Publish(name, loader.GetModel()), 1);
+
+    auto adapter = casbin::SharedMemoryAdapter::NewSharedMemoryAdapter(name);
+    casbin::Enforcer e(rbac_model_path, adapter);
+    ASSERT_EQ(adapter->GetLoadedGeneration(), 1);
+    ASSERT_FALSE(adapter->IsUpdated());
+
+    ASSERT_TRUE(e.Enforce({"alice", "data1", "read"}));
+    ASSERT_TRUE(e.Enforce({"alice", "data2", "write"}));
+    ASSERT_TRUE(e.Enforce({"bob", "data2", "write"}));
+    ASSERT_FALSE(e.Enforce({"bob", "data1", "read"}));
+    ASSERT_EQ(e.GetPolicy().size(), loader.GetPolicy().size());
+    ASSERT_EQ(e.GetGroupingPolicy().size(), loader.GetGroupingPolicy().size());
+
+    // The rules are read from the mapping
+    ASSERT_TRUE(e.GetModel()->m["p"].assertion_map["p"]->policy.is_mapped());
+    ASSERT_TRUE(e.HasPolicy({"alice", "data1", "read"}));
+
+    // Local changes stay local, the snapshot is read-only
+    ASSERT_TRUE(e.AddPolicy({"bob", "data1", "read"}));
+    ASSERT_FALSE(e.GetModel()->m["p"].assertion_map["p"]->policy.is_mapped());
+    ASSERT_EQ(e.GetPolicy().size(), loader.GetPolicy().size() + 1);
+    ASSERT_TRUE(e.Enforce({"bob", "data1", "read"}));
+    ASSERT_FALSE(adapter->IsUpdated());
+    ASSERT_THROW(adapter->AddPolicy("p", "p", {"bob", "data1", "read"}), casbin::UnsupportedOperationException);
+
+    casbin::SharedMemoryAdapter::Unlink(name);
+    ASSERT_EQ(adapter->GetGeneration(), 0);
+}
+
+TEST(TestSharedMemoryAdapter, TestSwapFromAnotherProcess) {
+    std::string name = StoreName("swap");
+    casbin::Enforcer loader(rbac_model_path, rbac_policy_path);
+    casbin::SharedMemoryAdapter::Publish(name, loader.GetModel());
+
+    auto adapter = casbin::SharedMemoryAdapter::NewSharedMemoryAdapter(name);
+    casbin::Enforcer e(rbac_model_path, adapter);
+    ASSERT_FALSE(e.Enforce({"bob", "data1", "read"}));
+
+    pid_t pid = fork();
+    ASSERT_GE(pid, 0);
+    if (pid == 0) {
+        loader.EnableAutoSave(false);
+        loader.AddPolicy({"bob", "data1", "read"});
+        casbin::SharedMemoryAdapter::Publish(name, loader.GetModel());
+        _exit(0);
+    }
+    int status = 0;
+    waitpid(pid, &status, 0);
+    ASSERT_EQ(status, 0);
+
+    ASSERT_TRUE(adapter->IsUpdated());
+    ASSERT_FALSE(e.Enforce({"bob", "data1", "read"}));
+    e.LoadPolicy();
+    ASSERT_EQ(adapter->GetLoadedGeneration(), 2);
+    ASSERT_TRUE(e.Enforce({"bob", "data1", "read"}));
+
+    casbin::SharedMemoryAdapter::Unlink(name);
+}
+
+TEST(TestSharedMemoryAdapter, TestCorruptSnapshot) {
+    std::string name = StoreName("corrupt");
+    casbin::Enforcer loader(rbac_model_path, rbac_policy_path);
+    uint64_t generation = casbin::SharedMemoryAdapter::Publish(name, loader.GetModel());
+
+    std::string segment_name = name + "." + std::to_string(generation);
+    int fd = shm_open(segment_name.c_str(), O_RDWR, 0);
+    ASSERT_GE(fd, 0);
+    struct stat st;
+    ASSERT_EQ(fstat(fd, &st), 0);
+    void* data = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    ASSERT_NE(data, MAP_FAILED);
+
+    // the header is magic, version, size, string count, assertion count, rows size, characters size
+    uint64_t* header = reinterpret_cast<uint64_t*>(static_cast<char*>(data) + 2 * sizeof(uint32_t));
+    uint64_t rows_size = header[3];
+    header[3] = uint64_t(1) << 60;
+    auto adapter = casbin::SharedMemoryAdapter::NewSharedMemoryAdapter(name);
+    ASSERT_THROW(casbin::Enforcer(rbac_model_path, adapter), casbin::CasbinAdapterException);
+
+    // a string id past the interned strings, in the last row
+    header[3] = rows_size;
+    casbin::Enforcer e(rbac_model_path, adapter);
+    uint64_t string_count = header[1];
+    uint64_t assertion_count = header[2];
+    size_t rows_at = (sizeof(uint32_t) * 2 + sizeof(uint64_t) * 5 + 7) / 8 * 8;
+    rows_at = (rows_at + (string_count + 1) * sizeof(uint64_t) + 7) / 8 * 8;
+    rows_at = (rows_at + assertion_count * (2 * sizeof(uint32_t) + 2 * sizeof(uint64_t)) + 7) / 8 * 8;
+    uint32_t* rows = reinterpret_cast<uint32_t*>(static_cast<char*>(data) + rows_at);
+    rows[rows_size - 1] = static_cast<uint32_t>(string_count);
+    ASSERT_THROW(e.LoadPolicy(), casbin::CasbinAdapterException);
+
+    munmap(data, st.st_size);
+    casbin::SharedMemoryAdapter::Unlink(name);
+}
+
+TEST(TestSharedMemoryAdapter, TestConcurrentPublishers) {
+    std::string name = StoreName("publishers");
+    casbin::Enforcer loader(rbac_model_path, rbac_policy_path);
+
+    std::vector<std::thread> publishers;
+    for (int i = 0; i < 4; ++i) {
+        publishers.emplace_back([&] {
+            for (int j = 0; j < 8; ++j)
+                casbin::SharedMemoryAdapter::Publish(name, loader.GetModel());
+        });
+    }
+    for (auto& publisher : publishers)
+        publisher.join();
+
+    // the latest reserved generation is the current one, every other snapshot was unlinked
+    auto adapter = casbin::SharedMemoryAdapter::NewSharedMemoryAdapter(name);
+    ASSERT_EQ(adapter->GetGeneration(), 32);
+    for (uint64_t generation = 1; generation < 32; ++generation) {
+        std::string segment_name = name + "." + std::to_string(generation);
+        ASSERT_LT(shm_open(segment_name.c_str(), O_RDONLY, 0), 0);
+    }
+    casbin::Enforcer e(rbac_model_path, adapter);
+    ASSERT_TRUE(e.Enforce({"alice", "data1", "read"}));
+
+    casbin::SharedMemoryAdapter::Unlink(name);
+}
+
+TEST(TestSharedMemoryAdapter, TestMissingStore) {
+    casbin::SharedMemoryAdapter adapter(StoreName("missing"));
+    ASSERT_EQ(adapter.GetGeneration(), 0);
+    ASSERT_THROW(casbin::Enforcer(rbac_model_path, std::make_shared<casbin::SharedMemoryAdapter>(adapter)), casbin::CasbinAdapterException);
+}
+
+} // namespace
+
+#endif // _WIN32
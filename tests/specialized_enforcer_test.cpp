@@ -0,0 +1,144 @@
+/*
+ * Copyright 2021 The casbin Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This is a test file for comparing casbin::SpecializedEnforcer with the generic enforcer
+ */
+
+#include <casbin/casbin.h>
+#include <gtest/gtest.h>
+
+#include "config_path.h"
+
+namespace {
+
+const std::vector<std::string> s_subjects = {"alice", "bob", "carol", "admin", "data1_admin", "data2_admin", ""};
+const std::vector<std::string> s_domains = {"domain1", "domain2", ""};
+const std::vector<std::string> s_objects = {"data1", "data2", "data3", ""};
+const std::vector<std::string> s_actions = {"read", "write", ""};
+
+// AssertSameDecisions compares every request of the vocabulary with the generic enforcer.
+template <typename Specialized>
+void AssertSameDecisions(casbin::Enforcer& e, const Specialized& specialized) {
+    for (const auto& sub : s_subjects)
+        for (const auto& obj : s_objects)
+            for (const auto& act : s_actions)
+                ASSERT_EQ(specialized.Enforce(sub, obj, act), e.Enforce({sub, obj, act})) << sub << ", " << obj << ", " << act;
+}
+
+void AssertSameDomainDecisions(casbin::Enforcer& e, const casbin::SpecializedEnforcer<casbin::RbacWithDomainsMatcher>& specialized) {
+    for (const auto& sub : s_subjects)
+        for (const auto& dom : s_domains)
+            for (const auto& obj : s_objects)
+                for (const auto& act : s_actions)
+                    ASSERT_EQ(specialized.Enforce(sub, dom, obj, act), e.Enforce({sub, dom, obj, act})) << sub << ", " << dom << ", " << obj << ", " << act;
+}
+
+TEST(TestSpecializedEnforcer, TestAcl) {
+    casbin::Enforcer e(basic_model_path, basic_policy_path);
+    casbin::SpecializedEnforcer<casbin::AclMatcher> acl(e);
+    ASSERT_TRUE(acl.Enforce("alice", "data1", "read"));
+    ASSERT_FALSE(acl.Enforce("alice", "data2", "read"));
+    ASSERT_TRUE(acl.Enforce({"bob", "data2", "write"}));
+    ASSERT_THROW(acl.Enforce({"bob", "data2"}), casbin::CasbinEnforcerException);
+    AssertSameDecisions(e, acl);
+
+    // policy changes through the enforcer are seen right away
+    e.AddPolicy({"carol", "data3", "read"});
+    e.RemovePolicy({"alice", "data1", "read"});
+    ASSERT_TRUE(acl.Enforce("carol", "data3", "read"));
+    AssertSameDecisions(e, acl);
+
+    e.ClearPolicy();
+    AssertSameDecisions(e, acl);
+}
+
+TEST(TestSpecializedEnforcer, TestRbac) {
+    casbin::Enforcer e(rbac_model_path, rbac_policy_path);
+    casbin::SpecializedEnforcer<casbin::RbacMatcher> rbac(e);
+    ASSERT_TRUE(rbac.Enforce("alice", "data2", "read"));
+    ASSERT_FALSE(rbac.Enforce("bob", "data2", "read"));
+    AssertSameDecisions(e, rbac);
+
+    e.AddGroupingPolicy({"bob", "data2_admin"});
+    e.RemoveGroupingPolicy({"alice", "data2_admin"});
+    ASSERT_TRUE(rbac.Enforce("bob", "data2", "read"));
+    AssertSameDecisions(e, rbac);
+
+    casbin::Enforcer hierarchy(rbac_model_path, rbac_with_hierarchy_policy_path);
+    casbin::SpecializedEnforcer<casbin::RbacMatcher> hierarchy_rbac(hierarchy);
+    ASSERT_TRUE(hierarchy_rbac.Enforce("alice", "data1", "write"));
+    AssertSameDecisions(hierarchy, hierarchy_rbac);
+}
+
+TEST(TestSpecializedEnforcer, TestRbacWithDeny) {
+    casbin::Enforcer e(rbac_with_deny_model_path, rbac_with_deny_policy_path);
+    casbin::SpecializedEnforcer<casbin::RbacMatcher, casbin::EffectPolicy::AllowAndDeny> rbac(e);
+    ASSERT_TRUE(rbac.Enforce("alice", "data2", "read"));
+    ASSERT_FALSE(rbac.Enforce("alice", "data2", "write"));
+    AssertSameDecisions(e, rbac);
+
+    e.AddPolicy({"data2_admin", "data2", "read", "deny"});
+    e.AddPolicy({"carol", "data3", "read", "unknown"});
+    AssertSameDecisions(e, rbac);
+}
+
+TEST(TestSpecializedEnforcer, TestRbacWithNotDeny) {
+    casbin::Enforcer e(rbac_with_not_deny_model_path, rbac_with_deny_policy_path);
+    casbin::SpecializedEnforcer<casbin::RbacMatcher, casbin::EffectPolicy::DenyOverride> rbac(e);
+    ASSERT_TRUE(rbac.Enforce("alice", "data2", "read"));
+    ASSERT_FALSE(rbac.Enforce("alice", "data2", "write"));
+    // no rule denies it
+    ASSERT_TRUE(rbac.Enforce("carol", "data3", "read"));
+    AssertSameDecisions(e, rbac);
+
+    e.AddPolicy({"data2_admin", "data2", "read", "deny"});
+    e.AddGroupingPolicy({"bob", "data2_admin"});
+    AssertSameDecisions(e, rbac);
+
+    e.ClearPolicy();
+    AssertSameDecisions(e, rbac);
+}
+
+TEST(TestSpecializedEnforcer, TestRbacWithDomains) {
+    casbin::Enforcer e(rbac_with_domains_model_path, rbac_with_domains_policy_path);
+    casbin::SpecializedEnforcer<casbin::RbacWithDomainsMatcher> rbac(e);
+    ASSERT_TRUE(rbac.Enforce("alice", "domain1", "data1", "read"));
+    ASSERT_FALSE(rbac.Enforce("alice", "domain2", "data2", "read"));
+    AssertSameDomainDecisions(e, rbac);
+
+    e.AddNamedGroupingPolicy("g", {"alice", "admin", "domain2"});
+    e.AddPolicy({"carol", "domain1", "data3", "write"});
+    ASSERT_TRUE(rbac.Enforce("alice", "domain2", "data2", "read"));
+    AssertSameDomainDecisions(e, rbac);
+}
+
+TEST(TestSpecializedEnforcer, TestModelMismatch) {
+    casbin::Enforcer acl(basic_model_path, basic_policy_path);
+    casbin::Enforcer rbac(rbac_model_path, rbac_policy_path);
+    casbin::Enforcer deny(rbac_with_deny_model_path, rbac_with_deny_policy_path);
+    casbin::Enforcer domains(rbac_with_domains_model_path, rbac_with_domains_policy_path);
+
+    ASSERT_THROW(casbin::SpecializedEnforcer<casbin::RbacMatcher>{acl}, casbin::CasbinEnforcerException);
+    ASSERT_THROW(casbin::SpecializedEnforcer<casbin::AclMatcher>{rbac}, casbin::CasbinEnforcerException);
+    ASSERT_THROW(casbin::SpecializedEnforcer<casbin::RbacMatcher>{deny}, casbin::CasbinEnforcerException);
+    using AllowAndDenyRbac = casbin::SpecializedEnforcer<casbin::RbacMatcher, casbin::EffectPolicy::AllowAndDeny>;
+    ASSERT_THROW(AllowAndDenyRbac{rbac}, casbin::CasbinEnforcerException);
+    using DenyOverrideRbac = casbin::SpecializedEnforcer<casbin::RbacMatcher, casbin::EffectPolicy::DenyOverride>;
+    ASSERT_THROW(DenyOverrideRbac{deny}, casbin::CasbinEnforcerException);
+    ASSERT_THROW(casbin::SpecializedEnforcer<casbin::RbacMatcher>{domains}, casbin::CasbinEnforcerException);
+    ASSERT_THROW(casbin::SpecializedEnforcer<casbin::RbacWithDomainsMatcher>{rbac}, casbin::CasbinEnforcerException);
+}
+
+} // namespace
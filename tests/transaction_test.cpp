@@ -0,0 +1,304 @@
+/*
+ * Copyright 2021 The casbin Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This is a test file for committing staged policy changes with casbin::Transaction
+ */
+
+#include <casbin/casbin.h>
+#include <gtest/gtest.h>
+
+#include "config_path.h"
+
+namespace {
+
+class CountingWatcher : public casbin::Watcher {
+public:
+    int updates = 0;
+
+    void Update() override {
+        ++updates;
+    }
+
+    void Close() override {
+    }
+};
+
+// CountingWatcherEx counts the notifications of a WatcherEx that has no batch methods.
+class CountingWatcherEx : public casbin::WatcherEx {
+public:
+    int updates = 0;
+    // The batches heard of, as "+p" or "-g" followed by the number of rules
+    std::vector<std::string> batches;
+
+    void Update() override {
+        ++updates;
+    }
+
+    void Close() override {
+    }
+
+    void UpdateForAddPolicy(std::vector<std::string> /*params*/) override {
+        batches.push_back("+1");
+    }
+
+    void UpdateForRemovePolicy(std::vector<std::string> /*params*/) override {
+        batches.push_back("-1");
+    }
+
+    void UpdateForRemoveFilteredPolicy(int /*field_index*/, std::vector<std::string> /*field_values*/) override {
+    }
+
+    void UpdateForSavePolicy(const std::shared_ptr<casbin::Model>& /*model*/) override {
+    }
+};
+
+class RecordingWatcherEx : public CountingWatcherEx {
+public:
+    void UpdateForAddPolicies(const std::string& /*sec*/, const std::string& p_type, const PoliciesValues& rules) override {
+        batches.push_back("+" + p_type + std::to_string(rules.size()));
+    }
+
+    void UpdateForRemovePolicies(const std::string& /*sec*/, const std::string& p_type, const PoliciesValues& rules) override {
+        batches.push_back("-" + p_type + std::to_string(rules.size()));
+    }
+};
+
+class CountingBatchAdapter : public casbin::BatchFileAdapter {
+public:
+    int batches = 0;
+    int single_writes = 0;
+    bool fail_adds = false;
+
+    CountingBatchAdapter(const std::string& file_path)
+        : casbin::BatchFileAdapter(file_path) {
+    }
+
+    void AddPolicy(std::string /*sec*/, std::string /*p_type*/, std::vector<std::string> /*rule*/) override {
+        ++single_writes;
+    }
+
+    void RemovePolicy(std::string /*sec*/, std::string /*p_type*/, std::vector<std::string> /*rule*/) override {
+        ++single_writes;
+    }
+
+    void AddPolicies(std::string /*sec*/, std::string /*p_type*/, PoliciesValues /*rules*/) override {
+        if (fail_adds)
+            throw casbin::CasbinAdapterException("storage unavailable");
+        ++batches;
+    }
+
+    void RemovePolicies(std::string /*sec*/, std::string /*p_type*/, PoliciesValues /*rules*/) override {
+        ++batches;
+    }
+};
+
+// LoggingAdapter logs the single rule writes it is given, it has no batch writes.
+class LoggingAdapter : public casbin::FileAdapter {
+public:
+    // The writes, as "+" or "-" followed by the first value of the rule
+    std::vector<std::string> writes;
+    // Adding a rule of this first value fails
+    std::string failing;
+
+    LoggingAdapter(const std::string& file_path)
+        : casbin::FileAdapter(file_path) {
+    }
+
+    void AddPolicy(std::string /*sec*/, std::string /*p_type*/, std::vector<std::string> rule) override {
+        if (rule[0] == failing)
+            throw casbin::CasbinAdapterException("storage unavailable");
+        writes.push_back("+" + rule[0]);
+    }
+
+    void RemovePolicy(std::string /*sec*/, std::string /*p_type*/, std::vector<std::string> rule) override {
+        writes.push_back("-" + rule[0]);
+    }
+};
+
+TEST(TestTransaction, TestStagingValidation) {
+    casbin::Enforcer e(rbac_model_path, rbac_policy_path);
+    casbin::Transaction transaction = e.BeginTransaction();
+
+    ASSERT_FALSE(transaction.AddPolicy({"alice", "data1", "read"}));
+    ASSERT_TRUE(transaction.AddPolicy({"carol", "data1", "read"}));
+    ASSERT_FALSE(transaction.AddPolicy({"carol", "data1", "read"}));
+    ASSERT_FALSE(transaction.RemovePolicy({"carol", "data9", "read"}));
+    ASSERT_TRUE(transaction.RemovePolicy({"carol", "data1", "read"}));
+    ASSERT_FALSE(transaction.UpdatePolicy({"bob", "data2", "write"}, {"alice", "data1", "read"}));
+    ASSERT_FALSE(transaction.AddNamedPolicy("p9", {"carol", "data1", "read"}));
+    ASSERT_EQ(transaction.GetOperations().size(), 2);
+
+    // rules are compared like the model compares them
+    ASSERT_FALSE(transaction.AddPolicy({"data1", "alice", "read"}));
+    ASSERT_TRUE(transaction.RemovePolicy({"read", "data1", "alice"}));
+    ASSERT_TRUE(transaction.AddPolicy({"alice", "data1", "read"}));
+    ASSERT_EQ(transaction.GetOperations().size(), 4);
+
+    // nothing is applied before the commit
+    ASSERT_FALSE(e.HasPolicy({"carol", "data1", "read"}));
+    transaction.Rollback();
+    ASSERT_TRUE(transaction.GetOperations().empty());
+}
+
+TEST(TestTransaction, TestCommit) {
+    auto adapter = std::make_shared<CountingBatchAdapter>(rbac_policy_path);
+    casbin::Enforcer e(rbac_model_path, adapter);
+    auto watcher = std::make_shared<CountingWatcher>();
+    e.SetWatcher(watcher);
+
+    casbin::Transaction transaction = e.BeginTransaction();
+    ASSERT_TRUE(transaction.AddPolicy({"carol", "data3", "read"}));
+    ASSERT_TRUE(transaction.AddPolicy({"dave", "data3", "read"}));
+    ASSERT_TRUE(transaction.RemovePolicy({"bob", "data2", "write"}));
+    ASSERT_TRUE(transaction.UpdatePolicy({"alice", "data1", "read"}, {"alice", "data1", "write"}));
+    ASSERT_TRUE(transaction.AddGroupingPolicy({"carol", "data2_admin"}));
+    ASSERT_TRUE(transaction.RemoveGroupingPolicy({"alice", "data2_admin"}));
+    ASSERT_TRUE(transaction.Commit());
+    ASSERT_TRUE(transaction.GetOperations().empty());
+
+    ASSERT_TRUE(e.Enforce({"carol", "data3", "read"}));
+    ASSERT_TRUE(e.Enforce({"carol", "data2", "write"}));
+    ASSERT_FALSE(e.Enforce({"bob", "data2", "write"}));
+    ASSERT_FALSE(e.Enforce({"alice", "data1", "read"}));
+    ASSERT_TRUE(e.Enforce({"alice", "data1", "write"}));
+    ASSERT_FALSE(e.Enforce({"alice", "data2", "read"}));
+
+    // one batch per direction and policy type, one notification
+    ASSERT_EQ(adapter->batches, 4);
+    ASSERT_EQ(adapter->single_writes, 0);
+    ASSERT_EQ(watcher->updates, 1);
+
+    // the rules are appended in the order they were staged
+    PoliciesValues policy = e.GetPolicy();
+    ASSERT_EQ(std::vector<std::vector<std::string>>(policy.begin(), policy.end()),
+              std::vector<std::vector<std::string>>({{"data2_admin", "data2", "read"}, {"data2_admin", "data2", "write"}, {"carol", "data3", "read"}, {"dave", "data3", "read"}, {"alice", "data1", "write"}}));
+}
+
+TEST(TestTransaction, TestCommitNotifiesWatcherEx) {
+    casbin::Enforcer e(rbac_model_path, rbac_policy_path);
+    e.EnableAutoSave(false);
+    auto watcher = std::make_shared<RecordingWatcherEx>();
+    e.SetWatcher(watcher);
+
+    casbin::Transaction transaction = e.BeginTransaction();
+    ASSERT_TRUE(transaction.AddPolicy({"carol", "data3", "read"}));
+    ASSERT_TRUE(transaction.RemovePolicy({"bob", "data2", "write"}));
+    ASSERT_TRUE(transaction.UpdatePolicy({"alice", "data1", "read"}, {"alice", "data1", "write"}));
+    ASSERT_TRUE(transaction.AddGroupingPolicy({"carol", "data2_admin"}));
+    ASSERT_TRUE(transaction.Commit());
+
+    // the rules changed, one batch per direction and policy type
+    ASSERT_EQ(watcher->batches, std::vector<std::string>({"-p2", "+p2", "+g1"}));
+    ASSERT_EQ(watcher->updates, 0);
+}
+
+TEST(TestTransaction, TestCommitNotifiesDefaultWatcherEx) {
+    casbin::Enforcer e(rbac_model_path, rbac_policy_path);
+    e.EnableAutoSave(false);
+    auto watcher = std::make_shared<CountingWatcherEx>();
+    e.SetWatcher(watcher);
+
+    casbin::Transaction transaction = e.BeginTransaction();
+    ASSERT_TRUE(transaction.AddPolicy({"carol", "data3", "read"}));
+    ASSERT_TRUE(transaction.AddPolicy({"dave", "data3", "read"}));
+    ASSERT_TRUE(transaction.AddPolicy({"erin", "data3", "read"}));
+    ASSERT_TRUE(transaction.Commit());
+
+    // without batch methods, one update for the batch instead of one per rule
+    ASSERT_TRUE(watcher->batches.empty());
+    ASSERT_EQ(watcher->updates, 1);
+}
+
+TEST(TestTransaction, TestStagingManyOperations) {
+    casbin::Enforcer e(rbac_model_path, rbac_policy_path);
+    e.EnableAutoSave(false);
+
+    casbin::Transaction transaction = e.BeginTransaction();
+    for (int i = 0; i < 1000; i++)
+        ASSERT_TRUE(transaction.AddPolicy({"user" + std::to_string(i), "data1", "read"}));
+    for (int i = 0; i < 1000; i += 2)
+        ASSERT_TRUE(transaction.RemovePolicy({"user" + std::to_string(i), "data1", "read"}));
+    // rules compare whatever the order of their values
+    ASSERT_FALSE(transaction.AddPolicy({"read", "user1", "data1"}));
+    ASSERT_FALSE(transaction.RemovePolicy({"user0", "data1", "read"}));
+    ASSERT_TRUE(transaction.RemovePolicy({"alice", "data1", "read"}));
+    ASSERT_TRUE(transaction.AddPolicy({"alice", "data1", "read"}));
+    ASSERT_TRUE(transaction.Commit());
+
+    ASSERT_EQ(e.GetPolicy().size(), 504);
+    ASSERT_TRUE(e.HasPolicy({"alice", "data1", "read"}));
+    ASSERT_TRUE(e.HasPolicy({"user999", "data1", "read"}));
+    ASSERT_FALSE(e.HasPolicy({"user998", "data1", "read"}));
+}
+
+TEST(TestTransaction, TestCommitRejectsStaleOperations) {
+    casbin::Enforcer e(rbac_model_path, rbac_policy_path);
+    e.EnableAutoSave(false);
+
+    casbin::Transaction transaction = e.BeginTransaction();
+    ASSERT_TRUE(transaction.AddPolicy({"carol", "data3", "read"}));
+    ASSERT_TRUE(transaction.RemovePolicy({"bob", "data2", "write"}));
+
+    // the policy changed after staging
+    e.RemovePolicy({"bob", "data2", "write"});
+    ASSERT_FALSE(transaction.Commit());
+    ASSERT_FALSE(e.HasPolicy({"carol", "data3", "read"}));
+    ASSERT_EQ(e.GetPolicy().size(), 3);
+}
+
+TEST(TestTransaction, TestRollbackOnAdapterFailure) {
+    auto adapter = std::make_shared<CountingBatchAdapter>(rbac_policy_path);
+    casbin::Enforcer e(rbac_model_path, adapter);
+    adapter->fail_adds = true;
+
+    casbin::Transaction transaction = e.BeginTransaction();
+    ASSERT_TRUE(transaction.RemovePolicy({"alice", "data1", "read"}));
+    ASSERT_TRUE(transaction.AddGroupingPolicy({"bob", "data2_admin"}));
+    ASSERT_THROW(transaction.Commit(), casbin::CasbinAdapterException);
+
+    ASSERT_TRUE(e.Enforce({"alice", "data1", "read"}));
+    ASSERT_FALSE(e.Enforce({"bob", "data2", "read"}));
+    ASSERT_EQ(e.GetPolicy().size(), 4);
+    ASSERT_TRUE(transaction.GetOperations().empty());
+}
+
+TEST(TestTransaction, TestRollbackSingleWritesOnAdapterFailure) {
+    auto adapter = std::make_shared<LoggingAdapter>(rbac_policy_path);
+    casbin::Enforcer e(rbac_model_path, adapter);
+    adapter->failing = "carol";
+
+    // the rule removed from the storage before the add failed is written back
+    casbin::Transaction transaction = e.BeginTransaction();
+    ASSERT_TRUE(transaction.RemovePolicy({"alice", "data1", "read"}));
+    ASSERT_TRUE(transaction.AddPolicy({"carol", "data3", "read"}));
+    adapter->writes.clear();
+    ASSERT_THROW(transaction.Commit(), casbin::CasbinAdapterException);
+    ASSERT_EQ(adapter->writes, std::vector<std::string>({"-alice", "+alice"}));
+    ASSERT_TRUE(e.HasPolicy({"alice", "data1", "read"}));
+    ASSERT_FALSE(e.HasPolicy({"carol", "data3", "read"}));
+}
+
+TEST(TestTransaction, TestSyncedEnforcer) {
+    casbin::SyncedEnforcer e(rbac_model_path, rbac_policy_path);
+    e.EnableAutoSave(false);
+
+    casbin::Transaction transaction = e.BeginTransaction();
+    ASSERT_TRUE(transaction.AddPolicy({"carol", "data3", "read"}));
+    ASSERT_TRUE(transaction.AddGroupingPolicy({"dave", "carol"}));
+    ASSERT_TRUE(transaction.Commit());
+    ASSERT_TRUE(e.Enforce({"dave", "data3", "read"}));
+}
+
+} // namespace
@@ -75,6 +75,7 @@ TEST(TestUtil, TestContainEval) {
     testContainEval("eval)( && a && b && c", false);
     testContainEval("eval(c * (a + b)) && a && b && c", true);
     testContainEval("xeval() && a && b && c", false);
+    testContainEval("a && Eval(b)", true);
 }
 
 void testReplaceEvalWithMap(std::string s, std::unordered_map<std::string, std::string> sets, std::string res) { ASSERT_EQ(casbin::ReplaceEvalWithMap(s, sets), res); }
@@ -111,4 +112,25 @@ TEST(TestUtil, TestGetEvalValue) {
     testGetEvalValue("a && eval(a) && eval(b) && b && c", {"a", "b"});
 }
 
+TEST(TestUtil, TestRequestArena) {
+    size_t capacity = casbin::RequestArena::Capacity();
+    {
+        casbin::RequestArena::Scope outer;
+        ASSERT_TRUE(outer.IsOutermost());
+        {
+            casbin::RequestArena::Scope nested;
+            ASSERT_FALSE(nested.IsOutermost());
+        }
+
+        // a request larger than the buffer takes the rest from the heap
+        std::pmr::vector<char> temporaries(capacity * 3, 'x', casbin::RequestArena::Resource());
+        ASSERT_EQ(temporaries.back(), 'x');
+    }
+
+    // and the buffer is enlarged to fit it when the request ends
+    ASSERT_GE(casbin::RequestArena::Capacity(), capacity * 3);
+    casbin::RequestArena::Scope next;
+    ASSERT_TRUE(next.IsOutermost());
+}
+
 } // namespace
@@ -0,0 +1,187 @@
+/*
+ * Copyright 2021 The casbin Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This is a test file for testing the write-behind adapter
+ */
+
+#include <casbin/casbin.h>
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <mutex>
+
+#include "config_path.h"
+
+namespace {
+
+// RecordingAdapter records the calls it gets, and fails those for the "fail" policy type.
+class RecordingAdapter : public casbin::BatchAdapter {
+public:
+    struct Call {
+        std::string method;
+        std::string p_type;
+        std::vector<std::vector<std::string>> rules;
+    };
+
+    std::mutex mutex;
+    std::vector<Call> calls;
+
+    RecordingAdapter() {
+        filtered = false;
+    }
+
+    std::vector<Call> GetCalls() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return calls;
+    }
+
+    void Record(const std::string& method, const std::string& p_type, std::vector<std::vector<std::string>> rules) {
+        if (p_type == "fail")
+            throw casbin::CasbinAdapterException("cannot store " + method);
+        std::lock_guard<std::mutex> lock(mutex);
+        calls.push_back({method, p_type, std::move(rules)});
+    }
+
+    void LoadPolicy(const std::shared_ptr<casbin::Model>& /*model*/) {}
+
+    void SavePolicy(const std::shared_ptr<casbin::Model>& /*model*/) {
+        Record("SavePolicy", "", {});
+    }
+
+    void AddPolicy(std::string /*sec*/, std::string p_type, std::vector<std::string> rule) {
+        Record("AddPolicy", p_type, {rule});
+    }
+
+    void RemovePolicy(std::string /*sec*/, std::string p_type, std::vector<std::string> rule) {
+        Record("RemovePolicy", p_type, {rule});
+    }
+
+    void AddPolicies(std::string /*sec*/, std::string p_type, PoliciesValues rules) {
+        Record("AddPolicies", p_type, std::vector<std::vector<std::string>>(rules.begin(), rules.end()));
+    }
+
+    void RemovePolicies(std::string /*sec*/, std::string p_type, PoliciesValues rules) {
+        Record("RemovePolicies", p_type, std::vector<std::vector<std::string>>(rules.begin(), rules.end()));
+    }
+
+    void RemoveFilteredPolicy(std::string /*sec*/, std::string p_type, int /*field_index*/, std::vector<std::string> field_values) {
+        Record("RemoveFilteredPolicy", p_type, {field_values});
+    }
+
+    bool IsFiltered() {
+        return false;
+    }
+
+    bool IsValid() {
+        return true;
+    }
+};
+
+TEST(TestWriteBehindAdapter, TestCoalescing) {
+    auto recording = std::make_shared<RecordingAdapter>();
+    // an interval no test waits for, only Flush writes the changes
+    auto adapter = casbin::WriteBehindAdapter::NewWriteBehindAdapter(recording, std::chrono::hours(1));
+
+    adapter->AddPolicy("p", "p", {"alice", "data1", "read"});
+    adapter->AddPolicy("p", "p", {"bob", "data2", "write"});
+    adapter->AddPolicy("g", "g", {"alice", "admin"});
+    adapter->RemovePolicy("p", "p", {"bob", "data2", "write"});
+    adapter->RemovePolicy("p", "p", {"alice", "data1", "read"});
+    adapter->AddPolicy("p", "p", {"bob", "data2", "write"});
+    ASSERT_TRUE(recording->GetCalls().empty());
+
+    adapter->Flush().get();
+    auto calls = recording->GetCalls();
+    ASSERT_EQ(calls.size(), 4);
+    ASSERT_EQ(calls[0].method, "AddPolicies");
+    ASSERT_EQ(calls[0].rules, std::vector<std::vector<std::string>>({{"alice", "data1", "read"}, {"bob", "data2", "write"}}));
+    ASSERT_EQ(calls[1].method, "AddPolicies");
+    ASSERT_EQ(calls[1].p_type, "g");
+    ASSERT_EQ(calls[2].method, "RemovePolicies");
+    ASSERT_EQ(calls[2].rules, std::vector<std::vector<std::string>>({{"bob", "data2", "write"}, {"alice", "data1", "read"}}));
+    ASSERT_EQ(calls[3].method, "AddPolicies");
+    ASSERT_EQ(calls[3].rules, std::vector<std::vector<std::string>>({{"bob", "data2", "write"}}));
+}
+
+TEST(TestWriteBehindAdapter, TestMaxBatch) {
+    auto recording = std::make_shared<RecordingAdapter>();
+    auto adapter = casbin::WriteBehindAdapter::NewWriteBehindAdapter(recording, std::chrono::hours(1), 4);
+
+    std::vector<std::future<void>> stored;
+    for (int i = 0; i < 10; i++)
+        stored.push_back(adapter->AddPolicyAsync("p", "p", {"user" + std::to_string(i), "data", "read"}));
+    // the first full batch is written without a flush
+    stored[3].get();
+
+    adapter->Flush().get();
+    auto calls = recording->GetCalls();
+    size_t rules = 0;
+    for (const auto& call : calls) {
+        ASSERT_EQ(call.method, "AddPolicies");
+        ASSERT_LE(call.rules.size(), 4);
+        for (const auto& rule : call.rules)
+            ASSERT_EQ(rule[0], "user" + std::to_string(rules++));
+    }
+    ASSERT_EQ(rules, 10);
+}
+
+TEST(TestWriteBehindAdapter, TestErrors) {
+    auto recording = std::make_shared<RecordingAdapter>();
+    auto adapter = casbin::WriteBehindAdapter::NewWriteBehindAdapter(recording, std::chrono::hours(1));
+
+    auto failed = adapter->AddPolicyAsync("p", "fail", {"alice", "data1", "read"});
+    auto stored = adapter->AddPolicyAsync("p", "p", {"alice", "data1", "read"});
+    ASSERT_THROW(adapter->Flush().get(), casbin::CasbinAdapterException);
+    ASSERT_THROW(failed.get(), casbin::CasbinAdapterException);
+    stored.get();
+    // the failure is reported once
+    adapter->Flush().get();
+
+    auto errors = adapter->TakeErrors();
+    ASSERT_EQ(errors.size(), 1);
+    ASSERT_EQ(errors[0].op, casbin::policy_add);
+    ASSERT_EQ(errors[0].p_type, "fail");
+    ASSERT_EQ(errors[0].rules.size(), 1);
+    ASSERT_THROW(std::rethrow_exception(errors[0].error), casbin::CasbinAdapterException);
+    ASSERT_TRUE(adapter->TakeErrors().empty());
+
+    // a failure before a direct call is thrown by it
+    adapter->AddPolicy("p", "fail", {"bob", "data2", "write"});
+    ASSERT_THROW(adapter->SavePolicy(nullptr), casbin::CasbinAdapterException);
+    ASSERT_EQ(recording->GetCalls().back().method, "AddPolicies");
+    adapter->SavePolicy(nullptr);
+    ASSERT_EQ(recording->GetCalls().back().method, "SavePolicy");
+}
+
+TEST(TestWriteBehindAdapter, TestEnforcer) {
+    auto recording = std::make_shared<RecordingAdapter>();
+    auto adapter = casbin::WriteBehindAdapter::NewWriteBehindAdapter(recording, std::chrono::hours(1));
+    casbin::Enforcer e(basic_model_path, adapter);
+
+    ASSERT_TRUE(e.AddPolicy({"alice", "data1", "read"}));
+    ASSERT_TRUE(e.AddPolicy({"bob", "data2", "write"}));
+    ASSERT_TRUE(e.Enforce({"alice", "data1", "read"}));
+    ASSERT_TRUE(recording->GetCalls().empty());
+
+    // saving the whole policy waits for the queued changes
+    e.SavePolicy();
+    auto calls = recording->GetCalls();
+    ASSERT_EQ(calls.size(), 2);
+    ASSERT_EQ(calls[0].method, "AddPolicies");
+    ASSERT_EQ(calls[0].rules.size(), 2);
+    ASSERT_EQ(calls[1].method, "SavePolicy");
+}
+
+} // namespace